@@ -4,15 +4,11 @@
 #include "hhh_loop.h"
 
 struct State {
-  struct Map **subnet_indexers;
-  struct DoubleChain **allocators;
-  struct Vector **subnet_buckets;
-  struct Vector **subnets;
-  uint64_t threshold_rate; // B/s
-  int n_subnets;
+  struct HHH *hhh;
   uint32_t capacity;
   uint32_t dev_count;
 };
 
-struct State *alloc_state(uint64_t link_capacity, uint8_t threshold, uint32_t subnets_mask, uint32_t capacity, uint32_t dev_count);
-#endif //_STATE_H_INCLUDED_
+struct State *alloc_state(uint64_t link_capacity, uint8_t threshold, uint32_t subnets_mask, uint64_t burst, uint32_t capacity,
+                          uint32_t dev_count);
+#endif //_STATE_H_INCLUDED_
\ No newline at end of file
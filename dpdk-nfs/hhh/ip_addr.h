@@ -1,31 +0,0 @@
-#ifndef _ip_addr_GEN_H_INCLUDED_
-#define _ip_addr_GEN_H_INCLUDED_
-
-#include <stdbool.h>
-#include "lib/util/boilerplate.h"
-
-#include "lib/util/ether.h"
-
-#define DEFAULT_ip_addr ip_addrc(0)
-
-#include <stdint.h>
-
-struct ip_addr {
-  uint32_t addr;
-} PACKED_FOR_KLEE_VERIFICATION;
-
-#define LOG_IP_ADDR(obj, p)                                                                                                                \
-  ;                                                                                                                                        \
-  p("{");                                                                                                                                  \
-  p("addr: %d", obj->addr);                                                                                                                \
-  p("}");
-
-#ifdef KLEE_VERIFICATION
-#include <klee/klee.h>
-#include "lib/models/str-descr.h"
-
-extern struct str_field_descr ip_addr_descrs[1];
-extern struct nested_field_descr ip_addr_nests[0];
-#endif // KLEE_VERIFICATION
-
-#endif //_ip_addr_GEN_H_INCLUDED_
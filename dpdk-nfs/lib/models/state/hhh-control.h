@@ -0,0 +1,9 @@
+#ifndef _HHH_STUB_CONTROL_H_INCLUDED_
+#define _HHH_STUB_CONTROL_H_INCLUDED_
+
+#include "lib/state/hhh.h"
+#include "../util/time-control.h"
+
+void hhh_reset(struct HHH *hhh);
+
+#endif
\ No newline at end of file
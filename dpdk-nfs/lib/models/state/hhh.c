@@ -0,0 +1,72 @@
+#include "lib/state/hhh.h"
+
+#include "hhh-control.h"
+
+#include <klee/klee.h>
+#include <stdlib.h>
+
+struct HHH {
+  uint32_t capacity;
+  uint32_t subnets_mask;
+};
+
+void hhh_reset(struct HHH *hhh) {}
+
+int hhh_allocate(uint32_t capacity, uint32_t subnets_mask, uint64_t rate, uint64_t burst, struct HHH **hhh_out) {
+  klee_trace_ret();
+
+  klee_trace_param_u32(capacity, "capacity");
+  klee_trace_param_u32(subnets_mask, "subnets_mask");
+  klee_trace_param_u64(rate, "rate");
+  klee_trace_param_u64(burst, "burst");
+  klee_trace_param_ptr(hhh_out, sizeof(struct HHH *), "hhh_out");
+
+  int allocation_succeeded = klee_int("hhh_allocation_succeeded");
+
+  if (allocation_succeeded) {
+    *hhh_out = malloc(sizeof(struct HHH));
+    klee_make_symbolic((*hhh_out), sizeof(struct HHH), "hhh");
+    klee_assert((*hhh_out) != NULL);
+    (*hhh_out)->capacity     = capacity;
+    (*hhh_out)->subnets_mask = subnets_mask;
+  }
+
+  return allocation_succeeded;
+}
+
+int hhh_update(struct HHH *hhh, uint32_t addr, uint16_t pkt_len, time_ns_t time, uint32_t *hh_out, uint8_t *hh_prefix_len_out) {
+  klee_trace_ret();
+
+  klee_trace_param_u64((uint64_t)hhh, "hhh");
+  klee_trace_param_u32(addr, "addr");
+  klee_trace_param_u16(pkt_len, "pkt_len");
+  klee_trace_param_u64(time, "time");
+  klee_trace_param_ptr(hh_out, sizeof(uint32_t), "hh_out");
+  klee_trace_param_ptr(hh_prefix_len_out, sizeof(uint8_t), "hh_prefix_len_out");
+
+  klee_assert(hhh != NULL);
+
+  int hh_detected = klee_int("hh_detected");
+  if (hh_detected) {
+    *hh_out            = klee_int("hh");
+    *hh_prefix_len_out = klee_int("hh_prefix_len");
+    klee_assume(*hh_prefix_len_out >= 1);
+    klee_assume(*hh_prefix_len_out <= 32);
+  }
+
+  return hh_detected;
+}
+
+int hhh_expire(struct HHH *hhh, time_ns_t time) {
+  klee_trace_ret();
+
+  klee_trace_param_u64((uint64_t)hhh, "hhh");
+  klee_trace_param_u64(time, "time");
+
+  klee_assert(hhh != NULL);
+
+  int nfreed = klee_int("number_of_freed_flows");
+  klee_assume(0 <= nfreed);
+
+  return nfreed;
+}
@@ -3,34 +3,29 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <assert.h>
+#include <string.h>
 
 #include "lib/util/boilerplate.h"
-#include "lib/state/vector.h"
 #include "lib/util/time.h"
 #include "lib/util/hash.h"
 #include "lib/util/compute.h"
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
+// Counters are laid out row-major, each row's width rounded up to a power of two. The key is hashed once per operation, and the counter of
+// each row is then picked by double hashing: row h uses (h1 + h * h2) masked by the width, with h1 and h2 derived from that single hash.
 struct CMS {
-  struct Vector *buckets;
+  uint32_t *counters;
 
   uint32_t height;
   uint32_t width;
+  uint32_t width_mask;
   uint32_t key_size;
   time_ns_t cleanup_interval;
 
   time_ns_t last_cleanup;
 };
 
-struct hash {
-  uint32_t value;
-};
-
-struct cms_bucket {
-  uint64_t value;
-};
-
 int cms_allocate(uint32_t height, uint32_t width, uint32_t key_size, time_ns_t periodic_cleanup_interval, struct CMS **cms_out) {
   assert(height > 0);
   assert(width > 0);
@@ -41,51 +36,74 @@ int cms_allocate(uint32_t height, uint32_t width, uint32_t key_size, time_ns_t p
     return 0;
   }
 
+  if (!is_power_of_two(width)) {
+    width = ensure_power_of_two(width);
+  }
+
+  uint32_t *counters_alloc = (uint32_t *)calloc((size_t)height * width, sizeof(uint32_t));
+  if (counters_alloc == NULL) {
+    free(cms_alloc);
+    return 0;
+  }
+
   (*cms_out) = cms_alloc;
 
+  (*cms_out)->counters         = counters_alloc;
   (*cms_out)->height           = height;
   (*cms_out)->width            = width;
+  (*cms_out)->width_mask       = width - 1;
   (*cms_out)->key_size         = key_size;
   (*cms_out)->cleanup_interval = periodic_cleanup_interval;
 
   (*cms_out)->last_cleanup = 0;
 
-  uint32_t capacity = ensure_power_of_two(height * width);
+  return 1;
+}
 
-  (*cms_out)->buckets = NULL;
-  if (vector_allocate(sizeof(struct cms_bucket), capacity, &((*cms_out)->buckets)) == 0) {
-    return 0;
-  }
+static void cms_offsets(struct CMS *cms, void *key, uint32_t *offsets) {
+  unsigned hash = hash_obj(key, cms->key_size);
+  uint32_t h1   = __builtin_ia32_crc32si(CMS_SALTS[0], hash);
+  uint32_t h2   = __builtin_ia32_crc32si(CMS_SALTS[1], hash) | 1; // Odd, so that rows never collapse into the same column sequence
 
-  return 1;
+  for (uint32_t h = 0; h < cms->height; h++) {
+    offsets[h] = h * cms->width + ((h1 + h * h2) & cms->width_mask);
+  }
 }
 
+static int cms_clamp(uint32_t value) { return value > INT32_MAX ? INT32_MAX : (int)value; }
+
 void cms_increment(struct CMS *cms, void *key) {
-  for (uint32_t h = 0; h < cms->height; h++) {
-    unsigned hash   = __builtin_ia32_crc32si(CMS_SALTS[h], hash_obj(key, cms->key_size));
-    uint32_t offset = h * cms->width + (hash % cms->width);
+  uint32_t offsets[CMS_MAX_SALTS_BANK_SIZE];
+  cms_offsets(cms, key, offsets);
 
-    struct cms_bucket *bucket = 0;
-    vector_borrow(cms->buckets, offset, (void **)&bucket);
-    bucket->value++;
-    vector_return(cms->buckets, offset, bucket);
+  for (uint32_t h = 0; h < cms->height; h++) {
+    cms->counters[offsets[h]]++;
   }
 }
 
 int cms_count_min(struct CMS *cms, void *key) {
-  int min_val = INT32_MAX;
+  uint32_t offsets[CMS_MAX_SALTS_BANK_SIZE];
+  cms_offsets(cms, key, offsets);
 
+  uint32_t min_val = UINT32_MAX;
   for (uint32_t h = 0; h < cms->height; h++) {
-    unsigned hash   = __builtin_ia32_crc32si(CMS_SALTS[h], hash_obj(key, cms->key_size));
-    uint32_t offset = h * cms->width + (hash % cms->width);
+    min_val = MIN(min_val, cms->counters[offsets[h]]);
+  }
+
+  return cms_clamp(min_val);
+}
 
-    struct cms_bucket *bucket = 0;
-    vector_borrow(cms->buckets, offset, (void **)&bucket);
-    min_val = MIN(min_val, bucket->value);
-    vector_return(cms->buckets, offset, bucket);
+int cms_increment_and_count_min(struct CMS *cms, void *key) {
+  uint32_t offsets[CMS_MAX_SALTS_BANK_SIZE];
+  cms_offsets(cms, key, offsets);
+
+  uint32_t min_val = UINT32_MAX;
+  for (uint32_t h = 0; h < cms->height; h++) {
+    uint32_t value = ++cms->counters[offsets[h]];
+    min_val        = MIN(min_val, value);
   }
 
-  return min_val;
+  return cms_clamp(min_val);
 }
 
 int cms_periodic_cleanup(struct CMS *cms, time_ns_t now) {
@@ -98,8 +116,8 @@ int cms_periodic_cleanup(struct CMS *cms, time_ns_t now) {
     return 0;
   }
 
-  vector_clear(cms->buckets);
+  memset(cms->counters, 0, (size_t)cms->height * cms->width * sizeof(uint32_t));
   cms->last_cleanup = now;
 
   return 1;
-}
+}
\ No newline at end of file
@@ -13,6 +13,8 @@ struct CMS;
 int cms_allocate(uint32_t height, uint32_t width, uint32_t key_size, time_ns_t periodic_cleanup_interval, struct CMS **cms_out);
 void cms_increment(struct CMS *cms, void *key);
 int cms_count_min(struct CMS *cms, void *key);
+// Same as cms_increment followed by cms_count_min, hashing the key only once.
+int cms_increment_and_count_min(struct CMS *cms, void *key);
 int cms_periodic_cleanup(struct CMS *cms, time_ns_t now);
 
 #endif
\ No newline at end of file
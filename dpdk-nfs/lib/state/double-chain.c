@@ -58,6 +58,17 @@ int dchain_rejuvenate_index(struct DoubleChain *chain, int index, time_ns_t time
   return ret;
 }
 
+void dchain_rejuvenate_bulk(struct DoubleChain *chain, int *indexes, unsigned n, time_ns_t time, int *results_out) {
+  for (unsigned i = 0; i < n; ++i) {
+    __builtin_prefetch(&chain->cells[indexes[i] + DCHAIN_RESERVED], 1);
+    __builtin_prefetch(&chain->timestamps[indexes[i]], 1);
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    results_out[i] = dchain_rejuvenate_index(chain, indexes[i], time);
+  }
+}
+
 int dchain_expire_one_index(struct DoubleChain *chain, int *index_out, time_ns_t time) {
   int has_ind = dchain_impl_get_oldest_index(chain->cells, index_out);
   if (has_ind) {
@@ -51,6 +51,12 @@ int dchain_rejuvenate_index(struct DoubleChain *chain, int index, time_ns_t time
 //   0 otherwise.
 int dchain_expire_one_index(struct DoubleChain *chain, int *index_out, time_ns_t time);
 
+//   Rejuvenate several indexes at once, in order. Same as calling
+//   dchain_rejuvenate_index on each of them, but all their cells are prefetched
+//   first.
+//   @param results_out - the result of each rejuvenation.
+void dchain_rejuvenate_bulk(struct DoubleChain *chain, int *indexes, unsigned n, time_ns_t time, int *results_out);
+
 int dchain_is_index_allocated(struct DoubleChain *chain, int index);
 
 int dchain_free_index(struct DoubleChain *chain, int index);
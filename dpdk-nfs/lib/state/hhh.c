@@ -0,0 +1,325 @@
+#include "hhh.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+
+#include "lib/util/time.h"
+
+// The subnets of every prefix length live in a single open addressing table, keyed by (prefix length, masked address). Updating all prefix
+// lengths of an address is one pass over a handful of slots (8 per cache line), whose home slots are all hashed and prefetched up front, instead
+// of a map, a dchain and two vectors per prefix length.
+//
+// Slots only hold the key and the index of the subnet's bucket. Buckets live in a separate pool and are chained from the least to the most
+// recently updated one. As time only moves forward, expiring is popping from the head of that chain, for all prefix lengths at once.
+//
+// Erasing uses backward shift deletion, so there are no tombstones and probe sequences never grow with churn.
+
+#define HHH_MAX_LEVELS 32
+#define HHH_NONE ((uint32_t)-1)
+#define HHH_ENTRY_BITS 26
+#define HHH_ENTRY_MASK ((1u << HHH_ENTRY_BITS) - 1)
+
+struct HHHSlot {
+  uint32_t addr;
+  uint32_t level_entry; // Level in the top bits, bucket index in the bottom HHH_ENTRY_BITS; HHH_NONE when free
+};
+
+struct HHHBucket {
+  uint64_t size;
+  time_ns_t time;
+  uint32_t older;
+  uint32_t newer;
+  uint32_t slot;
+  uint32_t level;
+};
+
+struct HHH {
+  struct HHHSlot *slots;
+  uint32_t slots_mask;
+  unsigned slots_bits;
+
+  struct HHHBucket *buckets;
+  uint32_t free_buckets;
+  uint32_t oldest;
+  uint32_t newest;
+
+  uint32_t n_levels;
+  uint32_t masks[HHH_MAX_LEVELS]; // In network byte order
+  uint8_t prefix_lens[HHH_MAX_LEVELS];
+  uint32_t level_sizes[HHH_MAX_LEVELS];
+
+  uint32_t capacity;
+  uint64_t rate;
+  uint64_t burst;
+  time_ns_t expiration_time;
+};
+
+static uint32_t to_network_order(uint32_t n) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  return __builtin_bswap32(n);
+#else
+  return n;
+#endif
+}
+
+static uint32_t hash_slot(struct HHH *hhh, uint32_t addr, uint32_t level) {
+  uint64_t key = ((uint64_t)level << 32) | addr;
+  return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - hhh->slots_bits));
+}
+
+static uint32_t slot_level(const struct HHHSlot *slot) { return slot->level_entry >> HHH_ENTRY_BITS; }
+
+static uint32_t slot_bucket(const struct HHHSlot *slot) { return slot->level_entry & HHH_ENTRY_MASK; }
+
+int hhh_allocate(uint32_t capacity, uint32_t subnets_mask, uint64_t rate, uint64_t burst, struct HHH **hhh_out) {
+  if (capacity == 0 || rate == 0) {
+    return 0;
+  }
+
+  struct HHH *hhh = (struct HHH *)malloc(sizeof(struct HHH));
+  if (hhh == NULL) {
+    return 0;
+  }
+
+  memset(hhh, 0, sizeof(struct HHH));
+
+  uint32_t mask = 0;
+  for (uint32_t subnet = 0; subnet < HHH_MAX_LEVELS; subnet++, subnets_mask >>= 1) {
+    mask = (mask >> 1) | (1u << 31);
+
+    if (subnets_mask & 1) {
+      hhh->masks[hhh->n_levels]       = to_network_order(mask);
+      hhh->prefix_lens[hhh->n_levels] = subnet + 1;
+      hhh->n_levels++;
+    }
+  }
+
+  uint64_t total_buckets = (uint64_t)capacity * hhh->n_levels;
+  if (total_buckets > HHH_ENTRY_MASK) {
+    free(hhh);
+    return 0;
+  }
+
+  // At most half full.
+  hhh->slots_bits = 3;
+  while ((1ull << hhh->slots_bits) < 2 * total_buckets) {
+    hhh->slots_bits++;
+  }
+  hhh->slots_mask = (1u << hhh->slots_bits) - 1;
+
+  hhh->slots   = (struct HHHSlot *)aligned_alloc(64, sizeof(struct HHHSlot) * (hhh->slots_mask + 1));
+  hhh->buckets = (struct HHHBucket *)malloc(sizeof(struct HHHBucket) * (total_buckets + 1));
+
+  if (hhh->slots == NULL || hhh->buckets == NULL) {
+    free(hhh->slots);
+    free(hhh->buckets);
+    free(hhh);
+    return 0;
+  }
+
+  for (uint32_t i = 0; i <= hhh->slots_mask; i++) {
+    hhh->slots[i].level_entry = HHH_NONE;
+  }
+
+  for (uint32_t i = 0; i < total_buckets; i++) {
+    hhh->buckets[i].newer = i + 1 < total_buckets ? i + 1 : HHH_NONE;
+  }
+
+  hhh->free_buckets    = total_buckets > 0 ? 0 : HHH_NONE;
+  hhh->oldest          = HHH_NONE;
+  hhh->newest          = HHH_NONE;
+  hhh->capacity        = capacity;
+  hhh->rate            = rate;
+  hhh->burst           = burst;
+  hhh->expiration_time = NS_TO_S_MULTIPLIER * burst / rate;
+
+  *hhh_out = hhh;
+  return 1;
+}
+
+static uint32_t find_slot(struct HHH *hhh, uint32_t addr, uint32_t level, uint32_t home) {
+  for (uint32_t i = home;; i = (i + 1) & hhh->slots_mask) {
+    struct HHHSlot *slot = &hhh->slots[i];
+
+    if (slot->level_entry == HHH_NONE) {
+      return HHH_NONE;
+    }
+
+    if (slot->addr == addr && slot_level(slot) == level) {
+      return i;
+    }
+  }
+}
+
+static void unlink_bucket(struct HHH *hhh, uint32_t b) {
+  struct HHHBucket *bucket = &hhh->buckets[b];
+
+  if (bucket->older != HHH_NONE) {
+    hhh->buckets[bucket->older].newer = bucket->newer;
+  } else {
+    hhh->oldest = bucket->newer;
+  }
+
+  if (bucket->newer != HHH_NONE) {
+    hhh->buckets[bucket->newer].older = bucket->older;
+  } else {
+    hhh->newest = bucket->older;
+  }
+}
+
+static void link_newest(struct HHH *hhh, uint32_t b) {
+  struct HHHBucket *bucket = &hhh->buckets[b];
+
+  bucket->older = hhh->newest;
+  bucket->newer = HHH_NONE;
+
+  if (hhh->newest != HHH_NONE) {
+    hhh->buckets[hhh->newest].newer = b;
+  } else {
+    hhh->oldest = b;
+  }
+
+  hhh->newest = b;
+}
+
+static int insert(struct HHH *hhh, uint32_t addr, uint32_t level, uint32_t home, uint16_t pkt_len, time_ns_t time) {
+  if (hhh->level_sizes[level] >= hhh->capacity) {
+    return 0;
+  }
+
+  assert(hhh->free_buckets != HHH_NONE);
+
+  uint32_t b        = hhh->free_buckets;
+  hhh->free_buckets = hhh->buckets[b].newer;
+
+  uint32_t i = home;
+  while (hhh->slots[i].level_entry != HHH_NONE) {
+    i = (i + 1) & hhh->slots_mask;
+  }
+
+  hhh->slots[i].addr        = addr;
+  hhh->slots[i].level_entry = (level << HHH_ENTRY_BITS) | b;
+
+  assert(hhh->burst >= pkt_len);
+
+  struct HHHBucket *bucket = &hhh->buckets[b];
+  bucket->size             = hhh->burst - pkt_len;
+  bucket->time             = time;
+  bucket->slot             = i;
+  bucket->level            = level;
+
+  link_newest(hhh, b);
+  hhh->level_sizes[level]++;
+
+  return 1;
+}
+
+static void erase_slot(struct HHH *hhh, uint32_t i) {
+  uint32_t j = i;
+
+  for (;;) {
+    j = (j + 1) & hhh->slots_mask;
+
+    struct HHHSlot *slot = &hhh->slots[j];
+    if (slot->level_entry == HHH_NONE) {
+      break;
+    }
+
+    // Move it back into the hole, unless its home lies cyclically in (i, j].
+    uint32_t home = hash_slot(hhh, slot->addr, slot_level(slot));
+    int stays     = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+    if (stays) {
+      continue;
+    }
+
+    hhh->slots[i]                                  = *slot;
+    hhh->buckets[slot_bucket(&hhh->slots[i])].slot = i;
+    i                                              = j;
+  }
+
+  hhh->slots[i].level_entry = HHH_NONE;
+}
+
+int hhh_update(struct HHH *hhh, uint32_t addr, uint16_t pkt_len, time_ns_t time, uint32_t *hh_out, uint8_t *hh_prefix_len_out) {
+  uint32_t homes[HHH_MAX_LEVELS];
+
+  for (uint32_t level = 0; level < hhh->n_levels; level++) {
+    homes[level] = hash_slot(hhh, addr & hhh->masks[level], level);
+    __builtin_prefetch(&hhh->slots[homes[level]]);
+  }
+
+  assert(time >= 0);
+  uint64_t time_u = (uint64_t)time;
+
+  int captured = 0;
+
+  for (uint32_t level = 0; level < hhh->n_levels; level++) {
+    uint32_t masked = addr & hhh->masks[level];
+    uint32_t i      = find_slot(hhh, masked, level, homes[level]);
+
+    if (i == HHH_NONE) {
+      // Not much we can do...
+      if (!insert(hhh, masked, level, homes[level], pkt_len, time)) {
+        return captured;
+      }
+      continue;
+    }
+
+    uint32_t b               = slot_bucket(&hhh->slots[i]);
+    struct HHHBucket *bucket = &hhh->buckets[b];
+
+    assert(bucket->time >= 0);
+    assert((uint64_t)bucket->time <= time_u);
+    uint64_t time_diff = time_u - bucket->time;
+
+    if (time_diff < (hhh->burst * NS_TO_S_MULTIPLIER) / hhh->rate) {
+      uint64_t added_tokens = (time_diff * hhh->rate) / NS_TO_S_MULTIPLIER;
+      assert(bucket->size <= hhh->burst);
+      bucket->size += added_tokens;
+      if (bucket->size > hhh->burst) {
+        bucket->size = hhh->burst;
+      }
+    } else {
+      bucket->size = hhh->burst;
+    }
+
+    bucket->time = time;
+
+    unlink_bucket(hhh, b);
+    link_newest(hhh, b);
+
+    if (bucket->size > pkt_len) {
+      bucket->size -= pkt_len;
+    } else {
+      captured           = 1;
+      *hh_out            = masked;
+      *hh_prefix_len_out = hhh->prefix_lens[level];
+    }
+  }
+
+  return captured;
+}
+
+int hhh_expire(struct HHH *hhh, time_ns_t time) {
+  assert(time >= 0);
+  time_ns_t min_time = time - hhh->expiration_time;
+
+  int freed = 0;
+  while (hhh->oldest != HHH_NONE && hhh->buckets[hhh->oldest].time < min_time) {
+    uint32_t b               = hhh->oldest;
+    struct HHHBucket *bucket = &hhh->buckets[b];
+
+    unlink_bucket(hhh, b);
+    erase_slot(hhh, bucket->slot);
+    hhh->level_sizes[bucket->level]--;
+
+    bucket->newer     = hhh->free_buckets;
+    hhh->free_buckets = b;
+
+    freed++;
+  }
+
+  return freed;
+}
@@ -0,0 +1,22 @@
+#ifndef _HHH_H_INCLUDED_
+#define _HHH_H_INCLUDED_
+
+#include <stdint.h>
+
+#include "lib/util/time.h"
+
+// Hierarchical heavy hitters: a token bucket per source subnet, for every enabled prefix length at once.
+//
+// Bit i of subnets_mask enables subnets /(i+1). Every enabled prefix length may track up to capacity subnets. Buckets are refilled at rate
+// bytes/s, up to burst bytes, and are forgotten once they have not been updated for as long as it takes to refill a full bucket.
+struct HHH;
+
+int hhh_allocate(uint32_t capacity, uint32_t subnets_mask, uint64_t rate, uint64_t burst, struct HHH **hhh_out);
+
+// Charges pkt_len bytes to every enabled subnet of addr (in network byte order), from the shortest prefix to the longest. Returns 1 if any of
+// them ran out of tokens, storing the longest one in hh_out/hh_prefix_len_out.
+int hhh_update(struct HHH *hhh, uint32_t addr, uint16_t pkt_len, time_ns_t time, uint32_t *hh_out, uint8_t *hh_prefix_len_out);
+
+int hhh_expire(struct HHH *hhh, time_ns_t time);
+
+#endif
\ No newline at end of file
@@ -106,6 +106,15 @@ void map_impl_erase(int *busybits, void **keyps, unsigned *k_hashes, int *chns,
   find_key_remove_chain(busybits, keyps, k_hashes, chns, keyp, key_size, hash, capacity, keyp_out);
 }
 
+void map_impl_prefetch(int *busybits, void **keyps, unsigned *k_hashes, int *chns, int *values, unsigned hash, unsigned capacity) {
+  unsigned index = loop(hash, capacity);
+  __builtin_prefetch(&busybits[index]);
+  __builtin_prefetch(&keyps[index]);
+  __builtin_prefetch(&k_hashes[index]);
+  __builtin_prefetch(&chns[index]);
+  __builtin_prefetch(&values[index]);
+}
+
 unsigned map_impl_size(int *busybits, unsigned capacity) {
   unsigned s = 0;
   unsigned i = 0;
@@ -22,6 +22,9 @@ void map_impl_put(int *busybits, void **keyps, unsigned *k_hashes, int *chns, in
 void map_impl_erase(int *busybits, void **keyps, unsigned *key_hashes, int *chns, void *keyp, unsigned key_size, unsigned hash,
                     unsigned capacity, void **keyp_out);
 
+// Prefetches the first slot probed for this hash, ahead of a map_impl_get.
+void map_impl_prefetch(int *busybits, void **keyps, unsigned *k_hashes, int *chns, int *values, unsigned hash, unsigned capacity);
+
 unsigned map_impl_size(int *busybits, unsigned capacity);
 
 #endif //_MAP_IMPL_H_INCLUDED_
@@ -0,0 +1,249 @@
+#ifdef MAP_IMPL_SWISS
+
+// Alternative backend for map.h, selected at build time with MAP_IMPL=swiss.
+//
+// Slots are grouped 8 at a time. Each group packs its tags, hash fragments, values and chain counter in a single cache line, and the key
+// pointers in the adjacent one, so a lookup hit touches two lines instead of one line per array. All 8 tags of a group are matched at once
+// with SSE2.
+//
+// Like the pow2 backend, we keep a chain counter instead of tombstones: it counts the keys that overflowed past a group, so lookups stop at
+// the first group that neither matches nor was overflowed, and erasing a key always frees its slot.
+
+#include "map.h"
+#include "../util/compute.h"
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <emmintrin.h>
+
+#define MAP_GROUP_WIDTH 8
+#define MAP_EMPTY_TAG 0
+
+struct MapGroup {
+  uint8_t tags[MAP_GROUP_WIDTH];   // Low 7 bits of the hash, with the top bit set; MAP_EMPTY_TAG when free
+  uint16_t frags[MAP_GROUP_WIDTH]; // 16 more bits from a remix of the hash, to (almost) never dereference a key pointer in vain
+  int values[MAP_GROUP_WIDTH];
+  unsigned chain; // Keys stored past this group that probed through it
+  unsigned pad;
+  void *keyps[MAP_GROUP_WIDTH];
+} __attribute__((aligned(64)));
+
+struct Map {
+  struct MapGroup *groups;
+  unsigned num_groups;
+  unsigned capacity;
+  unsigned size;
+  unsigned key_size;
+};
+
+static int keq(void *key1, void *key2, unsigned keys_size) { return memcmp(key1, key2, keys_size) == 0; }
+
+// The home group comes from the top bits of the hash, so keys sharing a group share those: the tag takes the bottom bits instead, and the
+// fragment a remix of the whole hash, so that neither tells apart keys of the same group any worse than chance.
+static uint8_t hash_tag(unsigned hash) { return 0x80 | (hash & 0x7f); }
+
+static uint16_t hash_frag(unsigned hash) { return (uint16_t)((hash * 0x9E3779B1u) >> 16); }
+
+// Works for any number of groups, not only powers of two.
+static unsigned home_group(struct Map *map, unsigned hash) { return (unsigned)(((uint64_t)hash * map->num_groups) >> 32); }
+
+static unsigned next_group(struct Map *map, unsigned group) { return group + 1 == map->num_groups ? 0 : group + 1; }
+
+// Bit i is set if tags[i] == tag.
+static unsigned match_tags(const struct MapGroup *group, uint8_t tag) {
+  __m128i tags = _mm_loadl_epi64((const __m128i *)group->tags);
+  __m128i eq   = _mm_cmpeq_epi8(tags, _mm_set1_epi8((char)tag));
+  return (unsigned)_mm_movemask_epi8(eq) & ((1u << MAP_GROUP_WIDTH) - 1);
+}
+
+int map_allocate(unsigned capacity, unsigned key_size, struct Map **map_out) {
+  // Check that capacity is a power of 2
+  if (capacity == 0 || is_power_of_two(capacity) == 0) {
+    return 0;
+  }
+
+  struct Map *old_map_val = *map_out;
+  struct Map *map_alloc   = (struct Map *)malloc(sizeof(struct Map));
+  if (map_alloc == NULL)
+    return 0;
+  *map_out = (struct Map *)map_alloc;
+
+  // Keep at least one free slot every 8 even when the map is full, so that probe sequences stay short.
+  unsigned num_groups           = (capacity + MAP_GROUP_WIDTH - 2) / (MAP_GROUP_WIDTH - 1);
+  struct MapGroup *groups_alloc = (struct MapGroup *)aligned_alloc(64, sizeof(struct MapGroup) * (size_t)num_groups);
+  if (groups_alloc == NULL) {
+    free(map_alloc);
+    *map_out = old_map_val;
+    return 0;
+  }
+  memset(groups_alloc, 0, sizeof(struct MapGroup) * (size_t)num_groups);
+
+  (*map_out)->groups     = groups_alloc;
+  (*map_out)->num_groups = num_groups;
+  (*map_out)->capacity   = capacity;
+  (*map_out)->size       = 0;
+  (*map_out)->key_size   = key_size;
+
+  return 1;
+}
+
+static unsigned khash(void *key, unsigned key_size) {
+  unsigned hash = 0;
+  while (key_size > 0) {
+    if (key_size >= sizeof(unsigned int)) {
+      hash = __builtin_ia32_crc32si(hash, *(unsigned int *)key);
+      key  = (unsigned int *)key + 1;
+      key_size -= sizeof(unsigned int);
+    } else {
+      unsigned int c = *(unsigned char *)key;
+      hash           = __builtin_ia32_crc32si(hash, c);
+      key            = (unsigned char *)key + 1;
+      key_size -= 1;
+    }
+  }
+  return hash;
+}
+
+// Returns the group holding the key (and its slot in slot_out), or -1. Distance is the number of groups probed before it.
+static int find_key(struct Map *map, void *keyp, unsigned hash, unsigned *slot_out, unsigned *distance_out) {
+  uint8_t tag   = hash_tag(hash);
+  uint16_t frag = hash_frag(hash);
+  unsigned g    = home_group(map, hash);
+
+  for (unsigned distance = 0; distance < map->num_groups; ++distance) {
+    struct MapGroup *group = &map->groups[g];
+
+    unsigned matches = match_tags(group, tag);
+    while (matches != 0) {
+      unsigned slot = __builtin_ctz(matches);
+      if (group->frags[slot] == frag && keq(group->keyps[slot], keyp, map->key_size)) {
+        *slot_out     = slot;
+        *distance_out = distance;
+        return (int)g;
+      }
+      matches &= matches - 1;
+    }
+
+    if (group->chain == 0) {
+      return -1;
+    }
+
+    g = next_group(map, g);
+  }
+
+  return -1;
+}
+
+int map_get(struct Map *map, void *key, int *value_out) {
+  unsigned hash = khash(key, map->key_size);
+  unsigned slot;
+  unsigned distance;
+
+  int g = find_key(map, key, hash, &slot, &distance);
+  if (g < 0) {
+    return 0;
+  }
+
+  *value_out = map->groups[g].values[slot];
+  return 1;
+}
+
+void map_put(struct Map *map, void *key, int value) {
+  unsigned hash = khash(key, map->key_size);
+  unsigned g    = home_group(map, hash);
+
+  for (unsigned i = 0; i < map->num_groups; ++i) {
+    struct MapGroup *group = &map->groups[g];
+
+    unsigned empty = match_tags(group, MAP_EMPTY_TAG);
+    if (empty != 0) {
+      unsigned slot       = __builtin_ctz(empty);
+      group->tags[slot]   = hash_tag(hash);
+      group->frags[slot]  = hash_frag(hash);
+      group->values[slot] = value;
+      group->keyps[slot]  = key;
+      ++map->size;
+      return;
+    }
+
+    ++group->chain;
+    g = next_group(map, g);
+  }
+}
+
+static void erase_key(struct Map *map, void *key, unsigned hash, void **trash) {
+  unsigned slot;
+  unsigned distance;
+
+  int g = find_key(map, key, hash, &slot, &distance);
+  if (g < 0) {
+    return;
+  }
+
+  struct MapGroup *group = &map->groups[g];
+  group->tags[slot]      = MAP_EMPTY_TAG;
+  *trash                 = group->keyps[slot];
+  --map->size;
+
+  // Undo the overflows this key caused on its way here.
+  unsigned h = home_group(map, hash);
+  for (unsigned i = 0; i < distance; ++i) {
+    --map->groups[h].chain;
+    h = next_group(map, h);
+  }
+}
+
+void map_erase(struct Map *map, void *key, void **trash) { erase_key(map, key, khash(key, map->key_size), trash); }
+
+static void prefetch_group(struct Map *map, unsigned hash) {
+  struct MapGroup *group = &map->groups[home_group(map, hash)];
+  __builtin_prefetch(group);
+  __builtin_prefetch(group->keyps);
+}
+
+unsigned map_size(struct Map *map) { return map->size; }
+
+void map_get_bulk(struct Map *map, void **keys, unsigned n, int *values_out, int *hits_out) {
+  unsigned hashes[MAP_BULK_SIZE];
+
+  for (unsigned base = 0; base < n; base += MAP_BULK_SIZE) {
+    unsigned count = n - base < MAP_BULK_SIZE ? n - base : MAP_BULK_SIZE;
+
+    for (unsigned i = 0; i < count; ++i) {
+      hashes[i] = khash(keys[base + i], map->key_size);
+      prefetch_group(map, hashes[i]);
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+      unsigned slot;
+      unsigned distance;
+
+      int g              = find_key(map, keys[base + i], hashes[i], &slot, &distance);
+      hits_out[base + i] = g >= 0;
+      if (g >= 0) {
+        values_out[base + i] = map->groups[g].values[slot];
+      }
+    }
+  }
+}
+
+void map_erase_bulk(struct Map *map, void **keys, unsigned n, void **trash) {
+  unsigned hashes[MAP_BULK_SIZE];
+
+  for (unsigned base = 0; base < n; base += MAP_BULK_SIZE) {
+    unsigned count = n - base < MAP_BULK_SIZE ? n - base : MAP_BULK_SIZE;
+
+    for (unsigned i = 0; i < count; ++i) {
+      hashes[i] = khash(keys[base + i], map->key_size);
+      prefetch_group(map, hashes[i]);
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+      erase_key(map, keys[base + i], hashes[i], &trash[base + i]);
+    }
+  }
+}
+
+#endif // MAP_IMPL_SWISS
\ No newline at end of file
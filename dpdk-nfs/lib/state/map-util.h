@@ -3,4 +3,7 @@
 
 #define CAPACITY_UPPER_LIMIT 140000
 
+// How many keys map_get_bulk hashes and prefetches before resolving them
+#define MAP_BULK_SIZE 32
+
 #endif //_MAP_UTIL_H_INCLUDED_
@@ -1,3 +1,5 @@
+#ifndef MAP_IMPL_SWISS // Otherwise, see map-swiss.c
+
 #include "map.h"
 #include "map-impl-pow2.h"
 #include "../util/compute.h"
@@ -117,3 +119,41 @@ void map_erase(struct Map *map, void *key, void **trash) {
 }
 
 unsigned map_size(struct Map *map) { return map->size; }
+
+void map_erase_bulk(struct Map *map, void **keys, unsigned n, void **trash) {
+  unsigned hashes[MAP_BULK_SIZE];
+
+  for (unsigned base = 0; base < n; base += MAP_BULK_SIZE) {
+    unsigned count = n - base < MAP_BULK_SIZE ? n - base : MAP_BULK_SIZE;
+
+    for (unsigned i = 0; i < count; ++i) {
+      hashes[i] = khash(keys[base + i], map->key_size);
+      map_impl_prefetch(map->busybits, map->keyps, map->khs, map->chns, map->vals, hashes[i], map->capacity);
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+      map_impl_erase(map->busybits, map->keyps, map->khs, map->chns, keys[base + i], map->key_size, hashes[i], map->capacity, &trash[base + i]);
+      --map->size;
+    }
+  }
+}
+
+void map_get_bulk(struct Map *map, void **keys, unsigned n, int *values_out, int *hits_out) {
+  unsigned hashes[MAP_BULK_SIZE];
+
+  for (unsigned base = 0; base < n; base += MAP_BULK_SIZE) {
+    unsigned count = n - base < MAP_BULK_SIZE ? n - base : MAP_BULK_SIZE;
+
+    for (unsigned i = 0; i < count; ++i) {
+      hashes[i] = khash(keys[base + i], map->key_size);
+      map_impl_prefetch(map->busybits, map->keyps, map->khs, map->chns, map->vals, hashes[i], map->capacity);
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+      hits_out[base + i] = map_impl_get(map->busybits, map->keyps, map->khs, map->chns, map->vals, keys[base + i], map->key_size, hashes[i],
+                                        &values_out[base + i], map->capacity);
+    }
+  }
+}
+
+#endif // MAP_IMPL_SWISS
\ No newline at end of file
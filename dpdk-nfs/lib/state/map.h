@@ -11,4 +11,11 @@ void map_put(struct Map *map, void *key, int value);
 void map_erase(struct Map *map, void *key, void **trash);
 unsigned map_size(struct Map *map);
 
+// Same as calling map_get on each key, but hashes MAP_BULK_SIZE keys and prefetches their buckets before resolving any of them, so their
+// cache misses overlap instead of being paid one after the other.
+void map_get_bulk(struct Map *map, void **keys, unsigned n, int *values_out, int *hits_out);
+
+// Same as calling map_erase on each key, prefetching the same way as map_get_bulk.
+void map_erase_bulk(struct Map *map, void **keys, unsigned n, void **trash);
+
 #endif //_MAP_H_INCLUDED_
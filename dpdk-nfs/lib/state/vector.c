@@ -40,6 +40,13 @@ void vector_return(struct Vector *vector, int index, void *value) {}
 
 void vector_clear(struct Vector *vector) { memset(vector->data, 0, vector->elem_size * vector->capacity); }
 
+void vector_borrow_bulk(struct Vector *vector, int *indexes, unsigned n, void **vals_out) {
+  for (unsigned i = 0; i < n; ++i) {
+    vals_out[i] = vector->data + indexes[i] * vector->elem_size;
+    __builtin_prefetch(vals_out[i]);
+  }
+}
+
 int vector_sample_lt(struct Vector *vector, int samples, void *threshold, int *index_out) {
   for (int i = 0; i < samples; i++) {
     int index  = rand() % vector->capacity;
@@ -15,6 +15,9 @@ void vector_return(struct Vector *vector, int index, void *value);
 
 void vector_clear(struct Vector *vector);
 
+// Same as calling vector_borrow on each index, prefetching all the cells first.
+void vector_borrow_bulk(struct Vector *vector, int *indexes, unsigned n, void **vals_out);
+
 // Randomly sample an element from the vector and compare it with the provided
 // threshold value.
 // Little endian byte by byte comparison (so it doesn't work for signed
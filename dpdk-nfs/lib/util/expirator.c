@@ -15,6 +15,36 @@ int expire_items_single_map(struct DoubleChain *chain, struct Vector *vector, st
   return count;
 }
 
+int expire_items_single_map_bounded(struct DoubleChain *chain, struct Vector *vector, struct Map *map, time_ns_t time, int max_expirations) {
+  int indexes[MAP_BULK_SIZE];
+  void *keys[MAP_BULK_SIZE];
+  void *trash[MAP_BULK_SIZE];
+
+  int count = 0;
+
+  while (count < max_expirations) {
+    unsigned n = 0;
+    while (n < MAP_BULK_SIZE && count + (int)n < max_expirations && dchain_expire_one_index(chain, &indexes[n], time)) {
+      ++n;
+    }
+
+    if (n == 0) {
+      break;
+    }
+
+    vector_borrow_bulk(vector, indexes, n, keys);
+    map_erase_bulk(map, keys, n, trash);
+
+    for (unsigned i = 0; i < n; ++i) {
+      vector_return(vector, indexes[i], trash[i]);
+    }
+
+    count += n;
+  }
+
+  return count;
+}
+
 int expire_items_single_map_iteratively(struct Vector *vector, struct Map *map, int start, int n_elems) {
   assert(start >= 0);
   assert(n_elems >= 0);
@@ -21,6 +21,15 @@ typedef void entry_pack_key(void *entry, void *key);
 // @returns the number of expired items.
 int expire_items_single_map(struct DoubleChain *chain, struct Vector *vector, struct Map *map, time_ns_t time);
 
+// Same as expire_items_single_map, but expires at most max_expirations items,
+// leaving the rest to later calls. Spreads the cost of expiring a burst of
+// flows over several packets, instead of stalling the one that finds them.
+// Erasures are batched, prefetching their keys and map buckets first.
+// Items left behind can still be found, and rejuvenated, until then, so
+// this is not equivalent to expire_items_single_map.
+// @returns the number of expired items.
+int expire_items_single_map_bounded(struct DoubleChain *chain, struct Vector *vector, struct Map *map, time_ns_t time, int max_expirations);
+
 // The function takes "coherent" chain vector and hash map,
 // and a given number of elements.
 // It removes items from 0 to n_elems (inclusive) simultaneously from the vector
@@ -6,8 +6,9 @@
 
 #include "packet-io.h"
 
-size_t global_total_length;
-size_t global_read_length = 0;
+// Per lcore, as multi-core NFs parse packets on several lcores at the same time.
+__thread size_t global_total_length;
+__thread size_t global_read_length = 0;
 
 void packet_state_total_length(void *p, uint32_t *len) { global_total_length = *len; }
 
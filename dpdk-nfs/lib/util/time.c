@@ -3,7 +3,8 @@
 #include <time.h>
 #include <assert.h>
 
-time_ns_t last_time = 0;
+// Kept per lcore: recent_time() must return the time last read by the calling lcore.
+__thread time_ns_t last_time = 0;
 
 time_ns_t current_time(void) {
   struct timespec tp;
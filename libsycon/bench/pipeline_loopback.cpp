@@ -0,0 +1,274 @@
+// Benchmarks the controller pipeline without a switch (or the SDE): synthetic UDP flows are injected through the loopback packet manager into a
+// small NF that counts packets per flow (with one table per worker, so it needs no lock) and sends them back out. Every so often a flow also
+// writes to the "switch", which goes through the staged writes and a stand-in for the controller lock, just like BfRt writes do on the switch.
+
+#include <sycon/pipeline.h>
+#include <sycon/staged_writes.h>
+
+#include <CLI/CLI.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+using namespace sycon;
+
+namespace {
+
+struct eth_hdr_t {
+  u8 dst_mac[6];
+  u8 src_mac[6];
+  u16 ether_type;
+} __attribute__((packed));
+
+struct ipv4_hdr_t {
+  u8 ihl_version;
+  u8 type_of_service;
+  u16 total_length;
+  u16 packet_id;
+  u16 fragment_offset;
+  u8 time_to_live;
+  u8 next_proto_id;
+  u16 hdr_checksum;
+  u32 src_addr;
+  u32 dst_addr;
+} __attribute__((packed));
+
+struct udp_hdr_t {
+  u16 src_port;
+  u16 dst_port;
+  u16 dgram_len;
+  u16 dgram_cksum;
+} __attribute__((packed));
+
+constexpr const size_t HEADERS_SIZE = sizeof(eth_hdr_t) + sizeof(ipv4_hdr_t) + sizeof(udp_hdr_t);
+
+struct flow_t {
+  u32 src_addr;
+  u32 dst_addr;
+  u16 src_port;
+  u16 dst_port;
+
+  bool operator==(const flow_t &other) const {
+    return src_addr == other.src_addr && dst_addr == other.dst_addr && src_port == other.src_port && dst_port == other.dst_port;
+  }
+};
+
+u64 hash_flow(const flow_t &flow) {
+  u64 h = (static_cast<u64>(flow.src_addr) << 32) | flow.dst_addr;
+  h ^= (static_cast<u64>(flow.src_port) << 16 | flow.dst_port) * 0x9E3779B97F4A7C15ull;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  return h;
+}
+
+struct flow_hasher_t {
+  size_t operator()(const flow_t &flow) const { return hash_flow(flow); }
+};
+
+flow_t get_flow(const u8 *pkt) {
+  const ipv4_hdr_t *ipv4_hdr = reinterpret_cast<const ipv4_hdr_t *>(pkt + sizeof(eth_hdr_t));
+  const udp_hdr_t *udp_hdr   = reinterpret_cast<const udp_hdr_t *>(pkt + sizeof(eth_hdr_t) + sizeof(ipv4_hdr_t));
+  return {ipv4_hdr->src_addr, ipv4_hdr->dst_addr, udp_hdr->src_port, udp_hdr->dst_port};
+}
+
+time_ns_t get_bench_time() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void busy_wait(time_ns_t ns) {
+  const time_ns_t until = get_bench_time() + ns;
+  while (get_bench_time() < until) {
+  }
+}
+
+// Stands in for the BfRt session: a single spinlock (just like cfg's controller lock), held from begin() to commit() or abort(). Writes and commits
+// take as long as we are told, with the lock held.
+class BenchTransactionBackend : public TransactionBackend {
+private:
+  std::atomic<bool> held;
+
+public:
+  const time_ns_t write_latency;
+  const time_ns_t commit_latency;
+
+  std::atomic<u64> commits;
+  std::atomic<time_ns_t> lock_wait;
+
+  BenchTransactionBackend(time_ns_t _write_latency, time_ns_t _commit_latency)
+      : held(false), write_latency(_write_latency), commit_latency(_commit_latency), commits(0), lock_wait(0) {}
+
+  void begin() override {
+    const time_ns_t start = get_bench_time();
+    while (held.exchange(true, std::memory_order_acquire)) {
+    }
+    lock_wait.fetch_add(get_bench_time() - start, std::memory_order_relaxed);
+  }
+
+  void commit() override {
+    busy_wait(commit_latency);
+    commits.fetch_add(1, std::memory_order_relaxed);
+    held.store(false, std::memory_order_release);
+  }
+
+  void abort() override { held.store(false, std::memory_order_release); }
+  void restart() override {}
+
+  // What the primitives do when writing to the switch.
+  void write(u64 key) {
+    if (stage_write([this, key]() { write(key); })) {
+      return;
+    }
+    busy_wait(write_latency);
+  }
+};
+
+std::unique_ptr<BenchTransactionBackend> backend;
+
+// One table per worker: flows never move between workers.
+std::vector<std::unordered_map<flow_t, u64, flow_hasher_t>> flow_counters;
+
+// A flow writes to the switch on its first packet, and then once every this many packets (0 for never).
+u64 update_period;
+
+// Runs the whole NF under the controller lock, like NFs that touch state shared with the dataplane notification callbacks.
+bool lock_nf;
+
+u64 flow_hash(const u8 *pkt, u16 size) { return size < HEADERS_SIZE ? 0 : hash_flow(get_flow(pkt)); }
+
+nf_process_result_t nf_process(time_ns_t now, u8 *pkt, u16 size) {
+  nf_process_result_t result;
+
+  if (size < HEADERS_SIZE) {
+    result.forward = false;
+    return result;
+  }
+
+  if (lock_nf) {
+    lock_shared_state();
+  }
+
+  const flow_t flow = get_flow(pkt);
+  const u64 count   = flow_counters[pipeline_worker_id()][flow]++;
+
+  if (update_period > 0 && count % update_period == 0) {
+    backend->write(hash_flow(flow));
+  }
+
+  eth_hdr_t *eth_hdr = reinterpret_cast<eth_hdr_t *>(pkt);
+  u8 mac[6];
+  memcpy(mac, eth_hdr->dst_mac, sizeof(mac));
+  memcpy(eth_hdr->dst_mac, eth_hdr->src_mac, sizeof(mac));
+  memcpy(eth_hdr->src_mac, mac, sizeof(mac));
+
+  return result;
+}
+
+bool process(time_ns_t now, u8 *pkt, u16 size) { return staged_writes->process(now, pkt, size); }
+
+std::vector<std::vector<u8>> build_pkts(size_t flows, u16 pkt_size) {
+  std::mt19937_64 rng(0);
+  std::vector<std::vector<u8>> pkts;
+
+  for (size_t i = 0; i < flows; i++) {
+    std::vector<u8> pkt(pkt_size, 0);
+
+    eth_hdr_t *eth_hdr   = reinterpret_cast<eth_hdr_t *>(pkt.data());
+    ipv4_hdr_t *ipv4_hdr = reinterpret_cast<ipv4_hdr_t *>(pkt.data() + sizeof(eth_hdr_t));
+    udp_hdr_t *udp_hdr   = reinterpret_cast<udp_hdr_t *>(pkt.data() + sizeof(eth_hdr_t) + sizeof(ipv4_hdr_t));
+
+    eth_hdr->ether_type     = __builtin_bswap16(0x0800);
+    ipv4_hdr->ihl_version   = 0x45;
+    ipv4_hdr->total_length  = __builtin_bswap16(pkt_size - sizeof(eth_hdr_t));
+    ipv4_hdr->time_to_live  = 64;
+    ipv4_hdr->next_proto_id = 17;
+    ipv4_hdr->src_addr      = rng();
+    ipv4_hdr->dst_addr      = rng();
+    udp_hdr->src_port       = rng();
+    udp_hdr->dst_port       = rng();
+    udp_hdr->dgram_len      = __builtin_bswap16(pkt_size - sizeof(eth_hdr_t) - sizeof(ipv4_hdr_t));
+
+    pkts.push_back(std::move(pkt));
+  }
+
+  return pkts;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  CLI::App app{"Benchmark the controller pipeline over the loopback packet manager"};
+
+  size_t workers;
+  size_t producers;
+  size_t flows;
+  u16 pkt_size;
+  double duration;
+  size_t ring_size;
+  size_t burst;
+  u64 rate;
+  time_ns_t write_latency;
+  time_ns_t commit_latency;
+
+  app.add_option("--workers", workers, "Pipeline workers running the NF")->default_val(1);
+  app.add_option("--producers", producers, "Injector threads (stand-ins for the RX rings)")->default_val(1);
+  app.add_option("--flows", flows, "Synthetic UDP flows")->default_val(1024);
+  app.add_option("--pkt-size", pkt_size, "Packet size (bytes)")->default_val(64);
+  app.add_option("--duration", duration, "Time spent injecting (s)")->default_val(5);
+  app.add_option("--ring-size", ring_size, "Slots in each (producer, worker) ring")->default_val(128);
+  app.add_option("--burst", burst, "Most packets a worker takes from a ring at once")->default_val(32);
+  app.add_option("--rate", rate, "Packets per second injected by each producer (0 for as fast as possible)")->default_val(0);
+  app.add_option("--update-period", update_period, "Packets of a flow between its writes to the switch (0 for none)")->default_val(16);
+  app.add_option("--write-latency", write_latency, "Time (ns) a write to the switch takes, holding the controller lock")->default_val(1000);
+  app.add_option("--commit-latency", commit_latency, "Time (ns) a commit takes, holding the controller lock")->default_val(5000);
+  app.add_flag("--lock-nf", lock_nf, "Run the whole NF under the controller lock")->default_val(false);
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (workers == 0 || producers == 0 || flows == 0 || burst == 0 || ring_size == 0) {
+    std::cerr << "Workers, producers, flows, burst and ring size must all be at least 1.\n";
+    return 1;
+  }
+
+  if (pkt_size < HEADERS_SIZE || pkt_size > PIPELINE_PKT_BUFFER_SIZE) {
+    std::cerr << "Packet size must be between " << HEADERS_SIZE << " and " << PIPELINE_PKT_BUFFER_SIZE << " bytes.\n";
+    return 1;
+  }
+
+  flow_counters.resize(workers);
+
+  backend       = std::make_unique<BenchTransactionBackend>(write_latency, commit_latency);
+  staged_writes = std::make_unique<StagedWrites>(backend.get(), nf_process);
+
+  LoopbackPacketManager loopback(workers, build_pkts(flows, pkt_size));
+  ControllerPipeline pipeline(producers, workers, ring_size, burst, process, &loopback);
+  pipeline.set_flow_hash(flow_hash);
+
+  const LoopbackPacketManager::report_t report = loopback.run(pipeline, duration, rate);
+
+  size_t flows_seen = 0;
+  for (const auto &counters : flow_counters) {
+    flows_seen += counters.size();
+  }
+
+  std::cout << "Workers:     " << workers << "\n";
+  std::cout << "Producers:   " << producers << "\n";
+  std::cout << "Duration:    " << report.seconds << " s\n";
+  std::cout << "Injected:    " << report.injected << " (" << report.injected / report.seconds / 1e6 << " Mpps)\n";
+  std::cout << "Dropped:     " << report.dropped << " (" << 100.0 * report.dropped / std::max<u64>(report.injected, 1) << "%)\n";
+  std::cout << "Processed:   " << report.processed << " (" << report.processed / report.seconds / 1e6 << " Mpps)\n";
+  std::cout << "Forwarded:   " << report.forwarded << " (" << report.forwarded_bytes * 8 / report.seconds / 1e9 << " Gbps)\n";
+  std::cout << "Flows:       " << flows_seen << "\n";
+  std::cout << "Commits:     " << backend->commits.load() << "\n";
+  std::cout << "Lock wait:   " << backend->lock_wait.load() / report.seconds / 1e9 / workers * 100 << "% of the workers' time\n";
+  std::cout << "Latency p50:  <= " << report.latency_p50 << " ns\n";
+  std::cout << "Latency p99:  <= " << report.latency_p99 << " ns\n";
+  std::cout << "Latency p999: <= " << report.latency_p999 << " ns\n";
+  std::cout << "Latency max:  " << report.latency_max << " ns\n";
+
+  return 0;
+}
\ No newline at end of file
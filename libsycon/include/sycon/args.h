@@ -19,6 +19,21 @@ struct args_t {
   // Wait until the input and output ports are ready.
   // Is is only relevant when running with the ASIC, not with the model.
   bool wait_for_ports;
+
+  // Controller packets processed under a single transaction (1 commits after every packet).
+  size_t commit_batch_size;
+
+  // Longest a batch transaction stays open before being committed.
+  time_us_t commit_window;
+
+  // Threads running the NF behind lock-free rings filled by the RX callbacks (0 runs it right in the RX callbacks).
+  size_t pipeline_workers;
+
+  // Slots in each (RX ring, worker) ring.
+  size_t pipeline_ring_size;
+
+  // Most packets a worker takes from a ring at once.
+  size_t pipeline_burst;
 };
 
 extern args_t args;
@@ -6,29 +6,44 @@
 #include <cstring>
 #include <sstream>
 #include <iomanip>
+#include <string_view>
 
 namespace sycon {
 
+// Buffers up to INLINE_CAPACITY bytes (every key and value we have seen so far) are stored inline, so building a key or reading a value on the
+// packet path never touches the heap. Larger buffers fall back to a heap allocation.
 struct buffer_t {
+  static constexpr const bytes_t INLINE_CAPACITY = 32;
+
   u8 *data;
   bytes_t size;
+  bytes_t capacity;
+  u8 inline_data[INLINE_CAPACITY];
 
-  explicit buffer_t() : data(nullptr), size(0) {}
-  explicit buffer_t(bytes_t _size) : data(new u8[_size]), size(_size) { std::memset(data, 0, size); }
-  explicit buffer_t(u8 *_data, bytes_t _size) : data(new u8[_size]), size(_size) { std::copy(_data, _data + size, data); }
+  explicit buffer_t() : data(inline_data), size(0), capacity(INLINE_CAPACITY) {}
 
-  buffer_t(const buffer_t &other) : buffer_t(other.size) { std::copy(other.data, other.data + size, data); }
+  explicit buffer_t(bytes_t _size) : buffer_t() {
+    reserve(_size);
+    size = _size;
+    std::memset(data, 0, size);
+  }
 
-  buffer_t(buffer_t &&other) : data(other.data), size(other.size) {
-    other.data = nullptr;
-    other.size = 0;
+  explicit buffer_t(u8 *_data, bytes_t _size) : buffer_t() {
+    reserve(_size);
+    size = _size;
+    std::copy(_data, _data + size, data);
   }
 
-  ~buffer_t() {
-    if (data != nullptr) {
-      delete[] data;
-    }
+  buffer_t(const buffer_t &other) : buffer_t() {
+    reserve(other.size);
+    size = other.size;
+    std::copy(other.data, other.data + size, data);
+  }
 
+  buffer_t(buffer_t &&other) : buffer_t() { steal(other); }
+
+  ~buffer_t() {
+    release();
     size = 0;
   }
 
@@ -37,15 +52,10 @@ struct buffer_t {
       return *this;
     }
 
-    if (data != nullptr) {
-      delete[] data;
-    }
-
+    // Reuse whatever storage we already have if it is big enough.
+    reserve(other.size);
     size = other.size;
-    data = new u8[size];
-
-    std::memset(data, 0, size);
-    std::copy(other.data, other.data + other.size, data + (size - other.size));
+    std::copy(other.data, other.data + other.size, data);
 
     return *this;
   }
@@ -55,19 +65,14 @@ struct buffer_t {
       return *this;
     }
 
-    if (data != nullptr) {
-      delete[] data;
-    }
-
-    data = other.data;
-    size = other.size;
-
-    other.data = nullptr;
-    other.size = 0;
+    release();
+    steal(other);
 
     return *this;
   }
 
+  bool is_inline() const { return data == inline_data; }
+
   u8 &operator[](bytes_t i) {
     assert(i < size);
     return data[i];
@@ -201,6 +206,45 @@ struct buffer_t {
 
     return ss.str();
   }
+
+private:
+  // Grows the storage (discarding its contents) so that it can hold at least new_capacity bytes.
+  void reserve(bytes_t new_capacity) {
+    if (new_capacity <= capacity) {
+      return;
+    }
+
+    release();
+    data     = new u8[new_capacity];
+    capacity = new_capacity;
+  }
+
+  void release() {
+    if (!is_inline()) {
+      delete[] data;
+    }
+
+    data     = inline_data;
+    capacity = INLINE_CAPACITY;
+  }
+
+  // Takes over other's contents, leaving it empty. Inline contents have to be copied.
+  void steal(buffer_t &other) {
+    if (other.is_inline()) {
+      std::copy(other.data, other.data + other.size, inline_data);
+      data     = inline_data;
+      capacity = INLINE_CAPACITY;
+    } else {
+      data     = other.data;
+      capacity = other.capacity;
+    }
+
+    size = other.size;
+
+    other.data     = other.inline_data;
+    other.size     = 0;
+    other.capacity = INLINE_CAPACITY;
+  }
 };
 
 inline bool operator==(const buffer_t &lhs, const buffer_t &rhs) {
@@ -232,11 +276,8 @@ inline std::ostream &operator<<(std::ostream &os, const buffer_t &buffer) {
 
 struct buffer_hash_t {
   std::size_t operator()(const buffer_t &buffer) const {
-    std::size_t hash = 0;
-    for (bytes_t i = 0; i < buffer.size; i++) {
-      hash ^= std::hash<bytes_t>{}(buffer.data[i]);
-    }
-    return hash;
+    // XORing the bytes' hashes together made every permutation of a key collide.
+    return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char *>(buffer.data), buffer.size));
   }
 };
 
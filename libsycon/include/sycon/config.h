@@ -113,6 +113,16 @@ extern struct config_t {
     unlock();
   }
 
+  // Drops everything written so far but keeps the transaction (and the lock) open.
+  void restart_transaction() {
+    LOG_DEBUG("***** Restarting transaction *****");
+    bf_status_t bf_status = session->abortTransaction();
+    ASSERT_BF_STATUS(bf_status);
+    const bool atomic{true};
+    bf_status = session->beginTransaction(atomic);
+    ASSERT_BF_STATUS(bf_status);
+  }
+
   void commit_transaction() {
     const bool block_until_complete{true};
     bf_status_t bf_status = session->commitTransaction(block_until_complete);
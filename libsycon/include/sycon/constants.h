@@ -27,6 +27,11 @@ constexpr const bf_port_speed_t DEFAULT_PORT_SPEED            = BF_SPEED_100G;
 constexpr const bf_loopback_mode_e DEFAULT_PORT_LOOPBACK_MODE = BF_LPBK_NONE;
 constexpr const u16 DEFAULT_PORT_LANE                         = 0;
 constexpr const bool DEFAULT_WAIT_FOR_PORTS                   = true;
+constexpr const size_t DEFAULT_COMMIT_BATCH_SIZE              = 1;
+constexpr const time_us_t DEFAULT_COMMIT_WINDOW               = 100;
+constexpr const size_t DEFAULT_PIPELINE_WORKERS               = 0;
+constexpr const size_t DEFAULT_PIPELINE_RING_SIZE             = 128;
+constexpr const size_t DEFAULT_PIPELINE_BURST                 = 32;
 
 constexpr const u16 ALL_PIPES                     = 0xffff;
 constexpr const int SWITCH_PACKET_MAX_BUFFER_SIZE = 10000;
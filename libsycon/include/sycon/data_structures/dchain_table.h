@@ -2,6 +2,7 @@
 
 #include <array>
 #include <optional>
+#include <set>
 #include <unordered_set>
 
 #include "synapse_ds.h"
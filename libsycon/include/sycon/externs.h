@@ -4,6 +4,7 @@
 
 #include "packet.h"
 #include "time.h"
+#include "types.h"
 
 // These should be defined by the application using this library.
 
@@ -21,13 +22,6 @@ extern void nf_init();
 // Runs on exit (typically used for freeing state allocated by nf_init).
 extern void nf_exit();
 
-struct nf_process_result_t {
-  bool forward;
-  bool abort_transaction;
-
-  nf_process_result_t() : forward(true), abort_transaction(false) {}
-};
-
 // Function triggered by the arrival of each packet.
 extern nf_process_result_t nf_process(time_ns_t now, u8 *pkt, u16 size);
 
@@ -0,0 +1,126 @@
+#pragma once
+
+// Only depends on the standard library (the BfRt transaction backend lives in pcie.cpp), so that batching and rollback can be tested without the SDE.
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace sycon {
+
+// What the group commit needs from the switch: a transaction that also holds the controller lock while open.
+class TransactionBackend {
+public:
+  virtual ~TransactionBackend() = default;
+
+  virtual void begin()  = 0;
+  virtual void commit() = 0;
+  virtual void abort()  = 0;
+
+  // Aborts the open transaction and immediately opens a new one, without ever releasing the controller lock.
+  virtual void restart() = 0;
+};
+
+// Stands in for a BfRt session, so that batching and rollback can be exercised without a switch. Writes are staged with stage() and only become
+// visible in committed once the transaction commits. write() is what the primitives do: leave the write to the pipeline worker's staged writes (see
+// stage_write()), or else stage it in the transaction, then record how to redo it.
+class MockTransactionBackend : public TransactionBackend {
+public:
+  struct write_t {
+    std::string table;
+    u64 key;
+    u64 value;
+  };
+
+  std::vector<write_t> staged;
+  std::vector<write_t> committed;
+
+  u64 begins;
+  u64 commits;
+  u64 aborts;
+  u64 restarts;
+  bool open;
+
+  MockTransactionBackend() : begins(0), commits(0), aborts(0), restarts(0), open(false) {}
+
+  void stage(const write_t &write);
+  void write(const write_t &write);
+
+  void begin() override;
+  void commit() override;
+  void abort() override;
+  void restart() override;
+};
+
+// Processes controller packets in batches, all under a single transaction, instead of paying for one synchronous commit per packet.
+//
+// BfRt has no savepoints, so when a packet asks for its transaction to be aborted the whole batch transaction is restarted and the hardware
+// writes of the packets before it are issued again, from a redo log filled in by the primitives (see record_write()). Packets to forward are only
+// transmitted once their batch commits. Software state kept by the data structures is not rolled back, just like with one transaction per packet.
+class GroupCommit {
+public:
+  using process_fn_t = std::function<nf_process_result_t(time_ns_t now, u8 *pkt, u16 size)>;
+  using tx_fn_t      = std::function<void(u8 *pkt, u16 size)>;
+
+private:
+  struct pending_tx_t {
+    std::vector<u8> pkt;
+    bool forward;
+  };
+
+  TransactionBackend *backend;
+  const process_fn_t process_fn;
+  const tx_fn_t tx_fn;
+  const size_t max_batch_size;
+  const time_ns_t max_batch_window;
+
+  std::mutex mutex;
+
+  bool open;
+  time_ns_t opened_at;
+  bool replaying;
+
+  // Redo logs of the packets in the open batch that did not abort, and of the packet being processed.
+  std::vector<std::vector<std::function<void()>>> committed_writes;
+  std::vector<std::function<void()>> current_writes;
+
+  std::vector<pending_tx_t> pending_tx;
+
+public:
+  GroupCommit(TransactionBackend *backend, process_fn_t process_fn, tx_fn_t tx_fn, size_t max_batch_size, time_ns_t max_batch_window);
+
+  GroupCommit(const GroupCommit &)            = delete;
+  GroupCommit &operator=(const GroupCommit &) = delete;
+
+  // Processes a packet inside the open batch (opening one if needed), committing it if it is full or too old.
+  void process(time_ns_t now, const u8 *pkt, u16 size);
+
+  // Commits the open batch if it has been open for longer than the batch window, or if someone else is waiting for the controller lock.
+  void flush_if_stale(time_ns_t now, bool contended);
+
+  void flush();
+
+  // Adds a write of the packet being processed to the batch's redo log.
+  void record(std::function<void()> redo);
+
+  size_t batch_size() const { return committed_writes.size(); }
+
+private:
+  void commit_batch();
+};
+
+// Set only when group commit is enabled.
+extern std::unique_ptr<GroupCommit> group_commit;
+
+// Called by the primitives whenever they write to the switch.
+inline void record_write(std::function<void()> redo) {
+  if (group_commit) {
+    group_commit->record(std::move(redo));
+  }
+}
+
+} // namespace sycon
\ No newline at end of file
@@ -57,8 +57,8 @@ struct tcpudp_hdr_t {
   port_t dst_port;
 } __attribute__((packed));
 
-extern bytes_t packet_consumed;
-extern bytes_t packet_size;
+extern thread_local bytes_t packet_consumed;
+extern thread_local bytes_t packet_size;
 
 template <typename T> T *packet_consume(u8 *packet_base) {
   bytes_t size = sizeof(T);
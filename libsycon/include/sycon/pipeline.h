@@ -0,0 +1,276 @@
+#pragma once
+
+// This header only depends on the standard library, so that the pipeline and its loopback backend can be built (and benchmarked) without the SDE.
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+#include "types.h"
+
+namespace sycon {
+
+// Largest packet the pipeline carries (same as SWITCH_PACKET_MAX_BUFFER_SIZE).
+constexpr const size_t PIPELINE_PKT_BUFFER_SIZE = 10000;
+
+// Lock-free ring with a single producer and a single consumer. Slots are filled and read in place: the producer reserves the next free slot, fills
+// it and publishes it, and the consumer reads the published slots and releases them (in order) once done with them. Each side caches the other
+// side's index, so it only touches the shared cache line when it runs out of room (or of work).
+template <typename T> class SpscRing {
+private:
+  static constexpr const size_t CACHE_LINE_SIZE = 64;
+
+  std::vector<T> slots;
+  const size_t mask;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;
+  size_t cached_tail;
+
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+  size_t cached_head;
+
+  static size_t round_up_to_power_of_two(size_t n) {
+    size_t power = 1;
+    while (power < n) {
+      power <<= 1;
+    }
+    return power;
+  }
+
+public:
+  SpscRing(size_t capacity)
+      : slots(round_up_to_power_of_two(capacity)), mask(slots.size() - 1), head(0), cached_tail(0), tail(0), cached_head(0) {}
+
+  SpscRing(const SpscRing &)            = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  size_t capacity() const { return slots.size(); }
+
+  // Producer side.
+
+  T *reserve() {
+    const size_t t = tail.load(std::memory_order_relaxed);
+
+    if (t - cached_head == slots.size()) {
+      cached_head = head.load(std::memory_order_acquire);
+      if (t - cached_head == slots.size()) {
+        return nullptr;
+      }
+    }
+
+    return &slots[t & mask];
+  }
+
+  void publish() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  bool push(const T &value) {
+    T *slot = reserve();
+    if (!slot) {
+      return false;
+    }
+
+    *slot = value;
+    publish();
+
+    return true;
+  }
+
+  // Consumer side.
+
+  size_t readable() {
+    const size_t h = head.load(std::memory_order_relaxed);
+
+    if (h == cached_tail) {
+      cached_tail = tail.load(std::memory_order_acquire);
+    }
+
+    return cached_tail - h;
+  }
+
+  // The i-th oldest published slot, i < readable().
+  T &peek(size_t i) { return slots[(head.load(std::memory_order_relaxed) + i) & mask]; }
+
+  void release(size_t n) { head.store(head.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+  bool pop(T &value) {
+    if (readable() == 0) {
+      return false;
+    }
+
+    value = peek(0);
+    release(1);
+
+    return true;
+  }
+};
+
+struct pipeline_pkt_t {
+  time_ns_t rx_time;
+  u16 size;
+  u8 data[PIPELINE_PKT_BUFFER_SIZE];
+};
+
+struct pipeline_tx_pkt_t {
+  const u8 *data;
+  u16 size;
+  time_ns_t rx_time;
+};
+
+// Where the pipeline sends the packets the NF forwards.
+class PipelineTxBackend {
+public:
+  virtual ~PipelineTxBackend() = default;
+
+  // Called by each worker with the packets it forwards, in bursts. Packet data is only borrowed for the duration of the call.
+  virtual void tx_burst(size_t worker, const pipeline_tx_pkt_t *pkts, size_t n) = 0;
+};
+
+// Runs the NF on a packet (in place), returning whether to forward it. Whatever transaction handling the NF needs goes in here.
+using pipeline_process_fn_t = bool (*)(time_ns_t now, u8 *pkt, u16 size);
+
+// Flow a packet belongs to, for picking the worker that processes it. Only sees the first segment of the packet, which always holds the headers.
+using pipeline_flow_hash_fn_t = u64 (*)(const u8 *pkt, u16 size);
+
+// Staged controller runtime.
+//
+// Producers (the RX callbacks, one per RX ring) only copy packets into SPSC rings, one per (producer, worker) pair, picking the worker by flow
+// hash. Each worker drains its rings, runs the NF on each packet right in its ring slot, and hands the packets to forward to the TX backend in
+// bursts. Packets of the same flow always go to the same worker, in order, so NF state partitioned by flow hash (see pipeline_worker_id()) needs no
+// lock. Hardware writes still need the controller lock: on the switch, workers stage them and only take the lock to apply them (see
+// StagedWrites).
+//
+// Until a flow hash is set (typically from nf_init()), every packet goes to the first worker.
+class ControllerPipeline {
+public:
+  struct stats_t {
+    u64 enqueued;
+    u64 dropped;
+    u64 processed;
+    u64 forwarded;
+  };
+
+private:
+  struct alignas(64) worker_stats_t {
+    std::atomic<u64> processed;
+    std::atomic<u64> forwarded;
+  };
+
+  struct alignas(64) producer_stats_t {
+    std::atomic<u64> enqueued;
+    std::atomic<u64> dropped;
+  };
+
+  const size_t num_producers;
+  const size_t num_workers;
+  const size_t burst;
+
+  const pipeline_process_fn_t process_fn;
+  PipelineTxBackend *tx_backend;
+  std::atomic<pipeline_flow_hash_fn_t> flow_hash_fn;
+
+  // Indexed by producer * num_workers + worker.
+  std::vector<std::unique_ptr<SpscRing<pipeline_pkt_t>>> rings;
+
+  std::vector<producer_stats_t> producer_stats;
+  std::vector<worker_stats_t> worker_stats;
+
+  std::atomic<bool> running;
+  std::vector<std::thread> workers;
+
+public:
+  ControllerPipeline(size_t num_producers, size_t num_workers, size_t ring_size, size_t burst, pipeline_process_fn_t process_fn,
+                     PipelineTxBackend *tx_backend);
+
+  ControllerPipeline(const ControllerPipeline &)            = delete;
+  ControllerPipeline &operator=(const ControllerPipeline &) = delete;
+
+  // Stops the workers, leaving whatever is still in the rings unprocessed.
+  ~ControllerPipeline();
+
+  size_t get_num_producers() const { return num_producers; }
+  size_t get_num_workers() const { return num_workers; }
+
+  void set_flow_hash(pipeline_flow_hash_fn_t fn) { flow_hash_fn.store(fn, std::memory_order_release); }
+  bool has_flow_hash() const { return flow_hash_fn.load(std::memory_order_relaxed) != nullptr; }
+
+  size_t get_worker(const u8 *pkt, u16 size) const {
+    const pipeline_flow_hash_fn_t fn = flow_hash_fn.load(std::memory_order_acquire);
+    return fn ? fn(pkt, size) % num_workers : 0;
+  }
+
+  // Producer side, only ever called from a single thread per producer. Reserves a slot in the ring of the worker in charge of the packet, returning
+  // nullptr (and counting a drop) if it is full. The producer fills in the slot and publishes it with enqueue().
+  pipeline_pkt_t *reserve(size_t producer, size_t worker);
+  void enqueue(size_t producer, size_t worker);
+
+  // Both at once, for packets already in a single buffer. Returns false if the packet was dropped.
+  bool enqueue(size_t producer, time_ns_t now, const u8 *pkt, u16 size);
+
+  // Only consistent once all producers and workers are quiet.
+  stats_t get_stats() const;
+
+  // Waits until the workers have processed everything enqueued so far.
+  void drain() const;
+
+private:
+  void worker_loop(size_t worker);
+};
+
+// Set only when the pipeline is enabled.
+extern std::unique_ptr<ControllerPipeline> controller_pipeline;
+
+inline void set_pipeline_flow_hash(pipeline_flow_hash_fn_t fn) {
+  if (controller_pipeline) {
+    controller_pipeline->set_flow_hash(fn);
+  }
+}
+
+// Worker running the calling thread (0 outside of the pipeline workers).
+size_t pipeline_worker_id();
+
+// Stands in for the BF packet manager on any Linux box, to benchmark the pipeline (and the NF in it).
+//
+// Each injector thread is a producer, replaying the given packets in a loop, stamped with the time they are injected. Forwarded packets are counted
+// per worker, along with their latency (from injection to TX) in a log-scale histogram.
+class LoopbackPacketManager : public PipelineTxBackend {
+public:
+  struct report_t {
+    double seconds;
+    u64 injected;
+    u64 dropped;
+    u64 processed;
+    u64 forwarded;
+    u64 forwarded_bytes;
+    time_ns_t latency_p50;
+    time_ns_t latency_p99;
+    time_ns_t latency_p999;
+    time_ns_t latency_max;
+  };
+
+private:
+  static constexpr const size_t LATENCY_BUCKETS = 64;
+
+  struct alignas(64) tx_stats_t {
+    u64 pkts;
+    u64 bytes;
+    time_ns_t max_latency;
+    u64 latency_buckets[LATENCY_BUCKETS];
+  };
+
+  const std::vector<std::vector<u8>> pkts;
+  std::vector<tx_stats_t> tx_stats;
+
+public:
+  LoopbackPacketManager(size_t num_workers, const std::vector<std::vector<u8>> &pkts);
+
+  void tx_burst(size_t worker, const pipeline_tx_pkt_t *pkts, size_t n) override;
+
+  // Injects packets into the pipeline for the given time, from one thread per pipeline producer, at up to rate_pps packets per second each (0 for
+  // as fast as possible). Just like on the switch, packets that find their ring full are dropped.
+  report_t run(ControllerPipeline &pipeline, double seconds, u64 rate_pps);
+};
+
+} // namespace sycon
\ No newline at end of file
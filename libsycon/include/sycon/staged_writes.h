@@ -0,0 +1,61 @@
+#pragma once
+
+// Only depends on the standard library (the BfRt transaction backend lives in pcie.cpp), so that staging can be tested, and the controller lock
+// benchmarked, without the SDE.
+
+#include <functional>
+#include <memory>
+
+#include "group_commit.h"
+#include "types.h"
+
+namespace sycon {
+
+// Runs the NF of the pipeline workers outside of the controller lock, taking it only to apply the hardware writes the NF made.
+//
+// While a worker runs the NF, the primitives don't write to the switch, they stage their writes instead (see stage_write()). Once the NF is done,
+// the staged writes are applied in a single transaction, holding the controller lock only for as long as that takes. Packets that write nothing, or
+// that abort their transaction, never take the lock at all. Packets are only forwarded after their writes are committed.
+//
+// Reads from the switch, and software state shared with the dataplane notification callbacks, need the lock for real: lock_shared_state() takes
+// it for the rest of the packet, applying whatever was staged so far, so that the NF reads its own writes. From then on the packet runs just like
+// with one transaction per packet.
+class StagedWrites {
+public:
+  using process_fn_t = std::function<nf_process_result_t(time_ns_t now, u8 *pkt, u16 size)>;
+
+private:
+  TransactionBackend *backend;
+  const process_fn_t process_fn;
+
+public:
+  StagedWrites(TransactionBackend *backend, process_fn_t process_fn);
+
+  StagedWrites(const StagedWrites &)            = delete;
+  StagedWrites &operator=(const StagedWrites &) = delete;
+
+  // Processes a packet (in place), returning whether to forward it. Safe to call from several threads at once.
+  bool process(time_ns_t now, u8 *pkt, u16 size);
+
+  // Stages a write of the packet being processed by the calling thread, returning false if it must be issued right away instead (outside of
+  // process(), once the lock is taken, or while applying the staged writes).
+  bool stage(std::function<void()> write);
+
+  // Takes the controller lock for the rest of the packet being processed by the calling thread (if not taken already).
+  void lock();
+};
+
+// Set only when the pipeline is enabled.
+extern std::unique_ptr<StagedWrites> staged_writes;
+
+// Called by the primitives before writing to the switch. When it returns true, the write was staged, and the primitive must not issue it.
+inline bool stage_write(std::function<void()> write) { return staged_writes && staged_writes->stage(std::move(write)); }
+
+// Called by the primitives before reading from the switch, and by the NF before touching state shared with the dataplane notification callbacks.
+inline void lock_shared_state() {
+  if (staged_writes) {
+    staged_writes->lock();
+  }
+}
+
+} // namespace sycon
\ No newline at end of file
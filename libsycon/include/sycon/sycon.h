@@ -9,6 +9,7 @@
 #include "log.h"
 #include "data_structures/data_structures.h"
 #include "packet.h"
+#include "pipeline.h"
 #include "primitives/primitives.h"
 #include "time.h"
 #include "util.h"
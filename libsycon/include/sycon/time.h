@@ -7,15 +7,11 @@
 #include <stdint.h>
 #include <time.h>
 
+#include "types.h"
 #include "util.h"
 
 namespace sycon {
 
-typedef u64 time_ns_t;
-typedef u64 time_ms_t;
-typedef u64 time_us_t;
-typedef u64 time_s_t;
-
 inline time_ns_t get_time() {
   struct timespec tp;
   clock_gettime(CLOCK_MONOTONIC, &tp);
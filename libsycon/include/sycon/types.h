@@ -0,0 +1,35 @@
+#pragma once
+
+// Only depends on the standard library, so that the parts of the controller that don't talk to the switch can be built (and tested) without the
+// SDE.
+
+namespace sycon {
+
+using u64 = __UINT64_TYPE__;
+using u32 = __UINT32_TYPE__;
+using u16 = __UINT16_TYPE__;
+using u8  = __UINT8_TYPE__;
+
+using i64 = __INT64_TYPE__;
+using i32 = __INT32_TYPE__;
+using i16 = __INT16_TYPE__;
+using i8  = __INT8_TYPE__;
+
+using bits_t  = u64;
+using bytes_t = u64;
+
+using field_t = u64;
+
+typedef u64 time_ns_t;
+typedef u64 time_ms_t;
+typedef u64 time_us_t;
+typedef u64 time_s_t;
+
+struct nf_process_result_t {
+  bool forward;
+  bool abort_transaction;
+
+  nf_process_result_t() : forward(true), abort_transaction(false) {}
+};
+
+} // namespace sycon
\ No newline at end of file
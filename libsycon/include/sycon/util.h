@@ -7,6 +7,7 @@
 #include <iostream>
 
 #include "log.h"
+#include "types.h"
 
 #define bswap16(v) __builtin_bswap16((v))
 #define bswap32(v) __builtin_bswap32((v))
@@ -30,21 +31,6 @@
 
 namespace sycon {
 
-using u64 = __UINT64_TYPE__;
-using u32 = __UINT32_TYPE__;
-using u16 = __UINT16_TYPE__;
-using u8  = __UINT8_TYPE__;
-
-using i64 = __INT64_TYPE__;
-using i32 = __INT32_TYPE__;
-using i16 = __INT16_TYPE__;
-using i8  = __INT8_TYPE__;
-
-using bits_t  = u64;
-using bytes_t = u64;
-
-using field_t = u64;
-
 std::string read_env(const char *env_var);
 
 } // namespace sycon
\ No newline at end of file
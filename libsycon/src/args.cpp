@@ -29,6 +29,15 @@ void parse_args(int argc, char *argv[]) {
   app.add_flag("--model", args.model, "Run for the tofino model")->default_val(DEFAULT_RUN_WITH_MODEL);
   app.add_option("--tna", args.tna_version, "TNA version")->default_val(DEFAULT_TNA_VERSION);
   app.add_option("--ports", args.ports, "Frontend ports")->required();
+  app.add_option("--commit-batch", args.commit_batch_size, "Controller packets committed together in a single transaction")
+      ->default_val(DEFAULT_COMMIT_BATCH_SIZE);
+  app.add_option("--commit-window-us", args.commit_window, "Maximum time (us) a batch transaction stays open")->default_val(DEFAULT_COMMIT_WINDOW);
+  app.add_option("--pipeline-workers", args.pipeline_workers, "Threads running the NF behind the RX callbacks (0 runs it in the RX callbacks)")
+      ->default_val(DEFAULT_PIPELINE_WORKERS);
+  app.add_option("--pipeline-ring-size", args.pipeline_ring_size, "Slots in each ring between an RX callback and a pipeline worker")
+      ->default_val(DEFAULT_PIPELINE_RING_SIZE);
+  app.add_option("--pipeline-burst", args.pipeline_burst, "Most packets a pipeline worker takes from a ring at once")
+      ->default_val(DEFAULT_PIPELINE_BURST);
 
   nf_args(app);
 
@@ -46,6 +55,19 @@ void parse_args(int argc, char *argv[]) {
   if (args.ports.empty()) {
     ERROR("No ports specified.\n");
   }
+
+  if (args.commit_batch_size == 0) {
+    ERROR("Commit batch size must be at least 1.\n");
+  }
+
+  if (args.pipeline_workers > 0 && (args.pipeline_ring_size == 0 || args.pipeline_burst == 0)) {
+    ERROR("Pipeline ring size and burst must be at least 1.\n");
+  }
+
+  // Batches serialize every packet under the controller lock, which is exactly what the pipeline workers avoid.
+  if (args.pipeline_workers > 0 && args.commit_batch_size > 1) {
+    ERROR("Group commit (--commit-batch) and the pipeline (--pipeline-workers) cannot be used together.\n");
+  }
 }
 
 } // namespace sycon
\ No newline at end of file
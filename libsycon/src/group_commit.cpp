@@ -0,0 +1,143 @@
+#include "../include/sycon/group_commit.h"
+#include "../include/sycon/staged_writes.h"
+
+#include <cassert>
+
+namespace sycon {
+
+std::unique_ptr<GroupCommit> group_commit;
+
+// Writes made by other threads (e.g. dataplane notification callbacks) run in their own transactions, and must stay out of the redo log.
+static thread_local bool processing = false;
+
+void MockTransactionBackend::stage(const write_t &write) {
+  assert(open && "Writing outside of a transaction");
+  staged.push_back(write);
+}
+
+void MockTransactionBackend::write(const write_t &write) {
+  if (stage_write([this, write]() { this->write(write); })) {
+    return;
+  }
+
+  stage(write);
+  record_write([this, write]() { this->write(write); });
+}
+
+void MockTransactionBackend::begin() {
+  assert(!open && "Transaction already open");
+  open = true;
+  begins++;
+}
+
+void MockTransactionBackend::commit() {
+  assert(open && "No open transaction");
+  committed.insert(committed.end(), staged.begin(), staged.end());
+  staged.clear();
+  open = false;
+  commits++;
+}
+
+void MockTransactionBackend::abort() {
+  assert(open && "No open transaction");
+  staged.clear();
+  open = false;
+  aborts++;
+}
+
+void MockTransactionBackend::restart() {
+  assert(open && "No open transaction");
+  staged.clear();
+  restarts++;
+}
+
+GroupCommit::GroupCommit(TransactionBackend *_backend, process_fn_t _process_fn, tx_fn_t _tx_fn, size_t _max_batch_size,
+                         time_ns_t _max_batch_window)
+    : backend(_backend), process_fn(_process_fn), tx_fn(_tx_fn), max_batch_size(_max_batch_size), max_batch_window(_max_batch_window),
+      open(false), opened_at(0), replaying(false) {
+  assert(max_batch_size > 0 && "Batches must hold at least one packet");
+}
+
+void GroupCommit::process(time_ns_t now, const u8 *pkt, u16 size) {
+  std::lock_guard<std::mutex> guard(mutex);
+
+  if (!open) {
+    backend->begin();
+    open      = true;
+    opened_at = now;
+  }
+
+  // The NF may rewrite the packet in place, and the buffer it came in is gone by the time the batch commits.
+  pending_tx.push_back({std::vector<u8>(pkt, pkt + size), false});
+  pending_tx_t &tx = pending_tx.back();
+
+  current_writes.clear();
+
+  processing                       = true;
+  const nf_process_result_t result = process_fn(now, tx.pkt.data(), size);
+  processing                       = false;
+
+  if (result.abort_transaction) {
+    // Throw away everything written in this batch, and write again what the packets before this one wrote.
+    backend->restart();
+
+    replaying = true;
+    for (const std::vector<std::function<void()>> &writes : committed_writes) {
+      for (const std::function<void()> &redo : writes) {
+        redo();
+      }
+    }
+    replaying = false;
+  } else {
+    committed_writes.push_back(std::move(current_writes));
+  }
+
+  current_writes.clear();
+  tx.forward = result.forward;
+
+  if (pending_tx.size() >= max_batch_size || now - opened_at >= max_batch_window) {
+    commit_batch();
+  }
+}
+
+void GroupCommit::flush_if_stale(time_ns_t now, bool contended) {
+  std::lock_guard<std::mutex> guard(mutex);
+
+  if (open && (contended || now - opened_at >= max_batch_window)) {
+    commit_batch();
+  }
+}
+
+void GroupCommit::flush() {
+  std::lock_guard<std::mutex> guard(mutex);
+
+  if (open) {
+    commit_batch();
+  }
+}
+
+void GroupCommit::record(std::function<void()> redo) {
+  if (processing && !replaying) {
+    current_writes.push_back(std::move(redo));
+  }
+}
+
+void GroupCommit::commit_batch() {
+  assert(open && "No open batch");
+
+  backend->commit();
+  open = false;
+
+  committed_writes.clear();
+
+  // Only now that the state they depend on is in the switch can the packets go out.
+  for (pending_tx_t &tx : pending_tx) {
+    if (tx.forward) {
+      tx_fn(tx.pkt.data(), tx.pkt.size());
+    }
+  }
+
+  pending_tx.clear();
+}
+
+} // namespace sycon
\ No newline at end of file
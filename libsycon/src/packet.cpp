@@ -125,8 +125,8 @@ inline u16 ipv4_udptcp_cksum(const ipv4_hdr_t *ipv4_hdr, const void *l4_hdr) {
 
 } // namespace
 
-bytes_t packet_consumed;
-bytes_t packet_size;
+thread_local bytes_t packet_consumed;
+thread_local bytes_t packet_size;
 
 void packet_init(bytes_t size) {
   assert(size > 0);
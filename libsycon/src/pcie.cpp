@@ -5,8 +5,11 @@
 #include "../include/sycon/config.h"
 #include "../include/sycon/constants.h"
 #include "../include/sycon/externs.h"
+#include "../include/sycon/group_commit.h"
 #include "../include/sycon/log.h"
 #include "../include/sycon/packet.h"
+#include "../include/sycon/pipeline.h"
+#include "../include/sycon/staged_writes.h"
 #include "../include/sycon/sycon.h"
 #include "packet.h"
 
@@ -19,11 +22,16 @@ extern "C" {
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace sycon {
 
 std::unique_ptr<nf_state_t> nf_state;
 
-static void pcie_tx(bf_dev_id_t device, u8 *pkt, u32 packet_size) {
+static_assert(PIPELINE_PKT_BUFFER_SIZE == SWITCH_PACKET_MAX_BUFFER_SIZE, "Pipeline slots must fit any packet the RX callback assembles");
+
+static void pcie_tx(bf_dev_id_t device, const u8 *pkt, u32 packet_size) {
   bf_pkt *tx_pkt = nullptr;
 
   bf_status_t bf_status = bf_pkt_alloc(cfg.dev_tgt.dev_id, &tx_pkt, packet_size, BF_DMA_CPU_PKT_TRANSMIT_0);
@@ -44,48 +52,133 @@ static void pcie_tx(bf_dev_id_t device, u8 *pkt, u32 packet_size) {
   }
 }
 
+// Transmits the packets forwarded by the pipeline workers, each from its own pool of preallocated buffers (and its own TX ring, when there are
+// enough of them) instead of allocating a buffer per packet. Buffers go back to their worker's pool from txComplete, through an SPSC ring, which
+// relies on completions of a TX ring being delivered one at a time. Workers that run out of buffers fall back to pcie_tx().
+class BfPktTxBackend : public PipelineTxBackend {
+private:
+  struct tx_buffer_t {
+    bf_pkt *pkt;
+    size_t worker;
+  };
+
+  const bf_dev_id_t device;
+
+  // A single array for all workers, so that txComplete can tell pooled buffers from the ones pcie_tx() allocates by their address alone.
+  std::vector<tx_buffer_t> buffers;
+  std::vector<std::unique_ptr<SpscRing<tx_buffer_t *>>> pools;
+
+public:
+  BfPktTxBackend(bf_dev_id_t _device, size_t num_workers, size_t buffers_per_worker) : device(_device), buffers(num_workers * buffers_per_worker) {
+    for (size_t worker = 0; worker < num_workers; worker++) {
+      pools.push_back(std::make_unique<SpscRing<tx_buffer_t *>>(buffers_per_worker));
+    }
+
+    for (size_t i = 0; i < buffers.size(); i++) {
+      tx_buffer_t &buffer = buffers[i];
+      buffer.worker       = i / buffers_per_worker;
+
+      bf_status_t bf_status = bf_pkt_alloc(device, &buffer.pkt, SWITCH_PACKET_MAX_BUFFER_SIZE, BF_DMA_CPU_PKT_TRANSMIT_0);
+      ASSERT_BF_STATUS(bf_status);
+
+      const bool pooled = pools[buffer.worker]->push(&buffer);
+      assert(pooled);
+    }
+  }
+
+  bool owns(u64 tx_cookie) const {
+    const uintptr_t cookie = static_cast<uintptr_t>(tx_cookie);
+    return !buffers.empty() && cookie >= reinterpret_cast<uintptr_t>(&buffers.front()) && cookie <= reinterpret_cast<uintptr_t>(&buffers.back());
+  }
+
+  void release(u64 tx_cookie) {
+    tx_buffer_t *buffer = reinterpret_cast<tx_buffer_t *>(static_cast<uintptr_t>(tx_cookie));
+    const bool pooled   = pools[buffer->worker]->push(buffer);
+    assert(pooled);
+  }
+
+  void tx_burst(size_t worker, const pipeline_tx_pkt_t *pkts, size_t n) override {
+    SpscRing<tx_buffer_t *> &pool  = *pools[worker];
+    const bf_pkt_tx_ring_t tx_ring = static_cast<bf_pkt_tx_ring_t>(BF_PKT_TX_RING_0 + worker % BF_PKT_TX_RING_MAX);
+
+    for (size_t i = 0; i < n; i++) {
+      tx_buffer_t *buffer = nullptr;
+
+      if (!pool.pop(buffer)) {
+        pcie_tx(device, pkts[i].data, pkts[i].size);
+        continue;
+      }
+
+      bf_status_t bf_status = bf_pkt_data_copy(buffer->pkt, pkts[i].data, pkts[i].size);
+
+      if (bf_status == BF_SUCCESS) {
+        bf_status = bf_pkt_tx(device, buffer->pkt, tx_ring, (void *)buffer);
+      }
+
+      if (bf_status != BF_SUCCESS) {
+        release(reinterpret_cast<uintptr_t>(buffer));
+        ASSERT_BF_STATUS(bf_status);
+      }
+    }
+  }
+};
+
+static std::unique_ptr<BfPktTxBackend> bf_pkt_tx_backend;
+
 static bf_status_t txComplete(bf_dev_id_t device, bf_pkt_tx_ring_t tx_ring, u64 tx_cookie, u32 status) {
+  if (bf_pkt_tx_backend && bf_pkt_tx_backend->owns(tx_cookie)) {
+    bf_pkt_tx_backend->release(tx_cookie);
+    return BF_SUCCESS;
+  }
+
   // Now we can free the packet.
   bf_pkt_free(device, (bf_pkt *)((uintptr_t)tx_cookie));
   return BF_SUCCESS;
 }
 
-static bf_status_t pcie_rx(bf_dev_id_t device, bf_pkt *pkt, void *data, bf_pkt_rx_ring_t rx_ring) {
-  bf_pkt *orig_pkt = nullptr;
-  char in_packet[SWITCH_PACKET_MAX_BUFFER_SIZE];
-  char *pkt_buf   = nullptr;
-  char *bufp      = nullptr;
-  u32 packet_size = 0;
-  u16 pkt_len     = 0;
+// Batch transactions, and the ones applying the writes staged by the pipeline workers, hold the controller lock while open, exactly like the
+// per-packet ones.
+class BfRtTransactionBackend : public TransactionBackend {
+public:
+  void begin() override { cfg.begin_transaction(); }
+  void commit() override { cfg.commit_transaction(); }
+  void abort() override { cfg.abort_transaction(); }
+  void restart() override { cfg.restart_transaction(); }
+};
 
-  // save a pointer to the packet
-  orig_pkt = pkt;
+static BfRtTransactionBackend bfrt_transaction_backend;
 
-  // assemble the received packet
-  bufp = &in_packet[0];
+// Copies the segments of a packet into buffer, returning its size.
+static u32 pcie_assemble(bf_pkt *pkt, u8 *buffer) {
+  u32 packet_size = 0;
 
   do {
-    pkt_buf = (char *)bf_pkt_get_pkt_data(pkt);
-    pkt_len = bf_pkt_get_pkt_size(pkt);
+    const u8 *pkt_buf = bf_pkt_get_pkt_data(pkt);
+    const u16 pkt_len = bf_pkt_get_pkt_size(pkt);
 
     if ((packet_size + pkt_len) > SWITCH_PACKET_MAX_BUFFER_SIZE) {
       LOG_DEBUG("Packet too large to transmit - skipping");
       break;
     }
 
-    memcpy(bufp, pkt_buf, pkt_len);
-    bufp += pkt_len;
+    memcpy(buffer + packet_size, pkt_buf, pkt_len);
     packet_size += pkt_len;
     pkt = bf_pkt_get_nextseg(pkt);
   } while (pkt);
 
-  const time_ns_t now = get_time();
-  u8 *packet          = reinterpret_cast<u8 *>(&in_packet);
-
-  LOG_DEBUG("RX tid=%lu time=%lu", syscall(__NR_gettid), now);
+  return packet_size;
+}
 
+// Runs the NF on a packet in the RX callback, in its own transaction (or in the open batch), returning whether to transmit it right away.
+static bool pcie_process(time_ns_t now, u8 *packet, u16 packet_size) {
   packet_init(packet_size);
 
+  if (group_commit) {
+    // Transmitted by the group commit, once the batch commits.
+    group_commit->process(now, packet, packet_size);
+    return false;
+  }
+
   cfg.begin_transaction();
   nf_process_result_t result = nf_process(now, packet, packet_size);
 
@@ -95,11 +188,52 @@ static bf_status_t pcie_rx(bf_dev_id_t device, bf_pkt *pkt, void *data, bf_pkt_r
     cfg.commit_transaction();
   }
 
-  if (result.forward) {
+  return result.forward;
+}
+
+// Runs the NF on a packet in a pipeline worker, outside of the controller lock, which is only taken to apply the writes it staged.
+static bool pcie_pipeline_process(time_ns_t now, u8 *packet, u16 packet_size) {
+  packet_init(packet_size);
+  return staged_writes->process(now, packet, packet_size);
+}
+
+// Only hands the packet over to the pipeline worker in charge of its flow (with each RX ring being a producer of its own).
+static void pcie_rx_enqueue(bf_pkt *pkt, bf_pkt_rx_ring_t rx_ring) {
+  const size_t worker  = controller_pipeline->get_worker(bf_pkt_get_pkt_data(pkt), bf_pkt_get_pkt_size(pkt));
+  pipeline_pkt_t *slot = controller_pipeline->reserve(rx_ring, worker);
+
+  if (!slot) {
+    LOG_DEBUG("Pipeline worker %lu falling behind - dropping packet", worker);
+    return;
+  }
+
+  slot->size    = pcie_assemble(pkt, slot->data);
+  slot->rx_time = get_time();
+
+  controller_pipeline->enqueue(rx_ring, worker);
+}
+
+static bf_status_t pcie_rx(bf_dev_id_t device, bf_pkt *pkt, void *data, bf_pkt_rx_ring_t rx_ring) {
+  if (controller_pipeline) {
+    pcie_rx_enqueue(pkt, rx_ring);
+
+    const int fail = bf_pkt_free(device, pkt);
+    assert(fail == 0);
+
+    return BF_SUCCESS;
+  }
+
+  u8 packet[SWITCH_PACKET_MAX_BUFFER_SIZE];
+  const u32 packet_size = pcie_assemble(pkt, packet);
+  const time_ns_t now   = get_time();
+
+  LOG_DEBUG("RX tid=%lu time=%lu", syscall(__NR_gettid), now);
+
+  if (pcie_process(now, packet, packet_size)) {
     pcie_tx(device, packet, packet_size);
   }
 
-  const int fail = bf_pkt_free(device, orig_pkt);
+  const int fail = bf_pkt_free(device, pkt);
   assert(fail == 0);
 
   return BF_SUCCESS;
@@ -117,11 +251,37 @@ void register_pcie_pkt_ops() {
     ASSERT_BF_STATUS(bf_status);
   }
 
+  if (args.pipeline_workers > 0) {
+    bf_pkt_tx_backend   = std::make_unique<BfPktTxBackend>(cfg.dev_tgt.dev_id, args.pipeline_workers, args.pipeline_ring_size);
+    staged_writes       = std::make_unique<StagedWrites>(&bfrt_transaction_backend, nf_process);
+    controller_pipeline = std::make_unique<ControllerPipeline>(BF_PKT_RX_RING_MAX, args.pipeline_workers, args.pipeline_ring_size,
+                                                               args.pipeline_burst, pcie_pipeline_process, bf_pkt_tx_backend.get());
+  }
+
   // register callback for RX
   for (int rx_ring = BF_PKT_RX_RING_0; rx_ring < BF_PKT_RX_RING_MAX; rx_ring++) {
     bf_status_t bf_status = bf_pkt_rx_register(cfg.dev_tgt.dev_id, pcie_rx, (bf_pkt_rx_ring_t)rx_ring, 0);
     ASSERT_BF_STATUS(bf_status);
   }
+
+  if (args.commit_batch_size > 1) {
+    const bf_dev_id_t device         = cfg.dev_tgt.dev_id;
+    const time_ns_t commit_window_ns = args.commit_window * 1'000;
+
+    group_commit = std::make_unique<GroupCommit>(
+        &bfrt_transaction_backend, nf_process, [device](u8 *pkt, u16 size) { pcie_tx(device, pkt, size); }, args.commit_batch_size,
+        commit_window_ns);
+
+    // Commits batches that went quiet, and gets out of the way of dataplane notifications waiting for the lock.
+    std::thread flusher([commit_window_ns]() {
+      while (true) {
+        const bool contended = atomic64_read(&cfg.pending_dataplane_notifications) != 0;
+        group_commit->flush_if_stale(get_time(), contended);
+        usleep(std::max<time_ns_t>(commit_window_ns / 2'000, 1));
+      }
+    });
+    flusher.detach();
+  }
 }
 
 } // namespace sycon
\ No newline at end of file
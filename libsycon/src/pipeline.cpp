@@ -0,0 +1,282 @@
+#include "../include/sycon/pipeline.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+namespace sycon {
+
+std::unique_ptr<ControllerPipeline> controller_pipeline;
+
+static thread_local size_t current_worker = 0;
+
+size_t pipeline_worker_id() { return current_worker; }
+
+// Spinning workers back off to the sibling hyperthread first, and only then to the scheduler.
+static constexpr const size_t IDLE_SPINS_BEFORE_YIELD = 64;
+
+static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+static time_ns_t get_loopback_time() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ControllerPipeline::ControllerPipeline(size_t _num_producers, size_t _num_workers, size_t ring_size, size_t _burst,
+                                       pipeline_process_fn_t _process_fn, PipelineTxBackend *_tx_backend)
+    : num_producers(_num_producers), num_workers(_num_workers), burst(_burst), process_fn(_process_fn), tx_backend(_tx_backend),
+      flow_hash_fn(nullptr), producer_stats(_num_producers), worker_stats(_num_workers), running(true) {
+  assert(num_producers > 0 && "Pipeline without producers");
+  assert(num_workers > 0 && "Pipeline without workers");
+  assert(burst > 0 && "Pipeline burst must be at least 1");
+  assert(process_fn && tx_backend);
+
+  for (size_t i = 0; i < num_producers * num_workers; i++) {
+    rings.push_back(std::make_unique<SpscRing<pipeline_pkt_t>>(ring_size));
+  }
+
+  for (size_t i = 0; i < num_producers; i++) {
+    producer_stats[i].enqueued.store(0, std::memory_order_relaxed);
+    producer_stats[i].dropped.store(0, std::memory_order_relaxed);
+  }
+
+  for (size_t i = 0; i < num_workers; i++) {
+    worker_stats[i].processed.store(0, std::memory_order_relaxed);
+    worker_stats[i].forwarded.store(0, std::memory_order_relaxed);
+  }
+
+  for (size_t worker = 0; worker < num_workers; worker++) {
+    workers.emplace_back([this, worker]() { worker_loop(worker); });
+  }
+}
+
+ControllerPipeline::~ControllerPipeline() {
+  running.store(false, std::memory_order_relaxed);
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+pipeline_pkt_t *ControllerPipeline::reserve(size_t producer, size_t worker) {
+  assert(producer < num_producers && worker < num_workers);
+
+  pipeline_pkt_t *slot = rings[producer * num_workers + worker]->reserve();
+
+  if (!slot) {
+    std::atomic<u64> &dropped = producer_stats[producer].dropped;
+    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  return slot;
+}
+
+void ControllerPipeline::enqueue(size_t producer, size_t worker) {
+  rings[producer * num_workers + worker]->publish();
+
+  std::atomic<u64> &enqueued = producer_stats[producer].enqueued;
+  enqueued.store(enqueued.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool ControllerPipeline::enqueue(size_t producer, time_ns_t now, const u8 *pkt, u16 size) {
+  assert(size <= PIPELINE_PKT_BUFFER_SIZE);
+
+  const size_t worker  = get_worker(pkt, size);
+  pipeline_pkt_t *slot = reserve(producer, worker);
+
+  if (!slot) {
+    return false;
+  }
+
+  slot->rx_time = now;
+  slot->size    = size;
+  memcpy(slot->data, pkt, size);
+
+  enqueue(producer, worker);
+
+  return true;
+}
+
+ControllerPipeline::stats_t ControllerPipeline::get_stats() const {
+  stats_t stats{0, 0, 0, 0};
+
+  for (const producer_stats_t &producer : producer_stats) {
+    stats.enqueued += producer.enqueued.load(std::memory_order_acquire);
+    stats.dropped += producer.dropped.load(std::memory_order_relaxed);
+  }
+
+  for (const worker_stats_t &worker : worker_stats) {
+    stats.processed += worker.processed.load(std::memory_order_acquire);
+    stats.forwarded += worker.forwarded.load(std::memory_order_relaxed);
+  }
+
+  return stats;
+}
+
+void ControllerPipeline::drain() const {
+  while (true) {
+    const stats_t stats = get_stats();
+    if (stats.processed >= stats.enqueued) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+}
+
+void ControllerPipeline::worker_loop(size_t worker) {
+  current_worker = worker;
+
+  std::vector<pipeline_tx_pkt_t> tx_pkts(burst);
+  worker_stats_t &stats = worker_stats[worker];
+  size_t idle_spins     = 0;
+
+  while (running.load(std::memory_order_relaxed)) {
+    size_t total_processed = 0;
+
+    for (size_t producer = 0; producer < num_producers; producer++) {
+      SpscRing<pipeline_pkt_t> &ring = *rings[producer * num_workers + worker];
+
+      const size_t n = std::min(ring.readable(), burst);
+      if (n == 0) {
+        continue;
+      }
+
+      size_t forwarded = 0;
+      for (size_t i = 0; i < n; i++) {
+        pipeline_pkt_t &pkt = ring.peek(i);
+        if (process_fn(pkt.rx_time, pkt.data, pkt.size)) {
+          tx_pkts[forwarded++] = {pkt.data, pkt.size, pkt.rx_time};
+        }
+      }
+
+      if (forwarded > 0) {
+        tx_backend->tx_burst(worker, tx_pkts.data(), forwarded);
+      }
+
+      // The slots are only handed back to the producer once the backend is done with them.
+      ring.release(n);
+
+      stats.forwarded.store(stats.forwarded.load(std::memory_order_relaxed) + forwarded, std::memory_order_relaxed);
+      stats.processed.store(stats.processed.load(std::memory_order_relaxed) + n, std::memory_order_release);
+
+      total_processed += n;
+    }
+
+    if (total_processed > 0) {
+      idle_spins = 0;
+    } else if (idle_spins < IDLE_SPINS_BEFORE_YIELD) {
+      idle_spins++;
+      cpu_relax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+LoopbackPacketManager::LoopbackPacketManager(size_t num_workers, const std::vector<std::vector<u8>> &_pkts)
+    : pkts(_pkts), tx_stats(num_workers) {
+  assert(!pkts.empty() && "Nothing to inject");
+  for (tx_stats_t &stats : tx_stats) {
+    memset(&stats, 0, sizeof(stats));
+  }
+}
+
+void LoopbackPacketManager::tx_burst(size_t worker, const pipeline_tx_pkt_t *tx_pkts, size_t n) {
+  tx_stats_t &stats   = tx_stats[worker];
+  const time_ns_t now = get_loopback_time();
+
+  for (size_t i = 0; i < n; i++) {
+    const time_ns_t latency = now > tx_pkts[i].rx_time ? now - tx_pkts[i].rx_time : 0;
+    const size_t bucket     = latency == 0 ? 0 : 64 - __builtin_clzll(latency);
+
+    stats.pkts++;
+    stats.bytes += tx_pkts[i].size;
+    stats.max_latency = std::max(stats.max_latency, latency);
+    stats.latency_buckets[std::min(bucket, LATENCY_BUCKETS - 1)]++;
+  }
+}
+
+LoopbackPacketManager::report_t LoopbackPacketManager::run(ControllerPipeline &pipeline, double seconds, u64 rate_pps) {
+  const time_ns_t duration = seconds * 1e9;
+  const time_ns_t start    = get_loopback_time();
+
+  std::vector<std::thread> injectors;
+
+  for (size_t producer = 0; producer < pipeline.get_num_producers(); producer++) {
+    injectors.emplace_back([this, &pipeline, producer, duration, start, rate_pps]() {
+      const time_ns_t gap = rate_pps > 0 ? 1'000'000'000 / rate_pps : 0;
+      time_ns_t next      = start;
+      size_t i            = producer % pkts.size();
+
+      while (true) {
+        const time_ns_t now = get_loopback_time();
+
+        if (now - start >= duration) {
+          break;
+        }
+
+        if (now < next) {
+          cpu_relax();
+          continue;
+        }
+
+        const std::vector<u8> &pkt = pkts[i];
+        pipeline.enqueue(producer, now, pkt.data(), pkt.size());
+
+        i = i + 1 == pkts.size() ? 0 : i + 1;
+        next += gap;
+      }
+    });
+  }
+
+  for (std::thread &injector : injectors) {
+    injector.join();
+  }
+
+  pipeline.drain();
+
+  const ControllerPipeline::stats_t stats = pipeline.get_stats();
+
+  report_t report;
+  report.seconds         = (get_loopback_time() - start) / 1e9;
+  report.injected        = stats.enqueued + stats.dropped;
+  report.dropped         = stats.dropped;
+  report.processed       = stats.processed;
+  report.forwarded       = 0;
+  report.forwarded_bytes = 0;
+  report.latency_max     = 0;
+
+  u64 latency_buckets[LATENCY_BUCKETS] = {0};
+  for (const tx_stats_t &worker_stats : tx_stats) {
+    report.forwarded += worker_stats.pkts;
+    report.forwarded_bytes += worker_stats.bytes;
+    report.latency_max = std::max(report.latency_max, worker_stats.max_latency);
+    for (size_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+      latency_buckets[bucket] += worker_stats.latency_buckets[bucket];
+    }
+  }
+
+  // Upper bound of the bucket holding the percentile.
+  auto percentile = [&latency_buckets, &report](double p) -> time_ns_t {
+    const u64 target = report.forwarded * p;
+    u64 seen         = 0;
+    for (size_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+      seen += latency_buckets[bucket];
+      if (seen > target) {
+        return std::min<time_ns_t>(bucket == 0 ? 0 : (1ull << bucket) - 1, report.latency_max);
+      }
+    }
+    return report.latency_max;
+  };
+
+  report.latency_p50  = percentile(0.5);
+  report.latency_p99  = percentile(0.99);
+  report.latency_p999 = percentile(0.999);
+
+  return report;
+}
+
+} // namespace sycon
\ No newline at end of file
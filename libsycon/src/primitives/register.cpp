@@ -1,6 +1,8 @@
 #include "../../include/sycon/primitives/register.h"
 
+#include "../../include/sycon/group_commit.h"
 #include "../../include/sycon/log.h"
+#include "../../include/sycon/staged_writes.h"
 
 namespace sycon {
 
@@ -19,6 +21,8 @@ Register::Register(const Register &other)
 }
 
 std::vector<u32> Register::get_per_pipe(u32 i) {
+  lock_shared_state();
+
   key_setup(i);
   data_reset();
 
@@ -50,14 +54,24 @@ u32 Register::get_min(u32 i) {
 }
 
 void Register::set(u32 i, u32 value) {
+  if (stage_write([this, i, value]() { set(i, value); })) {
+    return;
+  }
+
   key_setup(i);
   data_setup(value);
 
   bf_status_t bf_status = table->tableEntryMod(*session, dev_tgt, *key, *data);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, i, value]() { set(i, value); });
 }
 
 void Register::overwrite_all_entries(u32 value) {
+  if (stage_write([this, value]() { overwrite_all_entries(value); })) {
+    return;
+  }
+
   data_setup(value);
 
   for (size_t i = 0; i < capacity; i++) {
@@ -66,6 +80,8 @@ void Register::overwrite_all_entries(u32 value) {
     bf_status_t bf_status = table->tableEntryMod(*session, dev_tgt, *key, *data);
     ASSERT_BF_STATUS(bf_status);
   }
+
+  record_write([this, value]() { overwrite_all_entries(value); });
 }
 
 void Register::key_setup(u32 i) {
@@ -3,6 +3,8 @@
 #include <sstream>
 
 #include "../../include/sycon/config.h"
+#include "../../include/sycon/group_commit.h"
+#include "../../include/sycon/staged_writes.h"
 #include "../../include/sycon/constants.h"
 #include "../../include/sycon/log.h"
 #include "../../include/sycon/util.h"
@@ -530,6 +532,8 @@ size_t Table::get_capacity() const { return capacity; }
 size_t Table::get_effective_capacity() const { return static_cast<size_t>(capacity * CAPACITY_EFFICIENCY); }
 
 size_t Table::get_usage() const {
+  lock_shared_state();
+
   u32 usage;
   bf_status_t bf_status = table->tableUsageGet(*session, dev_tgt, bfrt::BfRtTable::BfRtTableGetFlag::GET_FROM_SW, &usage);
   ASSERT_BF_STATUS(bf_status);
@@ -558,6 +562,10 @@ table_action_t Table::get_action(const std::string &name) const {
 }
 
 void Table::add_entry(const buffer_t &k) {
+  if (stage_write([this, k]() { add_entry(k); })) {
+    return;
+  }
+
   bf_status_t bf_status;
 
   set_key(k);
@@ -569,9 +577,15 @@ void Table::add_entry(const buffer_t &k) {
 
   bf_status = table->tableEntryAdd(*session, dev_tgt, flags, *key, *data);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, k]() { add_entry(k); });
 }
 
 void Table::add_entry(const buffer_t &k, const std::string &action_name, const std::vector<buffer_t> &params) {
+  if (stage_write([this, k, action_name, params]() { add_entry(k, action_name, params); })) {
+    return;
+  }
+
   bf_status_t bf_status;
 
   set_key(k);
@@ -583,9 +597,14 @@ void Table::add_entry(const buffer_t &k, const std::string &action_name, const s
 
   bf_status = table->tableEntryAdd(*session, dev_tgt, flags, *key, *data);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, k, action_name, params]() { add_entry(k, action_name, params); });
 }
 
 bool Table::try_add_entry(const buffer_t &k) {
+  // Whether the entry fits depends on the switch, so it can't be staged.
+  lock_shared_state();
+
   set_key(k);
   set_data();
 
@@ -594,10 +613,17 @@ bool Table::try_add_entry(const buffer_t &k) {
   BF_RT_FLAG_SET(flags, BF_RT_FROM_HW);
 
   bf_status_t bf_status = table->tableEntryAdd(*session, dev_tgt, flags, *key, *data);
-  return bf_status == BF_SUCCESS;
+  if (bf_status != BF_SUCCESS) {
+    return false;
+  }
+
+  record_write([this, k]() { try_add_entry(k); });
+  return true;
 }
 
 bool Table::try_add_entry(const buffer_t &k, const std::string &action_name, const std::vector<buffer_t> &params) {
+  lock_shared_state();
+
   set_key(k);
   set_data(action_name, params);
 
@@ -606,10 +632,19 @@ bool Table::try_add_entry(const buffer_t &k, const std::string &action_name, con
   BF_RT_FLAG_SET(flags, BF_RT_FROM_HW);
 
   bf_status_t bf_status = table->tableEntryAdd(*session, dev_tgt, flags, *key, *data);
-  return bf_status == BF_SUCCESS;
+  if (bf_status != BF_SUCCESS) {
+    return false;
+  }
+
+  record_write([this, k, action_name, params]() { try_add_entry(k, action_name, params); });
+  return true;
 }
 
 void Table::mod_entry(const buffer_t &k) {
+  if (stage_write([this, k]() { mod_entry(k); })) {
+    return;
+  }
+
   bf_status_t bf_status;
 
   set_key(k);
@@ -621,9 +656,15 @@ void Table::mod_entry(const buffer_t &k) {
 
   bf_status = table->tableEntryMod(*session, dev_tgt, flags, *key, *data);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, k]() { mod_entry(k); });
 }
 
 void Table::mod_entry(const buffer_t &k, const std::string &action_name, const std::vector<buffer_t> &params) {
+  if (stage_write([this, k, action_name, params]() { mod_entry(k, action_name, params); })) {
+    return;
+  }
+
   bf_status_t bf_status;
 
   set_key(k);
@@ -631,9 +672,15 @@ void Table::mod_entry(const buffer_t &k, const std::string &action_name, const s
 
   bf_status = table->tableEntryMod(*session, dev_tgt, *key, *data);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, k, action_name, params]() { mod_entry(k, action_name, params); });
 }
 
 void Table::add_or_mod_entry(const buffer_t &k) {
+  if (stage_write([this, k]() { add_or_mod_entry(k); })) {
+    return;
+  }
+
   bf_status_t bf_status;
 
   set_key(k);
@@ -646,9 +693,15 @@ void Table::add_or_mod_entry(const buffer_t &k) {
   bool was_added = false;
   bf_status      = table->tableEntryAddOrMod(*session, dev_tgt, flags, *key, *data, &was_added);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, k]() { add_or_mod_entry(k); });
 }
 
 void Table::add_or_mod_entry(const buffer_t &k, const std::string &action_name, const std::vector<buffer_t> &params) {
+  if (stage_write([this, k, action_name, params]() { add_or_mod_entry(k, action_name, params); })) {
+    return;
+  }
+
   bf_status_t bf_status;
 
   set_key(k);
@@ -661,9 +714,15 @@ void Table::add_or_mod_entry(const buffer_t &k, const std::string &action_name,
   bool was_added = false;
   bf_status      = table->tableEntryAddOrMod(*session, dev_tgt, flags, *key, *data, &was_added);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, k, action_name, params]() { add_or_mod_entry(k, action_name, params); });
 }
 
 void Table::del_entry(const buffer_t &k) {
+  if (stage_write([this, k]() { del_entry(k); })) {
+    return;
+  }
+
   bf_status_t bf_status;
 
   set_key(k);
@@ -674,6 +733,8 @@ void Table::del_entry(const buffer_t &k) {
 
   bf_status = table->tableEntryDel(*session, dev_tgt, flags, *key);
   ASSERT_BF_STATUS(bf_status);
+
+  record_write([this, k]() { del_entry(k); });
 }
 
 void Table::dump_data_fields() const {
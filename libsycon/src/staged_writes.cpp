@@ -0,0 +1,78 @@
+#include "../include/sycon/staged_writes.h"
+
+#include <cassert>
+#include <vector>
+
+namespace sycon {
+
+std::unique_ptr<StagedWrites> staged_writes;
+
+// Each worker stages the writes of its own packet. Writes made by other threads (e.g. dataplane notification callbacks) are never staged.
+struct staging_t {
+  bool processing;
+  bool locked;
+  std::vector<std::function<void()>> writes;
+};
+
+static thread_local staging_t staging{false, false, {}};
+
+static void apply_staged_writes() {
+  // Applying a write calls the primitive again, which now issues it (the lock is held), instead of staging it.
+  for (const std::function<void()> &write : staging.writes) {
+    write();
+  }
+  staging.writes.clear();
+}
+
+StagedWrites::StagedWrites(TransactionBackend *_backend, process_fn_t _process_fn) : backend(_backend), process_fn(_process_fn) {}
+
+bool StagedWrites::process(time_ns_t now, u8 *pkt, u16 size) {
+  assert(!staging.processing && "Nested packet processing");
+
+  staging.processing = true;
+  staging.locked     = false;
+  staging.writes.clear();
+
+  const nf_process_result_t result = process_fn(now, pkt, size);
+
+  if (staging.locked) {
+    if (result.abort_transaction) {
+      backend->abort();
+    } else {
+      backend->commit();
+    }
+  } else if (!result.abort_transaction && !staging.writes.empty()) {
+    staging.locked = true;
+    backend->begin();
+    apply_staged_writes();
+    backend->commit();
+  }
+
+  // Aborted packets that never took the lock just leave their staged writes behind.
+  staging.writes.clear();
+  staging.processing = false;
+  staging.locked     = false;
+
+  return result.forward;
+}
+
+bool StagedWrites::stage(std::function<void()> write) {
+  if (!staging.processing || staging.locked) {
+    return false;
+  }
+
+  staging.writes.push_back(std::move(write));
+  return true;
+}
+
+void StagedWrites::lock() {
+  if (!staging.processing || staging.locked) {
+    return;
+  }
+
+  staging.locked = true;
+  backend->begin();
+  apply_staged_writes();
+}
+
+} // namespace sycon
\ No newline at end of file
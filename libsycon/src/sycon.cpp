@@ -88,7 +88,14 @@ void setup_async_signal_handling_thread() {
   }
 }
 
-void nf_setup() { nf_init(); }
+void nf_setup() {
+  nf_init();
+
+  if (controller_pipeline && controller_pipeline->get_num_workers() > 1 && !controller_pipeline->has_flow_hash()) {
+    WARNING("No flow hash set (see set_pipeline_flow_hash()), all packets go to the first of the %zu pipeline workers.",
+            controller_pipeline->get_num_workers());
+  }
+}
 
 void run_cli() {
   cli_run_bfshell();
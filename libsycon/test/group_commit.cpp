@@ -0,0 +1,189 @@
+// Exercises the group commit against the mock transaction backend: batches committed by size and by window, aborts replaying the redo log, and
+// writes from other threads staying out of it.
+
+#include <sycon/group_commit.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sycon;
+
+#define CHECK(condition)                                                                                                                             \
+  do {                                                                                                                                               \
+    if (!(condition)) {                                                                                                                              \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                                                                  \
+      exit(1);                                                                                                                                       \
+    }                                                                                                                                                \
+  } while (0)
+
+namespace {
+
+constexpr const time_ns_t NEVER = 1'000'000'000'000ull;
+
+// Test packets are just [key, flags]: the NF writes the key to the "table" table (unless it is 0), and then aborts or drops the packet if asked
+// to. Forwarded packets have their key bumped, to check that what goes out is what the NF left in the buffer.
+enum : u8 { ABORT = 1 << 0, DROP = 1 << 1 };
+
+struct harness_t {
+  MockTransactionBackend backend;
+  std::vector<std::vector<u8>> sent;
+
+  harness_t(size_t max_batch_size, time_ns_t max_batch_window) {
+    group_commit = std::make_unique<GroupCommit>(
+        &backend,
+        [this](time_ns_t now, u8 *pkt, u16 size) {
+          nf_process_result_t result;
+
+          if (pkt[0] != 0) {
+            backend.write({"table", pkt[0], now});
+          }
+
+          pkt[0]++;
+
+          result.abort_transaction = pkt[1] & ABORT;
+          result.forward           = !(pkt[1] & DROP);
+
+          return result;
+        },
+        [this](u8 *pkt, u16 size) { sent.emplace_back(pkt, pkt + size); }, max_batch_size, max_batch_window);
+  }
+
+  ~harness_t() { group_commit.reset(); }
+
+  void process(time_ns_t now, u8 key, u8 flags = 0) {
+    const u8 pkt[2] = {key, flags};
+    group_commit->process(now, pkt, sizeof(pkt));
+  }
+};
+
+std::vector<u64> keys(const std::vector<MockTransactionBackend::write_t> &writes) {
+  std::vector<u64> result;
+  for (const MockTransactionBackend::write_t &write : writes) {
+    result.push_back(write.key);
+  }
+  return result;
+}
+
+void test_commits_full_batches() {
+  harness_t harness(4, NEVER);
+
+  for (u8 key = 1; key <= 3; key++) {
+    harness.process(0, key);
+  }
+
+  CHECK(harness.backend.begins == 1);
+  CHECK(harness.backend.commits == 0);
+  CHECK(harness.backend.open);
+  CHECK(harness.sent.empty());
+  CHECK(group_commit->batch_size() == 3);
+
+  harness.process(0, 4);
+
+  CHECK(harness.backend.commits == 1);
+  CHECK(!harness.backend.open);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2, 3, 4}));
+  CHECK(group_commit->batch_size() == 0);
+
+  // Packets only go out once their batch commits, in order, as the NF left them.
+  CHECK(harness.sent.size() == 4);
+  for (u8 key = 1; key <= 4; key++) {
+    CHECK(harness.sent[key - 1][0] == key + 1);
+  }
+
+  harness.process(0, 5);
+  CHECK(harness.backend.begins == 2);
+}
+
+void test_commits_stale_batches() {
+  harness_t harness(100, 1000);
+
+  harness.process(0, 1);
+  harness.process(500, 2);
+
+  group_commit->flush_if_stale(999, false);
+  CHECK(harness.backend.commits == 0);
+
+  group_commit->flush_if_stale(1000, false);
+  CHECK(harness.backend.commits == 1);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2}));
+  CHECK(harness.sent.size() == 2);
+
+  // Batches also commit when a packet arrives after their window is over.
+  harness.process(2000, 3);
+  harness.process(3000, 4);
+  CHECK(harness.backend.commits == 2);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2, 3, 4}));
+
+  // Someone waiting for the controller lock gets it without waiting for the window.
+  harness.process(4000, 5);
+  group_commit->flush_if_stale(4001, true);
+  CHECK(harness.backend.commits == 3);
+
+  group_commit->flush_if_stale(5000, true);
+  CHECK(harness.backend.commits == 3);
+}
+
+void test_replays_batch_on_abort() {
+  harness_t harness(5, NEVER);
+
+  harness.process(0, 1);
+  harness.process(0, 2);
+  harness.process(0, 3, ABORT | DROP);
+
+  // The batch transaction starts over, with the writes of the packets before the aborted one, and only those.
+  CHECK(harness.backend.restarts == 1);
+  CHECK(harness.backend.open);
+  CHECK(keys(harness.backend.staged) == std::vector<u64>({1, 2}));
+  CHECK(group_commit->batch_size() == 2);
+
+  // Replayed writes are not recorded again, so aborting twice replays the same writes once.
+  harness.process(0, 4, ABORT | DROP);
+  CHECK(harness.backend.restarts == 2);
+  CHECK(keys(harness.backend.staged) == std::vector<u64>({1, 2}));
+
+  harness.process(0, 5);
+
+  CHECK(harness.backend.commits == 1);
+  CHECK(harness.backend.aborts == 0);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2, 5}));
+
+  CHECK(harness.sent.size() == 3);
+  CHECK(harness.sent[0][0] == 2);
+  CHECK(harness.sent[1][0] == 3);
+  CHECK(harness.sent[2][0] == 6);
+}
+
+void test_ignores_writes_of_other_threads() {
+  harness_t harness(10, NEVER);
+
+  harness.process(0, 1);
+
+  // E.g. a dataplane notification callback, writing while the batch is open.
+  std::thread other([&harness]() { harness.backend.write({"other", 42, 0}); });
+  other.join();
+
+  CHECK(keys(harness.backend.staged) == std::vector<u64>({1, 42}));
+
+  harness.process(0, 2, ABORT | DROP);
+
+  CHECK(keys(harness.backend.staged) == std::vector<u64>({1}));
+
+  group_commit->flush();
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1}));
+}
+
+} // namespace
+
+int main() {
+  test_commits_full_batches();
+  test_commits_stale_batches();
+  test_replays_batch_on_abort();
+  test_ignores_writes_of_other_threads();
+
+  printf("OK\n");
+
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include "bf_rt_init.hpp"
+#include "bf_rt_learn.hpp"
+#include "bf_rt_session.hpp"
+#include "bf_rt_table.hpp"
+#include "bf_rt_table_data.hpp"
+#include "bf_rt_table_key.hpp"
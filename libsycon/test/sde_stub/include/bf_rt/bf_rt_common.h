@@ -0,0 +1,22 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <bf_switchd/bf_switchd.h>
+
+typedef uint32_t bf_rt_id_t;
+
+typedef struct bf_rt_target_ {
+  bf_dev_id_t dev_id;
+  bf_dev_pipe_t pipe_id;
+  uint8_t direction;
+  uint8_t prsr_id;
+} bf_rt_target_t;
+
+typedef struct bf_rt_learn_msg_hdl bf_rt_learn_msg_hdl;
+
+#define BF_RT_FLAG_INIT(flags) ((flags) = 0)
+#define BF_RT_FLAG_SET(flags, flag) ((flags) |= (1ULL << (flag)))
+#define BF_RT_FLAG_CLEAR(flags, flag) ((flags) &= ~(1ULL << (flag)))
+
+enum bf_rt_flag_e { BF_RT_FROM_HW = 0 };
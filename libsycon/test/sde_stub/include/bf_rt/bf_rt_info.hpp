@@ -0,0 +1,20 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <string>
+
+#include "bf_rt_learn.hpp"
+#include "bf_rt_table.hpp"
+
+namespace bfrt {
+
+class BfRtInfo {
+public:
+  virtual ~BfRtInfo() = default;
+
+  virtual bf_status_t bfrtTableFromNameGet(const std::string &name, const BfRtTable **table_ret) const = 0;
+  virtual bf_status_t bfrtLearnFromNameGet(std::string name, const BfRtLearn **learn_ret) const = 0;
+};
+
+} // namespace bfrt
@@ -0,0 +1,18 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <string>
+
+#include "bf_rt_info.hpp"
+
+namespace bfrt {
+
+class BfRtDevMgr {
+public:
+  static BfRtDevMgr &getInstance();
+
+  bf_status_t bfRtInfoGet(const bf_dev_id_t &dev_id, const std::string &prog_name, const BfRtInfo **info) const;
+};
+
+} // namespace bfrt
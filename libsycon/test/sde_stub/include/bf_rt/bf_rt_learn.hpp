@@ -0,0 +1,44 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bf_rt_session.hpp"
+
+namespace bfrt {
+
+class BfRtLearn;
+
+class BfRtLearnData {
+public:
+  virtual ~BfRtLearnData() = default;
+
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, uint64_t *value) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, const size_t &size, uint8_t *value) const = 0;
+};
+
+typedef std::function<bf_status_t(const bf_rt_target_t &bf_rt_tgt, const std::shared_ptr<BfRtSession> session,
+                                  std::vector<std::unique_ptr<BfRtLearnData>> data, bf_rt_learn_msg_hdl *const learn_msg_hdl,
+                                  const void *cookie)>
+    bfRtCbFunction;
+
+class BfRtLearn {
+public:
+  virtual ~BfRtLearn() = default;
+
+  virtual bf_status_t bfRtLearnCallbackRegister(const std::shared_ptr<BfRtSession> session, const bf_rt_target_t &dev_tgt,
+                                                const bfRtCbFunction &callback_fn, const void *cookie) const = 0;
+  virtual bf_status_t bfRtLearnNotifyAck(const std::shared_ptr<BfRtSession> session, bf_rt_learn_msg_hdl *const learn_msg_hdl) const = 0;
+  virtual bf_status_t learnIdGet(bf_rt_id_t *id) const = 0;
+  virtual bf_status_t learnNameGet(std::string *name) const = 0;
+  virtual bf_status_t learnFieldIdListGet(std::vector<bf_rt_id_t> *id_vec) const = 0;
+  virtual bf_status_t learnFieldNameGet(const bf_rt_id_t &field_id, std::string *name) const = 0;
+  virtual bf_status_t learnFieldSizeGet(const bf_rt_id_t &field_id, size_t *size) const = 0;
+  virtual bf_status_t learnFieldIsPtrGet(const bf_rt_id_t &field_id, bool *is_ptr) const = 0;
+};
+
+} // namespace bfrt
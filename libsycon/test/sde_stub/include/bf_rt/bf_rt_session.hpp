@@ -0,0 +1,25 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <memory>
+
+#include "bf_rt_common.h"
+
+namespace bfrt {
+
+class BfRtSession {
+public:
+  virtual ~BfRtSession() = default;
+
+  static std::shared_ptr<BfRtSession> sessionCreate();
+
+  virtual bf_status_t sessionDestroy() = 0;
+  virtual bf_status_t sessionCompleteOperations() const = 0;
+  virtual bf_status_t beginTransaction(bool atomic) const = 0;
+  virtual bf_status_t verifyTransaction() const = 0;
+  virtual bf_status_t commitTransaction(bool hw_synchronous) const = 0;
+  virtual bf_status_t abortTransaction() const = 0;
+};
+
+} // namespace bfrt
@@ -0,0 +1,92 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bf_rt_session.hpp"
+#include "bf_rt_table_attributes.hpp"
+#include "bf_rt_table_data.hpp"
+#include "bf_rt_table_key.hpp"
+
+namespace bfrt {
+
+enum class KeyFieldType { INVALID, EXACT, TERNARY, RANGE, LPM, OPTIONAL };
+enum class DataType { INT_ARR, BOOL_ARR, UINT64, BYTE_STREAM, FLOAT, CONTAINER, STRING, BOOL, STRING_ARR, UINT };
+
+class BfRtTable {
+public:
+  enum class BfRtTableGetFlag { GET_FROM_HW, GET_FROM_SW };
+
+  using keyDataPairs = std::vector<std::pair<BfRtTableKey *, BfRtTableData *>>;
+
+  virtual ~BfRtTable() = default;
+
+  virtual bf_status_t tableEntryAdd(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableKey &key,
+                                    const BfRtTableData &data) const = 0;
+  virtual bf_status_t tableEntryMod(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableKey &key,
+                                    const BfRtTableData &data) const = 0;
+  virtual bf_status_t tableEntryAdd(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const uint64_t &flags, const BfRtTableKey &key,
+                                    const BfRtTableData &data) const = 0;
+  virtual bf_status_t tableEntryMod(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const uint64_t &flags, const BfRtTableKey &key,
+                                    const BfRtTableData &data) const = 0;
+  virtual bf_status_t tableEntryAddOrMod(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const uint64_t &flags, const BfRtTableKey &key,
+                                         const BfRtTableData &data, bool *is_added) const = 0;
+  virtual bf_status_t tableEntryDel(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableKey &key) const = 0;
+  virtual bf_status_t tableEntryDel(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const uint64_t &flags,
+                                    const BfRtTableKey &key) const = 0;
+  virtual bf_status_t tableClear(const BfRtSession &session, const bf_rt_target_t &dev_tgt) const = 0;
+  virtual bf_status_t tableDefaultEntrySet(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableData &data) const = 0;
+
+  virtual bf_status_t tableEntryGet(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableKey &key, const BfRtTableGetFlag &flag,
+                                    BfRtTableData *data) const = 0;
+  virtual bf_status_t tableEntryGet(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const uint64_t &flags, const BfRtTableKey &key,
+                                    BfRtTableData *data) const = 0;
+  virtual bf_status_t tableEntryGetFirst(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableGetFlag &flag,
+                                         BfRtTableKey *key, BfRtTableData *data) const = 0;
+  virtual bf_status_t tableEntryGetNext_n(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableKey &key, const uint32_t &n,
+                                          const BfRtTableGetFlag &flag, keyDataPairs *key_data_pairs, uint32_t *num_returned) const = 0;
+  virtual bf_status_t tableUsageGet(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const BfRtTableGetFlag &flag,
+                                    uint32_t *count) const = 0;
+  virtual bf_status_t tableSizeGet(const BfRtSession &session, const bf_rt_target_t &dev_tgt, size_t *size) const = 0;
+  virtual bf_status_t tableNameGet(std::string *name) const = 0;
+
+  virtual bf_status_t keyAllocate(std::unique_ptr<BfRtTableKey> *key_ret) const = 0;
+  virtual bf_status_t keyReset(BfRtTableKey *key) const = 0;
+  virtual bf_status_t keyFieldIdListGet(std::vector<bf_rt_id_t> *id_vec) const = 0;
+  virtual bf_status_t keyFieldIdGet(const std::string &name, bf_rt_id_t *field_id) const = 0;
+  virtual bf_status_t keyFieldTypeGet(const bf_rt_id_t &field_id, KeyFieldType *field_type) const = 0;
+  virtual bf_status_t keyFieldDataTypeGet(const bf_rt_id_t &field_id, DataType *data_type) const = 0;
+  virtual bf_status_t keyFieldNameGet(const bf_rt_id_t &field_id, std::string *name) const = 0;
+  virtual bf_status_t keyFieldSizeGet(const bf_rt_id_t &field_id, size_t *size) const = 0;
+
+  virtual bf_status_t dataAllocate(std::unique_ptr<BfRtTableData> *data_ret) const = 0;
+  virtual bf_status_t dataAllocate(const bf_rt_id_t &action_id, std::unique_ptr<BfRtTableData> *data_ret) const = 0;
+  virtual bf_status_t dataReset(BfRtTableData *data) const = 0;
+  virtual bf_status_t dataReset(const bf_rt_id_t &action_id, BfRtTableData *data) const = 0;
+  virtual bf_status_t dataFieldIdListGet(std::vector<bf_rt_id_t> *id_vec) const = 0;
+  virtual bf_status_t dataFieldIdListGet(const bf_rt_id_t &action_id, std::vector<bf_rt_id_t> *id_vec) const = 0;
+  virtual bf_status_t dataFieldIdGet(const std::string &name, bf_rt_id_t *field_id) const = 0;
+  virtual bf_status_t dataFieldIdGet(const std::string &name, const bf_rt_id_t &action_id, bf_rt_id_t *field_id) const = 0;
+  virtual bf_status_t dataFieldNameGet(const bf_rt_id_t &field_id, std::string *name) const = 0;
+  virtual bf_status_t dataFieldNameGet(const bf_rt_id_t &field_id, const bf_rt_id_t &action_id, std::string *name) const = 0;
+  virtual bf_status_t dataFieldSizeGet(const bf_rt_id_t &field_id, size_t *size) const = 0;
+  virtual bf_status_t dataFieldSizeGet(const bf_rt_id_t &field_id, const bf_rt_id_t &action_id, size_t *size) const = 0;
+  virtual bf_status_t dataFieldDataTypeGet(const bf_rt_id_t &field_id, DataType *type) const = 0;
+  virtual bf_status_t dataFieldDataTypeGet(const bf_rt_id_t &field_id, const bf_rt_id_t &action_id, DataType *type) const = 0;
+
+  virtual bool actionIdApplicable() const = 0;
+  virtual bf_status_t actionIdGet(const std::string &name, bf_rt_id_t *action_id) const = 0;
+  virtual bf_status_t actionIdListGet(std::vector<bf_rt_id_t> *id_vec) const = 0;
+  virtual bf_status_t actionNameGet(const bf_rt_id_t &action_id, std::string *name) const = 0;
+
+  virtual bf_status_t attributeAllocate(const TableAttributesType &type, const TableAttributesIdleTableMode &idle_table_type,
+                                        std::unique_ptr<BfRtTableAttributes> *attr) const = 0;
+  virtual bf_status_t tableAttributesSet(const BfRtSession &session, const bf_rt_target_t &dev_tgt, const uint64_t &flags,
+                                         const BfRtTableAttributes &table_attr) const = 0;
+};
+
+} // namespace bfrt
@@ -0,0 +1,24 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <functional>
+
+#include "bf_rt_table_key.hpp"
+
+namespace bfrt {
+
+enum class TableAttributesType { IDLE_TABLE_RUNTIME };
+enum class TableAttributesIdleTableMode { POLL_MODE, NOTIFY_MODE };
+
+typedef std::function<void(const bf_rt_target_t &dev_tgt, const BfRtTableKey *key, void *cookie)> BfRtIdleTmoExpiryCb;
+
+class BfRtTableAttributes {
+public:
+  virtual ~BfRtTableAttributes() = default;
+
+  virtual bf_status_t idleTableNotifyModeSet(const bool &enable, const BfRtIdleTmoExpiryCb &callback, const uint32_t &ttl_query_interval,
+                                             const uint32_t &max_ttl, const uint32_t &min_ttl, const void *cookie) = 0;
+};
+
+} // namespace bfrt
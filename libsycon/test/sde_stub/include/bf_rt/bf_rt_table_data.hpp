@@ -0,0 +1,39 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <string>
+#include <vector>
+
+#include "bf_rt_common.h"
+
+namespace bfrt {
+
+class BfRtTable;
+
+class BfRtTableData {
+public:
+  virtual ~BfRtTableData() = default;
+
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const uint64_t &value) = 0;
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const uint8_t *value, const size_t &size) = 0;
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const std::vector<bf_rt_id_t> &arr) = 0;
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const float &value) = 0;
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const bool &value) = 0;
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const std::string &str) = 0;
+
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, uint64_t *value) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, const size_t &size, uint8_t *value) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, std::vector<uint64_t> *arr) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, std::vector<bf_rt_id_t> *arr) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, float *value) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, bool *value) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, std::vector<bool> *arr) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, std::string *str) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, std::vector<std::string> *arr) const = 0;
+
+  virtual bf_status_t getParent(const BfRtTable **table) const = 0;
+  virtual bf_status_t actionIdGet(bf_rt_id_t *act_id) const = 0;
+};
+
+} // namespace bfrt
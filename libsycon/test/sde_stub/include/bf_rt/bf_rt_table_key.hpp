@@ -0,0 +1,32 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <string>
+
+#include "bf_rt_common.h"
+
+namespace bfrt {
+
+class BfRtTable;
+
+class BfRtTableKey {
+public:
+  virtual ~BfRtTableKey() = default;
+
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const uint64_t &value) = 0;
+  virtual bf_status_t setValue(const bf_rt_id_t &field_id, const uint8_t *value, const size_t &size) = 0;
+  virtual bf_status_t setValueandMask(const bf_rt_id_t &field_id, const uint64_t &value, const uint64_t &mask) = 0;
+  virtual bf_status_t setValueandMask(const bf_rt_id_t &field_id, const uint8_t *value, const uint8_t *mask, const size_t &size) = 0;
+  virtual bf_status_t setValueLpm(const bf_rt_id_t &field_id, const uint64_t &value, const uint16_t &p_length) = 0;
+
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, uint64_t *value) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, const size_t &size, uint8_t *value) const = 0;
+  virtual bf_status_t getValue(const bf_rt_id_t &field_id, std::string *value) const = 0;
+  virtual bf_status_t getValueandMask(const bf_rt_id_t &field_id, uint64_t *value, uint64_t *mask) const = 0;
+  virtual bf_status_t getValueandMask(const bf_rt_id_t &field_id, const size_t &size, uint8_t *value, uint8_t *mask) const = 0;
+
+  virtual bf_status_t tableGet(const BfRtTable **table) const = 0;
+};
+
+} // namespace bfrt
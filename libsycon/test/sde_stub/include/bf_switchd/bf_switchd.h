@@ -0,0 +1,40 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef int bf_status_t;
+typedef int bf_dev_id_t;
+typedef int bf_dev_port_t;
+typedef uint32_t bf_dev_pipe_t;
+
+#define BF_SUCCESS 0
+
+const char *bf_err_str(bf_status_t sts);
+
+typedef struct bf_switchd_context_s {
+  char *install_dir;
+  char *conf_file;
+  bool running_in_background;
+  bool skip_port_add;
+  bool skip_p4;
+  bool skip_hld;
+  bool is_sw_model;
+  bool shell_set_ucli;
+  bool is_asic;
+  pthread_t tmr_t_id;
+  pthread_t dma_t_id;
+  pthread_t int_t_id;
+  pthread_t pkt_t_id;
+  pthread_t port_fsm_t_id;
+  pthread_t drusim_t_id;
+  pthread_t agent_t_id[4];
+} bf_switchd_context_t;
+
+int bf_switchd_lib_init(bf_switchd_context_t *ctx);
+void bf_switchd_exit_sighandler(int signum);
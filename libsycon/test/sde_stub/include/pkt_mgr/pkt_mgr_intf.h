@@ -0,0 +1,48 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <bf_switchd/bf_switchd.h>
+
+typedef struct bf_pkt bf_pkt;
+
+typedef enum {
+  BF_PKT_TX_RING_0,
+  BF_PKT_TX_RING_1,
+  BF_PKT_TX_RING_2,
+  BF_PKT_TX_RING_3,
+  BF_PKT_TX_RING_MAX,
+} bf_pkt_tx_ring_t;
+
+typedef enum {
+  BF_PKT_RX_RING_0,
+  BF_PKT_RX_RING_1,
+  BF_PKT_RX_RING_2,
+  BF_PKT_RX_RING_3,
+  BF_PKT_RX_RING_4,
+  BF_PKT_RX_RING_5,
+  BF_PKT_RX_RING_6,
+  BF_PKT_RX_RING_7,
+  BF_PKT_RX_RING_MAX,
+} bf_pkt_rx_ring_t;
+
+typedef enum {
+  BF_DMA_CPU_PKT_TRANSMIT_0,
+  BF_DMA_CPU_PKT_TRANSMIT_1,
+  BF_DMA_CPU_PKT_TRANSMIT_2,
+  BF_DMA_CPU_PKT_TRANSMIT_3,
+} bf_dma_type_t;
+
+typedef bf_status_t (*bf_pkt_tx_done_notif_cb)(bf_dev_id_t dev_id, bf_pkt_tx_ring_t tx_ring, uint64_t tx_cookie, uint32_t status);
+typedef bf_status_t (*bf_pkt_rx_callback)(bf_dev_id_t dev_id, bf_pkt *pkt, void *cookie, bf_pkt_rx_ring_t rx_ring);
+
+bool bf_pkt_is_inited(bf_dev_id_t dev_id);
+bf_status_t bf_pkt_alloc(bf_dev_id_t dev_id, bf_pkt **pkt, size_t size, bf_dma_type_t dma_type);
+int bf_pkt_free(bf_dev_id_t dev_id, bf_pkt *pkt);
+bf_status_t bf_pkt_data_copy(bf_pkt *pkt, const uint8_t *pkt_buf, uint16_t size);
+bf_status_t bf_pkt_tx(bf_dev_id_t dev_id, bf_pkt *pkt, bf_pkt_tx_ring_t tx_ring, void *tx_cookie);
+uint8_t *bf_pkt_get_pkt_data(bf_pkt *pkt);
+uint16_t bf_pkt_get_pkt_size(bf_pkt *pkt);
+bf_pkt *bf_pkt_get_nextseg(bf_pkt *pkt);
+bf_status_t bf_pkt_tx_done_notif_register(bf_dev_id_t dev_id, bf_pkt_tx_done_notif_cb cb, bf_pkt_tx_ring_t tx_ring);
+bf_status_t bf_pkt_rx_register(bf_dev_id_t dev_id, bf_pkt_rx_callback cb, bf_pkt_rx_ring_t rx_ring, void *rx_cookie);
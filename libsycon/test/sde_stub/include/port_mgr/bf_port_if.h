@@ -0,0 +1,37 @@
+#pragma once
+
+// Declarations only, just enough for the SDE-dependent sources to compile without the SDE (see the sycon_sde_stub target).
+
+#include <bf_switchd/bf_switchd.h>
+
+typedef enum {
+  BF_SPEED_NONE,
+  BF_SPEED_1G,
+  BF_SPEED_10G,
+  BF_SPEED_25G,
+  BF_SPEED_40G,
+  BF_SPEED_50G,
+  BF_SPEED_100G,
+} bf_port_speed_t;
+
+typedef enum {
+  BF_FEC_TYP_NONE,
+  BF_FEC_TYP_FIRECODE,
+  BF_FEC_TYP_REED_SOLOMON,
+} bf_fec_type_t;
+
+typedef enum {
+  BF_LPBK_NONE,
+  BF_LPBK_MAC_NEAR,
+  BF_LPBK_MAC_FAR,
+  BF_LPBK_PCS_NEAR,
+  BF_LPBK_SERDES_NEAR,
+  BF_LPBK_SERDES_FAR,
+  BF_LPBK_PIPE,
+} bf_loopback_mode_e;
+
+const char *bf_port_speed_str(bf_port_speed_t speed);
+
+bf_dev_port_t bf_pcie_cpu_port_get(bf_dev_id_t dev_id);
+bf_dev_port_t bf_eth_cpu_port_get(bf_dev_id_t dev_id);
+bf_status_t bf_port_info_get(bf_dev_id_t dev_id, bf_dev_port_t dev_port, bf_port_speed_t *speed, uint32_t *lane_numb);
@@ -0,0 +1,153 @@
+// Exercises the staged writes against the mock transaction backend: the NF running without the controller lock, its writes applied in a single
+// transaction afterwards, and packets that need the lock taking it for the rest of their processing.
+
+#include <sycon/staged_writes.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace sycon;
+
+#define CHECK(condition)                                                                                                                             \
+  do {                                                                                                                                               \
+    if (!(condition)) {                                                                                                                              \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                                                                  \
+      exit(1);                                                                                                                                       \
+    }                                                                                                                                                \
+  } while (0)
+
+namespace {
+
+// Test packets are just [key0, key1, flags]: the NF writes each key to the "table" table (unless it is 0), taking the lock in between if asked
+// to, and then aborts or drops the packet if asked to.
+enum : u8 { ABORT = 1 << 0, DROP = 1 << 1, LOCK = 1 << 2 };
+
+struct harness_t {
+  MockTransactionBackend backend;
+
+  // Whether the controller lock was held when the NF finished.
+  bool locked_in_nf;
+
+  harness_t() : locked_in_nf(false) {
+    staged_writes = std::make_unique<StagedWrites>(&backend, [this](time_ns_t now, u8 *pkt, u16 size) {
+      nf_process_result_t result;
+
+      if (pkt[0] != 0) {
+        backend.write({"table", pkt[0], now});
+      }
+
+      if (pkt[2] & LOCK) {
+        lock_shared_state();
+      }
+
+      if (pkt[1] != 0) {
+        backend.write({"table", pkt[1], now});
+      }
+
+      locked_in_nf = backend.open;
+
+      result.abort_transaction = pkt[2] & ABORT;
+      result.forward           = !(pkt[2] & DROP);
+
+      return result;
+    });
+  }
+
+  ~harness_t() { staged_writes.reset(); }
+
+  bool process(time_ns_t now, u8 key0, u8 key1, u8 flags = 0) {
+    u8 pkt[3] = {key0, key1, flags};
+    return staged_writes->process(now, pkt, sizeof(pkt));
+  }
+};
+
+std::vector<u64> keys(const std::vector<MockTransactionBackend::write_t> &writes) {
+  std::vector<u64> result;
+  for (const MockTransactionBackend::write_t &write : writes) {
+    result.push_back(write.key);
+  }
+  return result;
+}
+
+void test_applies_writes_after_the_nf() {
+  harness_t harness;
+
+  CHECK(harness.process(0, 1, 2));
+
+  // The NF ran without the lock, and its writes only reached the switch afterwards, in a single transaction.
+  CHECK(!harness.locked_in_nf);
+  CHECK(harness.backend.begins == 1);
+  CHECK(harness.backend.commits == 1);
+  CHECK(!harness.backend.open);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2}));
+
+  CHECK(!harness.process(0, 3, 0, DROP));
+  CHECK(harness.backend.commits == 2);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2, 3}));
+}
+
+void test_skips_the_lock_when_possible() {
+  harness_t harness;
+
+  // Nothing to write.
+  CHECK(harness.process(0, 0, 0));
+
+  // Aborted before ever taking the lock.
+  CHECK(!harness.process(0, 1, 2, ABORT | DROP));
+
+  CHECK(harness.backend.begins == 0);
+  CHECK(harness.backend.aborts == 0);
+  CHECK(harness.backend.committed.empty());
+}
+
+void test_locks_for_the_rest_of_the_packet() {
+  harness_t harness;
+
+  CHECK(harness.process(0, 1, 2, LOCK));
+
+  // What was staged before taking the lock went in first, and everything after it went straight into the transaction.
+  CHECK(harness.locked_in_nf);
+  CHECK(harness.backend.begins == 1);
+  CHECK(harness.backend.commits == 1);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2}));
+
+  // Once the lock is taken, aborting rolls back the transaction, like with one transaction per packet.
+  CHECK(!harness.process(0, 3, 4, LOCK | ABORT | DROP));
+  CHECK(harness.backend.begins == 2);
+  CHECK(harness.backend.aborts == 1);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2}));
+
+  // The next packet starts over without the lock.
+  CHECK(harness.process(0, 5, 0));
+  CHECK(!harness.locked_in_nf);
+  CHECK(keys(harness.backend.committed) == std::vector<u64>({1, 2, 5}));
+}
+
+void test_ignores_writes_outside_of_the_nf() {
+  harness_t harness;
+
+  // E.g. a dataplane notification callback, writing in its own transaction.
+  harness.backend.begin();
+  harness.backend.write({"other", 42, 0});
+  CHECK(keys(harness.backend.staged) == std::vector<u64>({42}));
+  harness.backend.commit();
+
+  // Taking the lock outside of a packet is up to the caller.
+  lock_shared_state();
+  CHECK(!harness.backend.open);
+  CHECK(harness.backend.begins == 1);
+}
+
+} // namespace
+
+int main() {
+  test_applies_writes_after_the_nf();
+  test_skips_the_lock_when_possible();
+  test_locks_for_the_rest_of_the_packet();
+  test_ignores_writes_outside_of_the_nf();
+
+  printf("OK\n");
+
+  return 0;
+}
\ No newline at end of file
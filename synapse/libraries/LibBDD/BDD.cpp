@@ -54,6 +54,7 @@ const std::unordered_map<std::string, std::unordered_set<std::string>> symbols_f
     {"dchain_allocate", {"is_dchain_allocated"}},
     {"cms_allocate", {"cms_allocation_succeeded"}},
     {"tb_allocate", {"tb_allocation_succeeded"}},
+    {"hhh_allocate", {"hhh_allocation_succeeded"}},
     {"lpm_allocate", {"lpm_alloc_success"}},
     {"rte_lcore_count", {"lcores"}},
     {"rte_ether_addr_hash", {"rte_ether_addr_hash"}},
@@ -75,6 +76,8 @@ const std::unordered_map<std::string, std::unordered_set<std::string>> symbols_f
     {"tb_trace", {"successfuly_tracing", "index_out"}},
     {"tb_update_and_check", {"pass"}},
     {"tb_expire", {"number_of_freed_flows"}},
+    {"hhh_update", {"hh_detected", "hh", "hh_prefix_len"}},
+    {"hhh_expire", {"number_of_freed_flows"}},
     {"lpm_lookup", {"lpm_lookup_match", "lpm_lookup_result"}},
     {"lpm_update", {"lpm_update_elem_result"}},
 };
@@ -643,41 +646,93 @@ addr_t get_vector_obj_storing_map_key(const BDD *bdd, addr_t map) {
 
 void BDD::visit(BDDVisitor &visitor) const { visitor.visit(this); }
 
-const BDDNode *BDD::get_node_by_id(bdd_node_id_t node_id) const { return root ? root->get_node_by_id(node_id) : nullptr; }
+void BDD::build_node_index() const {
+  nodes_by_id.clear();
 
-BDDNode *BDD::get_mutable_node_by_id(bdd_node_id_t node_id) { return root ? root->get_mutable_node_by_id(node_id) : nullptr; }
+  if (root) {
+    root->visit_mutable_nodes([this](BDDNode *node) {
+      // Keep the first node in visiting order, like a plain lookup would.
+      nodes_by_id.insert({node->get_id(), node});
+      return BDDNodeVisitAction::Continue;
+    });
+  }
 
-int BDD::get_node_depth(bdd_node_id_t node_id) const {
-  int depth = -1;
+  indexed_generation = manager.get_generation();
+}
+
+namespace {
+// Number of ancestors of the node, or -1 if it is not reachable from the root. Following the prev links is not enough, as a node can be unlinked
+// from its parent without its prev link being reset, so every parent must also still link to its child.
+int get_distance_to_root(const BDDNode *root, const BDDNode *node) {
+  int distance = 0;
+
+  while (node != root) {
+    const BDDNode *prev = node->get_prev();
+    if (!prev) {
+      return -1;
+    }
+
+    const bool linked = prev->get_type() == BDDNodeType::Branch ? dynamic_cast<const Branch *>(prev)->get_on_true() == node ||
+                                                                      dynamic_cast<const Branch *>(prev)->get_on_false() == node
+                                                                : prev->get_next() == node;
+    if (!linked) {
+      return -1;
+    }
+
+    node = prev;
+    distance++;
+  }
 
+  return distance;
+}
+
+size_t count_nodes(const BDDNode *root) { return root ? root->count_children(true) + 1 : 0; }
+} // namespace
+
+BDDNode *BDD::find_node_by_id(bdd_node_id_t node_id) const {
   if (!root) {
-    return depth;
+    return nullptr;
   }
 
-  struct depth_tracker_t : cookie_t {
-    int depth;
+  // Nodes were added or freed since the index was built (so it may hold freed nodes, or miss clones that now come first in visiting order).
+  if (indexed_generation != manager.get_generation()) {
+    build_node_index();
+  }
 
-    depth_tracker_t() : depth(0) {}
-    depth_tracker_t(int _depth) : depth(_depth) {}
+  auto found_it = nodes_by_id.find(node_id);
+  if (found_it != nodes_by_id.end()) {
+    BDDNode *node = found_it->second;
+    if (node->get_id() == node_id && get_distance_to_root(root, node) >= 0) {
+      return node;
+    }
+  }
 
-    std::unique_ptr<cookie_t> clone() const override { return std::make_unique<depth_tracker_t>(depth); }
-  };
+  // Either there is no such node, or it was relinked or renumbered since the index was built. Only the latter is worth a new index.
+  BDDNode *node = root->get_mutable_node_by_id(node_id);
+  if (node) {
+    build_node_index();
+  }
 
-  root->visit_nodes(
-      [node_id, &depth](const BDDNode *node, cookie_t *cookie) {
-        depth_tracker_t *depth_tracker = dynamic_cast<depth_tracker_t *>(cookie);
+  return node;
+}
 
-        if (node->get_id() == node_id) {
-          depth = depth_tracker->depth;
-          return BDDNodeVisitAction::Stop;
-        }
+const BDDNode *BDD::get_node_by_id(bdd_node_id_t node_id) const { return find_node_by_id(node_id); }
 
-        depth_tracker->depth++;
-        return BDDNodeVisitAction::Continue;
-      },
-      std::make_unique<depth_tracker_t>());
+BDDNode *BDD::get_mutable_node_by_id(bdd_node_id_t node_id) { return find_node_by_id(node_id); }
+
+size_t BDD::size() const {
+  if (num_nodes_stale) {
+    num_nodes       = count_nodes(root);
+    num_nodes_stale = false;
+  }
+
+  assert(num_nodes == count_nodes(root) && "Node count out of sync with the BDD");
+  return num_nodes;
+}
 
-  return depth;
+int BDD::get_node_depth(bdd_node_id_t node_id) const {
+  const BDDNode *node = get_node_by_id(node_id);
+  return node ? get_distance_to_root(root, node) : -1;
 }
 
 Symbols BDD::get_generated_symbols(const BDDNode *node) const {
@@ -708,11 +763,13 @@ Symbols BDD::get_generated_symbols(const BDDNode *node) const {
   return symbols;
 }
 
-BDD::BDD(SymbolManager *_symbol_manager) : id(0), root(nullptr), symbol_manager(_symbol_manager) {
+BDD::BDD(SymbolManager *_symbol_manager)
+    : id(0), root(nullptr), symbol_manager(_symbol_manager), num_nodes(0), num_nodes_stale(false) {
   assert(symbol_manager && "Symbol manager cannot be null");
 }
 
-BDD::BDD(const call_paths_view_t &call_paths_view) : id(0), symbol_manager(call_paths_view.manager) {
+BDD::BDD(const call_paths_view_t &call_paths_view)
+    : id(0), symbol_manager(call_paths_view.manager), num_nodes(0), num_nodes_stale(true) {
   root = bdd_from_call_paths(call_paths_view, symbol_manager, manager, init, id, base_constraints);
 
   packet_len = symbol_manager->get_symbol("pkt_len");
@@ -726,11 +783,14 @@ BDD::BDD(const call_paths_view_t &call_paths_view) : id(0), symbol_manager(call_
   }
 }
 
-BDD::BDD(const std::filesystem::path &fpath, SymbolManager *_symbol_manager) : id(0), symbol_manager(_symbol_manager) { deserialize(fpath); }
+BDD::BDD(const std::filesystem::path &fpath, SymbolManager *_symbol_manager)
+    : id(0), symbol_manager(_symbol_manager), num_nodes(0), num_nodes_stale(true) {
+  deserialize(fpath);
+}
 
 BDD::BDD(const BDD &other)
     : id(other.id), device(other.device), packet_len(other.packet_len), time(other.time), base_constraints(other.base_constraints),
-      symbol_manager(other.symbol_manager) {
+      symbol_manager(other.symbol_manager), num_nodes(other.num_nodes), num_nodes_stale(other.num_nodes_stale) {
   for (const Call *init_node : other.init) {
     Call *cloned = dynamic_cast<Call *>(init_node->clone(manager));
     if (!init.empty()) {
@@ -745,13 +805,15 @@ BDD::BDD(const BDD &other)
 BDD::BDD(BDD &&other)
     : id(other.id), device(std::move(other.device)), packet_len(std::move(other.packet_len)), time(std::move(other.time)),
       base_constraints(std::move(other.base_constraints)), init(std::move(other.init)), root(other.root), manager(std::move(other.manager)),
-      symbol_manager(std::move(other.symbol_manager)) {
+      symbol_manager(std::move(other.symbol_manager)), num_nodes(other.num_nodes), num_nodes_stale(other.num_nodes_stale) {
   other.root = nullptr;
+  other.reset_node_caches();
 }
 
 BDD &BDD::operator=(const BDD &other) {
   if (this == &other)
     return *this;
+  reset_node_caches();
   id               = other.id;
   device           = other.device;
   packet_len       = other.packet_len;
@@ -767,8 +829,10 @@ BDD &BDD::operator=(const BDD &other) {
     init.push_back(cloned);
   }
 
-  root           = other.root->clone(manager, true);
-  symbol_manager = other.symbol_manager;
+  root            = other.root->clone(manager, true);
+  symbol_manager  = other.symbol_manager;
+  num_nodes       = other.num_nodes;
+  num_nodes_stale = other.num_nodes_stale;
   return *this;
 }
 
@@ -800,10 +864,27 @@ void BDD::delete_init_node(bdd_node_id_t target_id) {
   }
 }
 
-BDDNode *BDD::delete_non_branch(bdd_node_id_t target_id) { return delete_non_branch(get_mutable_node_by_id(target_id), manager); }
+BDDNode *BDD::delete_non_branch(bdd_node_id_t target_id) {
+  BDDNode *new_current = delete_non_branch(get_mutable_node_by_id(target_id), manager);
+  num_nodes--;
+  return new_current;
+}
 
 BDDNode *BDD::delete_branch(bdd_node_id_t target_id, BranchDeletionAction branch_deletion_action) {
-  return delete_branch(get_mutable_node_by_id(target_id), branch_deletion_action, manager);
+  Branch *target = dynamic_cast<Branch *>(get_mutable_node_by_id(target_id));
+  assert(target && "Branch not found");
+
+  size_t deleted = 1;
+  if (branch_deletion_action != BranchDeletionAction::KeepOnTrue) {
+    deleted += count_nodes(target->get_on_true());
+  }
+  if (branch_deletion_action != BranchDeletionAction::KeepOnFalse) {
+    deleted += count_nodes(target->get_on_false());
+  }
+
+  BDDNode *new_current = delete_branch(target, branch_deletion_action, manager);
+  num_nodes -= deleted;
+  return new_current;
 }
 
 std::vector<BDDNode *> BDD::delete_until(bdd_node_id_t target_id, const bdd_node_ids_t &stopping_points) {
@@ -812,6 +893,9 @@ std::vector<BDDNode *> BDD::delete_until(bdd_node_id_t target_id, const bdd_node
     panic("Target node not found (id=%lu)", target_id);
   }
 
+  // The stopping nodes are left detached, for the caller to link back.
+  num_nodes_stale = true;
+
   if (target_node->get_prev()) {
     BDDNode *prev = target_node->get_mutable_prev();
     if (prev->get_type() == BDDNodeType::Branch) {
@@ -868,12 +952,18 @@ std::vector<BDDNode *> BDD::delete_until(bdd_node_id_t target_id, const bdd_node
 }
 
 Branch *BDD::create_new_branch(klee::ref<klee::Expr> condition) {
+  // Linked by the caller.
+  num_nodes_stale = true;
+
   Branch *new_branch = new Branch(id++, symbol_manager, condition);
   manager.add_node(new_branch);
   return new_branch;
 }
 
 Call *BDD::create_new_call(const BDDNode *current, const call_t &call, const Symbols &generated_symbols) {
+  // Linked by the caller.
+  num_nodes_stale = true;
+
   Call *new_call = new Call(id++, symbol_manager, call, generated_symbols);
   manager.add_node(new_call);
   return new_call;
@@ -937,6 +1027,8 @@ BDDNode *BDD::add_cloned_non_branches(bdd_node_id_t target_id, const std::vector
     anchor = clone;
   }
 
+  num_nodes += new_nodes.size();
+
   return new_current;
 }
 
@@ -957,7 +1049,8 @@ Branch *BDD::add_cloned_branch(bdd_node_id_t target_id, klee::ref<klee::Expr> co
   BDDNode *on_false_cond = anchor_next->clone(manager, true);
   on_false_cond->recursive_update_ids(id);
 
-  Branch *new_branch = create_new_branch(condition);
+  Branch *new_branch = new Branch(id++, symbol_manager, condition);
+  manager.add_node(new_branch);
 
   new_branch->set_on_true(on_true_cond);
   new_branch->set_on_false(on_false_cond);
@@ -989,6 +1082,8 @@ Branch *BDD::add_cloned_branch(bdd_node_id_t target_id, klee::ref<klee::Expr> co
 
   new_branch->set_prev(anchor);
 
+  num_nodes += count_nodes(on_false_cond) + 1;
+
   return new_branch;
 }
 
@@ -1006,7 +1101,8 @@ Call *BDD::add_new_symbol_generator_function(bdd_node_id_t target_id, const std:
       .ret           = {},
   };
 
-  Call *new_node = create_new_call(current, call, symbols);
+  Call *new_node = new Call(id++, symbol_manager, call, symbols);
+  manager.add_node(new_node);
 
   bdd_node_id_t anchor_id = prev->get_id();
   BDDNode *anchor         = get_mutable_node_by_id(anchor_id);
@@ -1038,6 +1134,8 @@ Call *BDD::add_new_symbol_generator_function(bdd_node_id_t target_id, const std:
   new_node->set_next(anchor_next);
   anchor_next->set_prev(new_node);
 
+  num_nodes++;
+
   return new_node;
 }
 
@@ -2060,7 +2158,9 @@ BDDNode *BDD::delete_constraints(const klee::ConstraintManager &target_constrain
     return nullptr;
   }
 
-  return delete_non_branch(target_node_for_deletion, manager);
+  BDDNode *new_current = delete_non_branch(target_node_for_deletion, manager);
+  num_nodes--;
+  return new_current;
 }
 
 } // namespace LibBDD
\ No newline at end of file
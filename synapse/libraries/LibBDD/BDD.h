@@ -9,6 +9,8 @@
 #include <LibBDD/Config.h>
 #include <LibBDD/Visitors/BDDVisualizer.h>
 
+#include <optional>
+
 namespace LibBDD {
 
 using LibCore::symbol_t;
@@ -32,6 +34,16 @@ private:
   BDDNodeManager manager;
   SymbolManager *symbol_manager;
 
+  // Number of nodes reachable from the root, kept up to date by the add_* and delete_* operations. Whoever gets hold of the node manager, of
+  // nodes not linked yet, or of detached subtrees can relink nodes without the BDD knowing, so those mark it stale, to be recounted by size().
+  mutable size_t num_nodes;
+  mutable bool num_nodes_stale;
+
+  // Id index of the nodes reachable from the root, rebuilt lazily once nodes have been added or freed (see BDDNodeManager::get_generation()).
+  // Nodes can still be relinked or renumbered in between, so hits are only trusted if their links still lead back to the root.
+  mutable std::unordered_map<bdd_node_id_t, BDDNode *> nodes_by_id;
+  mutable std::optional<u64> indexed_generation;
+
 public:
   BDD(SymbolManager *symbol_manager);
 
@@ -58,6 +70,7 @@ public:
   const std::vector<Call *> &get_init() const { return init; }
 
   void set_root(BDDNode *_root) {
+    reset_node_caches();
     root = _root;
     assert_or_panic(manager.has_node(_root), "Root node is not managed by the BDDNodeManager");
   }
@@ -70,13 +83,16 @@ public:
   }
 
   std::string hash() const { return root->hash(true); }
-  size_t size() const { return root->count_children(true) + 1; }
+  size_t size() const;
   std::unordered_set<u16> get_devices() const;
 
   Symbols get_generated_symbols(const BDDNode *node) const;
   void visit(BDDVisitor &visitor) const;
   void serialize(const std::filesystem::path &fpath) const;
+  // Same contents as serialize(), in the compact binary format (see BinaryIO.cpp). deserialize() reads either.
+  void serialize_binary(const std::filesystem::path &fpath) const;
   void deserialize(const std::filesystem::path &fpath);
+  static bool is_binary(const std::filesystem::path &fpath);
   int get_node_depth(bdd_node_id_t id) const;
 
   enum class InspectionStatus {
@@ -137,7 +153,10 @@ public:
   const BDDNode *get_node_by_id(bdd_node_id_t id) const;
   BDDNode *get_mutable_node_by_id(bdd_node_id_t id);
 
-  BDDNodeManager &get_mutable_manager() { return manager; }
+  BDDNodeManager &get_mutable_manager() {
+    num_nodes_stale = true;
+    return manager;
+  }
   const BDDNodeManager &get_manager() const { return manager; }
 
   SymbolManager *get_mutable_symbol_manager() { return symbol_manager; }
@@ -160,6 +179,15 @@ public:
 
   static BDDNode *delete_non_branch(BDDNode *target, BDDNodeManager &manager);
   static BDDNode *delete_branch(BDDNode *target, BranchDeletionAction branch_deletion_action, BDDNodeManager &manager);
+
+private:
+  void reset_node_caches() {
+    num_nodes_stale = true;
+    indexed_generation.reset();
+  }
+  void build_node_index() const;
+  BDDNode *find_node_by_id(bdd_node_id_t id) const;
+  void deserialize_binary(const std::filesystem::path &fpath);
 };
 
 std::ostream &operator<<(std::ostream &os, const BDD::inspection_report_t &report);
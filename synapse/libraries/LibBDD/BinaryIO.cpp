@@ -0,0 +1,852 @@
+#include <LibBDD/BDD.h>
+#include <LibCore/Debug.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include <klee/ExprBuilder.h>
+#include <klee/util/ExprHashMap.h>
+
+namespace LibBDD {
+
+// Binary BDD format.
+//
+// The file is a fixed header followed by flat tables, all in native byte order (the header records it, so that a file written on a machine
+// with a different byte order is rejected instead of misread):
+//
+//   strings   string_record_t[], pointing into a blob of characters
+//   arrays    array_record_t[], the symbolic arrays the expressions read from
+//   exprs     expr_record_t[], a hash-consed expression DAG: every distinct (sub)expression is stored once, always after its kids
+//   kids      u32[], the kids of every expression, referenced by expr_record_t::first_kid
+//   nodes     node_record_t[], fixed-width, with edges stored as positions in this same table
+//   payload   u32[], the variable-length part of call nodes (arguments, extra vars, symbols, ...) and constants wider than 64 bits
+//   init      u32[], positions of the init nodes in the nodes table, in order
+//   base      u32[], the base constraints
+//
+// Loading maps the file and walks each table once: no text parsing, no kQuery, and no lookups by node id.
+
+namespace {
+
+constexpr const char BINARY_MAGIC[8]     = {'B', 'D', 'D', 'B', 'I', 'N', '\0', '\0'};
+constexpr const u32 BINARY_VERSION       = 1;
+constexpr const u32 BINARY_BYTE_ORDER    = 0x01020304;
+constexpr const u32 NONE                 = std::numeric_limits<u32>::max();
+constexpr const u32 NODE_TYPE_CALL       = 0;
+constexpr const u32 NODE_TYPE_BRANCH     = 1;
+constexpr const u32 NODE_TYPE_ROUTE      = 2;
+constexpr const size_t MAX_INLINE_CONST  = 64;
+constexpr const size_t APINT_WORD_BITS   = 64;
+constexpr const size_t HEADER_ALIGNMENT  = 8;
+constexpr const size_t SECTION_ALIGNMENT = 8;
+
+struct section_t {
+  u64 offset;
+  u64 count;
+};
+
+struct header_t {
+  char magic[8];
+  u32 version;
+  u32 byte_order;
+  section_t chars;
+  section_t strings;
+  section_t arrays;
+  section_t exprs;
+  section_t kids;
+  section_t nodes;
+  section_t payload;
+  section_t init;
+  section_t base_constraints;
+  u32 root;
+  u32 padding;
+};
+
+struct string_record_t {
+  u64 offset;
+  u64 length;
+};
+
+struct array_record_t {
+  u32 name;
+  u32 size;
+  u32 domain;
+  u32 range;
+};
+
+struct expr_record_t {
+  u32 kind;
+  u32 width;
+  u32 first_kid;
+  u32 num_kids;
+  // Constant: the value (or, past 64 bits, the position of its words in the payload). Read: the array. Extract: the offset.
+  u64 aux;
+};
+
+struct node_record_t {
+  u64 id;
+  u32 type;
+  // Branch: the condition. Route: the destination device (forwarding only).
+  u32 expr;
+  u32 next;
+  u32 on_true;
+  u32 on_false;
+  // Call: where its description starts in the payload. Route: the operation.
+  u32 aux;
+};
+
+static_assert(sizeof(header_t) % HEADER_ALIGNMENT == 0, "Unaligned header");
+
+class BinaryWriter {
+private:
+  const SymbolManager *symbol_manager;
+
+  std::string chars;
+  std::vector<string_record_t> strings;
+  std::unordered_map<std::string, u32> string_ids;
+
+  std::vector<array_record_t> arrays;
+  std::unordered_map<const klee::Array *, u32> array_ids;
+
+  std::vector<expr_record_t> exprs;
+  std::vector<u32> kids;
+  klee::ExprHashMap<u32> expr_ids;
+
+  std::vector<node_record_t> nodes;
+  std::unordered_map<const BDDNode *, u32> node_ids;
+
+  std::vector<u32> payload;
+  std::vector<u32> init;
+  std::vector<u32> base_constraints;
+
+public:
+  BinaryWriter(const SymbolManager *_symbol_manager) : symbol_manager(_symbol_manager) {
+    // Same arrays, in the same order, as the text format's kQuery section.
+    for (const klee::Array *array : symbol_manager->get_arrays()) {
+      add_array(array);
+    }
+  }
+
+  void add_base_constraint(klee::ref<klee::Expr> constraint) { base_constraints.push_back(add_expr(constraint)); }
+
+  void add_init(const std::vector<Call *> &calls) {
+    for (const Call *call : calls) {
+      init.push_back(add_node(call));
+    }
+  }
+
+  u32 add_tree(const BDDNode *root) {
+    // Records first, edges once every node has a position.
+    root->visit_nodes([this](const BDDNode *node) {
+      add_node(node);
+      return BDDNodeVisitAction::Continue;
+    });
+
+    root->visit_nodes([this](const BDDNode *node) {
+      node_record_t &record = nodes[node_ids.at(node)];
+
+      switch (node->get_type()) {
+      case BDDNodeType::Branch: {
+        const Branch *branch = dynamic_cast<const Branch *>(node);
+        record.on_true       = branch->get_on_true() ? node_ids.at(branch->get_on_true()) : NONE;
+        record.on_false      = branch->get_on_false() ? node_ids.at(branch->get_on_false()) : NONE;
+      } break;
+      case BDDNodeType::Call:
+      case BDDNodeType::Route: {
+        record.next = node->get_next() ? node_ids.at(node->get_next()) : NONE;
+      } break;
+      }
+
+      return BDDNodeVisitAction::Continue;
+    });
+
+    return node_ids.at(root);
+  }
+
+  void write(const std::filesystem::path &fpath, u32 root) const {
+    header_t header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version    = BINARY_VERSION;
+    header.byte_order = BINARY_BYTE_ORDER;
+    header.root       = root;
+
+    std::ofstream out(fpath, std::ios::binary);
+    if (!out) {
+      panic("Unable to open BDD file \"%s\"", fpath.c_str());
+    }
+
+    u64 offset = sizeof(header_t);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    header.chars            = write_section(out, offset, chars.data(), chars.size());
+    header.strings          = write_section(out, offset, strings.data(), strings.size());
+    header.arrays           = write_section(out, offset, arrays.data(), arrays.size());
+    header.exprs            = write_section(out, offset, exprs.data(), exprs.size());
+    header.kids             = write_section(out, offset, kids.data(), kids.size());
+    header.nodes            = write_section(out, offset, nodes.data(), nodes.size());
+    header.payload          = write_section(out, offset, payload.data(), payload.size());
+    header.init             = write_section(out, offset, init.data(), init.size());
+    header.base_constraints = write_section(out, offset, base_constraints.data(), base_constraints.size());
+
+    // Now that every section has its place.
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    if (!out) {
+      panic("Failed to write BDD file \"%s\"", fpath.c_str());
+    }
+  }
+
+private:
+  template <typename T> static section_t write_section(std::ofstream &out, u64 &offset, const T *data, size_t count) {
+    const u64 padding = (SECTION_ALIGNMENT - offset % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+    const char zeros[SECTION_ALIGNMENT]{};
+    out.write(zeros, padding);
+    offset += padding;
+
+    const section_t section{offset, count};
+    out.write(reinterpret_cast<const char *>(data), sizeof(T) * count);
+    offset += sizeof(T) * count;
+
+    return section;
+  }
+
+  u32 add_string(const std::string &str) {
+    auto found_it = string_ids.find(str);
+    if (found_it != string_ids.end()) {
+      return found_it->second;
+    }
+
+    const u32 string_id = strings.size();
+    strings.push_back({chars.size(), str.size()});
+    chars += str;
+    string_ids[str] = string_id;
+
+    return string_id;
+  }
+
+  u32 add_array(const klee::Array *array) {
+    auto found_it = array_ids.find(array);
+    if (found_it != array_ids.end()) {
+      return found_it->second;
+    }
+
+    const u32 array_id = arrays.size();
+    arrays.push_back({add_string(array->getName()), static_cast<u32>(array->getSize()), array->getDomain(), array->getRange()});
+    array_ids[array] = array_id;
+
+    return array_id;
+  }
+
+  u32 add_expr(klee::ref<klee::Expr> expr) {
+    if (expr.isNull()) {
+      return NONE;
+    }
+
+    auto found_it = expr_ids.find(expr);
+    if (found_it != expr_ids.end()) {
+      return found_it->second;
+    }
+
+    expr_record_t record{
+        .kind      = static_cast<u32>(expr->getKind()),
+        .width     = expr->getWidth(),
+        .first_kid = 0,
+        .num_kids  = 0,
+        .aux       = 0,
+    };
+
+    switch (expr->getKind()) {
+    case klee::Expr::Constant: {
+      const llvm::APInt &value = dynamic_cast<const klee::ConstantExpr *>(expr.get())->getAPValue();
+      if (value.getBitWidth() <= MAX_INLINE_CONST) {
+        record.aux = value.getZExtValue();
+      } else {
+        // APInt words are 64 bits wide, stored as pairs of u32 (low first).
+        record.aux = payload.size();
+        for (size_t i = 0; i < value.getNumWords(); i++) {
+          const u64 word = value.getRawData()[i];
+          payload.push_back(static_cast<u32>(word));
+          payload.push_back(static_cast<u32>(word >> 32));
+        }
+      }
+    } break;
+    case klee::Expr::Read: {
+      const klee::ReadExpr *read = dynamic_cast<const klee::ReadExpr *>(expr.get());
+      assert(read->updates.getSize() == 0 && "TODO: handle updates");
+      record.aux = add_array(read->updates.root);
+    } break;
+    case klee::Expr::Extract: {
+      record.aux = dynamic_cast<const klee::ExtractExpr *>(expr.get())->offset;
+    } break;
+    default:
+      break;
+    }
+
+    // Kids always come before their parents, so that loading is a single pass. A Read's only kid is its index.
+    std::vector<u32> expr_kids;
+    for (unsigned i = 0; i < expr->getNumKids(); i++) {
+      expr_kids.push_back(add_expr(expr->getKid(i)));
+    }
+
+    record.first_kid = kids.size();
+    record.num_kids  = expr_kids.size();
+    kids.insert(kids.end(), expr_kids.begin(), expr_kids.end());
+
+    const u32 expr_id = exprs.size();
+    exprs.push_back(record);
+    expr_ids[expr] = expr_id;
+
+    return expr_id;
+  }
+
+  // Returns where the call's words start in the payload.
+  u32 add_call(const call_t &call, const Symbols &symbols) {
+    // Referenced expressions and strings are added first, so that the call's words come out contiguous.
+    std::vector<u32> words;
+
+    words.push_back(add_string(call.function_name));
+
+    words.push_back(call.args.size());
+    for (const auto &[arg_name, arg] : call.args) {
+      words.push_back(add_string(arg_name));
+      words.push_back(add_expr(arg.expr));
+      words.push_back(add_expr(arg.in));
+      words.push_back(add_expr(arg.out));
+      words.push_back(arg.fn_ptr_name.first ? add_string(arg.fn_ptr_name.second) : NONE);
+
+      words.push_back(arg.meta.size());
+      for (const meta_t &meta : arg.meta) {
+        words.push_back(add_string(meta.symbol));
+        words.push_back(meta.offset);
+        words.push_back(meta.size);
+      }
+    }
+
+    words.push_back(call.extra_vars.size());
+    for (const auto &[extra_var_name, extra_var] : call.extra_vars) {
+      words.push_back(add_string(extra_var_name));
+      words.push_back(add_expr(extra_var.first));
+      words.push_back(add_expr(extra_var.second));
+    }
+
+    words.push_back(add_expr(call.ret));
+
+    const std::vector<symbol_t> symbols_list = symbols.get();
+    words.push_back(symbols_list.size());
+    for (const symbol_t &symbol : symbols_list) {
+      words.push_back(add_string(symbol.base));
+      words.push_back(add_string(symbol.name));
+      words.push_back(add_expr(symbol.expr));
+    }
+
+    const u32 offset = payload.size();
+    payload.insert(payload.end(), words.begin(), words.end());
+
+    return offset;
+  }
+
+  u32 add_node(const BDDNode *node) {
+    node_record_t record{
+        .id       = node->get_id(),
+        .type     = 0,
+        .expr     = NONE,
+        .next     = NONE,
+        .on_true  = NONE,
+        .on_false = NONE,
+        .aux      = 0,
+    };
+
+    switch (node->get_type()) {
+    case BDDNodeType::Call: {
+      const Call *call_node = dynamic_cast<const Call *>(node);
+      record.type           = NODE_TYPE_CALL;
+      record.aux            = add_call(call_node->get_call(), call_node->get_local_symbols());
+    } break;
+    case BDDNodeType::Branch: {
+      const Branch *branch_node = dynamic_cast<const Branch *>(node);
+      record.type               = NODE_TYPE_BRANCH;
+      record.expr               = add_expr(branch_node->get_condition());
+    } break;
+    case BDDNodeType::Route: {
+      const Route *route_node = dynamic_cast<const Route *>(node);
+      record.type             = NODE_TYPE_ROUTE;
+      record.aux              = static_cast<u32>(route_node->get_operation());
+      if (route_node->get_operation() == RouteOp::Forward) {
+        record.expr = add_expr(route_node->get_dst_device());
+      }
+    } break;
+    }
+
+    const u32 node_id = nodes.size();
+    nodes.push_back(record);
+    node_ids[node] = node_id;
+
+    return node_id;
+  }
+};
+
+class BinaryReader {
+private:
+  const std::filesystem::path fpath;
+  SymbolManager *symbol_manager;
+  std::unique_ptr<klee::ExprBuilder> builder;
+
+  const u8 *data;
+  size_t size;
+  const header_t *header;
+
+  std::vector<std::string> strings;
+  std::vector<const klee::Array *> arrays;
+  std::vector<klee::ref<klee::Expr>> exprs;
+
+public:
+  BinaryReader(const std::filesystem::path &_fpath, SymbolManager *_symbol_manager)
+      : fpath(_fpath), symbol_manager(_symbol_manager), builder(klee::createDefaultExprBuilder()), data(nullptr), size(0), header(nullptr) {
+    int fd = open(fpath.c_str(), O_RDONLY);
+    if (fd < 0) {
+      panic("Unable to open BDD file \"%s\"", fpath.c_str());
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(header_t)) {
+      close(fd);
+      panic("Invalid BDD file \"%s\"", fpath.c_str());
+    }
+
+    size          = st.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+      panic("Unable to map BDD file \"%s\"", fpath.c_str());
+    }
+
+    data   = static_cast<const u8 *>(mapping);
+    header = reinterpret_cast<const header_t *>(data);
+
+    if (std::memcmp(header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+      panic("Not a binary BDD file: \"%s\"", fpath.c_str());
+    }
+
+    if (header->byte_order != BINARY_BYTE_ORDER) {
+      panic("Binary BDD file \"%s\" was written on a machine with a different byte order", fpath.c_str());
+    }
+
+    if (header->version != BINARY_VERSION) {
+      panic("Unsupported binary BDD version %u (expected %u) in \"%s\"", header->version, BINARY_VERSION, fpath.c_str());
+    }
+  }
+
+  BinaryReader(const BinaryReader &)            = delete;
+  BinaryReader &operator=(const BinaryReader &) = delete;
+
+  ~BinaryReader() { munmap(const_cast<u8 *>(data), size); }
+
+  template <typename T> const T *section(const section_t &s) const {
+    if (s.offset % alignof(T) != 0 || s.offset > size || s.count > (size - s.offset) / sizeof(T)) {
+      panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+    }
+    return reinterpret_cast<const T *>(data + s.offset);
+  }
+
+  const header_t &get_header() const { return *header; }
+
+  void load_strings() {
+    const char *chars              = section<char>(header->chars);
+    const string_record_t *records = section<string_record_t>(header->strings);
+
+    strings.reserve(header->strings.count);
+    for (size_t i = 0; i < header->strings.count; i++) {
+      const string_record_t &record = records[i];
+      if (record.offset > header->chars.count || record.length > header->chars.count - record.offset) {
+        panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+      }
+      strings.emplace_back(chars + record.offset, record.length);
+    }
+  }
+
+  void load_arrays() {
+    const array_record_t *records = section<array_record_t>(header->arrays);
+
+    arrays.reserve(header->arrays.count);
+    for (size_t i = 0; i < header->arrays.count; i++) {
+      const array_record_t &record = records[i];
+      const std::string &name      = get_string(record.name);
+
+      symbol_manager->create_symbol(name, record.size * 8);
+      const klee::Array *array = symbol_manager->get_array(name);
+      if (array->getDomain() != record.domain || array->getRange() != record.range) {
+        panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+      }
+
+      arrays.push_back(array);
+    }
+  }
+
+  void load_exprs() {
+    const expr_record_t *records = section<expr_record_t>(header->exprs);
+    const u32 *kids              = section<u32>(header->kids);
+    const u32 *payload           = section<u32>(header->payload);
+
+    exprs.reserve(header->exprs.count);
+    for (size_t i = 0; i < header->exprs.count; i++) {
+      const expr_record_t &record = records[i];
+
+      if (record.first_kid > header->kids.count || record.num_kids > header->kids.count - record.first_kid) {
+        panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+      }
+
+      // Kids were written before their parents, so they are all here already.
+      auto kid = [&](u32 k) -> klee::ref<klee::Expr> {
+        if (k >= record.num_kids) {
+          panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+        }
+        klee::ref<klee::Expr> kid_expr = get_expr(kids[record.first_kid + k]);
+        if (kid_expr.isNull()) {
+          panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+        }
+        return kid_expr;
+      };
+
+      klee::ref<klee::Expr> expr;
+      switch (static_cast<klee::Expr::Kind>(record.kind)) {
+      case klee::Expr::Constant: {
+        if (record.width <= MAX_INLINE_CONST) {
+          expr = builder->Constant(llvm::APInt(record.width, record.aux));
+        } else {
+          const size_t num_words = (record.width + APINT_WORD_BITS - 1) / APINT_WORD_BITS;
+          if (record.aux > header->payload.count || 2 * num_words > header->payload.count - record.aux) {
+            panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+          }
+          std::vector<uint64_t> words;
+          for (size_t w = 0; w < num_words; w++) {
+            words.push_back(static_cast<u64>(payload[record.aux + 2 * w]) | (static_cast<u64>(payload[record.aux + 2 * w + 1]) << 32));
+          }
+          expr = builder->Constant(llvm::APInt(record.width, words));
+        }
+      } break;
+      case klee::Expr::NotOptimized:
+        expr = builder->NotOptimized(kid(0));
+        break;
+      case klee::Expr::Read: {
+        if (record.aux >= arrays.size()) {
+          panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+        }
+        const klee::UpdateList updates(arrays[record.aux], nullptr);
+        expr = builder->Read(updates, kid(0));
+      } break;
+      case klee::Expr::Select:
+        expr = builder->Select(kid(0), kid(1), kid(2));
+        break;
+      case klee::Expr::Concat:
+        expr = builder->Concat(kid(0), kid(1));
+        break;
+      case klee::Expr::Extract:
+        expr = builder->Extract(kid(0), record.aux, record.width);
+        break;
+      case klee::Expr::ZExt:
+        expr = builder->ZExt(kid(0), record.width);
+        break;
+      case klee::Expr::SExt:
+        expr = builder->SExt(kid(0), record.width);
+        break;
+      case klee::Expr::Not:
+        expr = builder->Not(kid(0));
+        break;
+      case klee::Expr::Add:
+        expr = builder->Add(kid(0), kid(1));
+        break;
+      case klee::Expr::Sub:
+        expr = builder->Sub(kid(0), kid(1));
+        break;
+      case klee::Expr::Mul:
+        expr = builder->Mul(kid(0), kid(1));
+        break;
+      case klee::Expr::UDiv:
+        expr = builder->UDiv(kid(0), kid(1));
+        break;
+      case klee::Expr::SDiv:
+        expr = builder->SDiv(kid(0), kid(1));
+        break;
+      case klee::Expr::URem:
+        expr = builder->URem(kid(0), kid(1));
+        break;
+      case klee::Expr::SRem:
+        expr = builder->SRem(kid(0), kid(1));
+        break;
+      case klee::Expr::And:
+        expr = builder->And(kid(0), kid(1));
+        break;
+      case klee::Expr::Or:
+        expr = builder->Or(kid(0), kid(1));
+        break;
+      case klee::Expr::Xor:
+        expr = builder->Xor(kid(0), kid(1));
+        break;
+      case klee::Expr::Shl:
+        expr = builder->Shl(kid(0), kid(1));
+        break;
+      case klee::Expr::LShr:
+        expr = builder->LShr(kid(0), kid(1));
+        break;
+      case klee::Expr::AShr:
+        expr = builder->AShr(kid(0), kid(1));
+        break;
+      case klee::Expr::Eq:
+        expr = builder->Eq(kid(0), kid(1));
+        break;
+      case klee::Expr::Ne:
+        expr = builder->Ne(kid(0), kid(1));
+        break;
+      case klee::Expr::Ult:
+        expr = builder->Ult(kid(0), kid(1));
+        break;
+      case klee::Expr::Ule:
+        expr = builder->Ule(kid(0), kid(1));
+        break;
+      case klee::Expr::Ugt:
+        expr = builder->Ugt(kid(0), kid(1));
+        break;
+      case klee::Expr::Uge:
+        expr = builder->Uge(kid(0), kid(1));
+        break;
+      case klee::Expr::Slt:
+        expr = builder->Slt(kid(0), kid(1));
+        break;
+      case klee::Expr::Sle:
+        expr = builder->Sle(kid(0), kid(1));
+        break;
+      case klee::Expr::Sgt:
+        expr = builder->Sgt(kid(0), kid(1));
+        break;
+      case klee::Expr::Sge:
+        expr = builder->Sge(kid(0), kid(1));
+        break;
+      default:
+        panic("Unknown expression kind %u in \"%s\"", record.kind, fpath.c_str());
+      }
+
+      if (expr->getWidth() != record.width) {
+        panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+      }
+      exprs.push_back(expr);
+    }
+  }
+
+  const std::string &get_string(u32 string_id) const {
+    if (string_id >= strings.size()) {
+      panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+    }
+    return strings[string_id];
+  }
+
+  klee::ref<klee::Expr> get_expr(u32 expr_id) const {
+    if (expr_id == NONE) {
+      return nullptr;
+    }
+    if (expr_id >= exprs.size()) {
+      panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+    }
+    return exprs[expr_id];
+  }
+
+  std::pair<call_t, Symbols> get_call(u32 pos) const {
+    const u32 *payload = section<u32>(header->payload);
+
+    auto next = [&]() {
+      if (pos >= header->payload.count) {
+        panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+      }
+      return payload[pos++];
+    };
+
+    call_t call;
+    call.function_name = get_string(next());
+
+    const u32 num_args = next();
+    for (u32 i = 0; i < num_args; i++) {
+      const std::string &arg_name = get_string(next());
+
+      arg_t arg;
+      arg.expr = get_expr(next());
+      arg.in   = get_expr(next());
+      arg.out  = get_expr(next());
+
+      const u32 fn_ptr_name = next();
+      if (fn_ptr_name != NONE) {
+        arg.fn_ptr_name = {true, get_string(fn_ptr_name)};
+      }
+
+      const u32 num_meta = next();
+      for (u32 j = 0; j < num_meta; j++) {
+        meta_t meta;
+        meta.symbol = get_string(next());
+        meta.offset = next();
+        meta.size   = next();
+        arg.meta.push_back(meta);
+      }
+
+      call.args[arg_name] = arg;
+    }
+
+    const u32 num_extra_vars = next();
+    for (u32 i = 0; i < num_extra_vars; i++) {
+      const std::string &extra_var_name = get_string(next());
+      klee::ref<klee::Expr> in          = get_expr(next());
+      klee::ref<klee::Expr> out         = get_expr(next());
+      call.extra_vars[extra_var_name]   = {in, out};
+    }
+
+    call.ret = get_expr(next());
+
+    Symbols symbols;
+    const u32 num_symbols = next();
+    for (u32 i = 0; i < num_symbols; i++) {
+      const std::string &base = get_string(next());
+      const std::string &name = get_string(next());
+      symbols.add(symbol_t(base, name, get_expr(next())));
+    }
+
+    return {call, symbols};
+  }
+};
+
+} // namespace
+
+void BDD::serialize_binary(const std::filesystem::path &fpath) const {
+  BinaryWriter writer(symbol_manager);
+
+  for (klee::ref<klee::Expr> constraint : base_constraints) {
+    writer.add_base_constraint(constraint);
+  }
+
+  writer.add_init(init);
+  const u32 root_pos = writer.add_tree(root);
+
+  writer.write(fpath, root_pos);
+}
+
+bool BDD::is_binary(const std::filesystem::path &fpath) {
+  std::ifstream bdd_file(fpath, std::ios::binary);
+
+  char magic[sizeof(BINARY_MAGIC)];
+  if (!bdd_file.read(magic, sizeof(magic))) {
+    return false;
+  }
+
+  return std::memcmp(magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
+
+void BDD::deserialize_binary(const std::filesystem::path &fpath) {
+  reset_node_caches();
+
+  BinaryReader reader(fpath, symbol_manager);
+  const header_t &header = reader.get_header();
+
+  reader.load_strings();
+  reader.load_arrays();
+  reader.load_exprs();
+
+  device     = symbol_manager->get_symbol("DEVICE");
+  packet_len = symbol_manager->get_symbol("pkt_len");
+  time       = symbol_manager->get_symbol("next_time");
+
+  const u32 *base_constraints_ids = reader.section<u32>(header.base_constraints);
+  for (size_t i = 0; i < header.base_constraints.count; i++) {
+    base_constraints.addConstraint(reader.get_expr(base_constraints_ids[i]));
+  }
+
+  const node_record_t *records = reader.section<node_record_t>(header.nodes);
+
+  std::vector<BDDNode *> nodes(header.nodes.count, nullptr);
+  for (size_t i = 0; i < header.nodes.count; i++) {
+    const node_record_t &record = records[i];
+
+    BDDNode *node = nullptr;
+    switch (record.type) {
+    case NODE_TYPE_CALL: {
+      auto [call, symbols] = reader.get_call(record.aux);
+      node                 = new Call(record.id, symbol_manager, call, symbols);
+    } break;
+    case NODE_TYPE_BRANCH: {
+      node = new Branch(record.id, symbol_manager, reader.get_expr(record.expr));
+    } break;
+    case NODE_TYPE_ROUTE: {
+      const RouteOp op = static_cast<RouteOp>(record.aux);
+      if (op == RouteOp::Forward) {
+        node = new Route(record.id, symbol_manager, op, reader.get_expr(record.expr));
+      } else {
+        node = new Route(record.id, symbol_manager, op);
+      }
+    } break;
+    default:
+      panic("Unknown node type %u in \"%s\"", record.type, fpath.c_str());
+    }
+
+    manager.add_node(node);
+    nodes[i] = node;
+    id       = std::max(id, node->get_id()) + 1;
+  }
+
+  auto get_node = [&](u32 pos) -> BDDNode * {
+    if (pos == NONE) {
+      return nullptr;
+    }
+    if (pos >= nodes.size()) {
+      panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+    }
+    return nodes[pos];
+  };
+
+  for (size_t i = 0; i < header.nodes.count; i++) {
+    const node_record_t &record = records[i];
+    BDDNode *node               = nodes[i];
+
+    if (record.type == NODE_TYPE_BRANCH) {
+      Branch *branch    = dynamic_cast<Branch *>(node);
+      BDDNode *on_true  = get_node(record.on_true);
+      BDDNode *on_false = get_node(record.on_false);
+
+      branch->set_on_true(on_true);
+      branch->set_on_false(on_false);
+
+      if (on_true) {
+        on_true->set_prev(branch);
+      }
+      if (on_false) {
+        on_false->set_prev(branch);
+      }
+    } else if (BDDNode *next = get_node(record.next)) {
+      node->set_next(next);
+      next->set_prev(node);
+    }
+  }
+
+  const u32 *init_ids = reader.section<u32>(header.init);
+  for (size_t i = 0; i < header.init.count; i++) {
+    BDDNode *node = get_node(init_ids[i]);
+    if (!node || node->get_type() != BDDNodeType::Call) {
+      panic("Corrupted binary BDD file \"%s\"", fpath.c_str());
+    }
+
+    Call *call = dynamic_cast<Call *>(node);
+    if (!init.empty()) {
+      init.back()->set_next(call);
+      call->set_prev(init.back());
+    }
+
+    init.push_back(call);
+  }
+
+  root = get_node(header.root);
+  assert(root && "Invalid root node");
+}
+
+} // namespace LibBDD
\ No newline at end of file
@@ -786,6 +786,12 @@ void process_edge(std::string serialized_edge, const std::map<bdd_node_id_t, BDD
 }
 
 void BDD::deserialize(const std::filesystem::path &fpath) {
+  if (is_binary(fpath)) {
+    deserialize_binary(fpath);
+    return;
+  }
+
+  reset_node_caches();
   std::ifstream bdd_file(fpath.string());
 
   if (!bdd_file) {
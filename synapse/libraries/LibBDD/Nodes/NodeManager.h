@@ -3,6 +3,7 @@
 #include <LibBDD/Nodes/Node.h>
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace LibBDD {
@@ -11,11 +12,21 @@ class BDDNodeManager {
 private:
   std::vector<std::unique_ptr<BDDNode>> nodes;
 
+  // Position of each node in nodes, so that membership checks and frees don't have to scan.
+  std::unordered_map<const BDDNode *, size_t> slots;
+
+  // Bumped on every add and free, so that indexes over the nodes know when to rebuild.
+  u64 generation;
+
 public:
-  BDDNodeManager() {}
+  BDDNodeManager() : generation(0) {}
   BDDNodeManager(BDDNodeManager &&other) = default;
 
-  void add_node(BDDNode *node) { nodes.emplace_back(node); }
+  void add_node(BDDNode *node) {
+    slots[node] = nodes.size();
+    nodes.emplace_back(node);
+    generation++;
+  }
 
   void free_node(BDDNode *node, bool recursive = false) {
     std::vector<BDDNode *> to_free;
@@ -27,17 +38,28 @@ public:
     }
 
     for (BDDNode *to_free_node : to_free) {
-      auto it = std::find_if(nodes.begin(), nodes.end(), [to_free_node](const std::unique_ptr<BDDNode> &n) { return n.get() == to_free_node; });
-      if (it != nodes.end()) {
-        assert((*it)->get_id() == to_free_node->get_id() && "Invalid node id");
-        nodes.erase(it);
+      auto found_it = slots.find(to_free_node);
+      if (found_it == slots.end()) {
+        continue;
       }
+
+      const size_t slot = found_it->second;
+      assert(nodes[slot]->get_id() == to_free_node->get_id() && "Invalid node id");
+      slots.erase(found_it);
+
+      // Swap with the last node and pop, instead of shifting everything after it.
+      if (slot != nodes.size() - 1) {
+        nodes[slot]              = std::move(nodes.back());
+        slots[nodes[slot].get()] = slot;
+      }
+      nodes.pop_back();
+      generation++;
     }
   }
 
-  bool has_node(const BDDNode *node) const {
-    return std::any_of(nodes.begin(), nodes.end(), [node](const std::unique_ptr<BDDNode> &n) { return n.get() == node; });
-  }
+  bool has_node(const BDDNode *node) const { return slots.find(node) != slots.end(); }
+  size_t size() const { return nodes.size(); }
+  u64 get_generation() const { return generation; }
 
   BDDNodeManager operator+(const BDDNodeManager &other) const {
     BDDNodeManager manager;
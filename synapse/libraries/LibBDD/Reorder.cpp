@@ -37,6 +37,8 @@ const std::unordered_set<std::string> functions_cannot_cross_branches{
     "tb_expire",
     "tb_trace",
     "tb_update_and_check",
+    "hhh_update",
+    "hhh_expire",
     "lpm_update",
 };
 
@@ -433,6 +435,10 @@ bool tb_can_reorder(const BDD *bdd, const BDDNode *anchor, const BDDNode *betwee
   return !check_obj(between, candidate, "tb");
 }
 
+bool hhh_can_reorder(const BDD *bdd, const BDDNode *anchor, const BDDNode *between, const Call *candidate, klee::ref<klee::Expr> &condition) {
+  return !check_obj(between, candidate, "hhh");
+}
+
 using can_reorder_stateful_op_fn = bool (*)(const BDD *bdd, const BDDNode *anchor, const BDDNode *between, const Call *candidate,
                                             klee::ref<klee::Expr> &condition);
 
@@ -454,6 +460,8 @@ const std::unordered_map<std::string, can_reorder_stateful_op_fn> can_reorder_ha
     {"tb_is_tracing", tb_can_reorder},
     {"tb_trace", tb_can_reorder},
     {"tb_update_and_check", tb_can_reorder},
+    {"hhh_update", hhh_can_reorder},
+    {"hhh_expire", hhh_can_reorder},
 };
 
 bool can_reorder_stateful_op(const BDD *bdd, const BDDNode *anchor, const BDDNode *between, const BDDNode *candidate,
@@ -11,10 +11,13 @@ using LibCore::bytes_in_expr;
 using LibCore::expr_mod_t;
 using LibCore::expr_to_ascii;
 using LibCore::expr_to_string;
+using LibCore::get_unique_symbolic_reads;
 using LibCore::is_constant;
 using LibCore::is_constant_signed;
 using LibCore::simplify;
 using LibCore::solver_toolbox;
+using LibCore::symbolic_read_t;
+using LibCore::symbolic_reads_t;
 
 namespace {
 constexpr const char *const NF_TEMPLATE_FILENAME       = "nf.template.cpp";
@@ -23,6 +26,8 @@ constexpr const char *const PROFILER_TEMPLATE_FILENAME = "profiler.template.cpp"
 constexpr const char *const MARKER_NF_STATE   = "NF_STATE";
 constexpr const char *const MARKER_NF_INIT    = "NF_INIT";
 constexpr const char *const MARKER_NF_PROCESS = "NF_PROCESS";
+constexpr const char *const MARKER_NF_RSS     = "NF_RSS";
+constexpr const char *const MARKER_NF_BURST   = "NF_BURST";
 
 std::filesystem::path template_from_type(BDDSynthesizerTarget target) {
   std::filesystem::path template_file = std::filesystem::path(__FILE__).parent_path() / "Templates";
@@ -38,6 +43,78 @@ std::filesystem::path template_from_type(BDDSynthesizerTarget target) {
 
   return template_file;
 }
+
+std::unordered_map<marker_t, indent_t> markers_from_type(BDDSynthesizerTarget target) {
+  std::unordered_map<marker_t, indent_t> markers{
+      {MARKER_NF_STATE, 0},
+      {MARKER_NF_INIT, 0},
+      {MARKER_NF_PROCESS, 0},
+  };
+
+  // Only the NF runs on multiple lcores, processing packets in bursts.
+  if (target == BDDSynthesizerTarget::NF) {
+    markers[MARKER_NF_RSS]   = 0;
+    markers[MARKER_NF_BURST] = 0;
+  }
+
+  return markers;
+}
+
+std::unordered_set<bytes_t> get_packet_bytes(klee::ref<klee::Expr> expr) {
+  std::unordered_set<bytes_t> bytes;
+  for (const symbolic_read_t &read : get_unique_symbolic_reads(expr, "packet_chunks")) {
+    bytes.insert(read.byte);
+  }
+  return bytes;
+}
+
+// The packet offset of each byte of the expression, as long as all of them are read straight from the packet.
+std::optional<std::vector<bytes_t>> get_packet_offsets(klee::ref<klee::Expr> expr) {
+  std::vector<bytes_t> offsets;
+
+  for (bytes_t b = 0; b < expr->getWidth() / 8; b++) {
+    klee::ref<klee::Expr> byte = simplify(solver_toolbox.exprBuilder->Extract(expr, b * 8, 8));
+    if (byte->getKind() != klee::Expr::Read) {
+      return std::nullopt;
+    }
+
+    symbolic_reads_t reads = get_unique_symbolic_reads(byte, "packet_chunks");
+    if (reads.size() != 1) {
+      return std::nullopt;
+    }
+
+    offsets.push_back(reads.begin()->byte);
+  }
+
+  return offsets;
+}
+
+bool contains_all(const std::unordered_set<bytes_t> &bytes, const std::unordered_set<bytes_t> &required) {
+  for (bytes_t byte : required) {
+    if (bytes.find(byte) == bytes.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A cms_increment immediately followed by a cms_count_min of the same key in the same sketch collapses into a single
+// cms_increment_and_count_min.
+bool is_fused_cms_increment(const BDDNode *node) {
+  if (!node || node->get_type() != BDDNodeType::Call || !node->get_next() || node->get_next()->get_type() != BDDNodeType::Call) {
+    return false;
+  }
+
+  const call_t &inc = dynamic_cast<const Call *>(node)->get_call();
+  const call_t &min = dynamic_cast<const Call *>(node->get_next())->get_call();
+
+  if (inc.function_name != "cms_increment" || min.function_name != "cms_count_min") {
+    return false;
+  }
+
+  return solver_toolbox.are_exprs_always_equal(inc.args.at("cms").expr, min.args.at("cms").expr) &&
+         solver_toolbox.are_exprs_always_equal(inc.args.at("key").in, min.args.at("key").in);
+}
 } // namespace
 
 #define TODO(expr)                                                                                                                                   \
@@ -603,18 +680,14 @@ klee::ExprVisitor::Action BDDSynthesizer::Transpiler::visitSge(const klee::SgeEx
   { #FNAME, std::bind(&BDDSynthesizer::FNAME, this, std::placeholders::_1, std::placeholders::_2) }
 
 BDDSynthesizer::BDDSynthesizer(const BDD *_bdd, BDDSynthesizerTarget _target, std::filesystem::path _out_file)
-    : out_file(_out_file), bdd(_bdd), target(_target), code_template(template_from_type(_target),
-                                                                     {
-                                                                         {MARKER_NF_STATE, 0},
-                                                                         {MARKER_NF_INIT, 0},
-                                                                         {MARKER_NF_PROCESS, 0},
-                                                                     }),
-      transpiler(this), function_synthesizers({
+    : out_file(_out_file), bdd(_bdd), target(_target), code_template(template_from_type(_target), markers_from_type(_target)), transpiler(this),
+      function_synthesizers({
                             POPULATE_SYNTHESIZER(map_allocate),
                             POPULATE_SYNTHESIZER(vector_allocate),
                             POPULATE_SYNTHESIZER(dchain_allocate),
                             POPULATE_SYNTHESIZER(cms_allocate),
                             POPULATE_SYNTHESIZER(tb_allocate),
+                            POPULATE_SYNTHESIZER(hhh_allocate),
                             POPULATE_SYNTHESIZER(lpm_allocate),
                             POPULATE_SYNTHESIZER(packet_borrow_next_chunk),
                             POPULATE_SYNTHESIZER(packet_return_chunk),
@@ -641,24 +714,326 @@ BDDSynthesizer::BDDSynthesizer(const BDD *_bdd, BDDSynthesizerTarget _target, st
                             POPULATE_SYNTHESIZER(tb_trace),
                             POPULATE_SYNTHESIZER(tb_update_and_check),
                             POPULATE_SYNTHESIZER(tb_expire),
+                            POPULATE_SYNTHESIZER(hhh_update),
+                            POPULATE_SYNTHESIZER(hhh_expire),
                             POPULATE_SYNTHESIZER(lpm_lookup),
                             POPULATE_SYNTHESIZER(lpm_update),
                             POPULATE_SYNTHESIZER(lpm_from_file),
-                        }) {}
+                        }),
+      rss_mode(RSSMode::None), burst_lookup(nullptr) {}
 
 void BDDSynthesizer::synthesize() {
   // Global state
   stack_push();
 
+  if (target == BDDSynthesizerTarget::NF) {
+    init_rss();
+    init_burst();
+  }
+
   init_pre_process();
   process();
   init_post_process();
 
+  if (target == BDDSynthesizerTarget::NF) {
+    process_burst();
+  }
+
   std::ofstream ofs(out_file);
   ofs << code_template.dump();
   ofs.close();
 }
 
+void BDDSynthesizer::init_rss() {
+  coder_t &coder = code_template.get(MARKER_NF_RSS);
+
+  std::string reason;
+  rss_mode = find_rss_mode(reason);
+
+  coder << "// " << reason << "\n";
+  coder << "static const uint64_t NF_RSS_HF = ";
+
+  switch (rss_mode) {
+  case RSSMode::None:
+    coder << "0";
+    break;
+  case RSSMode::IPv4:
+    coder << "RTE_ETH_RSS_IPV4";
+    break;
+  case RSSMode::IPv4TcpUdp:
+    coder << "RTE_ETH_RSS_NONFRAG_IPV4_TCP | RTE_ETH_RSS_NONFRAG_IPV4_UDP";
+    break;
+  }
+
+  coder << ";\n";
+}
+
+// Replicating the state per lcore is only correct if RSS sends every packet touching a given state entry to the same lcore. That is the case
+// when every keyed access uses a key containing all the fields RSS hashes on (in any order, the RSS key is symmetric), and every indexed
+// access uses an index coming from that state (not straight from the packet, nor a constant shared by all flows).
+BDDSynthesizer::RSSMode BDDSynthesizer::find_rss_mode(std::string &reason) const {
+  const std::unordered_set<std::string> keyed_accesses{"map_get", "map_put", "map_erase", "cms_increment", "cms_count_min", "tb_is_tracing",
+                                                       "tb_trace"};
+  const std::unordered_set<std::string> indexed_accesses{"vector_borrow", "vector_return", "dchain_rejuvenate_index", "dchain_is_index_allocated",
+                                                         "dchain_free_index", "tb_update_and_check"};
+  const std::unordered_set<std::string> global_accesses{"map_size", "vector_clear", "vector_sample_lt", "lpm_update", "hhh_update", "hhh_expire"};
+
+  // NFs borrow the Ethernet, IPv4 and L4 headers in this order, so that is how we find the packet_chunks bytes holding the IPv4 addresses
+  // (bytes 12 to 19 of the second chunk) and the L4 ports (first 4 bytes of the third one).
+  std::unordered_set<bytes_t> ip_bytes;
+  std::unordered_set<bytes_t> port_bytes;
+  std::vector<const Call *> calls;
+
+  bdd->get_root()->visit_nodes([&](const BDDNode *node) {
+    if (node->get_type() != BDDNodeType::Call) {
+      return BDDNodeVisitAction::Continue;
+    }
+
+    const Call *call_node = dynamic_cast<const Call *>(node);
+    const call_t &call    = call_node->get_call();
+
+    calls.push_back(call_node);
+
+    if (call.function_name != "packet_borrow_next_chunk") {
+      return BDDNodeVisitAction::Continue;
+    }
+
+    klee::ref<klee::Expr> length = call.args.at("length").expr;
+    klee::ref<klee::Expr> chunk  = call.extra_vars.at("the_chunk").second;
+
+    std::unordered_set<bytes_t> chunk_bytes = get_packet_bytes(chunk);
+    if (!is_constant(length) || chunk_bytes.empty()) {
+      return BDDNodeVisitAction::Continue;
+    }
+
+    const bytes_t size         = solver_toolbox.value_from_expr(length);
+    const bytes_t offset       = *std::min_element(chunk_bytes.begin(), chunk_bytes.end());
+    const size_t chunks_before = call_node->get_prev_functions({"packet_borrow_next_chunk"}).size();
+
+    if (chunks_before == 1 && size == 20) {
+      for (bytes_t byte = 12; byte < 20; byte++) {
+        ip_bytes.insert(offset + byte);
+      }
+    } else if (chunks_before == 2 && size >= 4) {
+      for (bytes_t byte = 0; byte < 4; byte++) {
+        port_bytes.insert(offset + byte);
+      }
+    }
+
+    return BDDNodeVisitAction::Continue;
+  });
+
+  bool keys_have_ports = true;
+
+  for (const Call *call_node : calls) {
+    const call_t &call = call_node->get_call();
+
+    if (global_accesses.find(call.function_name) != global_accesses.end()) {
+      reason = "Single lcore: " + call.function_name + " needs a view of the whole state";
+      return RSSMode::None;
+    }
+
+    if (indexed_accesses.find(call.function_name) != indexed_accesses.end()) {
+      klee::ref<klee::Expr> index = call.args.at("index").expr;
+
+      if (get_unique_symbolic_reads(index).empty()) {
+        reason = "Single lcore: " + call.function_name + " uses a constant index, shared by all flows";
+        return RSSMode::None;
+      }
+
+      if (!get_packet_bytes(index).empty()) {
+        reason = "Single lcore: " + call.function_name + " uses an index taken from the packet";
+        return RSSMode::None;
+      }
+    }
+
+    if (keyed_accesses.find(call.function_name) != keyed_accesses.end()) {
+      std::unordered_set<bytes_t> key_bytes = get_packet_bytes(call.args.at("key").in);
+
+      if (ip_bytes.empty() || !contains_all(key_bytes, ip_bytes)) {
+        reason = "Single lcore: " + call.function_name + " is not keyed on the IPv4 addresses";
+        return RSSMode::None;
+      }
+
+      keys_have_ports &= contains_all(key_bytes, port_bytes);
+    }
+  }
+
+  if (keys_have_ports && !port_bytes.empty()) {
+    reason = "RSS on the IPv4 addresses and L4 ports: all the state is keyed on them, so each lcore gets its own replica";
+    return RSSMode::IPv4TcpUdp;
+  }
+
+  reason = "RSS on the IPv4 addresses: all the state is keyed on them, so each lcore gets its own replica";
+  return RSSMode::IPv4;
+}
+
+code_t BDDSynthesizer::state_qualifier() const { return rss_mode == RSSMode::None ? "" : "thread_local "; }
+
+void BDDSynthesizer::init_burst() {
+  burst_lookup = find_burst_lookup(burst_key_offsets);
+
+  if (!burst_lookup) {
+    return;
+  }
+
+  for (const BDDNode *node = burst_lookup->get_prev(); node; node = node->get_prev()) {
+    if (node->get_type() == BDDNodeType::Call && dynamic_cast<const Call *>(node)->get_call().function_name == "expire_items_single_map") {
+      burst_expirations.insert(burst_expirations.begin(), dynamic_cast<const Call *>(node));
+    }
+  }
+
+  coder_t &coder = code_template.get(MARKER_NF_STATE);
+
+  coder << "// nf_process_burst resolves the lookup of BDDNode " << burst_lookup->get_id() << " for the whole burst up front.\n";
+  coder << "// If the map changes in the meantime, the remaining packets fall back to map_get.\n";
+  coder << "static thread_local uint16_t burst_pkt;\n";
+  coder << "static thread_local bool burst_dirty;\n";
+  coder << "static thread_local int burst_hits[BATCH_SIZE];\n";
+  coder << "static thread_local int burst_values[BATCH_SIZE];\n";
+}
+
+// The burst lookup is the first map_get reached after nothing but parsing (borrowing headers and branching on them) and expiring old flows. Its
+// key must be made of packet bytes alone, so that it can be built straight from each packet's buffer. Packets that would not reach the lookup
+// only cost a wasted (read-only) one.
+const Call *BDDSynthesizer::find_burst_lookup(std::vector<bytes_t> &key_offsets) const {
+  const std::unordered_set<std::string> prefix_functions{"packet_borrow_next_chunk", "expire_items_single_map",
+                                                         "expire_items_single_map_iteratively"};
+
+  const Call *lookup = nullptr;
+
+  bdd->get_root()->visit_nodes([&](const BDDNode *node) {
+    if (node->get_type() == BDDNodeType::Branch) {
+      return BDDNodeVisitAction::Continue;
+    }
+
+    if (node->get_type() != BDDNodeType::Call) {
+      return BDDNodeVisitAction::SkipChildren;
+    }
+
+    const Call *call_node = dynamic_cast<const Call *>(node);
+    const call_t &call    = call_node->get_call();
+
+    if (prefix_functions.find(call.function_name) != prefix_functions.end()) {
+      return BDDNodeVisitAction::Continue;
+    }
+
+    if (call.function_name != "map_get") {
+      return BDDNodeVisitAction::SkipChildren;
+    }
+
+    std::optional<std::vector<bytes_t>> offsets = get_packet_offsets(call.args.at("key").in);
+    if (!offsets) {
+      return BDDNodeVisitAction::SkipChildren;
+    }
+
+    lookup      = call_node;
+    key_offsets = *offsets;
+    return BDDNodeVisitAction::Stop;
+  });
+
+  return lookup;
+}
+
+void BDDSynthesizer::process_burst() {
+  coder_t &coder = code_template.get(MARKER_NF_BURST);
+
+  coder << "void nf_process_burst(uint16_t device, uint8_t **buffers, uint16_t *packet_lengths, uint16_t count, time_ns_t now, ";
+  coder << "uint16_t *dst_devices) {\n";
+  coder.inc();
+
+  if (burst_lookup) {
+    klee::ref<klee::Expr> map_addr = burst_lookup->get_call().args.at("map").expr;
+
+    for (const Call *expiration : burst_expirations) {
+      const call_t &call = expiration->get_call();
+
+      coder.indent();
+      coder << "// BDDNode " << expiration->get_id() << ", once for the whole burst\n";
+      coder.indent();
+      coder << "nf_expire_items_single_map(";
+      coder << stack_get(call.args.at("chain").expr).name << ", ";
+      coder << stack_get(call.args.at("vector").expr).name << ", ";
+      coder << stack_get(call.args.at("map").expr).name << ", ";
+      coder << transpiler.transpile(call.args.at("time").expr);
+      coder << ");\n";
+    }
+
+    coder.indent();
+    coder << "// Phase 1: build every packet's key and resolve the lookup of BDDNode " << burst_lookup->get_id() << " for all of them at once\n";
+
+    coder.indent();
+    coder << "uint8_t keys[BATCH_SIZE][" << burst_key_offsets.size() << "];\n";
+    coder.indent();
+    coder << "void *key_ptrs[BATCH_SIZE];\n";
+
+    coder.indent();
+    coder << "for (uint16_t i = 0; i < count; i++) {\n";
+    coder.inc();
+
+    for (size_t b = 0; b < burst_key_offsets.size(); b++) {
+      coder.indent();
+      coder << "keys[i][" << b << "] = buffers[i][" << burst_key_offsets[b] << "];\n";
+    }
+
+    coder.indent();
+    coder << "key_ptrs[i] = keys[i];\n";
+
+    coder.dec();
+    coder.indent();
+    coder << "}\n";
+
+    coder.indent();
+    coder << "map_get_bulk(" << stack_get(map_addr).name << ", key_ptrs, count, burst_values, burst_hits);\n";
+    coder.indent();
+    coder << "burst_dirty = false;\n";
+    coder << "\n";
+
+    coder.indent();
+    coder << "// Phase 2: process each packet\n";
+  } else {
+    coder.indent();
+    coder << "// No parsing + map lookup prefix to resolve up front, so packets are simply processed one by one\n";
+  }
+
+  coder.indent();
+  coder << "for (uint16_t i = 0; i < count; i++) {\n";
+  coder.inc();
+
+  coder.indent();
+  coder << "uint32_t total_length = packet_lengths[i];\n";
+  coder.indent();
+  coder << "packet_state_total_length(buffers[i], &total_length);\n";
+
+  if (burst_lookup) {
+    coder.indent();
+    coder << "burst_pkt = i;\n";
+  }
+
+  coder.indent();
+  coder << "dst_devices[i] = nf_process(device, buffers[i], packet_lengths[i], now);\n";
+
+  coder.dec();
+  coder.indent();
+  coder << "}\n";
+
+  coder.dec();
+  coder << "}\n";
+}
+
+void BDDSynthesizer::mark_burst_dirty(coder_t &coder, klee::ref<klee::Expr> map_addr, const std::string &condition) {
+  if (!burst_lookup || !solver_toolbox.are_exprs_always_equal(map_addr, burst_lookup->get_call().args.at("map").expr)) {
+    return;
+  }
+
+  coder.indent();
+  if (condition.empty()) {
+    coder << "burst_dirty = true;\n";
+  } else {
+    coder << "burst_dirty |= " << condition << ";\n";
+  }
+}
+
 void BDDSynthesizer::init_pre_process() {
   coder_t &coder = code_template.get(MARKER_NF_INIT);
 
@@ -980,14 +1355,19 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::expire_items_single_map(code
 
     coder.indent();
     coder << "expiration_tracker.update(" << nfreed.name << ", now);\n";
+  } else if (std::find(burst_expirations.begin(), burst_expirations.end(), call_node) != burst_expirations.end()) {
+    coder << "0"; // Already done by nf_process_burst
+    coder << ";\n";
   } else {
-    coder << "expire_items_single_map(";
+    coder << "nf_expire_items_single_map(";
     coder << stack_get(chain).name << ", ";
     coder << stack_get(vector).name << ", ";
     coder << stack_get(map).name << ", ";
     coder << transpiler.transpile(time);
     coder << ")";
     coder << ";\n";
+
+    mark_burst_dirty(coder, map, nfreed.name + " > 0");
   }
 
   stack_add(nfreed);
@@ -1017,6 +1397,8 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::expire_items_single_map_iter
   coder << ")";
   coder << ";\n";
 
+  mark_burst_dirty(coder, map, nfreed.name + " > 0");
+
   stack_add(nfreed);
 
   return {};
@@ -1035,7 +1417,7 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::map_allocate(coder_t &coder,
 
   coder_t &coder_nf_state = code_template.get(MARKER_NF_STATE);
   coder_nf_state.indent();
-  coder_nf_state << "struct Map *";
+  coder_nf_state << state_qualifier() << "struct Map *";
   coder_nf_state << map_out_var.name;
   coder_nf_state << ";\n";
 
@@ -1072,14 +1454,36 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::map_get(coder_t &coder, cons
   coder.indent();
   coder << "int " << v.name << ";\n";
 
-  coder.indent();
-  coder << "int " << r.name << " = ";
-  coder << "map_get(";
-  coder << stack_get(map_addr).name << ", ";
-  coder << k.name << ", ";
-  coder << "&" << v.name;
-  coder << ")";
-  coder << ";\n";
+  if (call_node == burst_lookup) {
+    coder.indent();
+    coder << "int " << r.name << ";\n";
+
+    coder.indent();
+    coder << "if (burst_dirty) {\n";
+    coder.inc();
+    coder.indent();
+    coder << r.name << " = map_get(" << stack_get(map_addr).name << ", " << k.name << ", &" << v.name << ");\n";
+    coder.dec();
+    coder.indent();
+    coder << "} else {\n";
+    coder.inc();
+    coder.indent();
+    coder << r.name << " = burst_hits[burst_pkt];\n";
+    coder.indent();
+    coder << v.name << " = burst_values[burst_pkt];\n";
+    coder.dec();
+    coder.indent();
+    coder << "}\n";
+  } else {
+    coder.indent();
+    coder << "int " << r.name << " = ";
+    coder << "map_get(";
+    coder << stack_get(map_addr).name << ", ";
+    coder << k.name << ", ";
+    coder << "&" << v.name;
+    coder << ")";
+    coder << ";\n";
+  }
 
   if (target == BDDSynthesizerTarget::Profiler) {
     nodes_to_map.insert({call_node->get_id(), map_addr});
@@ -1125,6 +1529,8 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::map_put(coder_t &coder, cons
   coder << ")";
   coder << ";\n";
 
+  mark_burst_dirty(coder, map_addr, "");
+
   if (target == BDDSynthesizerTarget::Profiler) {
     nodes_to_map.insert({call_node->get_id(), map_addr});
     coder.indent();
@@ -1169,6 +1575,8 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::map_erase(coder_t &coder, co
   coder << ")";
   coder << ";\n";
 
+  mark_burst_dirty(coder, map_addr, "");
+
   if (target == BDDSynthesizerTarget::Profiler) {
     nodes_to_map.insert({call_node->get_id(), map_addr});
     coder.indent();
@@ -1227,7 +1635,7 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::vector_allocate(coder_t &cod
 
   coder_t &coder_nf_state = code_template.get(MARKER_NF_STATE);
   coder_nf_state.indent();
-  coder_nf_state << "struct Vector *";
+  coder_nf_state << state_qualifier() << "struct Vector *";
   coder_nf_state << vector_out_var.name;
   coder_nf_state << ";\n";
 
@@ -1390,7 +1798,7 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::dchain_allocate(coder_t &cod
 
   coder_t &coder_nf_state = code_template.get(MARKER_NF_STATE);
   coder_nf_state.indent();
-  coder_nf_state << "struct DoubleChain *";
+  coder_nf_state << state_qualifier() << "struct DoubleChain *";
   coder_nf_state << chain_out_var.name;
   coder_nf_state << ";\n";
 
@@ -1519,7 +1927,7 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::cms_allocate(coder_t &coder,
 
   coder_t &coder_nf_state = code_template.get(MARKER_NF_STATE);
   coder_nf_state.indent();
-  coder_nf_state << "struct CMS *";
+  coder_nf_state << state_qualifier() << "struct CMS *";
   coder_nf_state << cms_out_var.name;
   coder_nf_state << ";\n";
 
@@ -1548,12 +1956,15 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::cms_increment(coder_t &coder
   bool key_in_stack;
   var_t k = build_var_ptr("key", key_addr, key, coder, key_in_stack);
 
-  coder.indent();
-  coder << "cms_increment(";
-  coder << stack_get(cms_addr).name << ", ";
-  coder << k.name;
-  coder << ")";
-  coder << ";\n";
+  // Done by the cms_count_min that follows.
+  if (!is_fused_cms_increment(call_node)) {
+    coder.indent();
+    coder << "cms_increment(";
+    coder << stack_get(cms_addr).name << ", ";
+    coder << k.name;
+    coder << ")";
+    coder << ";\n";
+  }
 
   if (!key_in_stack) {
     stack_add(k);
@@ -1579,7 +1990,7 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::cms_count_min(coder_t &coder
 
   coder.indent();
   coder << "int " << me.name << " = ";
-  coder << "cms_count_min(";
+  coder << (is_fused_cms_increment(call_node->get_prev()) ? "cms_increment_and_count_min(" : "cms_count_min(");
   coder << stack_get(cms_addr).name << ", ";
   coder << k.name;
   coder << ")";
@@ -1634,7 +2045,7 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::tb_allocate(coder_t &coder,
 
   coder_t &coder_nf_state = code_template.get(MARKER_NF_STATE);
   coder_nf_state.indent();
-  coder_nf_state << "struct TokenBucket *";
+  coder_nf_state << state_qualifier() << "struct TokenBucket *";
   coder_nf_state << tb_out_var.name;
   coder_nf_state << ";\n";
 
@@ -1652,6 +2063,39 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::tb_allocate(coder_t &coder,
   return success_var;
 }
 
+BDDSynthesizer::success_condition_t BDDSynthesizer::hhh_allocate(coder_t &coder, const Call *call_node) {
+  const call_t &call = call_node->get_call();
+
+  klee::ref<klee::Expr> capacity     = call.args.at("capacity").expr;
+  klee::ref<klee::Expr> subnets_mask = call.args.at("subnets_mask").expr;
+  klee::ref<klee::Expr> rate         = call.args.at("rate").expr;
+  klee::ref<klee::Expr> burst        = call.args.at("burst").expr;
+  klee::ref<klee::Expr> hhh_out      = call.args.at("hhh_out").out;
+  symbol_t success                   = call_node->get_local_symbol("hhh_allocation_succeeded");
+
+  var_t hhh_out_var = build_var("hhh", hhh_out);
+  var_t success_var = build_var("hhh_allocation_succeeded", success.expr);
+
+  coder_t &coder_nf_state = code_template.get(MARKER_NF_STATE);
+  coder_nf_state.indent();
+  coder_nf_state << state_qualifier() << "struct HHH *";
+  coder_nf_state << hhh_out_var.name;
+  coder_nf_state << ";\n";
+
+  coder.indent();
+  coder << "hhh_allocate(";
+  coder << transpiler.transpile(capacity) << ", ";
+  coder << transpiler.transpile(subnets_mask) << ", ";
+  coder << transpiler.transpile(rate) << "ull, ";
+  coder << transpiler.transpile(burst) << "ull, ";
+  coder << "&" << hhh_out_var.name;
+  coder << ");\n";
+
+  stack_add(hhh_out_var);
+
+  return success_var;
+}
+
 BDDSynthesizer::success_condition_t BDDSynthesizer::lpm_allocate(coder_t &coder, const Call *call_node) {
   const call_t &call = call_node->get_call();
 
@@ -1663,7 +2107,7 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::lpm_allocate(coder_t &coder,
 
   coder_t &coder_nf_state = code_template.get(MARKER_NF_STATE);
   coder_nf_state.indent();
-  coder_nf_state << "struct LPM *";
+  coder_nf_state << state_qualifier() << "struct LPM *";
   coder_nf_state << lpm_out_var.name;
   coder_nf_state << ";\n";
 
@@ -1802,6 +2246,69 @@ BDDSynthesizer::success_condition_t BDDSynthesizer::tb_expire(coder_t &coder, co
   return {};
 }
 
+BDDSynthesizer::success_condition_t BDDSynthesizer::hhh_update(coder_t &coder, const Call *call_node) {
+  const call_t &call = call_node->get_call();
+
+  klee::ref<klee::Expr> hhh_addr          = call.args.at("hhh").expr;
+  klee::ref<klee::Expr> addr              = call.args.at("addr").expr;
+  klee::ref<klee::Expr> pkt_len           = call.args.at("pkt_len").expr;
+  klee::ref<klee::Expr> time              = call.args.at("time").expr;
+  klee::ref<klee::Expr> hh_out            = call.args.at("hh_out").out;
+  klee::ref<klee::Expr> hh_prefix_len_out = call.args.at("hh_prefix_len_out").out;
+  klee::ref<klee::Expr> hh_detected       = call.ret;
+
+  var_t detected   = build_var("hh_detected", hh_detected);
+  var_t hh         = build_var("hh", hh_out);
+  var_t prefix_len = build_var("hh_prefix_len", hh_prefix_len_out);
+
+  coder.indent();
+  coder << "uint32_t " << hh.name << ";\n";
+
+  coder.indent();
+  coder << "uint8_t " << prefix_len.name << ";\n";
+
+  coder.indent();
+  coder << "int " << detected.name << " = ";
+  coder << "hhh_update(";
+  coder << stack_get(hhh_addr).name << ", ";
+  coder << transpiler.transpile(addr) << ", ";
+  coder << transpiler.transpile(pkt_len) << ", ";
+  coder << transpiler.transpile(time) << ", ";
+  coder << "&" << hh.name << ", ";
+  coder << "&" << prefix_len.name;
+  coder << ")";
+  coder << ";\n";
+
+  stack_add(detected);
+  stack_add(hh);
+  stack_add(prefix_len);
+
+  return detected;
+}
+
+BDDSynthesizer::success_condition_t BDDSynthesizer::hhh_expire(coder_t &coder, const Call *call_node) {
+  const call_t &call = call_node->get_call();
+
+  klee::ref<klee::Expr> hhh_addr = call.args.at("hhh").expr;
+  klee::ref<klee::Expr> time     = call.args.at("time").expr;
+
+  symbol_t number_of_freed_flows = call_node->get_local_symbol("number_of_freed_flows");
+
+  var_t nfreed = build_var("freed_flows", number_of_freed_flows.expr);
+
+  coder.indent();
+  coder << "int " << nfreed.name << " = ";
+  coder << "hhh_expire(";
+  coder << stack_get(hhh_addr).name << ", ";
+  coder << transpiler.transpile(time);
+  coder << ")";
+  coder << ";\n";
+
+  stack_add(nfreed);
+
+  return {};
+}
+
 BDDSynthesizer::success_condition_t BDDSynthesizer::lpm_lookup(coder_t &coder, const Call *call_node) {
   const call_t &call = call_node->get_call();
 
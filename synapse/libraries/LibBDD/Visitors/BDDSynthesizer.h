@@ -100,11 +100,30 @@ private:
   std::vector<stack_frame_t> stack;
   std::unordered_map<std::string, int> reserved_var_names;
 
+  // Relevant for the multi-core NF runtime: which fields RSS hashes on. Unless it is None, every lcore gets its own replica of the NF state.
+  enum class RSSMode { None, IPv4, IPv4TcpUdp };
+  RSSMode rss_mode;
+
+  // Relevant for the NF's burst processing: the map lookup nf_process_burst resolves for every packet of a burst before processing them, the
+  // packet offset of each of its key bytes, and the expirations preceding it (run once per burst instead of once per packet).
+  const Call *burst_lookup;
+  std::vector<bytes_t> burst_key_offsets;
+  std::vector<const Call *> burst_expirations;
+
   // Relevant for profiling
   std::unordered_map<bdd_node_id_t, klee::ref<klee::Expr>> nodes_to_map;
   std::unordered_set<bdd_node_id_t> route_nodes;
   std::unordered_set<bdd_node_id_t> process_nodes;
 
+  void init_rss();
+  RSSMode find_rss_mode(std::string &reason) const;
+  code_t state_qualifier() const;
+
+  void init_burst();
+  const Call *find_burst_lookup(std::vector<bytes_t> &key_offsets) const;
+  void process_burst();
+  void mark_burst_dirty(coder_t &coder, klee::ref<klee::Expr> map_addr, const std::string &condition);
+
   void init_pre_process();
   void process();
   void init_post_process();
@@ -117,6 +136,7 @@ private:
   success_condition_t dchain_allocate(coder_t &, const Call *);
   success_condition_t cms_allocate(coder_t &, const Call *);
   success_condition_t tb_allocate(coder_t &, const Call *);
+  success_condition_t hhh_allocate(coder_t &, const Call *);
   success_condition_t lpm_allocate(coder_t &, const Call *);
 
   success_condition_t packet_borrow_next_chunk(coder_t &, const Call *);
@@ -144,6 +164,8 @@ private:
   success_condition_t tb_trace(coder_t &, const Call *);
   success_condition_t tb_update_and_check(coder_t &, const Call *);
   success_condition_t tb_expire(coder_t &, const Call *);
+  success_condition_t hhh_update(coder_t &, const Call *);
+  success_condition_t hhh_expire(coder_t &, const Call *);
   success_condition_t lpm_lookup(coder_t &, const Call *);
   success_condition_t lpm_update(coder_t &, const Call *);
   success_condition_t lpm_from_file(coder_t &, const Call *);
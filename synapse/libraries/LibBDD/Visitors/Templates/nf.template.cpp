@@ -7,6 +7,7 @@ extern "C" {
 #include <lib/state/cht.h>
 #include <lib/state/cms.h>
 #include <lib/state/token-bucket.h>
+#include <lib/state/hhh.h>
 #include <lib/state/lpm-dir-24-8.h>
 
 #include <lib/util/hash.h>
@@ -45,6 +46,17 @@ extern "C" {
 #endif // ENABLE_LOG
 
 #define BATCH_SIZE 32
+
+// Left undefined, expirations erase every stale flow, just like the original NF. Defining it caps the flows a single
+// expiration (per packet, or per burst) erases, leaving the rest for the next ones, which keeps churn from stalling
+// packets. That diverges from the original NF: a flow still waiting to be erased is found by its next packet and
+// rejuvenated, and a full table keeps dropping new flows until enough stale ones are gone.
+#ifdef NF_EXPIRATION_BUDGET
+#define nf_expire_items_single_map(chain, vector, map, time)                                                           \
+  expire_items_single_map_bounded(chain, vector, map, time, NF_EXPIRATION_BUDGET)
+#else
+#define nf_expire_items_single_map(chain, vector, map, time) expire_items_single_map(chain, vector, map, time)
+#endif
 #define MAX_NUM_DEVICES 32 // this is quite arbitrary...
 
 #define DROP ((uint16_t)-1)
@@ -55,8 +67,16 @@ static const uint16_t TX_QUEUE_SIZE = 1024;
 
 static const unsigned MEMPOOL_BUFFER_COUNT = 2048;
 
+// Symmetric RSS key (0x6d5a repeated): both directions of a flow hash to the same queue.
+static const uint8_t RSS_KEY_BYTE_0 = 0x6d;
+static const uint8_t RSS_KEY_BYTE_1 = 0x5a;
+#define RSS_KEY_MAX_SIZE 64
+
+/*@{NF_RSS}@*/
+
 bool nf_init();
 int nf_process(uint16_t device, uint8_t *buffer, uint16_t packet_length, time_ns_t now);
+void nf_process_burst(uint16_t device, uint8_t **buffers, uint16_t *packet_lengths, uint16_t count, time_ns_t now, uint16_t *dst_devices);
 
 // Send the given packet to all devices except the packet's own
 void flood(struct rte_mbuf *packet, uint16_t nb_devices, uint16_t queue_id) {
@@ -76,30 +96,61 @@ void flood(struct rte_mbuf *packet, uint16_t nb_devices, uint16_t queue_id) {
   }
 }
 
-// Initializes the given device using the given memory pool
-static int nf_init_device(uint16_t device, struct rte_mempool *mbuf_pool) {
+// Initializes the given device with one RX/TX queue per lcore, each queue using its lcore's memory pool
+static int nf_init_device(uint16_t device, uint16_t nb_queues, struct rte_mempool **mbuf_pools) {
   int retval;
 
   // device_conf passed to rte_eth_dev_configure cannot be NULL
   struct rte_eth_conf device_conf = {0};
   // device_conf.rxmode.hw_strip_crc = 1;
 
-  // Configure the device (1, 1 == number of RX/TX queues)
-  retval = rte_eth_dev_configure(device, 1, 1, &device_conf);
-  if (retval != 0) {
-    return retval;
+  static uint8_t rss_key[RSS_KEY_MAX_SIZE];
+
+  if (nb_queues > 1) {
+    struct rte_eth_dev_info dev_info;
+    retval = rte_eth_dev_info_get(device, &dev_info);
+    if (retval != 0) {
+      return retval;
+    }
+
+    // Hashing on fewer fields than requested would split flows (and their state) across lcores.
+    if ((dev_info.flow_type_rss_offloads & NF_RSS_HF) != NF_RSS_HF) {
+      return -ENOTSUP;
+    }
+
+    uint8_t rss_key_size = dev_info.hash_key_size > 0 ? dev_info.hash_key_size : 40;
+    if (rss_key_size > RSS_KEY_MAX_SIZE) {
+      return -ENOTSUP;
+    }
+
+    for (uint8_t i = 0; i < rss_key_size; i++) {
+      rss_key[i] = (i % 2 == 0) ? RSS_KEY_BYTE_0 : RSS_KEY_BYTE_1;
+    }
+
+    device_conf.rxmode.mq_mode                   = RTE_ETH_MQ_RX_RSS;
+    device_conf.rx_adv_conf.rss_conf.rss_key     = rss_key;
+    device_conf.rx_adv_conf.rss_conf.rss_key_len = rss_key_size;
+    device_conf.rx_adv_conf.rss_conf.rss_hf      = NF_RSS_HF;
   }
 
-  // Allocate and set up a TX queue (NULL == default config)
-  retval = rte_eth_tx_queue_setup(device, 0, TX_QUEUE_SIZE, rte_eth_dev_socket_id(device), NULL);
+  // Configure the device (nb_queues RX and TX queues)
+  retval = rte_eth_dev_configure(device, nb_queues, nb_queues, &device_conf);
   if (retval != 0) {
     return retval;
   }
 
-  // Allocate and set up RX queues (NULL == default config)
-  retval = rte_eth_rx_queue_setup(device, 0, RX_QUEUE_SIZE, rte_eth_dev_socket_id(device), NULL, mbuf_pool);
-  if (retval != 0) {
-    return retval;
+  for (uint16_t queue = 0; queue < nb_queues; queue++) {
+    // Allocate and set up a TX queue (NULL == default config)
+    retval = rte_eth_tx_queue_setup(device, queue, TX_QUEUE_SIZE, rte_eth_dev_socket_id(device), NULL);
+    if (retval != 0) {
+      return retval;
+    }
+
+    // Allocate and set up an RX queue (NULL == default config)
+    retval = rte_eth_rx_queue_setup(device, queue, RX_QUEUE_SIZE, rte_eth_dev_socket_id(device), NULL, mbuf_pools[queue]);
+    if (retval != 0) {
+      return retval;
+    }
   }
 
   retval = rte_eth_dev_start(device);
@@ -115,12 +166,15 @@ static int nf_init_device(uint16_t device, struct rte_mempool *mbuf_pool) {
   return 0;
 }
 
-static void worker_main(void) {
+// Runs on every lcore, each one polling its own queue on all devices. When the NF state is sharded, nf_init() builds this lcore's replica.
+static int worker_main(void *arg) {
+  uint16_t queue_id = (uint16_t)(uintptr_t)arg;
+
   if (!nf_init()) {
     rte_exit(EXIT_FAILURE, "Error initializing NF");
   }
 
-  NF_INFO("Core %u forwarding packets.", rte_lcore_id());
+  NF_INFO("Core %u forwarding packets (queue %u).", rte_lcore_id(), queue_id);
 
   struct tx_mbuf_batch {
     struct rte_mbuf *batch[BATCH_SIZE];
@@ -128,21 +182,36 @@ static void worker_main(void) {
   };
 
   uint16_t devices_count                  = rte_eth_dev_count_avail();
-  struct tx_mbuf_batch *tx_batch_per_port = (struct tx_mbuf_batch *)calloc(devices_count, sizeof(struct tx_mbuf_batch));
+  struct tx_mbuf_batch *tx_batch_per_port = (struct tx_mbuf_batch *)rte_zmalloc_socket(
+      "tx_batch_per_port", devices_count * sizeof(struct tx_mbuf_batch), RTE_CACHE_LINE_SIZE, rte_socket_id());
 
   while (1) {
     for (uint16_t device = 0; device < devices_count; device++) {
       struct rte_mbuf *mbufs[BATCH_SIZE];
-      uint16_t rx_count = rte_eth_rx_burst(device, 0, mbufs, BATCH_SIZE);
+      uint16_t rx_count = rte_eth_rx_burst(device, queue_id, mbufs, BATCH_SIZE);
+
+      if (rx_count == 0) {
+        continue;
+      }
+
+      uint8_t *buffers[BATCH_SIZE];
+      uint16_t packet_lengths[BATCH_SIZE];
+      uint16_t dst_devices[BATCH_SIZE];
 
       for (uint16_t n = 0; n < rx_count; n++) {
-        uint8_t *data = rte_pktmbuf_mtod(mbufs[n], uint8_t *);
-        packet_state_total_length(data, &(mbufs[n]->pkt_len));
-        time_ns_t now       = current_time();
-        uint16_t dst_device = nf_process(mbufs[n]->port, data, mbufs[n]->pkt_len, now);
+        buffers[n]        = rte_pktmbuf_mtod(mbufs[n], uint8_t *);
+        packet_lengths[n] = mbufs[n]->pkt_len;
+      }
+
+      nf_process_burst(device, buffers, packet_lengths, rx_count, current_time(), dst_devices);
+
+      for (uint16_t n = 0; n < rx_count; n++) {
+        uint16_t dst_device = dst_devices[n];
 
         if (dst_device == DROP) {
           rte_pktmbuf_free(mbufs[n]);
+        } else if (dst_device == FLOOD) {
+          flood(mbufs[n], devices_count, queue_id);
         } else {
           uint16_t tx_count                             = tx_batch_per_port[dst_device].tx_count;
           tx_batch_per_port[dst_device].batch[tx_count] = mbufs[n];
@@ -151,15 +220,18 @@ static void worker_main(void) {
       }
 
       for (uint16_t dst_device = 0; dst_device < devices_count; dst_device++) {
-        uint16_t sent_count = rte_eth_tx_burst(dst_device, 0, tx_batch_per_port[dst_device].batch, tx_batch_per_port[dst_device].tx_count);
+        uint16_t sent_count =
+            rte_eth_tx_burst(dst_device, queue_id, tx_batch_per_port[dst_device].batch, tx_batch_per_port[dst_device].tx_count);
         for (uint16_t n = sent_count; n < tx_batch_per_port[dst_device].tx_count; n++) {
-          rte_pktmbuf_free(mbufs[n]); // should not happen, but we're in
-                                      // the unverified case anyway
+          rte_pktmbuf_free(tx_batch_per_port[dst_device].batch[n]); // should not happen, but we're in
+                                                                    // the unverified case anyway
         }
         tx_batch_per_port[dst_device].tx_count = 0;
       }
     }
   }
+
+  return 0;
 }
 
 int main(int argc, char **argv) {
@@ -171,20 +243,46 @@ int main(int argc, char **argv) {
   argv += ret;
 
   unsigned nb_devices = rte_eth_dev_count_avail();
-  struct rte_mempool *mbuf_pool =
-      rte_pktmbuf_pool_create("MEMPOOL",                         // name
-                              MEMPOOL_BUFFER_COUNT * nb_devices, // #elements
-                              0,                         // cache size (per-core, not useful in a single-threaded app)
-                              0,                         // application private area size
-                              RTE_MBUF_DEFAULT_BUF_SIZE, // data buffer size
-                              rte_socket_id()            // socket ID
-      );
-  if (mbuf_pool == NULL) {
-    rte_exit(EXIT_FAILURE, "Cannot create pool: %s\n", rte_strerror(rte_errno));
+
+  // One queue per lcore, but only if RSS keeps every flow (and thus its state) on a single lcore.
+  uint16_t nb_queues = NF_RSS_HF != 0 ? rte_lcore_count() : 1;
+  if (nb_queues == 1 && rte_lcore_count() > 1) {
+    NF_INFO("NF state cannot be sharded across lcores, running on a single lcore.");
+  }
+
+  unsigned lcore_per_queue[RTE_MAX_LCORE];
+  struct rte_mempool *mbuf_pools[RTE_MAX_LCORE];
+
+  uint16_t queue           = 0;
+  lcore_per_queue[queue++] = rte_get_main_lcore();
+
+  unsigned lcore_id;
+  RTE_LCORE_FOREACH_WORKER(lcore_id) {
+    if (queue == nb_queues) {
+      break;
+    }
+    lcore_per_queue[queue++] = lcore_id;
+  }
+
+  for (queue = 0; queue < nb_queues; queue++) {
+    char pool_name[RTE_MEMPOOL_NAMESIZE];
+    snprintf(pool_name, sizeof(pool_name), "MEMPOOL_%u", queue);
+
+    // Each lcore allocates from and frees to its own pool, so no (per-core) cache is needed.
+    mbuf_pools[queue] = rte_pktmbuf_pool_create(pool_name,                                     // name
+                                                MEMPOOL_BUFFER_COUNT * nb_devices,             // #elements
+                                                0,                                             // cache size
+                                                0,                                             // application private area size
+                                                RTE_MBUF_DEFAULT_BUF_SIZE,                     // data buffer size
+                                                rte_lcore_to_socket_id(lcore_per_queue[queue]) // socket ID
+    );
+    if (mbuf_pools[queue] == NULL) {
+      rte_exit(EXIT_FAILURE, "Cannot create pool: %s\n", rte_strerror(rte_errno));
+    }
   }
 
   for (uint16_t device = 0; device < nb_devices; device++) {
-    ret = nf_init_device(device, mbuf_pool);
+    ret = nf_init_device(device, nb_queues, mbuf_pools);
     if (ret == 0) {
       NF_INFO("Initialized device %" PRIu16 ".", device);
     } else {
@@ -192,7 +290,12 @@ int main(int argc, char **argv) {
     }
   }
 
-  worker_main();
+  for (queue = 1; queue < nb_queues; queue++) {
+    rte_eal_remote_launch(worker_main, (void *)(uintptr_t)queue, lcore_per_queue[queue]);
+  }
+
+  worker_main((void *)(uintptr_t)0);
+  rte_eal_mp_wait_lcore();
 
   return 0;
 }
@@ -201,4 +304,6 @@ int main(int argc, char **argv) {
 
 /*@{NF_INIT}@*/
 
-/*@{NF_PROCESS}@*/
\ No newline at end of file
+/*@{NF_PROCESS}@*/
+
+/*@{NF_BURST}@*/
\ No newline at end of file
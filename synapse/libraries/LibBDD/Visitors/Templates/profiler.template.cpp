@@ -7,6 +7,7 @@ extern "C" {
 #include <lib/state/cht.h>
 #include <lib/state/cms.h>
 #include <lib/state/token-bucket.h>
+#include <lib/state/hhh.h>
 #include <lib/state/lpm-dir-24-8.h>
 
 #include <lib/util/hash.h>
@@ -31,14 +32,18 @@ extern "C" {
 #include <rte_random.h>
 #include <rte_hash_crc.h>
 
-#include <pcap.h>
 #include <cstdbool>
 #include <unistd.h>
 
 #include <fstream>
 #include <filesystem>
 #include <nlohmann/json.hpp>
+#include <LibCore/MappedPcap.h>
 #include <vector>
+#include <queue>
+#include <array>
+#include <algorithm>
+#include <chrono>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -116,36 +121,39 @@ struct config_t {
   std::vector<dev_pcap_t> pcaps;
 } config;
 
-struct pcap_data_t {
-  const uint8_t *data;
-  const struct pcap_pkthdr *header;
-};
-
 struct next_packet_t {
-  uint16_t device;
-  pkt_t pkt;
+  // Devices this packet is replayed on.
+  const std::vector<uint16_t> *devices;
+  // Points straight into the mmap'ed pcap.
+  const uint8_t *data;
+  uint32_t caplen;
+  uint32_t len;
+  time_ns_t ts;
+  bool assume_ip;
 };
 
 struct pcap_info_t {
-  pcap_t* pcap;
+  LibCore::MappedPcap pcap;
   bool assume_ip;
-  long start_offset;
-  uint64_t total_packets;
-  uint64_t total_bytes;
-  pkt_t first_packet;
-  std::unordered_set<uint16_t> devices;
+  std::vector<uint16_t> devices;
+  LibCore::MappedPcap::packet_t pending_pkt;
+
+  pcap_info_t(const std::filesystem::path &fname)
+      : pcap(fname), assume_ip(pcap.get_link_type() == LibCore::MappedPcap::LinkType::RawIP) {}
 };
 
 class PcapReader {
 private:
-  std::unordered_map<std::string, pcap_t*> fname_to_pcap;
-  std::unordered_map<pcap_t*, pcap_info_t> pcap_infos;
-  std::map<pcap_t *, pkt_t> pending_pkts_per_pcap;
-  int64_t last_ts;
-  
+  std::unordered_map<std::string, size_t> fname_to_pcap;
+  std::vector<pcap_info_t> pcaps;
+
+  // K-way merge of the pcaps: min-heap of (timestamp of the pending packet, pcap index), ties going to the pcap given first.
+  using pending_t = std::pair<time_ns_t, size_t>;
+  std::priority_queue<pending_t, std::vector<pending_t>, std::greater<pending_t>> pending_pkts;
+
   // Meta
-  uint64_t total_packets;
-  uint64_t total_bytes;
+  uint64_t total_file_bytes;
+  uint64_t read_file_bytes;
   uint64_t processed_packets;
   uint64_t processed_bytes;
   int last_percentage_report;
@@ -157,163 +165,78 @@ public:
   uint64_t get_processed_bytes() { return processed_bytes; }
 
   void setup(const std::vector<dev_pcap_t> &_pcaps) {
-    last_ts                = -1;
-    total_packets          = 0;
-    total_bytes            = 0;
+    total_file_bytes       = 0;
+    read_file_bytes        = 0;
     processed_packets      = 0;
+    processed_bytes        = 0;
     last_percentage_report = -1;
 
     for (const auto &dev_pcap : _pcaps) {
       auto fname_to_pcap_it = fname_to_pcap.find(dev_pcap.pcap.string());
       if (fname_to_pcap_it != fname_to_pcap.end()) {
-        pcap_t* pcap = fname_to_pcap_it->second;
-        pcap_infos[pcap].devices.insert(dev_pcap.device);
+        std::vector<uint16_t> &devices = pcaps[fname_to_pcap_it->second].devices;
+        if (std::find(devices.begin(), devices.end(), dev_pcap.device) == devices.end()) {
+          devices.push_back(dev_pcap.device);
+        }
         continue;
       }
 
-      char errbuf[PCAP_ERRBUF_SIZE];
-      pcap_t* pcap = pcap_open_offline(dev_pcap.pcap.c_str(), errbuf);
-
-      fname_to_pcap[dev_pcap.pcap.string()] = pcap;
-      pcap_infos[pcap] = pcap_info_t();
-
-      pcap_info_t &pcap_info = pcap_infos.at(pcap);
-
-      pcap_info.pcap = pcap;
-      pcap_info.devices.insert(dev_pcap.device);
-
-      if (pcap_info.pcap == NULL) {
-        rte_exit(EXIT_FAILURE, "pcap_open_offline() failed: %s\n", errbuf);
-      }
-
-      int link_hdr_type = pcap_datalink(pcap_info.pcap);
-
-      switch (link_hdr_type) {
-      case DLT_EN10MB:
-        // Normal ethernet, as expected.
-        pcap_info.assume_ip = false;
-        break;
-      case DLT_RAW:
-        // Contains raw IP packets.
-        pcap_info.assume_ip = true;
-        break;
-      default: {
-        fprintf(stderr, "Unknown header type (%d)", link_hdr_type);
-        exit(1);
-      }
-      }
-
-      FILE *pcap_fptr = pcap_file(pcap_info.pcap);
-      assert(pcap_fptr && "Invalid pcap file pointer");
-      pcap_info.start_offset = ftell(pcap_fptr);
+      fname_to_pcap[dev_pcap.pcap.string()] = pcaps.size();
+      pcaps.emplace_back(dev_pcap.pcap);
+      pcaps.back().devices.push_back(dev_pcap.device);
 
-      pcap_info.total_packets = 0;
-      pcap_info.total_bytes   = 0;
-
-      pkt_t pkt;
-      while (read(pcap_info.pcap, pkt)) {
-        if (pcap_info.total_packets == 0) {
-          pcap_info.first_packet = pkt;
-        }
-
-        pcap_info.total_packets++;
-        pcap_info.total_bytes += pkt.len + CRC_SIZE_BYTES;
-      }
-      
-      total_packets += pcap_info.total_packets;
-      total_bytes += pcap_info.total_bytes;
-
-      pending_pkts_per_pcap[pcap_info.pcap] = pcap_info.first_packet;
+      total_file_bytes += pcaps.back().pcap.get_size();
     }
-  }
 
-  std::vector<next_packet_t> get_next_packets() {
-    int64_t ts = -1;
-    for (const auto& [pending_pcap, pending_pkt] : pending_pkts_per_pcap) {
-      if (ts == -1 || pending_pkt.ts < ts) {
-        ts = pending_pkt.ts;
-      }
+    // No need to go through the pcaps beforehand: progress is tracked by how much of the files was already consumed.
+    for (size_t i = 0; i < pcaps.size(); i++) {
+      fetch(i);
     }
+  }
 
-    if (ts == -1) {
-      return {};
+  // The packet data stays valid for as long as the reader lives.
+  bool get_next_packet(next_packet_t &next_pkt) {
+    if (pending_pkts.empty()) {
+      return false;
     }
 
-    pcap_t* chosen_pcap = nullptr;
-    std::vector<next_packet_t> next_packets;
-    for (const auto& [pending_pcap, pending_pkt] : pending_pkts_per_pcap) {
-      if (pending_pkt.ts != ts) {
-        continue;
-      }
-
-      for (uint16_t dev : pcap_infos[pending_pcap].devices) {
-        next_packet_t next_pkt = {
-          .device = dev,
-          .pkt = pending_pkt
-        };
-        next_packets.push_back(next_pkt);
+    size_t i = pending_pkts.top().second;
+    pending_pkts.pop();
 
-        processed_packets += 1;
-        processed_bytes += pending_pkt.len + CRC_SIZE_BYTES;
-      }
+    const pcap_info_t &pcap_info                 = pcaps[i];
+    const LibCore::MappedPcap::packet_t &raw_pkt = pcap_info.pending_pkt;
 
-      chosen_pcap = pending_pcap;
-      break;
-    }
+    next_pkt.devices   = &pcap_info.devices;
+    next_pkt.data      = raw_pkt.data;
+    next_pkt.caplen    = raw_pkt.caplen;
+    next_pkt.len       = raw_pkt.len + (pcap_info.assume_ip ? sizeof(struct rte_ether_hdr) : 0);
+    next_pkt.ts        = raw_pkt.ts;
+    next_pkt.assume_ip = pcap_info.assume_ip;
 
-    last_ts = ts;
+    processed_packets += pcap_info.devices.size();
+    processed_bytes += (next_pkt.len + CRC_SIZE_BYTES) * pcap_info.devices.size();
 
+    fetch(i);
     show_progress();
 
-    pkt_t new_pkt;
-    if (read(chosen_pcap, new_pkt)) {
-      pending_pkts_per_pcap[chosen_pcap] = new_pkt;
-    } else {
-      pending_pkts_per_pcap.erase(chosen_pcap);
-    }
-
-    return next_packets;
+    return true;
   }
 
 private:
-  bool read(pcap_t* pcap, pkt_t &pkt) {
-    const uint8_t *data;
-    struct pcap_pkthdr *hdr;
-
-    if (pcap_next_ex(pcap, &hdr, &data) != 1) {
-      rewind(pcap);
-      return false;
-    }
-
-    uint8_t *pkt_data = pkt.data;
+  void fetch(size_t i) {
+    pcap_info_t &pcap_info = pcaps[i];
 
-    pkt.len = hdr->len;
+    size_t offset = pcap_info.pcap.get_offset();
+    bool fetched  = pcap_info.pcap.next(pcap_info.pending_pkt);
+    read_file_bytes += pcap_info.pcap.get_offset() - offset;
 
-    if (pcap_infos.at(pcap).assume_ip) {
-      struct rte_ether_hdr *eth_hdr = (struct rte_ether_hdr *)pkt_data;
-      nf_parse_etheraddr(DEFAULT_DST_MAC, &eth_hdr->dst_addr);
-      nf_parse_etheraddr(DEFAULT_SRC_MAC, &eth_hdr->src_addr);
-      eth_hdr->ether_type = rte_bswap16(RTE_ETHER_TYPE_IPV4);
-      pkt_data += sizeof(struct rte_ether_hdr);
-      pkt.len += sizeof(struct rte_ether_hdr);
+    if (fetched) {
+      pending_pkts.emplace(pcap_info.pending_pkt.ts, i);
     }
-
-    memcpy(pkt_data, data, hdr->caplen);
-    pkt.ts  = hdr->ts.tv_sec * 1e9 + hdr->ts.tv_usec * 1e3;
-
-    return true;
-  }
-
-  // WARNING: this does not work on windows!
-  // https://winpcap-users.winpcap.narkive.com/scCKD3x2/packet-random-access-using-file-seek
-  void rewind(pcap_t* pcap) {
-    long pcap_start = pcap_infos.at(pcap).start_offset;
-    FILE *pcap_fptr = pcap_file(pcap);
-    fseek(pcap_fptr, pcap_start, SEEK_SET);
   }
 
   void show_progress() {
-    int progress = 100.0 * processed_packets / total_packets;
+    int progress = pending_pkts.empty() ? 100 : 100.0 * read_file_bytes / total_file_bytes;
 
     if (progress <= last_percentage_report) {
       return;
@@ -327,6 +250,30 @@ private:
   }
 };
 
+// NFs are free to rewrite the packet, so every device it is replayed on gets its own pristine copy.
+void load_packet(const next_packet_t &next_pkt, pkt_t &pkt) {
+  static const struct rte_ether_hdr raw_ip_ether_hdr = [] {
+    struct rte_ether_hdr hdr;
+    nf_parse_etheraddr(DEFAULT_DST_MAC, &hdr.dst_addr);
+    nf_parse_etheraddr(DEFAULT_SRC_MAC, &hdr.src_addr);
+    hdr.ether_type = rte_bswap16(RTE_ETHER_TYPE_IPV4);
+    return hdr;
+  }();
+
+  uint8_t *pkt_data = pkt.data;
+
+  pkt.len = next_pkt.len;
+  pkt.ts  = next_pkt.ts;
+
+  if (next_pkt.assume_ip) {
+    memcpy(pkt_data, &raw_ip_ether_hdr, sizeof(raw_ip_ether_hdr));
+    pkt_data += sizeof(raw_ip_ether_hdr);
+  }
+
+  uint32_t room = sizeof(pkt.data) - (pkt_data - pkt.data);
+  memcpy(pkt_data, next_pkt.data, std::min(next_pkt.caplen, room));
+}
+
 void nf_log_pkt(time_ns_t time, uint16_t device, uint8_t *packet, uint16_t packet_length) {
   struct rte_ether_hdr *rte_ether_header = (struct rte_ether_hdr *)(packet);
   struct rte_ipv4_hdr *rte_ipv4_header   = (struct rte_ipv4_hdr *)(packet + sizeof(struct rte_ether_hdr));
@@ -403,54 +350,179 @@ int profiler_expire_items_single_map(struct DoubleChain *dchain, struct Vector *
   return 0;
 }
 
-struct Stats {
-  struct key_t {
-    uint8_t *data;
+// Open-addressing (linear probing) counter of map keys, built for the per-packet path.
+// Keys up to INLINE_KEY_BYTES live inside the slot itself, longer ones are copied once into an append-only arena. Counting a key that was
+// already seen never allocates. Each slot also keeps the key's CRC32, which doubles as the table hash.
+class KeyCounter {
+public:
+  static constexpr const uint32_t INLINE_KEY_BYTES = 16;
+
+private:
+  static constexpr const size_t INITIAL_CAPACITY = 64;
+
+  struct slot_t {
+    uint64_t count; // 0 marks an empty slot.
+    uint32_t crc32;
     uint32_t len;
+    union {
+      uint8_t bytes[INLINE_KEY_BYTES];
+      size_t arena_offset;
+    } key;
+  };
+
+  std::vector<slot_t> slots;
+  std::vector<uint8_t> arena;
+  size_t num_keys;
+  uint32_t shift;
+
+public:
+  KeyCounter() : slots(INITIAL_CAPACITY), num_keys(0), shift(32 - __builtin_ctzll(INITIAL_CAPACITY)) {}
+
+  size_t size() const { return num_keys; }
 
-    key_t(const uint8_t *_data, uint32_t _len) : len(_len) {
-      data = new uint8_t[len];
-      memcpy(data, _data, len);
+  void inc(const uint8_t *key, uint32_t len, uint32_t crc32) {
+    const size_t capacity_mask = slots.size() - 1;
+
+    for (size_t i = index(crc32);; i = (i + 1) & capacity_mask) {
+      slot_t &slot = slots[i];
+
+      if (slot.count == 0) {
+        slot.count = 1;
+        slot.crc32 = crc32;
+        slot.len   = len;
+
+        if (len <= INLINE_KEY_BYTES) {
+          memcpy(slot.key.bytes, key, len);
+        } else {
+          slot.key.arena_offset = arena.size();
+          arena.insert(arena.end(), key, key + len);
+        }
+
+        // Keep the load factor under 3/4.
+        if (++num_keys * 4 > slots.size() * 3) {
+          grow();
+        }
+
+        return;
+      }
+
+      if (matches(slot, key, len, crc32)) {
+        slot.count++;
+        return;
+      }
     }
+  }
+
+  bool contains(const uint8_t *key, uint32_t len, uint32_t crc32) const {
+    const size_t capacity_mask = slots.size() - 1;
 
-    key_t(const key_t &other) : len(other.len) {
-      data = new uint8_t[len];
-      memcpy(data, other.data, len);
+    for (size_t i = index(crc32); slots[i].count != 0; i = (i + 1) & capacity_mask) {
+      if (matches(slots[i], key, len, crc32)) {
+        return true;
+      }
     }
 
-    bool operator==(const key_t &other) const { return len == other.len && memcmp(data, other.data, len) == 0; }
+    return false;
+  }
 
-    ~key_t() { delete[] data; }
-  };
+  // fn(const uint8_t *key, uint32_t len, uint32_t crc32, uint64_t count)
+  template <typename F> void for_each(F &&fn) const {
+    for (const slot_t &slot : slots) {
+      if (slot.count != 0) {
+        fn(get_key(slot), slot.len, slot.crc32, slot.count);
+      }
+    }
+  }
 
-  struct KeyHasher {
-    std::size_t operator()(const key_t &key) const { return hash_obj((void *)key.data, key.len); }
-  };
+private:
+  // Fibonacci hashing: take the top bits of the multiplied CRC.
+  size_t index(uint32_t crc32) const { return (uint32_t)(crc32 * 0x9e3779b1u) >> shift; }
 
-  std::unordered_map<key_t, uint64_t, KeyHasher> key_counter;
-  std::unordered_map<uint32_t, std::unordered_set<uint32_t>> mask_to_crc32;
-  uint64_t total_count;
+  const uint8_t *get_key(const slot_t &slot) const {
+    return slot.len <= INLINE_KEY_BYTES ? slot.key.bytes : arena.data() + slot.key.arena_offset;
+  }
+
+  bool matches(const slot_t &slot, const uint8_t *key, uint32_t len, uint32_t crc32) const {
+    return slot.crc32 == crc32 && slot.len == len && memcmp(get_key(slot), key, len) == 0;
+  }
 
-  Stats() : total_count(0) {
-    uint32_t mask = 0;
-    while (1) {
-      mask                = (mask << 1) | 1;
-      mask_to_crc32[mask] = {};
-      if (mask == 0xffffffff) {
-        break;
+  void grow() {
+    std::vector<slot_t> old_slots(slots.size() * 2);
+    old_slots.swap(slots);
+    shift--;
+
+    const size_t capacity_mask = slots.size() - 1;
+
+    // Keys are unique and their CRCs already computed, so no comparisons are needed when rehashing.
+    for (const slot_t &slot : old_slots) {
+      if (slot.count == 0) {
+        continue;
       }
+
+      size_t i = index(slot.crc32);
+      while (slots[i].count != 0) {
+        i = (i + 1) & capacity_mask;
+      }
+
+      slots[i] = slot;
     }
   }
+};
+
+struct Stats {
+  KeyCounter key_counter;
+  uint64_t total_count;
+
+  Stats() : total_count(0) {}
 
   void update(const void *key, uint32_t len) {
-    key_t k((uint8_t *)key, len);
-    key_counter[k]++;
+    uint32_t crc32 = rte_hash_crc(key, len, 0xffffffff);
+    key_counter.inc((const uint8_t *)key, len, crc32);
     total_count++;
+  }
+
+  bool contains(const uint8_t *key, uint32_t len, uint32_t crc32) const { return key_counter.contains(key, len, crc32); }
+
+  // Number of distinct (crc32 & mask) values, for every low-bit mask (1, 3, 7, ..., 0xffffffff).
+  // Instead of feeding 32 hash sets on every packet, this is derived once from the CRC32s of the distinct keys. Sorting them by their
+  // bit-reversed value groups together the hashes sharing their k lowest bits, so each pair of neighbours tells us for which masks they
+  // collapse into the same value.
+  std::vector<std::pair<uint32_t, uint64_t>> get_crc32_hashes_per_mask() const {
+    std::vector<uint32_t> reversed_hashes;
+    reversed_hashes.reserve(key_counter.size());
+    key_counter.for_each([&reversed_hashes](const uint8_t *, uint32_t, uint32_t crc32, uint64_t) {
+      reversed_hashes.push_back(reverse_bits(crc32));
+    });
+
+    std::sort(reversed_hashes.begin(), reversed_hashes.end());
+    reversed_hashes.erase(std::unique(reversed_hashes.begin(), reversed_hashes.end()), reversed_hashes.end());
+
+    // Neighbours sharing exactly i low bits (reversed hashes are unique, so at most 31).
+    std::array<uint64_t, 32> neighbours_sharing_low_bits{};
+    for (size_t i = 1; i < reversed_hashes.size(); i++) {
+      neighbours_sharing_low_bits[__builtin_clz(reversed_hashes[i] ^ reversed_hashes[i - 1])]++;
+    }
 
-    uint32_t crc32 = rte_hash_crc(k.data, k.len, 0xffffffff);
-    for (auto &[mask, hashes] : mask_to_crc32) {
-      hashes.insert(crc32 & mask);
+    std::vector<std::pair<uint32_t, uint64_t>> hashes_per_mask;
+    uint64_t distinct = reversed_hashes.empty() ? 0 : 1;
+    uint32_t mask     = 0;
+    for (uint32_t bits = 1; bits <= 32; bits++) {
+      // Neighbours that agree on fewer than this many low bits are told apart by the mask.
+      distinct += neighbours_sharing_low_bits[bits - 1];
+      mask = (mask << 1) | 1;
+      hashes_per_mask.emplace_back(mask, distinct);
     }
+
+    return hashes_per_mask;
+  }
+
+private:
+  static uint32_t reverse_bits(uint32_t v) {
+    v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+    v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+    v = ((v >> 4) & 0x0f0f0f0f) | ((v & 0x0f0f0f0f) << 4);
+    v = ((v >> 8) & 0x00ff00ff) | ((v & 0x00ff00ff) << 8);
+    return (v >> 16) | (v << 16);
   }
 };
 
@@ -615,16 +687,15 @@ void generate_report() {
       map_op_stats_json["flows"]         = stats.key_counter.size();
 
       map_op_stats_json["crc32_hashes_per_mask"] = json::object();
-      for (const auto &[mask, crc32_hashes] : stats.mask_to_crc32) {
-        map_op_stats_json["crc32_hashes_per_mask"][std::to_string(mask)] = crc32_hashes.size();
+      for (const auto &[mask, num_crc32_hashes] : stats.get_crc32_hashes_per_mask()) {
+        map_op_stats_json["crc32_hashes_per_mask"][std::to_string(mask)] = num_crc32_hashes;
       }
 
       auto build_pkts_per_flow = [&stats] {
         auto pkts_per_flow = json::array();
         std::vector<uint64_t> ppf;
-        for (const auto &map_key_stats : stats.key_counter) {
-          ppf.push_back(map_key_stats.second);
-        }
+        ppf.reserve(stats.key_counter.size());
+        stats.key_counter.for_each([&ppf](const uint8_t *, uint32_t, uint32_t, uint64_t pkts) { ppf.push_back(pkts); });
         std::sort(ppf.begin(), ppf.end(), std::greater<>());
         for (uint64_t packets : ppf) {
           pkts_per_flow.push_back(packets);
@@ -652,14 +723,13 @@ void generate_report() {
 
       std::vector<uint64_t> pf;
       std::vector<uint64_t> nf;
-      for (const auto &[key, pkts] : epoch.stats.key_counter) {
-        if (i == 0 ||
-            (map_stats.epochs[i - 1].stats.key_counter.find(key) == map_stats.epochs[i - 1].stats.key_counter.end())) {
+      epoch.stats.key_counter.for_each([&](const uint8_t *key, uint32_t len, uint32_t crc32, uint64_t pkts) {
+        if (i == 0 || !map_stats.epochs[i - 1].stats.contains(key, len, crc32)) {
           nf.push_back(pkts);
         } else {
           pf.push_back(pkts);
         }
-      }
+      });
       std::sort(pf.begin(), pf.end(), std::greater<>());
       std::sort(nf.begin(), nf.end(), std::greater<>());
 
@@ -713,39 +783,45 @@ static void worker_main() {
 
   puts("Processing warmup packets...");
 
+  pkt_t pkt;
+  next_packet_t next_pkt;
+
   // First process warmup packets
   warmup = true;
-  std::vector<next_packet_t> next_pkts;
-  while (!(next_pkts = warmup_reader.get_next_packets()).empty()) {
-    for (next_packet_t& next_pkt : next_pkts) {
-      nf_process(next_pkt.device, next_pkt.pkt.data, next_pkt.pkt.len, next_pkt.pkt.ts);
+  while (warmup_reader.get_next_packet(next_pkt)) {
+    for (uint16_t device : *next_pkt.devices) {
+      load_packet(next_pkt, pkt);
+      nf_process(device, pkt.data, pkt.len, pkt.ts);
     }
   }
   warmup = false;
 
   puts("Processing NF packets...");
 
-  // Generate the first packet manually to record the starting time
-  next_pkts = reader.get_next_packets();
-  assert(!next_pkts.empty() && "Failed to generate the first packet");
+  // Fetch the first packet manually to record the starting time
+  bool got_first_pkt = reader.get_next_packet(next_pkt);
+  assert(got_first_pkt && "Failed to generate the first packet");
 
-  time_ns_t first_pkt_time = next_pkts.front().pkt.ts;
-  time_ns_t start_time = first_pkt_time;
-  time_ns_t last_time  = first_pkt_time;
+  auto wall_start = std::chrono::steady_clock::now();
 
-  while (!next_pkts.empty()) {
+  time_ns_t last_time = next_pkt.ts;
+
+  do {
     // Ignore destination device, we don't forward anywhere
-    for (next_packet_t& next_pkt : next_pkts) {
-      nf_process(next_pkt.device, next_pkt.pkt.data, next_pkt.pkt.len, next_pkt.pkt.ts);
+    for (uint16_t device : *next_pkt.devices) {
+      load_packet(next_pkt, pkt);
+      nf_process(device, pkt.data, pkt.len, pkt.ts);
     }
-    
-    elapsed_time += next_pkts.back().pkt.ts - last_time;
-    last_time = next_pkts.back().pkt.ts;
 
-    next_pkts = reader.get_next_packets();
-  }
+    elapsed_time += next_pkt.ts - last_time;
+    last_time = next_pkt.ts;
+  } while (reader.get_next_packet(next_pkt));
+
+  double wall_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
 
   NF_INFO("Elapsed virtual time: %lf s", (double)elapsed_time / 1e9);
+  NF_INFO("Profiling throughput: %lu pkts in %.3lf s (%.0lf pkts/s)", reader.get_processed_packets(), wall_elapsed,
+          reader.get_processed_packets() / wall_elapsed);
 }
 
 int main(int argc, char **argv) {
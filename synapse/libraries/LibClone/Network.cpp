@@ -352,6 +352,12 @@ void reset_data_structure_address(BDD &bdd, Call *init, BDDNode *root) {
             {"tb_update_and_check", "tb"},
             {"tb_expire", "tb"},
         }}},
+      {"hhh_allocate",
+       {"hhh_out",
+        {
+            {"hhh_update", "hhh"},
+            {"hhh_expire", "hhh"},
+        }}},
   };
 
   call_t init_call = init->get_call();
@@ -4,10 +4,13 @@
 #include <LibCore/Debug.h>
 #include <LibCore/Types.h>
 
+#include <array>
+#include <atomic>
 #include <iostream>
 #include <regex>
 #include <unordered_map>
 
+#include <klee/util/ExprHashMap.h>
 #include <klee/util/ExprVisitor.h>
 
 namespace LibCore {
@@ -1830,12 +1833,56 @@ std::ostream &operator<<(std::ostream &os, const simplifier_type_t &type) {
   return os;
 }
 
+namespace {
+
 struct simplifier_op {
   simplifier_type_t type;
   simplifier_fn apply;
 };
 
-typedef std::vector<simplifier_op> simplifiers_t;
+// Every rule only ever fires on a single kind of expression (or a handful of comparisons), so the rules are indexed by the kind they apply to.
+// Within a kind, they keep the order in which they are tried.
+typedef std::array<std::vector<simplifier_op>, klee::Expr::LastKind + 1> simplifiers_t;
+
+const std::vector<klee::Expr::Kind> cmp_kinds{
+    klee::Expr::Or,  klee::Expr::And, klee::Expr::Eq,  klee::Expr::Ne,  klee::Expr::Ult, klee::Expr::Ule,
+    klee::Expr::Ugt, klee::Expr::Uge, klee::Expr::Slt, klee::Expr::Sle, klee::Expr::Sgt, klee::Expr::Sge,
+};
+
+simplifiers_t build_simplifiers(const std::vector<std::pair<std::vector<klee::Expr::Kind>, simplifier_op>> &rules) {
+  simplifiers_t simplifiers;
+  for (const auto &[kinds, op] : rules) {
+    for (klee::Expr::Kind kind : kinds) {
+      simplifiers[kind].push_back(op);
+    }
+  }
+  return simplifiers;
+}
+
+const simplifiers_t simplifiers = build_simplifiers({
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractZeroZExtConditional, simplify_extract_0_zext_conditional}},
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractZeroSameWidth, simplify_extract_0_same_width}},
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractConcats, simplify_extract_of_concats}},
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractRead, simplify_extract_read}},
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractExt, simplify_extract_ext}},
+    {{klee::Expr::Eq}, {simplifier_type_t::CompareEqZero, simplify_cmp_eq_0}},
+    {cmp_kinds, {simplifier_type_t::CompareZExtEqSize, simplify_cmp_zext_eq_size}},
+    {{klee::Expr::Not}, {simplifier_type_t::NotEq, simplify_not_eq}},
+    {{klee::Expr::Ne}, {simplifier_type_t::CompareNeZero, simplify_cmp_ne_0}},
+    {{klee::Expr::Add}, {simplifier_type_t::AddNegativeSExt, simplify_add_neg_sext}},
+    {{klee::Expr::Add}, {simplifier_type_t::AddNonNegativeSExt, simplify_add_non_neg_sext}},
+});
+
+const simplifiers_t conditional_simplifiers = build_simplifiers({
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractConcats, simplify_extract_of_concats}},
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractZeroSameWidth, simplify_extract_0_same_width}},
+    {{klee::Expr::Extract}, {simplifier_type_t::ExtractExt, simplify_extract_ext}},
+    {{klee::Expr::Eq}, {simplifier_type_t::CompareEqZero, simplify_cmp_eq_0}},
+    {cmp_kinds, {simplifier_type_t::CompareZExtEqSize, simplify_cmp_zext_eq_size}},
+    {{klee::Expr::Not}, {simplifier_type_t::NotEq, simplify_not_eq}},
+    {{klee::Expr::Ne}, {simplifier_type_t::CompareNeZero, simplify_cmp_ne_0}},
+    {{klee::Expr::Add}, {simplifier_type_t::AddNegativeSExt, simplify_add_neg_sext}},
+});
 
 std::vector<simplifier_type_t> apply_simplifiers(const simplifiers_t &simplifiers, klee::ref<klee::Expr> expr,
                                                  klee::ref<klee::Expr> &simplified_expr) {
@@ -1843,7 +1890,7 @@ std::vector<simplifier_type_t> apply_simplifiers(const simplifiers_t &simplifier
 
   simplified_expr = expr;
 
-  for (auto op : simplifiers) {
+  for (const simplifier_op &op : simplifiers[expr->getKind()]) {
     if (op.apply(expr, simplified_expr)) {
       simplifications_applied.push_back(op.type);
       return simplifications_applied;
@@ -1890,32 +1937,9 @@ std::vector<simplifier_type_t> apply_simplifiers(const simplifiers_t &simplifier
   return simplifications_applied;
 }
 
-klee::ref<klee::Expr> simplify(klee::ref<klee::Expr> expr) {
-  if (expr.isNull()) {
-    return expr;
-  }
-
-  if (expr->getKind() == klee::Expr::Constant) {
-    return expr;
-  }
-
-  const simplifiers_t simplifiers{
-      {simplifier_type_t::ExtractZeroZExtConditional, simplify_extract_0_zext_conditional},
-      {simplifier_type_t::ExtractZeroSameWidth, simplify_extract_0_same_width},
-      {simplifier_type_t::ExtractConcats, simplify_extract_of_concats},
-      {simplifier_type_t::ExtractRead, simplify_extract_read},
-      {simplifier_type_t::ExtractExt, simplify_extract_ext},
-      {simplifier_type_t::CompareEqZero, simplify_cmp_eq_0},
-      {simplifier_type_t::CompareZExtEqSize, simplify_cmp_zext_eq_size},
-      {simplifier_type_t::NotEq, simplify_not_eq},
-      {simplifier_type_t::CompareNeZero, simplify_cmp_ne_0},
-      {simplifier_type_t::AddNegativeSExt, simplify_add_neg_sext},
-      {simplifier_type_t::AddNonNegativeSExt, simplify_add_non_neg_sext},
-      {simplifier_type_t::AddNonNegativeSExt, simplify_add_non_neg_sext},
-  };
-
-  klee::ref<klee::Expr> original_expr = expr;
-  std::vector<klee::ref<klee::Expr>> prev_exprs{expr};
+// Rewrites until an expression shows up for the second time.
+klee::ref<klee::Expr> apply_simplifiers_until_fixed_point(const simplifiers_t &simplifiers, klee::ref<klee::Expr> expr) {
+  klee::ExprHashSet prev_exprs{expr};
 
   while (true) {
     klee::ref<klee::Expr> simplified = expr;
@@ -1928,27 +1952,88 @@ klee::ref<klee::Expr> simplify(klee::ref<klee::Expr> expr) {
     //   std::cerr << "New expr: " << expr_to_string(simplified) << std::endl;
     // }
 
-    bool changed = true;
-    for (klee::ref<klee::Expr> prev : prev_exprs) {
-      if (!simplified->compare(*prev.get())) {
-        changed = false;
-        break;
-      }
+    if (!prev_exprs.insert(simplified).second) {
+      return expr;
     }
 
-    if (!changed) {
-      break;
+    expr = simplified;
+  }
+}
+
+// Expressions are reference counted without atomics, and built by the thread's own solver toolbox, so they never cross threads: neither do the
+// memo tables. They are dropped once they grow past SIMPLIFY_MEMO_CAPACITY entries.
+constexpr const size_t SIMPLIFY_MEMO_CAPACITY = 1 << 20;
+
+thread_local klee::ExprHashMap<klee::ref<klee::Expr>> simplify_memo;
+thread_local klee::ExprHashMap<klee::ref<klee::Expr>> simplify_conditional_memo;
+thread_local u64 simplify_validation_counter = 0;
+
+std::atomic<SimplifyValidation> simplify_validation{
+#ifdef NDEBUG
+    SimplifyValidation::Sampled
+#else
+    SimplifyValidation::Always
+#endif
+};
+
+struct atomic_simplify_stats_t {
+  std::atomic<u64> calls{0};
+  std::atomic<u64> memo_hits{0};
+  std::atomic<u64> validations{0};
+} simplify_stats;
+
+bool should_validate_simplification() {
+  switch (simplify_validation.load(std::memory_order_relaxed)) {
+  case SimplifyValidation::Always:
+    return true;
+  case SimplifyValidation::Sampled:
+    return simplify_validation_counter++ % SIMPLIFY_VALIDATION_SAMPLE_PERIOD == 0;
+  case SimplifyValidation::Off:
+    return false;
+  }
+  return true;
+}
+
+klee::ref<klee::Expr> memoized_simplify(klee::ExprHashMap<klee::ref<klee::Expr>> &memo, const simplifiers_t &simplifiers,
+                                        klee::ref<klee::Expr> expr, bool validate) {
+  simplify_stats.calls.fetch_add(1, std::memory_order_relaxed);
+
+  auto found_it = memo.find(expr);
+  if (found_it != memo.end()) {
+    simplify_stats.memo_hits.fetch_add(1, std::memory_order_relaxed);
+    return found_it->second;
+  }
+
+  // Rules may simplify subexpressions themselves, touching the memo table in the process: look it up again only once they are done.
+  const klee::ref<klee::Expr> simplified = apply_simplifiers_until_fixed_point(simplifiers, expr);
+
+  if (validate && simplified != expr && should_validate_simplification()) {
+    simplify_stats.validations.fetch_add(1, std::memory_order_relaxed);
+    if (!solver_toolbox.are_exprs_always_equal(expr, simplified)) {
+      panic("*** Bug in simplification! ***\nOriginal: %s\nSimplified: %s\n", expr_to_string(expr).c_str(), expr_to_string(simplified).c_str());
     }
+  }
 
-    prev_exprs.push_back(simplified);
-    expr = simplified;
+  if (memo.size() >= SIMPLIFY_MEMO_CAPACITY) {
+    memo.clear();
   }
 
-  if (!solver_toolbox.are_exprs_always_equal(original_expr, expr)) {
-    panic("*** Bug in simplification! ***\nOriginal: %s\nSimplified: %s\n", expr_to_string(original_expr).c_str(), expr_to_string(expr).c_str());
+  memo.emplace(expr, simplified);
+  return simplified;
+}
+
+} // namespace
+
+klee::ref<klee::Expr> simplify(klee::ref<klee::Expr> expr) {
+  if (expr.isNull()) {
+    return expr;
   }
 
-  return expr;
+  if (expr->getKind() == klee::Expr::Constant) {
+    return expr;
+  }
+
+  return memoized_simplify(simplify_memo, simplifiers, expr, true);
 }
 
 klee::ref<klee::Expr> simplify_conditional(klee::ref<klee::Expr> expr) {
@@ -1958,36 +2043,24 @@ klee::ref<klee::Expr> simplify_conditional(klee::ref<klee::Expr> expr) {
     return expr;
   }
 
-  const simplifiers_t simplifiers{
-      {simplifier_type_t::ExtractConcats, simplify_extract_of_concats},
-      {simplifier_type_t::ExtractZeroSameWidth, simplify_extract_0_same_width},
-      {simplifier_type_t::ExtractExt, simplify_extract_ext},
-      {simplifier_type_t::CompareEqZero, simplify_cmp_eq_0},
-      {simplifier_type_t::CompareZExtEqSize, simplify_cmp_zext_eq_size},
-      {simplifier_type_t::NotEq, simplify_not_eq},
-      {simplifier_type_t::CompareNeZero, simplify_cmp_ne_0},
-      {simplifier_type_t::AddNegativeSExt, simplify_add_neg_sext},
-  };
-
-  std::vector<klee::ref<klee::Expr>> prev_exprs{expr};
-
-  while (true) {
-    klee::ref<klee::Expr> simplified = expr;
+  return memoized_simplify(simplify_conditional_memo, conditional_simplifiers, expr, false);
+}
 
-    std::vector<simplifier_type_t> simplifications_applied = apply_simplifiers(simplifiers, expr, simplified);
-    assert(!simplified.isNull() && "Null expr");
+void set_simplify_validation(SimplifyValidation validation) { simplify_validation.store(validation, std::memory_order_relaxed); }
 
-    for (klee::ref<klee::Expr> prev : prev_exprs) {
-      if (!simplified->compare(*prev.get())) {
-        return expr;
-      }
-    }
+SimplifyValidation get_simplify_validation() { return simplify_validation.load(std::memory_order_relaxed); }
 
-    prev_exprs.push_back(simplified);
-    expr = simplified;
-  }
+simplify_stats_t get_simplify_stats() {
+  return {
+      .calls       = simplify_stats.calls.load(std::memory_order_relaxed),
+      .memo_hits   = simplify_stats.memo_hits.load(std::memory_order_relaxed),
+      .validations = simplify_stats.validations.load(std::memory_order_relaxed),
+  };
+}
 
-  return expr;
+void clear_simplify_memo() {
+  simplify_memo.clear();
+  simplify_conditional_memo.clear();
 }
 
 std::string pretty_print_expr(klee::ref<klee::Expr> expr, bool use_signed) { return ExprPrettyPrinter::print(expr, use_signed); }
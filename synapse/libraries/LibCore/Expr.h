@@ -2,6 +2,7 @@
 
 #include <LibCore/Types.h>
 
+#include <unordered_map>
 #include <unordered_set>
 #include <optional>
 
@@ -34,6 +35,28 @@ klee::ref<klee::Expr> simplify_conditional(klee::ref<klee::Expr> condition);
 klee::ref<klee::Expr> concat_exprs(const std::vector<klee::ref<klee::Expr>> &exprs, bool left_to_right = true);
 std::string expr_to_ascii(klee::ref<klee::Expr> expr);
 
+// Simplifications are memoized per thread. How often simplify() double-checks a new one with the solver is process-wide: every time by default on
+// debug builds, one in SIMPLIFY_VALIDATION_SAMPLE_PERIOD on release builds.
+enum class SimplifyValidation { Always, Sampled, Off };
+constexpr const u64 SIMPLIFY_VALIDATION_SAMPLE_PERIOD = 16;
+
+const std::unordered_map<std::string, SimplifyValidation> str_to_simplify_validation{
+    {"always", SimplifyValidation::Always},
+    {"sampled", SimplifyValidation::Sampled},
+    {"off", SimplifyValidation::Off},
+};
+
+struct simplify_stats_t {
+  u64 calls;
+  u64 memo_hits;
+  u64 validations;
+};
+
+void set_simplify_validation(SimplifyValidation validation);
+SimplifyValidation get_simplify_validation();
+simplify_stats_t get_simplify_stats();
+void clear_simplify_memo();
+
 struct expr_pos_t {
   bits_t offset;
   bits_t size;
@@ -0,0 +1,500 @@
+#pragma once
+
+// This header is also included by the generated (DPDK) profiler, so besides the standard library and POSIX it only depends on LibCore/Debug.h (for
+// panic), which is header-only.
+#include <LibCore/Debug.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace LibCore {
+
+// Zero-copy, read-only view of a pcap or pcapng file.
+//
+// The whole file is mmap'ed and headers are parsed in place: packets are handed out as pointers into the mapping, so reading a trace never
+// copies packet data. Supports classic pcap (micro/nanosecond timestamps, either byte order) and pcapng (enhanced and simple packet blocks).
+//
+// Classic pcap files can also be split into record-aligned byte ranges, each read by its own MappedPcap, so a trace can be processed in parallel.
+class MappedPcap {
+public:
+  enum class LinkType { Ethernet, RawIP };
+
+  struct packet_t {
+    const uint8_t *data;
+    uint32_t caplen;
+    uint32_t len;
+    int64_t ts; // ns
+  };
+
+private:
+  static constexpr const uint32_t PCAP_MAGIC_US         = 0xa1b2c3d4;
+  static constexpr const uint32_t PCAP_MAGIC_NS         = 0xa1b23c4d;
+  static constexpr const uint32_t PCAPNG_SHB            = 0x0a0d0d0a;
+  static constexpr const uint32_t PCAPNG_BYTE_ORDER     = 0x1a2b3c4d;
+  static constexpr const uint32_t PCAPNG_IDB            = 0x00000001;
+  static constexpr const uint32_t PCAPNG_SPB            = 0x00000003;
+  static constexpr const uint32_t PCAPNG_EPB            = 0x00000006;
+  static constexpr const uint16_t PCAPNG_OPT_END        = 0;
+  static constexpr const uint16_t PCAPNG_OPT_IF_TSRESOL = 9;
+
+  static constexpr const uint32_t LINKTYPE_ETHERNET = 1;
+  static constexpr const uint32_t LINKTYPE_RAW      = 101;
+  static constexpr const uint32_t LINKTYPE_IPV4     = 228;
+  // DLT_RAW, as some writers use the DLT value instead of the LINKTYPE one.
+  static constexpr const uint32_t DLT_RAW_BSD     = 12;
+  static constexpr const uint32_t DLT_RAW_OPENBSD = 14;
+
+  // Classic pcap records carry no sync marker, so split points are found by looking for a run of consecutive plausible record headers.
+  static constexpr const size_t RESYNC_RECORDS          = 8;
+  static constexpr const size_t RESYNC_MAX_SCAN         = 16 * 1024 * 1024;
+  static constexpr const uint64_t RESYNC_MAX_TS_GAP_SEC = 3600;
+  static constexpr const uint32_t MAX_RECORD_LEN        = 262'144;
+
+  struct interface_t {
+    uint32_t snaplen;
+    // Timestamp units per second.
+    uint64_t ts_units;
+  };
+
+  std::filesystem::path fname;
+  const uint8_t *base;
+  size_t size;
+  size_t offset;
+  size_t first_record;
+  size_t range_begin;
+  size_t range_end;
+  bool is_pcapng;
+  bool swapped;
+  LinkType link_type;
+
+  // Classic pcap.
+  uint64_t ts_frac_units;
+  uint32_t snaplen;
+
+  // pcapng interfaces of the current section.
+  std::vector<interface_t> interfaces;
+
+public:
+  MappedPcap(const std::filesystem::path &_fname)
+      : fname(_fname), base(nullptr), size(0), offset(0), first_record(0), range_begin(0), range_end(0), is_pcapng(false), swapped(false),
+        link_type(LinkType::Ethernet), ts_frac_units(1'000'000), snaplen(0) {
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+      panic("Unable to open file %s: %s", fname.c_str(), strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+      panic("Unable to stat file %s: %s", fname.c_str(), strerror(errno));
+    }
+
+    size = st.st_size;
+
+    if (size > 0) {
+      void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        panic("Unable to mmap file %s: %s", fname.c_str(), strerror(errno));
+      }
+
+      base = static_cast<const uint8_t *>(mapping);
+
+      // Traces are read front to back, let the kernel read ahead aggressively.
+      madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+
+    close(fd);
+
+    range_end = size;
+    parse_file_header();
+  }
+
+  MappedPcap(const MappedPcap &) = delete;
+
+  MappedPcap(MappedPcap &&other)
+      : fname(std::move(other.fname)), base(other.base), size(other.size), offset(other.offset), first_record(other.first_record),
+        range_begin(other.range_begin), range_end(other.range_end), is_pcapng(other.is_pcapng), swapped(other.swapped), link_type(other.link_type),
+        ts_frac_units(other.ts_frac_units), snaplen(other.snaplen), interfaces(std::move(other.interfaces)) {
+    other.base = nullptr;
+    other.size = 0;
+  }
+
+  MappedPcap &operator=(const MappedPcap &) = delete;
+
+  ~MappedPcap() {
+    if (base) {
+      munmap(const_cast<uint8_t *>(base), size);
+    }
+  }
+
+  const std::filesystem::path &get_fname() const { return fname; }
+  LinkType get_link_type() const { return link_type; }
+  size_t get_size() const { return size; }
+  size_t get_offset() const { return offset; }
+
+  // Fraction of the file (or of the range being read) already read, in [0,1]. Cheap enough to be called on every packet (no need to count the
+  // packets beforehand).
+  double get_progress() const {
+    return range_end == range_begin ? 1.0 : static_cast<double>(offset - range_begin) / (range_end - range_begin);
+  }
+
+  void rewind() {
+    offset      = first_record;
+    range_begin = 0;
+    range_end   = size;
+
+    // Interfaces will be declared again by the first section.
+    if (is_pcapng) {
+      interfaces.clear();
+    }
+  }
+
+  // The returned packet points into the mapping and stays valid for the lifetime of this object.
+  // A truncated trailing record is treated as the end of the file.
+  bool next(packet_t &pkt) { return is_pcapng ? next_pcapng(pkt) : next_pcap(pkt); }
+
+  // Splits the records into (at most) the given number of byte ranges of about the same size. Returns the boundaries, from the first record to
+  // the end of the file. pcapng files are never split, as blocks depend on the interfaces declared before them.
+  //
+  // Split points are found heuristically: whoever reads a range should check that it ends exactly where the next one begins (see set_range()),
+  // which, as the first range starts at a known record, proves every split point right.
+  std::vector<size_t> find_record_boundaries(size_t ranges) const {
+    std::vector<size_t> boundaries{first_record};
+
+    if (!is_pcapng) {
+      for (size_t i = 1; i < ranges; i++) {
+        const size_t target = first_record + (size - first_record) / ranges * i;
+        if (target <= boundaries.back()) {
+          continue;
+        }
+
+        const size_t scan_end = std::min(size, target + RESYNC_MAX_SCAN);
+        for (size_t candidate = target; candidate < scan_end; candidate++) {
+          if (is_plausible_record_run(candidate)) {
+            boundaries.push_back(candidate);
+            break;
+          }
+        }
+      }
+    }
+
+    boundaries.push_back(size);
+    return boundaries;
+  }
+
+  // Restricts reading to the records in [begin, end), which must come from find_record_boundaries().
+  void set_range(size_t begin, size_t end) {
+    assert_or_panic(!is_pcapng, "Reading ranges of pcapng files is not supported");
+    assert_or_panic(begin >= first_record && begin <= end && end <= size, "Invalid range [%zu, %zu) of %s", begin, end, fname.c_str());
+
+    offset      = begin;
+    range_begin = begin;
+    range_end   = end;
+  }
+
+private:
+  uint16_t rd16(size_t at) const {
+    uint16_t v;
+    memcpy(&v, base + at, sizeof(v));
+    return swapped ? __builtin_bswap16(v) : v;
+  }
+
+  uint32_t rd32(size_t at) const {
+    uint32_t v;
+    memcpy(&v, base + at, sizeof(v));
+    return swapped ? __builtin_bswap32(v) : v;
+  }
+
+  bool fits(size_t at, size_t len) const { return at <= range_end && len <= range_end - at; }
+
+  // Split points are looked for over the whole file, not just over the range being read.
+  bool is_plausible_record_run(size_t at) const {
+    constexpr const size_t PCAP_REC_HDR_SIZE = 16;
+
+    auto fits_file = [this](size_t at, size_t len) { return at <= size && len <= size - at; };
+    uint64_t prev_ts_sec = 0;
+
+    for (size_t i = 0; i < RESYNC_RECORDS; i++) {
+      // Running into the end of the file is as good as a full run.
+      if (at == size) {
+        return true;
+      }
+
+      if (!fits_file(at, PCAP_REC_HDR_SIZE)) {
+        return false;
+      }
+
+      const uint32_t ts_sec  = rd32(at);
+      const uint32_t ts_frac = rd32(at + 4);
+      const uint32_t caplen  = rd32(at + 8);
+      const uint32_t len     = rd32(at + 12);
+
+      if (ts_frac >= ts_frac_units || caplen == 0 || caplen > len || len > MAX_RECORD_LEN || (snaplen != 0 && caplen > snaplen) ||
+          !fits_file(at + PCAP_REC_HDR_SIZE, caplen)) {
+        return false;
+      }
+
+      // Consecutive packets are never far apart.
+      if (i > 0 && (ts_sec > prev_ts_sec + RESYNC_MAX_TS_GAP_SEC || prev_ts_sec > ts_sec + RESYNC_MAX_TS_GAP_SEC)) {
+        return false;
+      }
+
+      prev_ts_sec = ts_sec;
+      at += PCAP_REC_HDR_SIZE + caplen;
+    }
+
+    return true;
+  }
+
+  void set_link_type(uint32_t linktype) {
+    switch (linktype) {
+    case LINKTYPE_ETHERNET:
+      link_type = LinkType::Ethernet;
+      break;
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+    case DLT_RAW_BSD:
+    case DLT_RAW_OPENBSD:
+      link_type = LinkType::RawIP;
+      break;
+    default: {
+      panic("Unknown header type (%u) in %s", linktype, fname.c_str());
+    }
+    }
+  }
+
+  void parse_file_header() {
+    if (!fits(0, sizeof(uint32_t))) {
+      panic("Invalid pcap file %s: too small", fname.c_str());
+    }
+
+    uint32_t magic;
+    memcpy(&magic, base, sizeof(magic));
+
+    if (magic == PCAPNG_SHB) {
+      is_pcapng    = true;
+      first_record = 0;
+
+      // Peek into the first section (and its first interface) to find out the link type.
+      packet_t ignored;
+      while (interfaces.empty() && fits(offset, 8)) {
+        next_pcapng_block(ignored, true);
+      }
+
+      rewind();
+
+      return;
+    }
+
+    if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+      swapped = false;
+    } else if (magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS)) {
+      swapped = true;
+      magic   = __builtin_bswap32(magic);
+    } else {
+      panic("Invalid pcap file %s: unknown magic number 0x%08x", fname.c_str(), magic);
+    }
+
+    // Global header: magic, version major/minor, thiszone, sigfigs, snaplen, linktype.
+    constexpr const size_t PCAP_FILE_HDR_SIZE = 24;
+    if (!fits(0, PCAP_FILE_HDR_SIZE)) {
+      panic("Invalid pcap file %s: truncated header", fname.c_str());
+    }
+
+    ts_frac_units = magic == PCAP_MAGIC_NS ? 1'000'000'000 : 1'000'000;
+    snaplen       = rd32(16);
+    set_link_type(rd32(20) & 0xffff);
+
+    first_record = PCAP_FILE_HDR_SIZE;
+    offset       = first_record;
+  }
+
+  bool next_pcap(packet_t &pkt) {
+    // Record header: ts_sec, ts_frac, caplen, len.
+    constexpr const size_t PCAP_REC_HDR_SIZE = 16;
+
+    if (!fits(offset, PCAP_REC_HDR_SIZE)) {
+      return false;
+    }
+
+    uint32_t ts_sec  = rd32(offset);
+    uint32_t ts_frac = rd32(offset + 4);
+    uint32_t caplen  = rd32(offset + 8);
+    uint32_t len     = rd32(offset + 12);
+
+    if (!fits(offset + PCAP_REC_HDR_SIZE, caplen)) {
+      return false;
+    }
+
+    pkt.data   = base + offset + PCAP_REC_HDR_SIZE;
+    pkt.caplen = caplen;
+    pkt.len    = len;
+    pkt.ts     = static_cast<int64_t>(ts_sec) * 1'000'000'000 + static_cast<int64_t>(ts_frac) * (1'000'000'000 / ts_frac_units);
+
+    offset += PCAP_REC_HDR_SIZE + caplen;
+    return true;
+  }
+
+  bool next_pcapng(packet_t &pkt) {
+    while (fits(offset, 8)) {
+      if (next_pcapng_block(pkt, false)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Consumes one block, returning true if it holds a packet. Packet blocks are not parsed at all if only_interfaces is set.
+  bool next_pcapng_block(packet_t &pkt, bool only_interfaces) {
+    uint32_t raw_type;
+    memcpy(&raw_type, base + offset, sizeof(raw_type));
+
+    if (raw_type == PCAPNG_SHB) {
+      // The section header is the one that tells us the byte order of everything that follows.
+      if (!fits(offset, 12)) {
+        offset = range_end;
+        return false;
+      }
+
+      uint32_t byte_order;
+      memcpy(&byte_order, base + offset + 8, sizeof(byte_order));
+
+      if (byte_order == PCAPNG_BYTE_ORDER) {
+        swapped = false;
+      } else if (byte_order == __builtin_bswap32(PCAPNG_BYTE_ORDER)) {
+        swapped = true;
+      } else {
+        panic("Invalid pcapng file %s: bad byte order magic", fname.c_str());
+      }
+
+      interfaces.clear();
+    }
+
+    uint32_t type      = rd32(offset);
+    uint32_t block_len = rd32(offset + 4);
+
+    if (block_len < 12 || !fits(offset, block_len)) {
+      offset = range_end;
+      return false;
+    }
+
+    const size_t body     = offset + 8;
+    const size_t body_end = offset + block_len - 4;
+    offset += block_len;
+
+    switch (type) {
+    case PCAPNG_IDB: {
+      if (body + 8 > body_end) {
+        panic("Invalid pcapng file %s: truncated interface block", fname.c_str());
+      }
+
+      uint16_t linktype = rd16(body);
+      if (interfaces.empty()) {
+        set_link_type(linktype);
+      } else {
+        // Packets are handed out without their interface, so all of them must share the same link type.
+        LinkType first = link_type;
+        set_link_type(linktype);
+        if (link_type != first) {
+          panic("Unsupported pcapng file %s: interfaces with different link types", fname.c_str());
+        }
+      }
+
+      interface_t interface{.snaplen = rd32(body + 4), .ts_units = 1'000'000};
+
+      for (size_t opt = body + 8; opt + 4 <= body_end;) {
+        uint16_t code = rd16(opt);
+        uint16_t len  = rd16(opt + 2);
+
+        if (code == PCAPNG_OPT_END) {
+          break;
+        }
+
+        if (code == PCAPNG_OPT_IF_TSRESOL && len >= 1) {
+          uint8_t tsresol    = base[opt + 4];
+          uint64_t units     = 1;
+          const uint64_t exp = tsresol & 0x7f;
+          for (uint64_t i = 0; i < exp; i++) {
+            units *= (tsresol & 0x80) ? 2 : 10;
+          }
+          interface.ts_units = units;
+        }
+
+        opt += 4 + ((len + 3) & ~3u);
+      }
+
+      interfaces.push_back(interface);
+    } break;
+    case PCAPNG_EPB: {
+      if (only_interfaces) {
+        return false;
+      }
+
+      // Interface id, ts high, ts low, caplen, len.
+      if (body + 20 > body_end) {
+        return false;
+      }
+
+      uint32_t interface_id = rd32(body);
+      uint64_t ts           = (static_cast<uint64_t>(rd32(body + 4)) << 32) | rd32(body + 8);
+      uint32_t caplen       = rd32(body + 12);
+      uint32_t len          = rd32(body + 16);
+
+      if (interface_id >= interfaces.size()) {
+        panic("Invalid pcapng file %s: packet from undeclared interface %u", fname.c_str(), interface_id);
+      }
+
+      if (body + 20 + caplen > body_end) {
+        return false;
+      }
+
+      const uint64_t ts_units = interfaces[interface_id].ts_units;
+
+      pkt.data   = base + body + 20;
+      pkt.caplen = caplen;
+      pkt.len    = len;
+      pkt.ts     = static_cast<int64_t>((ts / ts_units) * 1'000'000'000 + (ts % ts_units) * 1'000'000'000 / ts_units);
+
+      return true;
+    } break;
+    case PCAPNG_SPB: {
+      if (only_interfaces) {
+        return false;
+      }
+
+      if (interfaces.empty() || body + 4 > body_end) {
+        return false;
+      }
+
+      // Simple packet blocks carry no timestamp and are implicitly from the first interface.
+      uint32_t len     = rd32(body);
+      uint32_t snaplen = interfaces[0].snaplen;
+      uint32_t caplen  = (snaplen != 0 && len > snaplen) ? snaplen : len;
+
+      if (body + 4 + caplen > body_end) {
+        return false;
+      }
+
+      pkt.data   = base + body + 4;
+      pkt.caplen = caplen;
+      pkt.len    = len;
+      pkt.ts     = 0;
+
+      return true;
+    } break;
+    }
+
+    // Anything else (name resolution, statistics, custom blocks, ...) is skipped.
+    return false;
+  }
+};
+
+} // namespace LibCore
\ No newline at end of file
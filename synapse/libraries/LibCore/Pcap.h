@@ -3,6 +3,7 @@
 #include <LibCore/Types.h>
 #include <LibCore/Net.h>
 #include <LibCore/Debug.h>
+#include <LibCore/MappedPcap.h>
 
 #include <byteswap.h>
 #include <pcap.h>
@@ -14,6 +15,8 @@
 #include <random>
 #include <chrono>
 #include <ctime>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <optional>
 
@@ -363,63 +366,48 @@ inline uintmax_t parse_int(const char *str, const char *name, int base, char nex
   return result;
 }
 
+// Single pass reader: packets are parsed in place from the mmap'ed trace, and the totals (packets, start/end timestamps) are accumulated as
+// packets are read. Use get_progress() to report progress without counting the packets beforehand.
 class PcapReader {
 private:
-  pcap_t *pd;
+  MappedPcap pcap;
   bool assume_ip;
-  long pcap_start;
-  u64 total_pkts;
+  u64 read_pkts;
   time_ns_t start;
   time_ns_t end;
 
 public:
-  PcapReader(const std::string &input_fname) : assume_ip(false), total_pkts(0) {
-    char errbuf[PCAP_ERRBUF_SIZE];
-    pd = pcap_open_offline(input_fname.c_str(), errbuf);
-
-    if (pd == nullptr) {
-      panic("Unable to open file %s: %s", input_fname.c_str(), errbuf);
-    }
-
-    int link_hdr_type = pcap_datalink(pd);
-
-    switch (link_hdr_type) {
-    case DLT_EN10MB:
-      // Normal ethernet, as expected. Nothing to do here.
-      break;
-    case DLT_RAW:
-      // Contains raw IP packets.
-      assume_ip = true;
-      break;
-    default: {
-      panic("Unknown header type (%d)", link_hdr_type);
-    }
-    }
-
-    FILE *pcap_fptr = pcap_file(pd);
-    assert(pcap_fptr && "Invalid pcap file pointer");
-    pcap_start = ftell(pcap_fptr);
-
-    run_preamble();
-  }
+  PcapReader(const std::string &input_fname)
+      : pcap(input_fname), assume_ip(pcap.get_link_type() == MappedPcap::LinkType::RawIP), read_pkts(0), start(0), end(0) {}
 
   bool assumes_ip() const { return assume_ip; }
-  u64 get_total_pkts() const { return total_pkts; }
+  double get_progress() const { return pcap.get_progress(); }
+
+  // These only account for the packets read so far, i.e. they cover the whole trace once read() returns false.
+  u64 get_total_pkts() const { return read_pkts; }
   time_ns_t get_start() const { return start; }
   time_ns_t get_end() const { return end; }
 
   bool read(const u8 *&pkt, u16 &hdrs_len, u16 &total_len, time_ns_t &ts, std::optional<flow_t> &flow) {
-    const u8 *data;
-    struct pcap_pkthdr *header;
+    MappedPcap::packet_t raw;
 
-    if (pcap_next_ex(pd, &header, &data) != 1) {
+    if (!pcap.next(raw)) {
       return false;
     }
 
+    if (read_pkts == 0) {
+      start = raw.ts;
+    }
+
+    read_pkts++;
+    end = raw.ts;
+
+    const u8 *data = raw.data;
+
     pkt       = data;
     hdrs_len  = 0;
-    total_len = header->len + CRC_SIZE_BYTES;
-    ts        = header->ts.tv_sec * 1'000'000'000 + header->ts.tv_usec * 1'000;
+    total_len = raw.len + CRC_SIZE_BYTES;
+    ts        = raw.ts;
 
     if (assume_ip) {
       total_len += sizeof(ether_hdr_t);
@@ -507,41 +495,25 @@ public:
     return true;
   }
 
-  // WARNING: this does not work on windows!
-  // https://winpcap-users.winpcap.narkive.com/scCKD3x2/packet-random-access-using-file-seek
   void rewind() {
-    FILE *pcap_fptr = pcap_file(pd);
-    fseek(pcap_fptr, pcap_start, SEEK_SET);
+    pcap.rewind();
+    read_pkts = 0;
   }
 
-private:
-  void run_preamble() {
-    total_pkts = 0;
-
-    const u8 *pkt;
-    u16 hdrs_len;
-    u16 sz;
-    time_ns_t ts;
-    std::optional<flow_t> flow;
-    bool set_start = false;
-
-    while (read(pkt, hdrs_len, sz, ts, flow)) {
-      total_pkts++;
-
-      if (!set_start) {
-        start     = ts;
-        set_start = true;
-      }
-
-      end = ts;
-    }
+  // See MappedPcap::find_record_boundaries() and MappedPcap::set_range().
+  std::vector<size_t> find_record_boundaries(size_t ranges) const { return pcap.find_record_boundaries(ranges); }
+  size_t get_offset() const { return pcap.get_offset(); }
 
-    rewind();
+  void set_range(size_t begin, size_t end) {
+    pcap.set_range(begin, end);
+    read_pkts = 0;
   }
 };
 
 class PcapWriter {
 private:
+  static constexpr const size_t WRITE_BUFFER_SIZE = 16 * 1024 * 1024;
+
   std::filesystem::path output_fname;
   pcap_t *pd;
   pcap_dumper_t *pdumper;
@@ -556,9 +528,17 @@ public:
       pd = pcap_open_dead(DLT_EN10MB, 65535 /* snaplen */);
     }
 
-    pdumper = pcap_dump_open(pd, _output_fname.c_str());
+    // Records are tiny and there are millions of them: a large stdio buffer turns them into a few big writes.
+    FILE *file = fopen(_output_fname.c_str(), "wb");
+    if (file == nullptr) {
+      panic("Unable to open file %s for writing: %s", _output_fname.c_str(), strerror(errno));
+    }
+
+    setvbuf(file, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+    pdumper = pcap_dump_fopen(pd, file);
 
     if (pdumper == nullptr) {
+      fclose(file);
       panic("Unable to open file %s for writing: %s", _output_fname.c_str(), pcap_geterr(pd));
     }
   }
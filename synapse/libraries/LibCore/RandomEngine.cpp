@@ -4,7 +4,7 @@
 
 namespace LibCore {
 
-std::unique_ptr<RandomUniformEngine> SingletonRandomEngine::engine;
+thread_local std::unique_ptr<RandomUniformEngine> SingletonRandomEngine::engine;
 
 void SingletonRandomEngine::seed(u32 rand_seed) { engine = std::unique_ptr<RandomUniformEngine>(new RandomUniformEngine(rand_seed)); }
 
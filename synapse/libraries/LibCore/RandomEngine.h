@@ -38,9 +38,11 @@ public:
   std::mt19937 get_engine() const { return gen; }
 };
 
+// The engine is per-thread: every thread must be seeded before generating numbers. Parallel search seeds each worker task with a value drawn
+// from the main thread's engine, so results stay deterministic for a given seed.
 class SingletonRandomEngine : private RandomUniformEngine {
 private:
-  static std::unique_ptr<RandomUniformEngine> engine;
+  static thread_local std::unique_ptr<RandomUniformEngine> engine;
 
   SingletonRandomEngine(const SingletonRandomEngine &)            = delete;
   SingletonRandomEngine(SingletonRandomEngine &&)                 = delete;
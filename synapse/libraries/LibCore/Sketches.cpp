@@ -0,0 +1,145 @@
+#include <LibCore/Sketches.h>
+#include <LibCore/Debug.h>
+
+#include <cmath>
+#include <limits>
+
+namespace LibCore {
+
+LogHistogram::LogHistogram() : total(0), min(std::numeric_limits<u64>::max()), max(0), sum(0), sum_squares(0) {}
+
+size_t LogHistogram::bucket_index(u64 value) {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+
+  const u64 magnitude = 63 - __builtin_clzll(value);
+  const u64 shift     = magnitude - SUB_BUCKET_BITS;
+
+  return ((shift + 1) << SUB_BUCKET_BITS) + ((value >> shift) - SUB_BUCKETS);
+}
+
+u64 LogHistogram::bucket_highest_value(size_t index) {
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+
+  const u64 shift  = (index >> SUB_BUCKET_BITS) - 1;
+  const u64 lowest = ((index & (SUB_BUCKETS - 1)) + SUB_BUCKETS) << shift;
+
+  return lowest + ((1ull << shift) - 1);
+}
+
+void LogHistogram::add(u64 value, u64 count) {
+  if (count == 0) {
+    return;
+  }
+
+  const size_t index = bucket_index(value);
+  if (index >= counts.size()) {
+    counts.resize(index + 1, 0);
+  }
+
+  counts[index] += count;
+  total += count;
+  min = std::min(min, value);
+  max = std::max(max, value);
+  sum += static_cast<double>(value) * count;
+  sum_squares += static_cast<double>(value) * value * count;
+}
+
+void LogHistogram::merge(const LogHistogram &other) {
+  if (other.counts.size() > counts.size()) {
+    counts.resize(other.counts.size(), 0);
+  }
+
+  for (size_t i = 0; i < other.counts.size(); i++) {
+    counts[i] += other.counts[i];
+  }
+
+  total += other.total;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+  sum += other.sum;
+  sum_squares += other.sum_squares;
+}
+
+std::map<u64, double> LogHistogram::get_cdf() const {
+  std::map<u64, double> cdf;
+  u64 accounted = 0;
+
+  double next_p = 0;
+  double step   = 0.05;
+
+  for (size_t i = 0; i < counts.size(); i++) {
+    if (counts[i] == 0) {
+      continue;
+    }
+
+    accounted += counts[i];
+
+    // Buckets are coarser than the values they hold, but the extremes are known exactly.
+    const u64 value = std::clamp(bucket_highest_value(i), min, max);
+
+    if (accounted == total) {
+      cdf[value] = 1;
+      break;
+    }
+
+    double p = static_cast<double>(accounted) / total;
+
+    if (p >= next_p) {
+      cdf[value] = p;
+
+      while (p >= next_p) {
+        next_p += step;
+      }
+    }
+  }
+
+  return cdf;
+}
+
+double LogHistogram::get_avg() const { return sum / total; }
+
+double LogHistogram::get_stdev() const {
+  const double avg      = get_avg();
+  const double variance = sum_squares / total - avg * avg;
+  return variance > 0 ? sqrt(variance) : 0;
+}
+
+HyperLogLog::HyperLogLog(u8 _precision) : precision(_precision), registers(1ull << _precision, 0) {
+  assert_or_panic(precision >= 4 && precision <= 18, "Invalid HyperLogLog precision %u", precision);
+}
+
+void HyperLogLog::merge(const HyperLogLog &other) {
+  assert_or_panic(precision == other.precision, "Merging HyperLogLogs with different precisions");
+  for (size_t i = 0; i < registers.size(); i++) {
+    registers[i] = std::max(registers[i], other.registers[i]);
+  }
+}
+
+u64 HyperLogLog::estimate() const {
+  const double m = registers.size();
+
+  double harmonic_sum = 0;
+  size_t zeros        = 0;
+  for (u8 reg : registers) {
+    harmonic_sum += std::ldexp(1.0, -reg);
+    if (reg == 0) {
+      zeros++;
+    }
+  }
+
+  const double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate    = alpha * m * m / harmonic_sum;
+
+  // Small cardinalities are better served by linear counting. With 64 bit hashes, there is no need for a large range correction.
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / zeros);
+  }
+
+  return static_cast<u64>(std::llround(estimate));
+}
+
+} // namespace LibCore
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <LibCore/Types.h>
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace LibCore {
+
+// Bounded-memory summaries of unbounded streams. All of them can be merged, so a stream can be split across threads and summarized piecewise.
+
+// SplitMix64 finalizer, to spread weak hashes (e.g. XORed fields) over all 64 bits.
+inline u64 mix64(u64 x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return x;
+}
+
+// Log-linear histogram, in the spirit of HDR histograms. Values below 2^SUB_BUCKET_BITS are counted exactly, and every power of two above that is
+// split into 2^SUB_BUCKET_BITS buckets, so every value is known within a relative error of 2^-SUB_BUCKET_BITS. It never takes more than ~58 KiB.
+// Average and standard deviation are exact.
+class LogHistogram {
+private:
+  static constexpr const u64 SUB_BUCKET_BITS = 7;
+  static constexpr const u64 SUB_BUCKETS     = 1ull << SUB_BUCKET_BITS;
+
+  std::vector<u64> counts;
+  u64 total;
+  u64 min;
+  u64 max;
+  double sum;
+  double sum_squares;
+
+public:
+  LogHistogram();
+
+  void add(u64 value) { add(value, 1); }
+  void add(u64 value, u64 count);
+  void merge(const LogHistogram &other);
+
+  u64 get_total() const { return total; }
+
+  // Same as an exact CDF sampled every 5% of the probability mass, each value being the highest one its bucket may hold.
+  std::map<u64, double> get_cdf() const;
+  double get_avg() const;
+  double get_stdev() const;
+
+private:
+  static size_t bucket_index(u64 value);
+  static u64 bucket_highest_value(size_t index);
+};
+
+// HyperLogLog distinct counter, over 2^precision one byte registers. The standard error is 1.04/sqrt(2^precision).
+class HyperLogLog {
+private:
+  u8 precision;
+  std::vector<u8> registers;
+
+public:
+  HyperLogLog(u8 precision);
+
+  void add_hash(u64 hash) {
+    const u64 index = hash >> (64 - precision);
+    const u64 rest  = hash << precision;
+    const u8 rank   = rest == 0 ? 64 - precision + 1 : __builtin_clzll(rest) + 1;
+    registers[index] = std::max(registers[index], rank);
+  }
+
+  void merge(const HyperLogLog &other);
+  u64 estimate() const;
+};
+
+// Space-saving top-k counter (Metwally et al.), over a fixed number of counters kept as a min-heap on their counts. Every key counted more than
+// total/capacity times is in there, and counts overestimate the real ones by at most their error.
+template <typename K, typename Hash> class SpaceSaving {
+public:
+  struct counter_t {
+    K key;
+    u64 count;
+    u64 error;
+  };
+
+private:
+  size_t capacity;
+  std::vector<counter_t> heap;
+  std::unordered_map<K, size_t, Hash> positions;
+
+public:
+  SpaceSaving(size_t _capacity) : capacity(std::max<size_t>(_capacity, 1)) {}
+
+  void add(const K &key, u64 weight) {
+    auto found_it = positions.find(key);
+
+    if (found_it != positions.end()) {
+      heap[found_it->second].count += weight;
+      sift_down(found_it->second);
+      return;
+    }
+
+    if (heap.size() < capacity) {
+      heap.push_back({key, weight, 0});
+      positions[key] = heap.size() - 1;
+      sift_up(heap.size() - 1);
+      return;
+    }
+
+    // Take over the smallest counter, inheriting its count as the error.
+    counter_t &smallest = heap.front();
+    positions.erase(smallest.key);
+
+    smallest.key   = key;
+    smallest.error = smallest.count;
+    smallest.count += weight;
+    positions[key] = 0;
+
+    sift_down(0);
+  }
+
+  void merge(const SpaceSaving &other) {
+    for (const counter_t &counter : other.heap) {
+      add(counter.key, counter.count);
+    }
+  }
+
+  // From the most to the least counted.
+  std::vector<counter_t> get_top() const {
+    std::vector<counter_t> top = heap;
+    std::sort(top.begin(), top.end(), [](const counter_t &c0, const counter_t &c1) { return c0.count > c1.count; });
+    return top;
+  }
+
+private:
+  void swap_counters(size_t i, size_t j) {
+    std::swap(heap[i], heap[j]);
+    positions[heap[i].key] = i;
+    positions[heap[j].key] = j;
+  }
+
+  void sift_up(size_t i) {
+    while (i > 0 && heap[(i - 1) / 2].count > heap[i].count) {
+      swap_counters(i, (i - 1) / 2);
+      i = (i - 1) / 2;
+    }
+  }
+
+  void sift_down(size_t i) {
+    while (true) {
+      const size_t left  = 2 * i + 1;
+      const size_t right = 2 * i + 2;
+      size_t smallest    = i;
+
+      if (left < heap.size() && heap[left].count < heap[smallest].count) {
+        smallest = left;
+      }
+
+      if (right < heap.size() && heap[right].count < heap[smallest].count) {
+        smallest = right;
+      }
+
+      if (smallest == i) {
+        break;
+      }
+
+      swap_counters(i, smallest);
+      i = smallest;
+    }
+  }
+};
+
+} // namespace LibCore
\ No newline at end of file
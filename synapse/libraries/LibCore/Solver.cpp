@@ -2,69 +2,256 @@
 #include <LibCore/Expr.h>
 #include <LibCore/Debug.h>
 
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
 namespace LibCore {
 
-solver_toolbox_t solver_toolbox;
+thread_local solver_toolbox_t solver_toolbox;
 
-solver_toolbox_t::solver_toolbox_t()
-    : solver(createCexCachingSolver(klee::createCoreSolver(klee::Z3_SOLVER))), exprBuilder(klee::createDefaultExprBuilder()) {
-  assert(solver && "Failed to create solver");
-  assert(exprBuilder && "Failed to create exprBuilder");
+namespace SolverStats {
+
+std::atomic<u64> num_trivial_queries{0};
+std::atomic<u64> num_cache_hits{0};
+std::atomic<u64> num_cache_misses{0};
+
+} // namespace SolverStats
+
+namespace {
+
+enum class QueryKind { MustBeTrue, MustBeFalse, MayBeTrue, MayBeFalse, GetValue };
+
+size_t hash_combine(size_t hash, size_t value) { return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2)); }
+
+// A query as it is asked, looked up in the cache without copying anything. Constraints are taken in the order the ConstraintManager holds them, as
+// canonicalizing them would mean copying and sorting them (by structural comparison) on every query, hit or not.
+struct query_t {
+  QueryKind kind;
+  const klee::ConstraintManager &constraints;
+  klee::ref<klee::Expr> expr;
+  size_t hash;
+
+  query_t(QueryKind _kind, const klee::ConstraintManager &_constraints, klee::ref<klee::Expr> _expr)
+      : kind(_kind), constraints(_constraints), expr(_expr), hash(static_cast<size_t>(_kind)) {
+    for (const klee::ref<klee::Expr> &constraint : constraints) {
+      hash = hash_combine(hash, constraint->hash());
+    }
+
+    hash = hash_combine(hash, expr->hash());
+  }
+};
+
+// What the cache holds on to, only built when storing a new entry.
+struct query_key_t {
+  QueryKind kind;
+  std::vector<klee::ref<klee::Expr>> constraints;
+  klee::ref<klee::Expr> expr;
+  size_t hash;
+
+  query_key_t(const query_t &query)
+      : kind(query.kind), constraints(query.constraints.begin(), query.constraints.end()), expr(query.expr), hash(query.hash) {}
+};
+
+struct query_key_hash_t {
+  using is_transparent = void;
+
+  size_t operator()(const query_key_t &key) const { return key.hash; }
+  size_t operator()(const query_t &query) const { return query.hash; }
+};
+
+struct query_key_equal_t {
+  using is_transparent = void;
+
+  // Cheap checks first, the structural comparison of expressions is what costs.
+  bool operator()(const query_key_t &key, const query_t &query) const {
+    return key.kind == query.kind && key.hash == query.hash && key.constraints.size() == query.constraints.size() && key.expr == query.expr &&
+           std::equal(key.constraints.begin(), key.constraints.end(), query.constraints.begin());
+  }
+
+  bool operator()(const query_t &query, const query_key_t &key) const { return (*this)(key, query); }
+
+  bool operator()(const query_key_t &key, const query_key_t &other) const {
+    return key.kind == other.kind && key.hash == other.hash && key.constraints.size() == other.constraints.size() && key.expr == other.expr &&
+           key.constraints == other.constraints;
+  }
+};
+
+// Per thread, as keys hold klee::refs: even looking one up compares expressions, which is not thread-safe.
+class QueryCache {
+private:
+  // The cache keeps the expressions alive, so we don't let it grow forever. When full, we simply start over.
+  static constexpr const size_t MAX_ENTRIES{1'000'000};
+
+  std::unordered_map<query_key_t, u64, query_key_hash_t, query_key_equal_t> entries;
+
+public:
+  std::optional<u64> get(const query_t &query) const {
+    auto found_it = entries.find(query);
+    if (found_it == entries.end()) {
+      return std::nullopt;
+    }
+
+    return found_it->second;
+  }
+
+  void put(const query_t &query, u64 value) {
+    if (entries.size() >= MAX_ENTRIES) {
+      entries.clear();
+    }
+
+    entries.emplace(query_key_t(query), value);
+  }
+};
+
+thread_local QueryCache query_cache;
+
+bool contains(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) {
+  for (klee::ref<klee::Expr> constraint : constraints) {
+    if (constraint == expr) {
+      return true;
+    }
+  }
+  return false;
 }
 
-bool solver_toolbox_t::is_expr_always_true(klee::ref<klee::Expr> expr) const {
-  klee::ConstraintManager no_constraints;
-  return is_expr_always_true(no_constraints, expr);
+// Answers queries we don't need a solver for. This mirrors what KLEE does with constant expressions (the constraints are not checked for
+// satisfiability), and adds a couple of syntactic shortcuts that the default expression builder doesn't simplify away.
+std::optional<bool> trivial_check(QueryKind kind, const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) {
+  std::optional<bool> value;
+
+  if (expr->getKind() == klee::Expr::Constant) {
+    value = expr->isTrue();
+  } else if (expr->getKind() == klee::Expr::Eq && expr->getKid(0) == expr->getKid(1)) {
+    value = true;
+  } else if (kind == QueryKind::MustBeTrue && contains(constraints, expr)) {
+    return true;
+  }
+
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+
+  switch (kind) {
+  case QueryKind::MustBeTrue:
+  case QueryKind::MayBeTrue:
+    return *value;
+  case QueryKind::MustBeFalse:
+  case QueryKind::MayBeFalse:
+    return !*value;
+  case QueryKind::GetValue:
+    break;
+  }
+
+  return std::nullopt;
 }
 
-bool solver_toolbox_t::is_expr_always_true(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) const {
-  klee::Query sat_query(constraints, expr);
+bool solve(klee::Solver *solver, QueryKind kind, const klee::Query &query) {
+  bool result  = false;
+  bool success = false;
+
+  switch (kind) {
+  case QueryKind::MustBeTrue:
+    success = solver->mustBeTrue(query, result);
+    break;
+  case QueryKind::MustBeFalse:
+    success = solver->mustBeFalse(query, result);
+    break;
+  case QueryKind::MayBeTrue:
+    success = solver->mayBeTrue(query, result);
+    break;
+  case QueryKind::MayBeFalse:
+    success = solver->mayBeFalse(query, result);
+    break;
+  case QueryKind::GetValue:
+    panic("Not a boolean query");
+  }
 
-  bool result = false;
-  if (!solver->mustBeTrue(sat_query, result)) {
+  if (!success) {
     panic("Solver internal error");
   }
 
   return result;
 }
 
-bool solver_toolbox_t::is_expr_maybe_true(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) const {
-  klee::Query sat_query(constraints, expr);
+bool check(klee::Solver *solver, QueryKind kind, const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) {
+  const std::optional<bool> trivial_result = trivial_check(kind, constraints, expr);
+  if (trivial_result.has_value()) {
+    SolverStats::num_trivial_queries++;
+    return *trivial_result;
+  }
 
-  bool result = false;
-  if (!solver->mayBeTrue(sat_query, result)) {
-    panic("Solver internal error");
+  const query_t query(kind, constraints, expr);
+
+  const std::optional<u64> cached_result = query_cache.get(query);
+  if (cached_result.has_value()) {
+    SolverStats::num_cache_hits++;
+    return *cached_result != 0;
   }
 
+  SolverStats::num_cache_misses++;
+
+  const bool result = solve(solver, kind, klee::Query(constraints, expr));
+  query_cache.put(query, result);
+
   return result;
 }
 
-bool solver_toolbox_t::is_expr_maybe_false(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) const {
-  klee::Query sat_query(constraints, expr);
+// Callers are expected to handle constant expressions themselves.
+u64 get_value(klee::Solver *solver, const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) {
+  const query_t query(QueryKind::GetValue, constraints, expr);
+
+  const std::optional<u64> cached_value = query_cache.get(query);
+  if (cached_value.has_value()) {
+    SolverStats::num_cache_hits++;
+    return *cached_value;
+  }
 
-  bool result = false;
-  if (!solver->mayBeFalse(sat_query, result)) {
+  SolverStats::num_cache_misses++;
+
+  klee::ref<klee::ConstantExpr> value_expr;
+  if (!solver->getValue(klee::Query(constraints, expr), value_expr)) {
     panic("Solver internal error");
   }
 
-  return result;
+  const u64 value = value_expr->getZExtValue();
+  query_cache.put(query, value);
+
+  return value;
+}
+
+} // namespace
+
+solver_toolbox_t::solver_toolbox_t()
+    : solver(createCexCachingSolver(klee::createCoreSolver(klee::Z3_SOLVER))), exprBuilder(klee::createDefaultExprBuilder()) {
+  assert(solver && "Failed to create solver");
+  assert(exprBuilder && "Failed to create exprBuilder");
+}
+
+bool solver_toolbox_t::is_expr_always_true(klee::ref<klee::Expr> expr) const {
+  klee::ConstraintManager no_constraints;
+  return is_expr_always_true(no_constraints, expr);
+}
+
+bool solver_toolbox_t::is_expr_always_true(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) const {
+  return check(solver.get(), QueryKind::MustBeTrue, constraints, expr);
+}
+
+bool solver_toolbox_t::is_expr_maybe_true(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) const {
+  return check(solver.get(), QueryKind::MayBeTrue, constraints, expr);
+}
+
+bool solver_toolbox_t::is_expr_maybe_false(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) const {
+  return check(solver.get(), QueryKind::MayBeFalse, constraints, expr);
 }
 
 bool solver_toolbox_t::are_exprs_always_equal(klee::ref<klee::Expr> e1, klee::ref<klee::Expr> e2, klee::ConstraintManager c1,
                                               klee::ConstraintManager c2) const {
   klee::ref<klee::Expr> eq_expr = exprBuilder->Eq(e1, e2);
 
-  klee::Query eq_in_e1_ctx_sat_query(c1, eq_expr);
-  bool eq_in_e1_ctx = false;
-  if (!solver->mustBeTrue(eq_in_e1_ctx_sat_query, eq_in_e1_ctx)) {
-    panic("Solver internal error");
-  }
-
-  klee::Query eq_in_e2_ctx_sat_query(c2, eq_expr);
-  bool eq_in_e2_ctx = false;
-  if (!solver->mustBeTrue(eq_in_e2_ctx_sat_query, eq_in_e2_ctx)) {
-    panic("Solver internal error");
-  }
+  const bool eq_in_e1_ctx = check(solver.get(), QueryKind::MustBeTrue, c1, eq_expr);
+  const bool eq_in_e2_ctx = check(solver.get(), QueryKind::MustBeTrue, c2, eq_expr);
 
   return eq_in_e1_ctx && eq_in_e2_ctx;
 }
@@ -73,17 +260,8 @@ bool solver_toolbox_t::are_exprs_always_not_equal(klee::ref<klee::Expr> e1, klee
                                                   klee::ConstraintManager c2) const {
   klee::ref<klee::Expr> eq_expr = exprBuilder->Eq(e1, e2);
 
-  klee::Query eq_in_e1_ctx_sat_query(c1, eq_expr);
-  bool not_eq_in_e1_ctx = false;
-  if (!solver->mustBeFalse(eq_in_e1_ctx_sat_query, not_eq_in_e1_ctx)) {
-    panic("Solver internal error");
-  }
-
-  klee::Query eq_in_e2_ctx_sat_query(c2, eq_expr);
-  bool not_eq_in_e2_ctx = false;
-  if (!solver->mustBeFalse(eq_in_e2_ctx_sat_query, not_eq_in_e2_ctx)) {
-    panic("Solver internal error");
-  }
+  const bool not_eq_in_e1_ctx = check(solver.get(), QueryKind::MustBeFalse, c1, eq_expr);
+  const bool not_eq_in_e2_ctx = check(solver.get(), QueryKind::MustBeFalse, c2, eq_expr);
 
   return not_eq_in_e1_ctx && not_eq_in_e2_ctx;
 }
@@ -94,14 +272,7 @@ bool solver_toolbox_t::is_expr_always_false(klee::ref<klee::Expr> expr) const {
 }
 
 bool solver_toolbox_t::is_expr_always_false(const klee::ConstraintManager &constraints, klee::ref<klee::Expr> expr) const {
-  klee::Query sat_query(constraints, expr);
-
-  bool result = false;
-  if (!solver->mustBeFalse(sat_query, result)) {
-    panic("Solver internal error");
-  }
-
-  return result;
+  return check(solver.get(), QueryKind::MustBeFalse, constraints, expr);
 }
 
 bool solver_toolbox_t::are_exprs_always_equal(klee::ref<klee::Expr> expr1, klee::ref<klee::Expr> expr2) const {
@@ -131,19 +302,8 @@ bool solver_toolbox_t::strict_value_from_expr(klee::ref<klee::Expr> expr, u64 &v
     return true;
   }
 
-  struct expr_hash_t {
-    std::size_t operator()(klee::ref<klee::Expr> expr) const { return expr->hash(); }
-  };
-
   klee::ConstraintManager no_constraints;
-  klee::Query sat_query(no_constraints, expr);
-
-  klee::ref<klee::ConstantExpr> value_expr;
-  if (!solver->getValue(sat_query, value_expr)) {
-    panic("Solver internal error");
-  }
-
-  value = value_expr->getZExtValue();
+  value = get_value(solver.get(), no_constraints, expr);
 
   if (!is_expr_always_true(exprBuilder->Eq(expr, exprBuilder->Constant(value, expr->getWidth())))) {
     return false;
@@ -160,19 +320,8 @@ u64 solver_toolbox_t::value_from_expr(klee::ref<klee::Expr> expr) const {
     return constant_expr->getZExtValue();
   }
 
-  struct expr_hash_t {
-    std::size_t operator()(klee::ref<klee::Expr> expr) const { return expr->hash(); }
-  };
-
   klee::ConstraintManager no_constraints;
-  klee::Query sat_query(no_constraints, expr);
-
-  klee::ref<klee::ConstantExpr> value_expr;
-  if (!solver->getValue(sat_query, value_expr)) {
-    panic("Solver internal error");
-  }
-
-  return value_expr->getZExtValue();
+  return get_value(solver.get(), no_constraints, expr);
 }
 
 u64 solver_toolbox_t::value_from_expr(klee::ref<klee::Expr> expr, const klee::ConstraintManager &constraints) const {
@@ -181,14 +330,7 @@ u64 solver_toolbox_t::value_from_expr(klee::ref<klee::Expr> expr, const klee::Co
     return constant_expr->getZExtValue();
   }
 
-  klee::Query sat_query(constraints, expr);
-
-  klee::ref<klee::ConstantExpr> value_expr;
-  if (!solver->getValue(sat_query, value_expr)) {
-    panic("Solver internal error");
-  }
-
-  return value_expr->getZExtValue();
+  return get_value(solver.get(), constraints, expr);
 }
 
 int64_t solver_toolbox_t::signed_value_from_expr(klee::ref<klee::Expr> expr, const klee::ConstraintManager &constraints) const {
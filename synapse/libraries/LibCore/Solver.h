@@ -2,6 +2,7 @@
 
 #include <LibCore/Types.h>
 
+#include <atomic>
 #include <memory>
 
 #include <klee/ExprBuilder.h>
@@ -38,6 +39,19 @@ struct solver_toolbox_t {
   i64 signed_value_from_expr(klee::ref<klee::Expr> expr, const klee::ConstraintManager &constraints) const;
 };
 
-extern solver_toolbox_t solver_toolbox;
+// Each thread gets its own toolbox (and therefore its own Z3 instance), lazily built on first use. Z3 contexts are not thread-safe, and this
+// way parallel search workers never share a solver.
+//
+// Query results are cached per thread as well: the cache holds (and compares) klee::refs, which are not safe to share across threads.
+extern thread_local solver_toolbox_t solver_toolbox;
+
+namespace SolverStats {
+
+// Queries answered without the solver (constant or syntactically trivial expressions).
+extern std::atomic<u64> num_trivial_queries;
+extern std::atomic<u64> num_cache_hits;
+extern std::atomic<u64> num_cache_misses;
+
+} // namespace SolverStats
 
 } // namespace LibCore
\ No newline at end of file
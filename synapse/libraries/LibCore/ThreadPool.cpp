@@ -0,0 +1,55 @@
+#include <LibCore/ThreadPool.h>
+
+#include <cassert>
+
+namespace LibCore {
+
+ThreadPool::ThreadPool(size_t num_workers) : stopping(false) {
+  assert(num_workers > 0 && "Thread pool without workers");
+
+  workers.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; i++) {
+    workers.emplace_back(&ThreadPool::worker_loop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    stopping = true;
+  }
+
+  cv.notify_all();
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::worker_loop() {
+  while (true) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+      // Drain whatever was already submitted before shutting down.
+      if (stopping && tasks.empty()) {
+        return;
+      }
+
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+
+    task();
+  }
+}
+
+size_t ThreadPool::hardware_concurrency() {
+  const size_t n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+} // namespace LibCore
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace LibCore {
+
+// Fixed-size pool of long-lived workers.
+//
+// Workers are kept alive for the whole lifetime of the pool on purpose: thread-local state (e.g. the solver toolbox or the random engine) is
+// built the first time a worker touches it, and we want to pay that price once per worker, not once per task.
+class ThreadPool {
+private:
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> tasks;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stopping;
+
+public:
+  ThreadPool(size_t num_workers);
+
+  ThreadPool(const ThreadPool &)            = delete;
+  ThreadPool(ThreadPool &&)                 = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool();
+
+  size_t size() const { return workers.size(); }
+
+  template <typename F> std::future<std::invoke_result_t<F>> submit(F &&fn) {
+    using result_t = std::invoke_result_t<F>;
+
+    auto task                    = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(fn));
+    std::future<result_t> result = task->get_future();
+
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      tasks.emplace([task]() { (*task)(); });
+    }
+
+    cv.notify_one();
+    return result;
+  }
+
+  static size_t hardware_concurrency();
+
+private:
+  void worker_loop();
+};
+
+} // namespace LibCore
\ No newline at end of file
@@ -1,12 +1,18 @@
 #include <LibCore/TrafficGenerator.h>
+#include <LibCore/ThreadPool.h>
+
+#include <deque>
+#include <future>
+#include <memory>
 
 namespace LibCore {
 
 TrafficGenerator::TrafficGenerator(const std::string &_nf, const config_t &_config, bool _assume_ip)
     : nf(_nf), config(_config), assume_ip(_assume_ip), template_packet(build_pkt_template()), dt(compute_dt(config)),
       seeds_random_engine(config.random_seed), flows_random_engine_uniform(seeds_random_engine.generate(), 0, config.total_flows - 1),
-      flows_random_engine_zipf(seeds_random_engine.generate(), config.zipf_param, 0, config.total_flows - 1), pd(NULL), pdumper(NULL),
-      client_dev_it(0), counters(config.total_flows, 0), flows_swapped(0), current_time(0), alarm_tick(0), next_alarm(-1) {
+      flows_random_engine_zipf(seeds_random_engine.generate(), config.zipf_param, 0, config.total_flows - 1), flows_seed(config.random_seed),
+      pd(NULL), pdumper(NULL), client_dev_it(0), counters(config.total_flows, 0), flows_swapped(0), current_time(0), alarm_tick(0),
+      next_alarm(-1) {
   for (device_t warmup_dev : config.warmup_devices) {
     warmup_writers.emplace(warmup_dev, PcapWriter(get_warmup_pcap_fname(nf, config, warmup_dev), assume_ip));
     client_to_active_device.emplace(warmup_dev, warmup_dev);
@@ -55,6 +61,7 @@ void TrafficGenerator::config_t::print() const {
   }
   printf("]\n");
   printf("random seed: %u\n", random_seed);
+  printf("threads:     %lu\n", threads);
   printf("--- ---------- ---\n");
 }
 
@@ -87,6 +94,39 @@ TrafficGenerator::pkt_t TrafficGenerator::build_pkt_template() const {
   return pkt;
 }
 
+std::vector<TrafficGenerator::flow_idx_t> TrafficGenerator::draw_flow_idx_chunk(u64 chunk) const {
+  // SplitMix64 finalizer, so that consecutive chunks get unrelated seeds.
+  u64 z = (static_cast<u64>(flows_seed) << 32) ^ (chunk + 1) * 0x9E3779B97F4A7C15ull;
+  z     = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z     = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z     = z ^ (z >> 31);
+
+  const u32 chunk_seed = static_cast<u32>(z);
+
+  std::vector<flow_idx_t> flow_indices(FLOW_IDX_CHUNK_SIZE);
+
+  switch (config.traffic_type) {
+  case TrafficType::Uniform: {
+    RandomUniformEngine engine(chunk_seed, 0, config.total_flows - 1);
+    for (flow_idx_t &flow_idx : flow_indices) {
+      flow_idx = engine.generate();
+    }
+  } break;
+  case TrafficType::Zipf: {
+    RandomZipfEngine engine(chunk_seed, config.zipf_param, 0, config.total_flows - 1);
+    for (flow_idx_t &flow_idx : flow_indices) {
+      flow_idx = engine.generate();
+    }
+  } break;
+  }
+
+  for (flow_idx_t flow_idx : flow_indices) {
+    assert(flow_idx < config.total_flows);
+  }
+
+  return flow_indices;
+}
+
 void TrafficGenerator::generate() {
   const bytes_t hdrs_len = assume_ip ? get_hdrs_len() - sizeof(ether_hdr_t) : get_hdrs_len();
   const bytes_t pkt_len  = assume_ip ? config.packet_size_without_crc - sizeof(ether_hdr_t) : config.packet_size_without_crc;
@@ -98,8 +138,36 @@ void TrafficGenerator::generate() {
     printf("Dev %u: %s\n", dev, writer.get_output_fname().c_str());
   }
 
+  // Drawing the flow indices (the zipf one especially) is what dominates generation, and it is the only part that does not depend on the
+  // generator state: building a packet may allocate, swap or forget flows. So with more than one thread, the workers draw the chunks ahead, and
+  // this thread consumes them in order, building and writing the packets. That draws a different sequence of flows than a single thread does,
+  // which keeps the one the seed always gave.
+  std::unique_ptr<ThreadPool> pool = config.threads > 1 ? std::make_unique<ThreadPool>(config.threads) : nullptr;
+  std::deque<std::future<std::vector<flow_idx_t>>> pending_chunks;
+  std::vector<flow_idx_t> chunk;
+  u64 next_chunk  = 0;
+  size_t chunk_it = 0;
+
+  auto next_flow_idx = [&]() {
+    if (!pool) {
+      return get_next_flow_idx();
+    }
+
+    while (pending_chunks.size() < 2 * pool->size()) {
+      pending_chunks.push_back(pool->submit([this, i = next_chunk++]() { return draw_flow_idx_chunk(i); }));
+    }
+
+    if (chunk_it == chunk.size()) {
+      chunk = pending_chunks.front().get();
+      pending_chunks.pop_front();
+      chunk_it = 0;
+    }
+
+    return chunk[chunk_it++];
+  };
+
   const device_t first_client_dev = get_current_client_dev();
-  flow_idx_t flow_idx             = get_next_flow_idx();
+  flow_idx_t flow_idx             = next_flow_idx();
 
   while (counter < config.total_packets) {
     const device_t client_dev = get_current_client_dev();
@@ -108,7 +176,7 @@ void TrafficGenerator::generate() {
 
     if (client_dev == first_client_dev) {
       tick();
-      flow_idx = get_next_flow_idx();
+      flow_idx = next_flow_idx();
       if (next_alarm >= 0 && current_time >= next_alarm) {
         random_swap_flow(flow_idx);
         counters[flow_idx] = 0;
@@ -30,6 +30,11 @@ public:
   static constexpr const fpm_t DEFAULT_TOTAL_CHURN_FPM    = 0;
   static constexpr const TrafficType DEFAULT_TRAFFIC_TYPE = TrafficType::Uniform;
   static constexpr const double DEFAULT_ZIPF_PARAM        = 1.26; // From Castan [SIGCOMM'18]
+  static constexpr const size_t DEFAULT_THREADS           = 1;
+
+  // With more than one thread, flow indices are drawn in chunks of this many, each from its own engine. Fixed, so that the traffic is the same for
+  // any thread count above one.
+  static constexpr const u64 FLOW_IDX_CHUNK_SIZE = 65'536;
 
   struct config_t {
     std::filesystem::path out_dir;
@@ -43,12 +48,14 @@ public:
     std::vector<device_t> devices;
     std::vector<device_t> warmup_devices;
     u32 random_seed;
+    size_t threads;
     bool dry_run;
 
     config_t()
         : out_dir(DEFAULT_OUTPUT_DIR), total_packets(DEFAULT_TOTAL_PACKETS), total_flows(DEFAULT_TOTAL_FLOWS),
           packet_size_without_crc(DEFAULT_PACKET_SIZE - CRC_SIZE_BYTES), rate(DEFAULT_RATE), churn(DEFAULT_TOTAL_CHURN_FPM),
-          traffic_type(DEFAULT_TRAFFIC_TYPE), zipf_param(DEFAULT_ZIPF_PARAM), devices(), warmup_devices(), random_seed(0), dry_run(false) {}
+          traffic_type(DEFAULT_TRAFFIC_TYPE), zipf_param(DEFAULT_ZIPF_PARAM), devices(), warmup_devices(), random_seed(0),
+          threads(DEFAULT_THREADS), dry_run(false) {}
 
     void print() const;
   };
@@ -73,6 +80,7 @@ protected:
   RandomUniformEngine seeds_random_engine;
   RandomUniformEngine flows_random_engine_uniform;
   RandomZipfEngine flows_random_engine_zipf;
+  const u32 flows_seed;
   std::unordered_map<device_t, device_t> client_to_active_device;
 
   pcap_t *pd;
@@ -182,6 +190,9 @@ private:
     assert(flow_idx < config.total_flows);
     return flow_idx;
   }
+
+  // Chunk i of the flow indices is drawn from an engine seeded with (flows_seed, i) alone, so chunks can be drawn ahead and out of order.
+  std::vector<flow_idx_t> draw_flow_idx_chunk(u64 chunk) const;
 };
 
 } // namespace LibCore
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <LibCore/Expr.h>
 #include <LibCore/Debug.h>
 
+#include <algorithm>
+
 namespace LibSynapse {
 
 using LibBDD::bdd_node_id_t;
@@ -91,19 +93,19 @@ void Context::bdd_pre_processing_get_coalescing_candidates(const BDD *bdd) {
 
       map_coalescing_objs_t candidate;
       if (bdd->get_map_coalescing_objs(addr, candidate)) {
-        coalescing_candidates.push_back(candidate);
+        bdd_info->coalescing_candidates.push_back(candidate);
       }
     }
   }
 }
 
 void Context::bdd_pre_processing_get_dchains_failing_to_allocate_new_index_hit_rates(const BDD *bdd) {
-  for (const map_coalescing_objs_t &map_objs : coalescing_candidates) {
+  for (const map_coalescing_objs_t &map_objs : bdd_info->coalescing_candidates) {
     const std::vector<branch_direction_t> branches_checking_index_alloc = bdd->find_all_branches_checking_index_alloc(map_objs.dchain);
     for (const branch_direction_t &branch_direction : branches_checking_index_alloc) {
       const BDDNode *failure_node = branch_direction.get_failure_node();
       const hit_rate_t failure_hr = profiler.get_hr(failure_node);
-      dchains_failing_to_allocate_new_index_hit_rates[map_objs.dchain].push_back(failure_hr);
+      bdd_info->dchains_failing_to_allocate_new_index_hit_rates[map_objs.dchain].push_back(failure_hr);
     }
   }
 }
@@ -115,50 +117,50 @@ void Context::bdd_pre_processing_get_ds_configs(const BDD *bdd) {
     const call_t &call = call_node->get_call();
 
     if (call.function_name == "map_allocate") {
-      klee::ref<klee::Expr> obj = call.args.at("map_out").out;
-      const addr_t addr         = expr_addr_to_obj_addr(obj);
-      const map_config_t cfg    = get_map_config_from_bdd(*bdd, addr);
-      map_configs[addr]         = cfg;
+      klee::ref<klee::Expr> obj   = call.args.at("map_out").out;
+      const addr_t addr           = expr_addr_to_obj_addr(obj);
+      const map_config_t cfg      = get_map_config_from_bdd(*bdd, addr);
+      bdd_info->map_configs[addr] = cfg;
       continue;
     }
 
     if (call.function_name == "vector_allocate") {
-      klee::ref<klee::Expr> obj = call.args.at("vector_out").out;
-      const addr_t addr         = expr_addr_to_obj_addr(obj);
-      const vector_config_t cfg = get_vector_config_from_bdd(*bdd, addr);
-      vector_configs[addr]      = cfg;
+      klee::ref<klee::Expr> obj      = call.args.at("vector_out").out;
+      const addr_t addr              = expr_addr_to_obj_addr(obj);
+      const vector_config_t cfg      = get_vector_config_from_bdd(*bdd, addr);
+      bdd_info->vector_configs[addr] = cfg;
       continue;
     }
 
     if (call.function_name == "dchain_allocate") {
-      klee::ref<klee::Expr> obj = call.args.at("chain_out").out;
-      const addr_t addr         = expr_addr_to_obj_addr(obj);
-      const dchain_config_t cfg = get_dchain_config_from_bdd(*bdd, addr);
-      dchain_configs[addr]      = cfg;
+      klee::ref<klee::Expr> obj      = call.args.at("chain_out").out;
+      const addr_t addr              = expr_addr_to_obj_addr(obj);
+      const dchain_config_t cfg      = get_dchain_config_from_bdd(*bdd, addr);
+      bdd_info->dchain_configs[addr] = cfg;
       continue;
     }
 
     if (call.function_name == "cms_allocate") {
-      klee::ref<klee::Expr> obj = call.args.at("cms_out").out;
-      const addr_t addr         = expr_addr_to_obj_addr(obj);
-      const cms_config_t cfg    = get_cms_config_from_bdd(*bdd, addr);
-      cms_configs[addr]         = cfg;
+      klee::ref<klee::Expr> obj   = call.args.at("cms_out").out;
+      const addr_t addr           = expr_addr_to_obj_addr(obj);
+      const cms_config_t cfg      = get_cms_config_from_bdd(*bdd, addr);
+      bdd_info->cms_configs[addr] = cfg;
       continue;
     }
 
     if (call.function_name == "cht_fill_cht") {
-      klee::ref<klee::Expr> obj = call.args.at("cht").expr;
-      const addr_t addr         = expr_addr_to_obj_addr(obj);
-      const cht_config_t cfg    = get_cht_config_from_bdd(*bdd, addr);
-      cht_configs[addr]         = cfg;
+      klee::ref<klee::Expr> obj   = call.args.at("cht").expr;
+      const addr_t addr           = expr_addr_to_obj_addr(obj);
+      const cht_config_t cfg      = get_cht_config_from_bdd(*bdd, addr);
+      bdd_info->cht_configs[addr] = cfg;
       continue;
     }
 
     if (call.function_name == "tb_allocate") {
-      klee::ref<klee::Expr> obj = call.args.at("tb_out").out;
-      const addr_t addr         = expr_addr_to_obj_addr(obj);
-      const tb_config_t cfg     = get_tb_config_from_bdd(*bdd, addr);
-      tb_configs[addr]          = cfg;
+      klee::ref<klee::Expr> obj  = call.args.at("tb_out").out;
+      const addr_t addr          = expr_addr_to_obj_addr(obj);
+      const tb_config_t cfg      = get_tb_config_from_bdd(*bdd, addr);
+      bdd_info->tb_configs[addr] = cfg;
       continue;
     }
   }
@@ -176,13 +178,13 @@ void Context::bdd_pre_processing_get_structural_fields(const BDD *bdd) {
     if (call.function_name == "packet_borrow_next_chunk") {
       expr_struct_t header;
       if (call_node->guess_header_fields_from_packet_borrow(header)) {
-        expr_structs.push_back(header);
+        bdd_info->expr_structs.push_back(header);
       }
     } else if (call.function_name == "vector_borrow") {
       expr_struct_t value_struct;
       if (call_node->guess_value_fields_from_vector_borrow(value_struct)) {
         bool found = false;
-        for (expr_struct_t &existing_struct : expr_structs) {
+        for (expr_struct_t &existing_struct : bdd_info->expr_structs) {
           const bool same_expr = solver_toolbox.are_exprs_always_equal(existing_struct.expr, value_struct.expr);
 
           if (!same_expr) {
@@ -199,7 +201,7 @@ void Context::bdd_pre_processing_get_structural_fields(const BDD *bdd) {
         }
 
         if (!found) {
-          expr_structs.push_back(value_struct);
+          bdd_info->expr_structs.push_back(value_struct);
         }
       }
     }
@@ -215,7 +217,7 @@ void Context::bdd_pre_processing_build_tofino_parser(const BDD *bdd) {
     return;
   }
 
-  Tofino::TofinoContext *tofino_ctx = dynamic_cast<Tofino::TofinoContext *>(target_ctxs.at(type));
+  Tofino::TofinoContext *tofino_ctx = dynamic_cast<Tofino::TofinoContext *>(target_ctxs.at(type).get());
 
   struct parser_operations_t : cookie_t {
     std::vector<const BDDNode *> nodes;
@@ -313,7 +315,7 @@ void Context::bdd_pre_processing_log() {
   std::cerr << "\n";
 
   std::cerr << "Coalescing candidates:\n";
-  for (const map_coalescing_objs_t &candidate : coalescing_candidates) {
+  for (const map_coalescing_objs_t &candidate : bdd_info->coalescing_candidates) {
     std::cerr << "  ";
     std::cerr << " map=" << candidate.map << ", dchain=" << candidate.dchain << ", vectors=[";
     size_t i = 0;
@@ -327,7 +329,7 @@ void Context::bdd_pre_processing_log() {
   }
 
   std::cerr << "Hit rates of dchains failing to allocate new index:\n";
-  for (const auto &[dchain, hit_rates] : dchains_failing_to_allocate_new_index_hit_rates) {
+  for (const auto &[dchain, hit_rates] : bdd_info->dchains_failing_to_allocate_new_index_hit_rates) {
     std::cerr << "  dchain=" << dchain << ", hit rates={";
     size_t i = 0;
     for (hit_rate_t hr : hit_rates) {
@@ -341,7 +343,7 @@ void Context::bdd_pre_processing_log() {
 
   std::cerr << "\n";
   std::cerr << "Structural estimations:\n";
-  for (const expr_struct_t &expr_struct : expr_structs) {
+  for (const expr_struct_t &expr_struct : bdd_info->expr_structs) {
     std::cerr << "--------------------------------\n";
     std::cerr << "Expr: " << expr_to_string(expr_struct.expr, true) << "\n";
     std::cerr << "Fields:\n";
@@ -354,14 +356,17 @@ void Context::bdd_pre_processing_log() {
 }
 
 Context::Context(const BDD *bdd, const TargetsView &targets, const targets_config_t &targets_config, const Profiler &_profiler)
-    : profiler(_profiler), perf_oracle(targets_config, profiler.get_avg_pkt_bytes()), expiration_data(build_expiration_data(bdd)) {
+    : profiler(_profiler), perf_oracle(std::make_shared<PerfOracle>(targets_config, profiler.get_avg_pkt_bytes())),
+      bdd_info(std::make_shared<bdd_info_t>()), ds_impls(std::make_shared<std::unordered_map<addr_t, DSImpl>>()) {
   for (const TargetView &target : targets.elements) {
-    target_ctxs[target.type] = target.base_ctx->clone();
+    target_ctxs[target.type] = std::shared_ptr<TargetContext>(target.base_ctx->clone());
   }
 
+  bdd_info->expiration_data = build_expiration_data(bdd);
+
   const Tofino::TofinoContext *tofino_ctx = get_target_ctx_if_available<Tofino::TofinoContext>();
-  if (tofino_ctx && expiration_data.has_value()) {
-    const time_ns_t expiration_time     = expiration_data->expiration_time;
+  if (tofino_ctx && bdd_info->expiration_data.has_value()) {
+    const time_ns_t expiration_time     = bdd_info->expiration_data->expiration_time;
     const time_ns_t min_expiration_time = tofino_ctx->get_tna().tna_config.properties.min_expiration_time * MILLION;
 
     if (expiration_time < min_expiration_time) {
@@ -377,136 +382,50 @@ Context::Context(const BDD *bdd, const TargetsView &targets, const targets_confi
   bdd_pre_processing_log();
 }
 
-Context::Context(const Context &other)
-    : profiler(other.profiler), perf_oracle(other.perf_oracle), map_configs(other.map_configs), vector_configs(other.vector_configs),
-      dchain_configs(other.dchain_configs), cms_configs(other.cms_configs), cht_configs(other.cht_configs), tb_configs(other.tb_configs),
-      coalescing_candidates(other.coalescing_candidates),
-      dchains_failing_to_allocate_new_index_hit_rates(other.dchains_failing_to_allocate_new_index_hit_rates), expiration_data(other.expiration_data),
-      expr_structs(other.expr_structs), ds_impls(other.ds_impls) {
-  for (auto &target_ctx_pair : other.target_ctxs) {
-    target_ctxs[target_ctx_pair.first] = target_ctx_pair.second->clone();
-  }
-}
-
-Context::Context(Context &&other)
-    : profiler(std::move(other.profiler)), perf_oracle(std::move(other.perf_oracle)), map_configs(std::move(other.map_configs)),
-      vector_configs(std::move(other.vector_configs)), dchain_configs(std::move(other.dchain_configs)), cms_configs(std::move(other.cms_configs)),
-      cht_configs(std::move(other.cht_configs)), tb_configs(std::move(other.tb_configs)),
-      coalescing_candidates(std::move(other.coalescing_candidates)),
-      dchains_failing_to_allocate_new_index_hit_rates(std::move(other.dchains_failing_to_allocate_new_index_hit_rates)),
-      expiration_data(std::move(other.expiration_data)), expr_structs(std::move(other.expr_structs)), ds_impls(std::move(other.ds_impls)),
-      target_ctxs(std::move(other.target_ctxs)) {}
-
-Context::~Context() {
-  for (auto &target_ctx_pair : target_ctxs) {
-    if (target_ctx_pair.second) {
-      delete target_ctx_pair.second;
-      target_ctx_pair.second = nullptr;
-    }
-  }
-}
-
-Context &Context::operator=(const Context &other) {
-  if (this == &other) {
-    return *this;
-  }
-
-  for (auto &[_, ctx_ptr] : target_ctxs) {
-    if (ctx_ptr) {
-      delete ctx_ptr;
-      ctx_ptr = nullptr;
-    }
-  }
-
-  profiler                                        = other.profiler;
-  perf_oracle                                     = other.perf_oracle;
-  map_configs                                     = other.map_configs;
-  vector_configs                                  = other.vector_configs;
-  dchain_configs                                  = other.dchain_configs;
-  cms_configs                                     = other.cms_configs;
-  cht_configs                                     = other.cht_configs;
-  tb_configs                                      = other.tb_configs;
-  coalescing_candidates                           = other.coalescing_candidates;
-  dchains_failing_to_allocate_new_index_hit_rates = other.dchains_failing_to_allocate_new_index_hit_rates;
-  expiration_data                                 = other.expiration_data;
-  expr_structs                                    = other.expr_structs;
-  ds_impls                                        = other.ds_impls;
-
-  for (auto &target_ctx_pair : other.target_ctxs) {
-    target_ctxs[target_ctx_pair.first] = target_ctx_pair.second->clone();
-  }
+const Profiler &Context::get_profiler() const { return profiler; }
+Profiler &Context::get_mutable_profiler() { return profiler; }
 
-  return *this;
-}
+const PerfOracle &Context::get_perf_oracle() const { return *perf_oracle; }
 
-Context &Context::operator=(Context &&other) {
-  if (this == &other) {
-    return *this;
+PerfOracle &Context::get_mutable_perf_oracle() {
+  if (perf_oracle.use_count() > 1) {
+    perf_oracle = std::make_shared<PerfOracle>(*perf_oracle);
   }
-
-  for (auto &[_, ctx_ptr] : target_ctxs) {
-    if (ctx_ptr) {
-      delete ctx_ptr;
-      ctx_ptr = nullptr;
-    }
-  }
-
-  profiler                                        = std::move(other.profiler);
-  perf_oracle                                     = std::move(other.perf_oracle);
-  map_configs                                     = std::move(other.map_configs);
-  vector_configs                                  = std::move(other.vector_configs);
-  dchain_configs                                  = std::move(other.dchain_configs);
-  cms_configs                                     = std::move(other.cms_configs);
-  cht_configs                                     = std::move(other.cht_configs);
-  tb_configs                                      = std::move(other.tb_configs);
-  coalescing_candidates                           = std::move(other.coalescing_candidates);
-  dchains_failing_to_allocate_new_index_hit_rates = std::move(other.dchains_failing_to_allocate_new_index_hit_rates);
-  expiration_data                                 = std::move(other.expiration_data);
-  expr_structs                                    = std::move(other.expr_structs);
-  ds_impls                                        = std::move(other.ds_impls);
-  target_ctxs                                     = std::move(other.target_ctxs);
-
-  return *this;
+  return *perf_oracle;
 }
 
-const Profiler &Context::get_profiler() const { return profiler; }
-Profiler &Context::get_mutable_profiler() { return profiler; }
-
-const PerfOracle &Context::get_perf_oracle() const { return perf_oracle; }
-PerfOracle &Context::get_mutable_perf_oracle() { return perf_oracle; }
-
 const map_config_t &Context::get_map_config(addr_t addr) const {
-  assert(map_configs.find(addr) != map_configs.end() && "Map not found");
-  return map_configs.at(addr);
+  assert(bdd_info->map_configs.find(addr) != bdd_info->map_configs.end() && "Map not found");
+  return bdd_info->map_configs.at(addr);
 }
 
 const vector_config_t &Context::get_vector_config(addr_t addr) const {
-  assert(vector_configs.find(addr) != vector_configs.end() && "Vector not found");
-  return vector_configs.at(addr);
+  assert(bdd_info->vector_configs.find(addr) != bdd_info->vector_configs.end() && "Vector not found");
+  return bdd_info->vector_configs.at(addr);
 }
 
 const dchain_config_t &Context::get_dchain_config(addr_t addr) const {
-  assert(dchain_configs.find(addr) != dchain_configs.end() && "Dchain not found");
-  return dchain_configs.at(addr);
+  assert(bdd_info->dchain_configs.find(addr) != bdd_info->dchain_configs.end() && "Dchain not found");
+  return bdd_info->dchain_configs.at(addr);
 }
 
 const cms_config_t &Context::get_cms_config(addr_t addr) const {
-  assert(cms_configs.find(addr) != cms_configs.end() && "CMS not found");
-  return cms_configs.at(addr);
+  assert(bdd_info->cms_configs.find(addr) != bdd_info->cms_configs.end() && "CMS not found");
+  return bdd_info->cms_configs.at(addr);
 }
 
 const cht_config_t &Context::get_cht_config(addr_t addr) const {
-  assert(cht_configs.find(addr) != cht_configs.end() && "CHT not found");
-  return cht_configs.at(addr);
+  assert(bdd_info->cht_configs.find(addr) != bdd_info->cht_configs.end() && "CHT not found");
+  return bdd_info->cht_configs.at(addr);
 }
 
 const tb_config_t &Context::get_tb_config(addr_t addr) const {
-  assert(tb_configs.find(addr) != tb_configs.end() && "TB not found");
-  return tb_configs.at(addr);
+  assert(bdd_info->tb_configs.find(addr) != bdd_info->tb_configs.end() && "TB not found");
+  return bdd_info->tb_configs.at(addr);
 }
 
 std::optional<map_coalescing_objs_t> Context::get_map_coalescing_objs(addr_t obj) const {
-  for (const map_coalescing_objs_t &candidate : coalescing_candidates) {
+  for (const map_coalescing_objs_t &candidate : bdd_info->coalescing_candidates) {
     bool match = false;
 
     match = match || candidate.map == obj;
@@ -522,34 +441,56 @@ std::optional<map_coalescing_objs_t> Context::get_map_coalescing_objs(addr_t obj
 }
 
 const std::vector<hit_rate_t> &Context::get_failing_to_allocate_new_index_hit_rates(addr_t dchain) const {
-  auto found_it = dchains_failing_to_allocate_new_index_hit_rates.find(dchain);
-  assert(found_it != dchains_failing_to_allocate_new_index_hit_rates.end() && "Dchain not found");
+  auto found_it = bdd_info->dchains_failing_to_allocate_new_index_hit_rates.find(dchain);
+  assert(found_it != bdd_info->dchains_failing_to_allocate_new_index_hit_rates.end() && "Dchain not found");
   return found_it->second;
 }
 
-const std::optional<expiration_data_t> &Context::get_expiration_data() const { return expiration_data; }
+const std::optional<expiration_data_t> &Context::get_expiration_data() const { return bdd_info->expiration_data; }
 
-const std::vector<expr_struct_t> &Context::get_expr_structs() const { return expr_structs; }
+const std::vector<expr_struct_t> &Context::get_expr_structs() const { return bdd_info->expr_structs; }
 
 void Context::save_ds_impl(addr_t obj, DSImpl impl) {
   assert(can_impl_ds(obj, impl) && "Incompatible implementation");
-  ds_impls[obj] = impl;
+
+  if (ds_impls.use_count() > 1) {
+    ds_impls = std::make_shared<std::unordered_map<addr_t, DSImpl>>(*ds_impls);
+  }
+
+  (*ds_impls)[obj] = impl;
 }
 
-bool Context::has_ds_impl(addr_t obj) const { return ds_impls.find(obj) != ds_impls.end(); }
-DSImpl Context::get_ds_impl(addr_t obj) const { return ds_impls.at(obj); }
+bool Context::has_ds_impl(addr_t obj) const { return ds_impls->find(obj) != ds_impls->end(); }
+DSImpl Context::get_ds_impl(addr_t obj) const { return ds_impls->at(obj); }
 
 bool Context::check_ds_impl(addr_t obj, DSImpl decision) const {
-  auto found_it = ds_impls.find(obj);
-  return found_it != ds_impls.end() && found_it->second == decision;
+  auto found_it = ds_impls->find(obj);
+  return found_it != ds_impls->end() && found_it->second == decision;
 }
 
 bool Context::can_impl_ds(addr_t obj, DSImpl decision) const {
-  auto found_it = ds_impls.find(obj);
-  return found_it == ds_impls.end() || found_it->second == decision;
+  auto found_it = ds_impls->find(obj);
+  return found_it == ds_impls->end() || found_it->second == decision;
 }
 
-const std::unordered_map<addr_t, DSImpl> &Context::get_ds_impls() const { return ds_impls; }
+const std::unordered_map<addr_t, DSImpl> &Context::get_ds_impls() const { return *ds_impls; }
+
+void Context::clone_bdd_info_if_shared() {
+  if (bdd_info.use_count() > 1) {
+    bdd_info = std::make_shared<bdd_info_t>(*bdd_info);
+  }
+}
+
+TargetContext *Context::clone_target_ctx_if_shared(TargetType type) {
+  assert(target_ctxs.find(type) != target_ctxs.end() && "No context for target");
+
+  std::shared_ptr<TargetContext> &target_ctx = target_ctxs.at(type);
+  if (target_ctx.use_count() > 1) {
+    target_ctx = std::shared_ptr<TargetContext>(target_ctx->clone());
+  }
+
+  return target_ctx.get();
+}
 
 std::ostream &operator<<(std::ostream &os, DSImpl impl) {
   switch (impl) {
@@ -635,10 +576,44 @@ std::string ds_impl_to_string(DSImpl impl) {
   return oss.str();
 }
 
+Context::fingerprint_t Context::get_fingerprint() const {
+  fingerprint_t fingerprint{
+      .profiler    = profiler.get_root(),
+      .perf_oracle = perf_oracle.get(),
+      .bdd_info    = bdd_info.get(),
+      .ds_impls    = ds_impls.get(),
+      .target_ctxs = {},
+  };
+
+  for (const auto &[type, target_ctx] : target_ctxs) {
+    fingerprint.target_ctxs.emplace_back(type, target_ctx.get());
+  }
+
+  std::sort(fingerprint.target_ctxs.begin(), fingerprint.target_ctxs.end());
+
+  return fingerprint;
+}
+
+size_t Context::fingerprint_t::hash() const {
+  size_t hash = 0;
+
+  auto combine = [&hash](const void *ptr) { hash ^= std::hash<const void *>()(ptr) + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+
+  combine(profiler);
+  combine(perf_oracle);
+  combine(bdd_info);
+  combine(ds_impls);
+  for (const auto &[_, target_ctx] : target_ctxs) {
+    combine(target_ctx);
+  }
+
+  return hash;
+}
+
 void Context::debug() const {
   std::cerr << "~~~~~~~~~~~~~~~~~~~~~~~~ Context ~~~~~~~~~~~~~~~~~~~~~~~~\n";
   std::cerr << "Implementations: [\n";
-  for (const auto &[obj, impl] : ds_impls) {
+  for (const auto &[obj, impl] : *ds_impls) {
     std::cerr << "    " << obj << ": " << impl << "\n";
   }
   std::cerr << "]\n";
@@ -647,7 +622,7 @@ void Context::debug() const {
     ctx->debug();
   }
 
-  perf_oracle.debug();
+  perf_oracle->debug();
 
   std::cerr << "\n";
   std::cerr << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n";
@@ -659,7 +634,9 @@ void Context::translate(SymbolManager *symbol_manager, const std::vector<symbol_
     translations[old_symbol.name] = new_symbol.name;
   }
 
-  for (expr_struct_t &expr_struct : expr_structs) {
+  clone_bdd_info_if_shared();
+
+  for (expr_struct_t &expr_struct : bdd_info->expr_structs) {
     expr_struct.expr = symbol_manager->translate(expr_struct.expr, translations);
     for (klee::ref<klee::Expr> &field : expr_struct.fields) {
       field = symbol_manager->translate(field, translations);
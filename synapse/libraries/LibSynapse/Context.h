@@ -1,6 +1,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <memory>
 
 #include <LibSynapse/PerfOracle.h>
 #include <LibSynapse/Profiler.h>
@@ -88,34 +89,37 @@ public:
 
 class Context {
 private:
+  // Everything we extract from the BDD during pre-processing. It is (almost) never touched during search, so all copies of a context share it.
+  struct bdd_info_t {
+    std::unordered_map<addr_t, map_config_t> map_configs;
+    std::unordered_map<addr_t, vector_config_t> vector_configs;
+    std::unordered_map<addr_t, dchain_config_t> dchain_configs;
+    std::unordered_map<addr_t, cms_config_t> cms_configs;
+    std::unordered_map<addr_t, cht_config_t> cht_configs;
+    std::unordered_map<addr_t, tb_config_t> tb_configs;
+
+    std::vector<map_coalescing_objs_t> coalescing_candidates;
+    std::unordered_map<addr_t, std::vector<hit_rate_t>> dchains_failing_to_allocate_new_index_hit_rates;
+    std::optional<expiration_data_t> expiration_data;
+    std::vector<expr_struct_t> expr_structs;
+  };
+
+  // Copies of the context share all of the state below, and only clone what they are about to change (copy-on-write). This is what makes copying
+  // an EP cheap, as the search copies the context on every single step.
   Profiler profiler;
-  PerfOracle perf_oracle;
-
-  std::unordered_map<addr_t, map_config_t> map_configs;
-  std::unordered_map<addr_t, vector_config_t> vector_configs;
-  std::unordered_map<addr_t, dchain_config_t> dchain_configs;
-  std::unordered_map<addr_t, cms_config_t> cms_configs;
-  std::unordered_map<addr_t, cht_config_t> cht_configs;
-  std::unordered_map<addr_t, tb_config_t> tb_configs;
-
-  std::vector<map_coalescing_objs_t> coalescing_candidates;
-  std::unordered_map<addr_t, std::vector<hit_rate_t>> dchains_failing_to_allocate_new_index_hit_rates;
-  std::optional<expiration_data_t> expiration_data;
-  std::vector<expr_struct_t> expr_structs;
-
-  std::unordered_map<addr_t, DSImpl> ds_impls;
-  std::unordered_map<TargetType, TargetContext *> target_ctxs;
+  std::shared_ptr<PerfOracle> perf_oracle;
+  std::shared_ptr<bdd_info_t> bdd_info;
+  std::shared_ptr<std::unordered_map<addr_t, DSImpl>> ds_impls;
+  std::unordered_map<TargetType, std::shared_ptr<TargetContext>> target_ctxs;
 
 public:
   Context(const BDD *bdd, const TargetsView &targets, const targets_config_t &targets_config, const Profiler &profiler);
-  Context(const Context &other);
-  Context(Context &&other);
-  Context() = delete;
-
-  Context &operator=(const Context &other);
-  Context &operator=(Context &&other);
+  Context(const Context &other) = default;
+  Context(Context &&other)      = default;
+  Context()                     = delete;
 
-  ~Context();
+  Context &operator=(const Context &other) = default;
+  Context &operator=(Context &&other)      = default;
 
   const Profiler &get_profiler() const;
   Profiler &get_mutable_profiler();
@@ -148,9 +152,28 @@ public:
 
   void translate(SymbolManager *symbol_manager, const std::vector<symbol_translation_t> &translated_symbols);
 
+  // Identifies the state of a context by the addresses of its (shared) pieces. Two contexts with the same fingerprint hold the same state, as long
+  // as a copy of one of them is kept alive: shared state is cloned before being written to, so it can't change under that copy, nor be freed and
+  // have its address reused.
+  struct fingerprint_t {
+    const void *profiler;
+    const void *perf_oracle;
+    const void *bdd_info;
+    const void *ds_impls;
+    std::vector<std::pair<TargetType, const void *>> target_ctxs;
+
+    bool operator==(const fingerprint_t &other) const = default;
+    size_t hash() const;
+  };
+
+  fingerprint_t get_fingerprint() const;
+
   void debug() const;
 
 private:
+  void clone_bdd_info_if_shared();
+  TargetContext *clone_target_ctx_if_shared(TargetType type);
+
   void bdd_pre_processing_get_coalescing_candidates(const BDD *bdd);
   void bdd_pre_processing_get_dchains_failing_to_allocate_new_index_hit_rates(const BDD *bdd);
   void bdd_pre_processing_get_ds_configs(const BDD *bdd);
@@ -3,22 +3,19 @@
 #include <LibSynapse/Modules/Tofino/Recirculate.h>
 #include <LibCore/Solver.h>
 
+#include <atomic>
+
 namespace LibSynapse {
 
 using LibCore::solver_toolbox;
 
 namespace {
-ep_node_id_t ep_node_id_counter = 0;
+std::atomic<ep_node_id_t> ep_node_id_counter{0};
 }
 
 EPNode::EPNode(Module *_module) : id(ep_node_id_counter++), module(_module), prev(nullptr) {}
 
 EPNode::~EPNode() {
-  if (module) {
-    delete module;
-    module = nullptr;
-  }
-
   for (EPNode *child : children) {
     if (child) {
       delete child;
@@ -36,8 +33,14 @@ void EPNode::set_children(klee::ref<klee::Expr> condition, EPNode *on_true, EPNo
 
 void EPNode::set_prev(EPNode *_prev) { prev = _prev; }
 
-const Module *EPNode::get_module() const { return module; }
-Module *EPNode::get_mutable_module() { return module; }
+const Module *EPNode::get_module() const { return module.get(); }
+
+Module *EPNode::get_mutable_module() {
+  if (module && module.use_count() > 1) {
+    module = std::shared_ptr<Module>(module->clone());
+  }
+  return module.get();
+}
 
 const std::vector<EPNode *> &EPNode::get_children() const { return children; }
 
@@ -120,10 +123,11 @@ std::string EPNode::dump() const {
 }
 
 EPNode *EPNode::clone(bool recursive) const {
-  EPNode *cloned_node = new EPNode(module->clone());
+  EPNode *cloned_node = new EPNode(nullptr);
 
   // The constructor increments the ID, let's fix that
-  cloned_node->id = id;
+  cloned_node->id     = id;
+  cloned_node->module = module;
 
   if (recursive) {
     std::vector<EPNode *> children_clones;
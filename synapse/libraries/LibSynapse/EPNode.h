@@ -4,6 +4,7 @@
 #include <LibCore/Types.h>
 
 #include <functional>
+#include <memory>
 #include <vector>
 
 namespace LibSynapse {
@@ -12,10 +13,12 @@ enum class EPNodeVisitAction { Continue, SkipChildren, Stop };
 
 using ep_node_id_t = u64;
 
+// Cloning an EPNode tree only copies its structure. Modules are immutable once placed, so clones share them, and get_mutable_module() only
+// clones the module if someone else is still holding it.
 class EPNode {
 private:
   ep_node_id_t id;
-  Module *module;
+  std::shared_ptr<Module> module;
   std::vector<EPNode *> children;
   EPNode *prev;
   klee::ref<klee::Expr> constraint;
@@ -6,6 +6,8 @@
 #include <LibCore/Solver.h>
 #include <LibCore/Debug.h>
 
+#include <atomic>
+
 namespace LibSynapse {
 
 namespace {
@@ -69,7 +71,7 @@ pps_t find_stable_tput(pps_t ingress, std::function<tput_estimation_t(pps_t)> es
   return egress;
 }
 
-ep_id_t ep_id_counter = 0;
+std::atomic<ep_id_t> ep_id_counter{0};
 
 void delete_all_unused_vector_key_operations_from_bdd(BDD *bdd) {
   // 1. Get all map operations.
@@ -109,14 +111,12 @@ BDD *setup_bdd(const BDD &bdd) {
   return new_bdd;
 }
 
-std::set<ep_id_t> update_ancestors(const EP &other, bool is_ancestor) {
-  std::set<ep_id_t> ancestors = other.get_ancestors();
-
-  if (is_ancestor) {
-    ancestors.insert(other.get_id());
+std::shared_ptr<const ep_ancestry_t> update_ancestry(ep_id_t parent, const std::shared_ptr<const ep_ancestry_t> &parent_ancestry, bool is_ancestor) {
+  if (!is_ancestor) {
+    return parent_ancestry;
   }
 
-  return ancestors;
+  return std::make_shared<const ep_ancestry_t>(ep_ancestry_t{parent, parent_ancestry});
 }
 
 std::string spec2str(const spec_impl_t &speculation, const BDD *bdd) {
@@ -166,7 +166,7 @@ EP::EP(const BDD &_bdd, const TargetsView &_targets, const targets_config_t &_ta
 
 EP::EP(const EP &other, bool is_ancestor)
     : id(ep_id_counter++), bdd(other.bdd), root(other.root ? other.root->clone(true) : nullptr), targets(other.targets),
-      ancestors(update_ancestors(other, is_ancestor)), targets_roots(other.targets_roots), ctx(other.ctx), meta(other.meta) {
+      ancestry(update_ancestry(other.id, other.ancestry, is_ancestor)), targets_roots(other.targets_roots), ctx(other.ctx), meta(other.meta) {
   if (!root) {
     assert(other.active_leaves.size() == 1 && "No root and multiple leaves.");
     active_leaves.emplace_back(nullptr, bdd->get_root());
@@ -182,6 +182,19 @@ EP::EP(const EP &other, bool is_ancestor)
   sort_leaves();
 }
 
+std::vector<ep_id_t> EP::get_ancestors() const {
+  std::vector<ep_id_t> ancestors;
+
+  for (const ep_ancestry_t *ancestor = ancestry.get(); ancestor; ancestor = ancestor->prev.get()) {
+    ancestors.push_back(ancestor->id);
+  }
+
+  // Oldest ancestor first.
+  std::reverse(ancestors.begin(), ancestors.end());
+
+  return ancestors;
+}
+
 std::vector<const EPNode *> EP::get_prev_nodes() const {
   std::vector<const EPNode *> prev_nodes;
 
@@ -426,7 +439,7 @@ void EP::debug() const {
   std::cerr << "\n";
   std::cerr << "ID: " << id << "\n";
   std::cerr << "Ancestors:";
-  for (ep_id_t ancestor : ancestors) {
+  for (ep_id_t ancestor : get_ancestors()) {
     std::cerr << "  " << ancestor;
   }
   std::cerr << "\n";
@@ -597,6 +610,114 @@ void EP::sort_leaves() {
   active_leaves.sort(prioritize_switch_and_hot_paths);
 }
 
+// Memoizes speculation while speculating a single EP. Module factories look at the EP itself (its context, its leaves), so results can't be
+// shared between EPs. But comparing candidate decisions replays the same decisions, from the same contexts, over and over: the best candidate so
+// far is re-speculated against every new one, and so is everything downstream of it.
+//
+// Entries keep a copy of the context they were computed from, which is what makes its fingerprint a sound key (see Context::fingerprint_t). As
+// the cached speculations hand out their own contexts, replaying a known sequence of decisions keeps hitting the cache.
+class EP::SpeculationCache {
+public:
+  struct module_key_t {
+    const ModuleFactory *modgen;
+    bdd_node_id_t node;
+    Context::fingerprint_t ctx;
+
+    bool operator==(const module_key_t &other) const = default;
+  };
+
+  struct module_key_hash_t {
+    size_t operator()(const module_key_t &key) const {
+      return key.ctx.hash() ^ (std::hash<const void *>()(key.modgen) << 1) ^ (std::hash<bdd_node_id_t>()(key.node) << 2);
+    }
+  };
+
+
+  struct complete_key_t {
+    Context::fingerprint_t ctx;
+    std::vector<std::pair<bdd_node_id_t, TargetType>> targets;
+    pps_t ingress;
+    SpeculationStrategy strategy;
+
+    bool operator==(const complete_key_t &other) const = default;
+  };
+
+  struct complete_key_hash_t {
+    size_t operator()(const complete_key_t &key) const {
+      size_t hash = key.ctx.hash() ^ (std::hash<pps_t>()(key.ingress) << 1) ^ (static_cast<size_t>(key.strategy) << 2);
+      for (const auto &[node, target] : key.targets) {
+        hash ^= std::hash<bdd_node_id_t>()(node) + static_cast<size_t>(target) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      }
+      return hash;
+    }
+  };
+
+private:
+  static constexpr const size_t MAX_ENTRIES = 65'536;
+
+  struct module_entry_t {
+    Context ctx;
+    std::optional<spec_impl_t> speculation;
+  };
+
+  struct complete_entry_t {
+    Context ctx;
+    complete_speculation_t speculation;
+  };
+
+  std::unordered_map<module_key_t, module_entry_t, module_key_hash_t> module_speculations;
+  std::unordered_map<complete_key_t, complete_entry_t, complete_key_hash_t> complete_speculations;
+
+public:
+  static module_key_t module_key(const ModuleFactory *modgen, const BDDNode *node, const Context &ctx) {
+    return {.modgen = modgen, .node = node->get_id(), .ctx = ctx.get_fingerprint()};
+  }
+
+  static complete_key_t complete_key(const Context &ctx, const std::list<speculation_target_t> &speculation_target_nodes, pps_t ingress,
+                                     SpeculationStrategy strategy) {
+    complete_key_t key{.ctx = ctx.get_fingerprint(), .targets = {}, .ingress = ingress, .strategy = strategy};
+    key.targets.reserve(speculation_target_nodes.size());
+    for (const speculation_target_t &speculation_target : speculation_target_nodes) {
+      key.targets.emplace_back(speculation_target.node->get_id(), speculation_target.target);
+    }
+    return key;
+  }
+
+  const std::optional<spec_impl_t> *find(const module_key_t &key) const {
+    return lookup(module_speculations, key, [](const module_entry_t &entry) { return &entry.speculation; });
+  }
+
+  const complete_speculation_t *find(const complete_key_t &key) const {
+    return lookup(complete_speculations, key, [](const complete_entry_t &entry) { return &entry.speculation; });
+  }
+
+  void insert(const module_key_t &key, const Context &ctx, const std::optional<spec_impl_t> &speculation) {
+    if (module_speculations.size() >= MAX_ENTRIES) {
+      module_speculations.clear();
+    }
+    module_speculations.emplace(key, module_entry_t{.ctx = ctx, .speculation = speculation});
+  }
+
+  void insert(const complete_key_t &key, const Context &ctx, const complete_speculation_t &speculation) {
+    if (complete_speculations.size() >= MAX_ENTRIES) {
+      complete_speculations.clear();
+    }
+    complete_speculations.emplace(key, complete_entry_t{.ctx = ctx, .speculation = speculation});
+  }
+
+private:
+  template <typename Map, typename Getter>
+  static auto lookup(const Map &map, const typename Map::key_type &key, Getter getter) -> decltype(getter(map.begin()->second)) {
+    auto found_it = map.find(key);
+    if (found_it == map.end()) {
+      GlobalStats::num_speculation_cache_misses++;
+      return nullptr;
+    }
+    GlobalStats::num_speculation_cache_hits++;
+    return getter(found_it->second);
+  }
+};
+
 std::list<EP::speculation_target_t> EP::get_nodes_targeted_for_speculation() const {
   std::list<speculation_target_t> speculation_targets;
 
@@ -821,7 +942,7 @@ spec_impl_t EP::get_best_speculation(const speculation_target_t &speculation_tar
       // if (id == 56 && speculation_target.node->get_id() == 159) {
       //   std::cerr << "Trying module: " << modgen->get_name() << "\n";
       // }
-      const std::optional<spec_impl_t> spec = modgen->speculate(this, speculation_target.node, spec_ctx);
+      const std::optional<spec_impl_t> spec = speculate_module(modgen, speculation_target.node, spec_ctx);
 
       if (!spec.has_value()) {
         continue;
@@ -888,8 +1009,32 @@ spec_impl_t EP::get_best_speculation(const speculation_target_t &speculation_tar
   return *best;
 }
 
+std::optional<spec_impl_t> EP::speculate_module(const ModuleFactory *modgen, const BDDNode *node, const Context &spec_ctx) const {
+  if (!speculation_cache) {
+    return modgen->speculate(this, node, spec_ctx);
+  }
+
+  const auto key = SpeculationCache::module_key(modgen, node, spec_ctx);
+  if (const std::optional<spec_impl_t> *cached = speculation_cache->find(key)) {
+    return *cached;
+  }
+
+  const std::optional<spec_impl_t> spec = modgen->speculate(this, node, spec_ctx);
+  speculation_cache->insert(key, spec_ctx, spec);
+
+  return spec;
+}
+
 complete_speculation_t EP::speculate(const Context &current_ctx, std::list<speculation_target_t> speculation_target_nodes, pps_t ingress,
                                      SpeculationStrategy strategy) const {
+  std::optional<SpeculationCache::complete_key_t> cache_key;
+  if (speculation_cache) {
+    cache_key = SpeculationCache::complete_key(current_ctx, speculation_target_nodes, ingress, strategy);
+    if (const complete_speculation_t *cached = speculation_cache->find(*cache_key)) {
+      return *cached;
+    }
+  }
+
   complete_speculation_t complete_speculation = {
       .speculations_per_node = {},
       .final_ctx             = current_ctx,
@@ -929,6 +1074,10 @@ complete_speculation_t EP::speculate(const Context &current_ctx, std::list<specu
     });
   }
 
+  if (cache_key.has_value()) {
+    speculation_cache->insert(*cache_key, current_ctx, complete_speculation);
+  }
+
   return complete_speculation;
 }
 
@@ -939,7 +1088,10 @@ complete_speculation_t EP::speculate() const {
 
   const std::list<speculation_target_t> speculation_targets = get_nodes_targeted_for_speculation();
   const pps_t ingress                                       = estimate_tput_pps();
-  const complete_speculation_t complete_speculation         = speculate(ctx, speculation_targets, ingress, SpeculationStrategy::WithLookahead);
+
+  speculation_cache                                 = std::make_shared<SpeculationCache>();
+  const complete_speculation_t complete_speculation = speculate(ctx, speculation_targets, ingress, SpeculationStrategy::WithLookahead);
+  speculation_cache.reset();
 
   cached_speculations = complete_speculation;
 
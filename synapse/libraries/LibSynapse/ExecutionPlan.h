@@ -27,6 +27,7 @@ using translator_t = std::unordered_map<bdd_node_id_t, bdd_node_id_t>;
 using ep_id_t      = u64;
 
 class Profiler;
+class ModuleFactory;
 struct spec_impl_t;
 
 struct EPLeaf {
@@ -37,6 +38,12 @@ struct EPLeaf {
   EPLeaf(const EPLeaf &other) : node(other.node), next(other.next) {}
 };
 
+// Persistent (shared) list of ancestor EP ids. A child only prepends its parent to the list, so copying an EP doesn't grow with search depth.
+struct ep_ancestry_t {
+  ep_id_t id;
+  std::shared_ptr<const ep_ancestry_t> prev;
+};
+
 struct complete_speculation_t {
   std::vector<spec_impl_t> speculations_per_node;
   Context final_ctx;
@@ -55,7 +62,7 @@ private:
   std::list<EPLeaf> active_leaves;
 
   const TargetsView targets;
-  const std::set<ep_id_t> ancestors;
+  const std::shared_ptr<const ep_ancestry_t> ancestry;
 
   std::unordered_map<TargetType, bdd_node_ids_t> targets_roots;
 
@@ -66,6 +73,10 @@ private:
   mutable std::optional<pps_t> cached_tput_speculation;
   mutable std::optional<complete_speculation_t> cached_speculations;
 
+  // Only alive while speculating.
+  class SpeculationCache;
+  mutable std::shared_ptr<SpeculationCache> speculation_cache;
+
 public:
   EP(const BDD &bdd, const TargetsView &targets, const targets_config_t &targets_config, const Profiler &profiler);
   EP(const EP &other, bool is_ancestor = true);
@@ -106,7 +117,7 @@ public:
   const std::list<EPLeaf> &get_active_leaves() const { return active_leaves; }
   const TargetsView &get_targets() const { return targets; }
   const bdd_node_ids_t &get_target_roots(TargetType target) const { return targets_roots.at(target); }
-  const std::set<ep_id_t> &get_ancestors() const { return ancestors; }
+  std::vector<ep_id_t> get_ancestors() const;
   const Context &get_ctx() const { return ctx; }
   const EPMeta &get_meta() const { return meta; }
 
@@ -166,6 +177,7 @@ private:
 
   complete_speculation_t speculate(const Context &ctx, std::list<speculation_target_t> speculation_target_nodes, pps_t ingress,
                                    SpeculationStrategy lookahead = SpeculationStrategy::WithLookahead) const;
+  std::optional<spec_impl_t> speculate_module(const ModuleFactory *modgen, const BDDNode *node, const Context &ctx) const;
   spec_impl_t get_best_speculation(const speculation_target_t &speculation_target, const Context &ctx, pps_t ingress,
                                    const std::list<speculation_target_t> &speculation_target_nodes, SpeculationStrategy lookahead) const;
   bool is_better_speculation(const spec_impl_t &old_speculation, const spec_impl_t &new_speculation, const speculation_target_t &speculation_target,
@@ -3,9 +3,13 @@
 namespace LibSynapse {
 namespace GlobalStats {
 
-u64 num_phase1_speculations = 0;
-u64 num_phase2_speculations = 0;
-u64 num_phase3_speculations = 0;
+std::atomic<u64> num_phase1_speculations{0};
+std::atomic<u64> num_phase2_speculations{0};
+std::atomic<u64> num_phase3_speculations{0};
+std::atomic<u64> num_speculation_cache_hits{0};
+std::atomic<u64> num_speculation_cache_misses{0};
+std::atomic<u64> num_placement_cache_hits{0};
+std::atomic<u64> num_placement_cache_misses{0};
 
 } // namespace GlobalStats
 } // namespace LibSynapse
\ No newline at end of file
@@ -1,13 +1,25 @@
 #pragma once
 
+#include <LibCore/Solver.h>
 #include <LibCore/Types.h>
 
+#include <atomic>
+
 namespace LibSynapse {
 namespace GlobalStats {
 
-extern u64 num_phase1_speculations;
-extern u64 num_phase2_speculations;
-extern u64 num_phase3_speculations;
+extern std::atomic<u64> num_phase1_speculations;
+extern std::atomic<u64> num_phase2_speculations;
+extern std::atomic<u64> num_phase3_speculations;
+extern std::atomic<u64> num_speculation_cache_hits;
+extern std::atomic<u64> num_speculation_cache_misses;
+extern std::atomic<u64> num_placement_cache_hits;
+extern std::atomic<u64> num_placement_cache_misses;
+
+// Solver query counters, maintained by the solver toolbox itself.
+using LibCore::SolverStats::num_cache_hits;
+using LibCore::SolverStats::num_cache_misses;
+using LibCore::SolverStats::num_trivial_queries;
 
 } // namespace GlobalStats
 } // namespace LibSynapse
\ No newline at end of file
@@ -3,16 +3,115 @@
 
 #include <LibSynapse/Visualizers/EPVisualizer.h>
 
+#include <algorithm>
+
 namespace LibSynapse {
 
-Heuristic::Heuristic(std::unique_ptr<HeuristicCfg> _config, std::unique_ptr<EP> starting_ep, bool _stop_on_first_solution)
-    : config(std::move(_config)), stop_on_first_solution(_stop_on_first_solution) {
-  EP *ep = starting_ep.release();
-  assert(ep && "Invalid execution plan");
+bool Heuristic::Frontier::better(const entry_t &e1, const entry_t &e2) {
+  if (e1.score != e2.score) {
+    return e1.score > e2.score;
+  }
+  return e1.order < e2.order;
+}
 
-  unfinished_eps.emplace(ep);
+void Heuristic::Frontier::sift_up(size_t i) {
+  while (i > 0) {
+    const size_t parent = (i - 1) / ARITY;
+    if (!better(heap[i], heap[parent])) {
+      break;
+    }
+    std::swap(heap[i], heap[parent]);
+    i = parent;
+  }
+}
 
-  rebuild_execution_plans_sets();
+void Heuristic::Frontier::sift_down(size_t i) {
+  while (true) {
+    const size_t first_child = i * ARITY + 1;
+    if (first_child >= heap.size()) {
+      break;
+    }
+
+    const size_t last_child = std::min(first_child + ARITY, heap.size());
+
+    size_t best = first_child;
+    for (size_t child = first_child + 1; child < last_child; child++) {
+      if (better(heap[child], heap[best])) {
+        best = child;
+      }
+    }
+
+    if (!better(heap[best], heap[i])) {
+      break;
+    }
+
+    std::swap(heap[i], heap[best]);
+    i = best;
+  }
+}
+
+void Heuristic::Frontier::heapify() {
+  if (heap.size() < 2) {
+    return;
+  }
+
+  for (size_t i = (heap.size() - 2) / ARITY + 1; i > 0; i--) {
+    sift_down(i - 1);
+  }
+}
+
+void Heuristic::Frontier::push(const Score &score, std::unique_ptr<EP> ep) { push(entry_t{score, next_order++, std::move(ep)}); }
+
+void Heuristic::Frontier::push(entry_t &&entry) {
+  heap.push_back(std::move(entry));
+  sift_up(heap.size() - 1);
+}
+
+Heuristic::Frontier::entry_t Heuristic::Frontier::pop() {
+  assert(!heap.empty() && "Empty frontier");
+
+  entry_t entry = std::move(heap.front());
+  if (heap.size() > 1) {
+    heap.front() = std::move(heap.back());
+  }
+  heap.pop_back();
+
+  if (!heap.empty()) {
+    sift_down(0);
+  }
+
+  return entry;
+}
+
+const Heuristic::Frontier::entry_t &Heuristic::Frontier::top() const {
+  assert(!heap.empty() && "Empty frontier");
+  return heap.front();
+}
+
+void Heuristic::Frontier::rescore(const HeuristicCfg *config) {
+  for (entry_t &entry : heap) {
+    entry.score = config->score(entry.ep.get());
+  }
+  heapify();
+}
+
+void Heuristic::Frontier::trim(size_t target_size) {
+  if (heap.size() <= target_size) {
+    return;
+  }
+
+  std::nth_element(heap.begin(), heap.begin() + target_size, heap.end(), better);
+  heap.resize(target_size);
+  heapify();
+}
+
+Heuristic::Heuristic(std::unique_ptr<HeuristicCfg> _config, std::unique_ptr<EP> starting_ep, bool _stop_on_first_solution,
+                     size_t _max_unfinished_eps)
+    : config(std::move(_config)), stop_on_first_solution(_stop_on_first_solution), max_unfinished_eps(_max_unfinished_eps) {
+  assert(starting_ep && "Invalid execution plan");
+
+  const Score score = get_score(starting_ep.get());
+  unfinished_eps.push(score, std::move(starting_ep));
 }
 
 bool Heuristic::is_finished() {
@@ -24,57 +123,44 @@ bool Heuristic::is_finished() {
   return false;
 }
 
-std::unique_ptr<EP> Heuristic::pop_best_finished() { return std::move(finished_eps.extract(finished_eps.begin()).value()); }
-
-void Heuristic::rebuild_execution_plans_sets() {
-  auto rebuilder = [this](std::multiset<std::unique_ptr<EP>, ep_cmp_t> &target) {
-    std::vector<std::unique_ptr<EP>> backup;
-    backup.reserve(target.size());
-    while (!target.empty()) {
-      backup.push_back(std::move(target.extract(target.begin()).value()));
-    }
-
-    auto new_ep_cmp = [this](const std::unique_ptr<EP> &e1, const std::unique_ptr<EP> &e2) { return (*config)(e1.get(), e2.get()); };
-    target          = std::multiset<std::unique_ptr<EP>, ep_cmp_t>(new_ep_cmp);
-
-    for (std::unique_ptr<EP> &ep : backup) {
-      target.insert(std::move(ep));
-    }
-
-    backup.clear();
-  };
+std::unique_ptr<EP> Heuristic::pop_best_finished() { return std::move(finished_eps.pop().ep); }
 
-  rebuilder(unfinished_eps);
-  rebuilder(finished_eps);
+void Heuristic::rescore() {
+  unfinished_eps.rescore(config.get());
+  finished_eps.rescore(config.get());
 }
 
 std::unique_ptr<EP> Heuristic::pop_next_unfinished() {
-  ep_it_t next_it = get_next_unfinished_it();
-  assert(next_it != unfinished_eps.end() && "No more execution plans to pick");
+  Frontier::entry_t next = pop_next_unfinished_entry();
 
-  if (config->mutates(next_it->get())) {
-    // Trigger a re-sort with the new mutated heuristic.
-    // Otherwise the multiset won't use the new instance (modified).
-    rebuild_execution_plans_sets();
-    next_it = get_next_unfinished_it();
-    assert(next_it != unfinished_eps.end() && "No more execution plans to pick");
+  if (config->mutates(next.ep.get())) {
+    // The heuristic changed, so every cached score is stale.
+    unfinished_eps.push(std::move(next));
+    rescore();
+    next = pop_next_unfinished_entry();
   }
 
-  return std::move(unfinished_eps.extract(next_it).value());
+  return std::move(next.ep);
 }
 
 void Heuristic::add(std::vector<impl_t> &&new_implementations) {
   for (impl_t &impl : new_implementations) {
     assert(impl.result && "Invalid execution plan");
+    const Score score = get_score(impl.result.get());
     if (impl.result->get_next_node()) {
-      unfinished_eps.insert(std::move(impl.result));
+      unfinished_eps.push(score, std::move(impl.result));
     } else {
       impl.result->get_ctx().get_perf_oracle().assert_final_state();
-      finished_eps.insert(std::move(impl.result));
+      finished_eps.push(score, std::move(impl.result));
     }
   }
 
   new_implementations.clear();
+
+  // Drop the worst EPs, with some slack so that we don't trim on every single step.
+  if (max_unfinished_eps > 0 && unfinished_eps.size() > max_unfinished_eps) {
+    unfinished_eps.trim(max_unfinished_eps - max_unfinished_eps / 10);
+  }
 }
 
 size_t Heuristic::unfinished_size() const { return unfinished_eps.size(); }
@@ -84,27 +170,32 @@ const HeuristicCfg *Heuristic::get_cfg() const { return config.get(); }
 
 Score Heuristic::get_score(const EP *e) const { return config->score(e); }
 
-Heuristic::ep_it_t Heuristic::get_next_unfinished_it() {
+// Randomly picks one of the EPs tied for the best score: flip coins until the first head, and walk that many steps over the tied EPs (wrapping
+// around).
+Heuristic::Frontier::entry_t Heuristic::pop_next_unfinished_entry() {
   assert(!unfinished_eps.empty() && "No execution plans to pick");
 
-  ep_it_t it       = unfinished_eps.begin();
-  Score best_score = get_score(it->get());
+  size_t steps = 0;
+  while (SingletonRandomEngine::generate() % 2 != 0) {
+    steps++;
+  }
 
-  while (1) {
-    const std::unique_ptr<EP> &ep = *it;
+  const Score best_score = unfinished_eps.top().score;
 
-    if ((it == unfinished_eps.end()) || (get_score(ep.get()) != best_score)) {
-      it = unfinished_eps.begin();
-    }
+  // Only pop as many tied EPs as the walk needs.
+  std::vector<Frontier::entry_t> tied;
+  while (tied.size() <= steps && !unfinished_eps.empty() && unfinished_eps.top().score == best_score) {
+    tied.push_back(unfinished_eps.pop());
+  }
 
-    if (SingletonRandomEngine::generate() % 2 == 0) {
-      break;
+  const size_t chosen = steps % tied.size();
+  for (size_t i = 0; i < tied.size(); i++) {
+    if (i != chosen) {
+      unfinished_eps.push(std::move(tied[i]));
     }
-
-    it++;
   }
 
-  return it;
+  return std::move(tied[chosen]);
 }
 
 } // namespace LibSynapse
\ No newline at end of file
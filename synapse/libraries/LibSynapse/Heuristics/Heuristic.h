@@ -9,16 +9,54 @@ namespace LibSynapse {
 
 class Heuristic {
 private:
-  using ep_cmp_t = std::function<bool(const std::unique_ptr<EP> &, const std::unique_ptr<EP> &)>;
-  using ep_it_t  = typename std::set<std::unique_ptr<EP>, HeuristicCfg>::iterator;
+  // 4-ary max-heap of EPs keyed by their score, computed once when they are added. Ties are broken by insertion order, like the multiset this
+  // replaces.
+  class Frontier {
+  public:
+    struct entry_t {
+      Score score;
+      u64 order;
+      std::unique_ptr<EP> ep;
+    };
+
+  private:
+    static constexpr const size_t ARITY = 4;
+
+    std::vector<entry_t> heap;
+    u64 next_order;
+
+  public:
+    Frontier() : next_order(0) {}
+
+    void push(const Score &score, std::unique_ptr<EP> ep);
+    void push(entry_t &&entry);
+    entry_t pop();
+    const entry_t &top() const;
+
+    size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+
+    // Recomputes every score (e.g. after the heuristic mutates) and restores the heap.
+    void rescore(const HeuristicCfg *config);
+
+    // Keeps only the best target_size entries.
+    void trim(size_t target_size);
+
+  private:
+    static bool better(const entry_t &e1, const entry_t &e2);
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+    void heapify();
+  };
 
   std::unique_ptr<HeuristicCfg> config;
-  std::multiset<std::unique_ptr<EP>, ep_cmp_t> unfinished_eps;
-  std::multiset<std::unique_ptr<EP>, ep_cmp_t> finished_eps;
+  Frontier unfinished_eps;
+  Frontier finished_eps;
   bool stop_on_first_solution;
+  size_t max_unfinished_eps;
 
 public:
-  Heuristic(std::unique_ptr<HeuristicCfg> config, std::unique_ptr<EP> starting_ep, bool stop_on_first_solution);
+  Heuristic(std::unique_ptr<HeuristicCfg> config, std::unique_ptr<EP> starting_ep, bool stop_on_first_solution, size_t max_unfinished_eps = 0);
 
   bool is_finished();
   void add(std::vector<impl_t> &&new_implementations);
@@ -31,8 +69,8 @@ public:
   Score get_score(const EP *e) const;
 
 private:
-  void rebuild_execution_plans_sets();
-  ep_it_t get_next_unfinished_it();
+  void rescore();
+  Frontier::entry_t pop_next_unfinished_entry();
 };
 
 } // namespace LibSynapse
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <LibCore/Debug.h>
 #include <LibSynapse/ExecutionPlan.h>
 #include <LibSynapse/Heuristics/Score.h>
 
@@ -29,28 +30,32 @@ public:
   const std::string name;
   const std::vector<Metric> metrics;
 
-  HeuristicCfg(const std::string &_name, const std::vector<Metric> &_metrics) : name(_name), metrics(_metrics) {}
+  HeuristicCfg(const std::string &_name, const std::vector<Metric> &_metrics) : name(_name), metrics(_metrics) {
+    assert_or_panic(metrics.size() <= Score::MAX_VALUES, "Heuristic %s has %zu metrics, but scores hold at most %zu values", name.c_str(),
+                    metrics.size(), Score::MAX_VALUES);
+  }
 
   virtual ~HeuristicCfg() = default;
 
   Score score(const EP *e) const {
-    const size_t N = metrics.size();
-    std::vector<i64> values(N);
+    Score result;
 
-    for (size_t i = 0; i < metrics.size(); i++) {
-      values[i] = (metrics[i].computer)(e);
+    for (const Metric &metric : metrics) {
+      i64 value = (metric.computer)(e);
 
-      switch (metrics[i].objective) {
+      switch (metric.objective) {
       case Objective::Min: {
-        values[i] *= -1;
+        value *= -1;
       } break;
       case Objective::Max: {
         // Do nothing
       } break;
       }
+
+      result.push_back(value);
     }
 
-    return Score(values);
+    return result;
   }
 
   virtual bool operator()(const EP *e1, const EP *e2) const { return score(e1) > score(e2); }
@@ -2,6 +2,8 @@
 
 #include <LibCore/Types.h>
 
+#include <array>
+#include <cassert>
 #include <iostream>
 #include <vector>
 
@@ -9,16 +11,36 @@ namespace LibSynapse {
 
 using LibCore::int2hr;
 
+// Fixed capacity, so that scores can live inline in the heuristic's frontier without allocating.
 struct Score {
-  std::vector<i64> values;
+  static constexpr const size_t MAX_VALUES = 8;
+
+  std::array<i64, MAX_VALUES> values;
+  size_t num_values;
 
 public:
-  Score(const std::vector<i64> &_values) : values(_values) {}
-  Score(const Score &score) : values(score.values) {}
+  Score() : values{}, num_values(0) {}
+
+  Score(const std::vector<i64> &_values) : values{}, num_values(_values.size()) {
+    assert(num_values <= MAX_VALUES && "Too many score values");
+    std::copy(_values.begin(), _values.end(), values.begin());
+  }
+
+  Score(const Score &score)            = default;
+  Score &operator=(const Score &score) = default;
+
+  void push_back(i64 value) {
+    assert(num_values < MAX_VALUES && "Too many score values");
+    values[num_values++] = value;
+  }
 
-  inline bool operator<(const Score &other) {
-    assert(values.size() == other.values.size() && "Scores have different sizes");
-    for (size_t i = 0; i < values.size(); i++) {
+  size_t size() const { return num_values; }
+  const i64 *begin() const { return values.data(); }
+  const i64 *end() const { return values.data() + num_values; }
+
+  inline bool operator<(const Score &other) const {
+    assert(num_values == other.num_values && "Scores have different sizes");
+    for (size_t i = 0; i < num_values; i++) {
       const i64 this_score  = values[i];
       const i64 other_score = other.values[i];
 
@@ -34,13 +56,10 @@ public:
     return false;
   }
 
-  inline bool operator==(const Score &other) {
-    assert(values.size() == other.values.size() && "Scores have different sizes");
-    for (size_t i = 0; i < values.size(); i++) {
-      const i64 this_score  = values[i];
-      const i64 other_score = other.values[i];
-
-      if (this_score != other_score) {
+  inline bool operator==(const Score &other) const {
+    assert(num_values == other.num_values && "Scores have different sizes");
+    for (size_t i = 0; i < num_values; i++) {
+      if (values[i] != other.values[i]) {
         return false;
       }
     }
@@ -48,24 +67,22 @@ public:
     return true;
   }
 
-  inline bool operator>(const Score &other) { return !((*this) < other) && !((*this) == other); }
+  inline bool operator>(const Score &other) const { return other < (*this); }
 
-  inline bool operator<=(const Score &other) { return !((*this) > other); }
-  inline bool operator>=(const Score &other) { return !((*this) < other); }
-  inline bool operator!=(const Score &other) { return !((*this) == other); }
+  inline bool operator<=(const Score &other) const { return !((*this) > other); }
+  inline bool operator>=(const Score &other) const { return !((*this) < other); }
+  inline bool operator!=(const Score &other) const { return !((*this) == other); }
 };
 
 inline std::ostream &operator<<(std::ostream &os, const Score &score) {
-  const size_t N = score.values.size();
-
   os << "<";
 
   bool first = true;
-  for (size_t i = 0u; i < N; i++) {
+  for (i64 value : score) {
     if (!first)
       os << ",";
     first = false;
-    os << int2hr(score.values[i]);
+    os << int2hr(value);
   }
 
   os << ">";
@@ -5,13 +5,12 @@ namespace LibSynapse {
 template <> const Controller::ControllerContext *Context::get_target_ctx<Controller::ControllerContext>() const {
   TargetType type = TargetType::Controller;
   assert(target_ctxs.find(type) != target_ctxs.end() && "No context for target");
-  return dynamic_cast<const Controller::ControllerContext *>(target_ctxs.at(type));
+  return dynamic_cast<const Controller::ControllerContext *>(target_ctxs.at(type).get());
 }
 
 template <> Controller::ControllerContext *Context::get_mutable_target_ctx<Controller::ControllerContext>() {
   TargetType type = TargetType::Controller;
-  assert(target_ctxs.find(type) != target_ctxs.end() && "No context for target");
-  return dynamic_cast<Controller::ControllerContext *>(target_ctxs.at(type));
+  return dynamic_cast<Controller::ControllerContext *>(clone_target_ctx_if_shared(type));
 }
 
 } // namespace LibSynapse
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include <LibSynapse/Modules/Tofino/TNA/DSSet.h>
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace LibSynapse {
+namespace Tofino {
+
+namespace {
+
+// Search workers intern ids concurrently.
+std::shared_mutex interner_mutex;
+std::unordered_map<DS_ID, u32> interned_ids;
+std::deque<DS_ID> interned_names;
+
+} // namespace
+
+u32 intern_ds_id(const DS_ID &id) {
+  if (std::optional<u32> index = find_interned_ds_id(id)) {
+    return *index;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(interner_mutex);
+
+  auto [it, inserted] = interned_ids.emplace(id, static_cast<u32>(interned_names.size()));
+  if (inserted) {
+    interned_names.push_back(id);
+  }
+
+  return it->second;
+}
+
+std::optional<u32> find_interned_ds_id(const DS_ID &id) {
+  std::shared_lock<std::shared_mutex> lock(interner_mutex);
+
+  auto found_it = interned_ids.find(id);
+  if (found_it == interned_ids.end()) {
+    return std::nullopt;
+  }
+
+  return found_it->second;
+}
+
+DS_ID get_interned_ds_id(u32 index) {
+  std::shared_lock<std::shared_mutex> lock(interner_mutex);
+  assert(index < interned_names.size() && "Unknown data structure index");
+  return interned_names[index];
+}
+
+DSSet::DSSet(const std::unordered_set<DS_ID> &ids) {
+  for (const DS_ID &id : ids) {
+    insert(id);
+  }
+}
+
+void DSSet::insert(u32 index) {
+  if (index / 64 >= words.size()) {
+    words.resize(index / 64 + 1, 0);
+  }
+  words[index / 64] |= 1ull << (index % 64);
+}
+
+void DSSet::insert(const DSSet &other) {
+  if (other.words.size() > words.size()) {
+    words.resize(other.words.size(), 0);
+  }
+  for (size_t i = 0; i < other.words.size(); i++) {
+    words[i] |= other.words[i];
+  }
+}
+
+bool DSSet::contains(const DS_ID &id) const {
+  const std::optional<u32> index = find_interned_ds_id(id);
+  return index.has_value() && contains(*index);
+}
+
+bool DSSet::contains_all(const DSSet &other) const {
+  for (size_t i = 0; i < other.words.size(); i++) {
+    const u64 word = i < words.size() ? words[i] : 0;
+    if ((other.words[i] & ~word) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DSSet::empty() const {
+  return std::all_of(words.begin(), words.end(), [](u64 word) { return word == 0; });
+}
+
+std::vector<DS_ID> DSSet::get_ids() const {
+  std::vector<DS_ID> ids;
+  for (size_t i = 0; i < words.size(); i++) {
+    for (u64 word = words[i]; word != 0; word &= word - 1) {
+      ids.push_back(get_interned_ds_id(i * 64 + __builtin_ctzll(word)));
+    }
+  }
+  return ids;
+}
+
+bool DSSet::operator==(const DSSet &other) const {
+  const size_t size = std::max(words.size(), other.words.size());
+  for (size_t i = 0; i < size; i++) {
+    const u64 lhs = i < words.size() ? words[i] : 0;
+    const u64 rhs = i < other.words.size() ? other.words[i] : 0;
+    if (lhs != rhs) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace Tofino
+} // namespace LibSynapse
\ No newline at end of file
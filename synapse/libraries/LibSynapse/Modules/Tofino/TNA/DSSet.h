@@ -0,0 +1,44 @@
+#pragma once
+
+#include <LibSynapse/Modules/Tofino/DataStructures/DataStructure.h>
+#include <LibCore/Types.h>
+
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace LibSynapse {
+namespace Tofino {
+
+// Data structure ids are interned process-wide into small integers, stable for the lifetime of the process.
+u32 intern_ds_id(const DS_ID &id);
+std::optional<u32> find_interned_ds_id(const DS_ID &id);
+DS_ID get_interned_ds_id(u32 index);
+
+// Set of data structures, as a bitset over their interned ids. Pipelines are copied on every search step and walked on every placement check, so
+// this is what each stage keeps instead of a set of strings.
+class DSSet {
+private:
+  std::vector<u64> words;
+
+public:
+  DSSet() = default;
+  explicit DSSet(const std::unordered_set<DS_ID> &ids);
+
+  void insert(const DS_ID &id) { insert(intern_ds_id(id)); }
+  void insert(u32 index);
+  void insert(const DSSet &other);
+
+  bool contains(const DS_ID &id) const;
+  bool contains(u32 index) const { return (index / 64) < words.size() && (words[index / 64] >> (index % 64)) & 1; }
+  bool contains_all(const DSSet &other) const;
+
+  bool empty() const;
+  std::vector<DS_ID> get_ids() const;
+  const std::vector<u64> &get_words() const { return words; }
+
+  bool operator==(const DSSet &other) const;
+};
+
+} // namespace Tofino
+} // namespace LibSynapse
\ No newline at end of file
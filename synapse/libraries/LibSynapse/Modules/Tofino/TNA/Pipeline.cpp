@@ -1,6 +1,7 @@
 #include <LibSynapse/Modules/Tofino/TNA/Pipeline.h>
 #include <LibSynapse/Modules/Tofino/TNA/SimplePlacer.h>
 #include <LibSynapse/Modules/Tofino/TNA/SolverPlacer.h>
+#include <LibSynapse/Modules/Tofino/TNA/PlacementCache.h>
 #include <LibCore/Debug.h>
 
 namespace LibSynapse {
@@ -101,7 +102,7 @@ void Pipeline::debug() const {
 
     ss << "Objs: [";
     bool first = true;
-    for (DS_ID ds_id : stage.data_structures) {
+    for (DS_ID ds_id : stage.data_structures.get_ids()) {
       if (!first) {
         ss << ",";
       }
@@ -120,8 +121,13 @@ void Pipeline::debug() const {
 }
 
 int Pipeline::get_placed_stage(DS_ID ds_id) const {
+  const std::optional<u32> index = find_interned_ds_id(ds_id);
+  if (!index.has_value()) {
+    return -1;
+  }
+
   auto it = std::find_if(resources.stages.begin(), resources.stages.end(),
-                         [ds_id](const Stage &stage) { return stage.data_structures.find(ds_id) != stage.data_structures.end(); });
+                         [index](const Stage &stage) { return stage.data_structures.contains(*index); });
 
   if (it != resources.stages.end()) {
     return it->stage_id;
@@ -161,16 +167,14 @@ int Pipeline::get_soonest_stage_satisfying_all_dependencies(const std::unordered
     return 0;
   }
 
-  std::unordered_set<DS_ID> cummulative_ds;
+  const DSSet deps_set(deps);
+  DSSet cummulative_ds;
   int soonest_stage_id = -1;
 
   for (const Stage &stage : resources.stages) {
-    cummulative_ds.insert(stage.data_structures.begin(), stage.data_structures.end());
-
-    bool all_dependencies_are_satisfied =
-        std::all_of(deps.begin(), deps.end(), [&cummulative_ds](DS_ID dep) { return cummulative_ds.find(dep) != cummulative_ds.end(); });
+    cummulative_ds.insert(stage.data_structures);
 
-    if (all_dependencies_are_satisfied) {
+    if (cummulative_ds.contains_all(deps_set)) {
       soonest_stage_id = stage.stage_id + 1;
       break;
     }
@@ -218,10 +222,16 @@ PlacementStatus Pipeline::can_place(const DS *ds, const std::unordered_set<DS_ID
 }
 
 PlacementResult Pipeline::find_placements(const DS *ds, const std::unordered_set<DS_ID> &deps) const {
+  const std::string cache_key = PlacementCache::build_key(*this, ds, deps);
+  if (std::optional<PlacementResult> cached = PlacementCache::find(cache_key)) {
+    return *cached;
+  }
+
   PlacementResult result;
 
   result = SimplePlacer::find_placements(*this, ds, deps);
   if (result.status == PlacementStatus::Success) {
+    PlacementCache::insert(cache_key, result);
     return result;
   }
 
@@ -234,7 +244,10 @@ PlacementResult Pipeline::find_placements(const DS *ds, const std::unordered_set
   // std::cerr << "]\n";
   // std::cerr << "Reason: " << placement_status_to_string(result.status) << "\n";
 
-  return SolverPlacer::find_placements(*this, ds, deps);
+  result = SolverPlacer::find_placements(*this, ds, deps);
+  PlacementCache::insert(cache_key, result);
+
+  return result;
 }
 
 } // namespace Tofino
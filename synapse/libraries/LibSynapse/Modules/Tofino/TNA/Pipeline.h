@@ -2,6 +2,7 @@
 
 #include <LibSynapse/Modules/Tofino/DataStructures/DataStructures.h>
 #include <LibSynapse/Modules/Tofino/TNA/TNAProperties.h>
+#include <LibSynapse/Modules/Tofino/TNA/DSSet.h>
 #include <LibCore/Types.h>
 
 #include <unordered_set>
@@ -80,7 +81,7 @@ struct Stage {
   bits_t available_map_ram;
   bits_t available_exact_match_xbar;
   int available_logical_ids;
-  std::unordered_set<DS_ID> data_structures;
+  DSSet data_structures;
 };
 
 struct PipelineResources {
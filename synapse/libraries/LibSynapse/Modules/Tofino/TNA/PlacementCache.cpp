@@ -0,0 +1,204 @@
+#include <LibSynapse/Modules/Tofino/TNA/PlacementCache.h>
+#include <LibSynapse/GlobalStats.h>
+
+#include <algorithm>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace LibSynapse {
+namespace Tofino {
+namespace PlacementCache {
+
+namespace {
+
+std::mutex cache_mutex;
+std::unordered_map<std::string, PlacementResult> cache;
+
+template <typename T> void append(std::string &key, const T &value) {
+  static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be appended as raw bytes");
+  key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void append(std::string &key, const std::string &value) {
+  append(key, value.size());
+  key.append(value);
+}
+
+template <typename T> void append(std::string &key, const std::vector<T> &values) {
+  append(key, values.size());
+  for (const T &value : values) {
+    append(key, value);
+  }
+}
+
+void append(std::string &key, const std::unordered_set<DS_ID> &ids) {
+  std::vector<DS_ID> sorted_ids(ids.begin(), ids.end());
+  std::sort(sorted_ids.begin(), sorted_ids.end());
+  append(key, sorted_ids);
+}
+
+void append(std::string &key, const tna_properties_t &properties) {
+  append(key, properties.total_ports);
+  append(key, properties.total_recirc_ports);
+  append(key, properties.max_packet_bytes_in_condition);
+  append(key, properties.pipes);
+  append(key, properties.stages);
+  append(key, properties.sram_per_stage);
+  append(key, properties.tcam_per_stage);
+  append(key, properties.map_ram_per_stage);
+  append(key, properties.max_logical_tcam_tables_per_stage);
+  append(key, properties.max_logical_sram_and_tcam_tables_per_stage);
+  append(key, properties.phv_size);
+  append(key, properties.phv_8bit_containers);
+  append(key, properties.phv_16bit_containers);
+  append(key, properties.phv_32bit_containers);
+  append(key, properties.packet_buffer_size);
+  append(key, properties.exact_match_xbar_per_stage);
+  append(key, properties.max_exact_match_keys);
+  append(key, properties.ternary_match_xbar);
+  append(key, properties.max_ternary_match_keys);
+  append(key, properties.max_salu_size);
+  append(key, properties.max_digests);
+  append(key, properties.min_expiration_time);
+  append(key, properties.max_capacity);
+}
+
+void append(std::string &key, const PipelineResources &resources) {
+  append(key, resources.used_digests);
+  append(key, resources.stages.size());
+  for (const Stage &stage : resources.stages) {
+    append(key, stage.stage_id);
+    append(key, stage.available_sram);
+    append(key, stage.available_tcam);
+    append(key, stage.available_map_ram);
+    append(key, stage.available_exact_match_xbar);
+    append(key, stage.available_logical_ids);
+    append(key, stage.data_structures.get_words());
+  }
+}
+
+void append_primitive(std::string &key, const DS *ds) {
+  append(key, ds->type);
+  append(key, ds->id);
+
+  switch (ds->type) {
+  case DSType::Table: {
+    const Table *table = dynamic_cast<const Table *>(ds);
+    append(key, table->capacity);
+    append(key, table->keys);
+    append(key, table->params);
+    append(key, table->time_aware);
+  } break;
+  case DSType::Register: {
+    const Register *reg = dynamic_cast<const Register *>(ds);
+    std::vector<RegisterActionType> actions(reg->actions.begin(), reg->actions.end());
+    std::sort(actions.begin(), actions.end());
+    append(key, reg->capacity);
+    append(key, reg->index_size);
+    append(key, reg->value_size);
+    append(key, actions);
+  } break;
+  case DSType::Meter: {
+    const Meter *meter = dynamic_cast<const Meter *>(ds);
+    append(key, meter->capacity);
+    append(key, meter->rate);
+    append(key, meter->burst);
+    append(key, meter->keys);
+  } break;
+  case DSType::Hash: {
+    const Hash *hash = dynamic_cast<const Hash *>(ds);
+    append(key, hash->keys);
+    append(key, hash->size);
+  } break;
+  case DSType::Digest: {
+    const Digest *digest = dynamic_cast<const Digest *>(ds);
+    append(key, digest->fields);
+    append(key, digest->digest_type);
+  } break;
+  case DSType::LPM: {
+    const LPM *lpm = dynamic_cast<const LPM *>(ds);
+    append(key, lpm->capacity);
+    append(key, lpm->key);
+  } break;
+  default: {
+    panic("Data structure %s is not primitive", ds->id.c_str());
+  }
+  }
+}
+
+// What the placers see of a data structure: its primitives, in groups of independent ones.
+void append(std::string &key, const DS *ds) {
+  append(key, ds->type);
+  append(key, ds->id);
+
+  if (ds->primitive) {
+    append_primitive(key, ds);
+    return;
+  }
+
+  const std::vector<std::unordered_set<const DS *>> internal_primitive = ds->get_internal_primitive();
+
+  append(key, internal_primitive.size());
+  for (const std::unordered_set<const DS *> &independent_data_structures : internal_primitive) {
+    std::vector<const DS *> sorted_ds(independent_data_structures.begin(), independent_data_structures.end());
+    std::sort(sorted_ds.begin(), sorted_ds.end(), [](const DS *ds0, const DS *ds1) { return ds0->id < ds1->id; });
+
+    append(key, sorted_ds.size());
+    for (const DS *independent_ds : sorted_ds) {
+      append_primitive(key, independent_ds);
+    }
+  }
+}
+
+} // namespace
+
+std::string build_key(const Pipeline &pipeline, const DS *ds, const std::unordered_set<DS_ID> &deps) {
+  std::string key;
+
+  append(key, pipeline.properties);
+  append(key, pipeline.resources);
+
+  append(key, pipeline.placement_requests.size());
+  for (const PlacementRequest &request : pipeline.placement_requests) {
+    append(key, pipeline.data_structures.get_ds_from_id(request.ds));
+    append(key, request.deps);
+  }
+
+  append(key, ds);
+  append(key, deps);
+
+  return key;
+}
+
+std::optional<PlacementResult> find(const std::string &key) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  auto found_it = cache.find(key);
+  if (found_it == cache.end()) {
+    GlobalStats::num_placement_cache_misses++;
+    return std::nullopt;
+  }
+
+  GlobalStats::num_placement_cache_hits++;
+  return found_it->second;
+}
+
+void insert(const std::string &key, const PlacementResult &result) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  if (cache.size() >= MAX_ENTRIES) {
+    cache.clear();
+  }
+
+  cache.emplace(key, result);
+}
+
+void clear() {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  cache.clear();
+}
+
+} // namespace PlacementCache
+} // namespace Tofino
+} // namespace LibSynapse
\ No newline at end of file
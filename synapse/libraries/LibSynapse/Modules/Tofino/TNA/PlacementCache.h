@@ -0,0 +1,27 @@
+#pragma once
+
+#include <LibSynapse/Modules/Tofino/TNA/Pipeline.h>
+#include <LibSynapse/Modules/Tofino/DataStructures/DataStructures.h>
+
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+namespace LibSynapse {
+namespace Tofino {
+namespace PlacementCache {
+
+// Placement results, shared by every pipeline of the process. The same placements are checked over and over across EPs (and then placed again),
+// and both placers are deterministic on the properties, the current resources, the previous requests and the requested data structure, so that
+// is what the key holds.
+constexpr const size_t MAX_ENTRIES = 1 << 16;
+
+std::string build_key(const Pipeline &pipeline, const DS *ds, const std::unordered_set<DS_ID> &deps);
+
+std::optional<PlacementResult> find(const std::string &key);
+void insert(const std::string &key, const PlacementResult &result);
+void clear();
+
+} // namespace PlacementCache
+} // namespace Tofino
+} // namespace LibSynapse
\ No newline at end of file
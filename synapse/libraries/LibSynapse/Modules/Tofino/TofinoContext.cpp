@@ -188,7 +188,7 @@ void TofinoContext::debug() const {
 template <> const Tofino::TofinoContext *Context::get_target_ctx<Tofino::TofinoContext>() const {
   const TargetType type = TargetType::Tofino;
   assert(target_ctxs.find(type) != target_ctxs.end() && "No context for target");
-  return dynamic_cast<const Tofino::TofinoContext *>(target_ctxs.at(type));
+  return dynamic_cast<const Tofino::TofinoContext *>(target_ctxs.at(type).get());
 }
 
 template <> const Tofino::TofinoContext *Context::get_target_ctx_if_available<Tofino::TofinoContext>() const {
@@ -196,13 +196,12 @@ template <> const Tofino::TofinoContext *Context::get_target_ctx_if_available<To
   if (target_ctxs.find(type) == target_ctxs.end()) {
     return nullptr;
   }
-  return dynamic_cast<const Tofino::TofinoContext *>(target_ctxs.at(type));
+  return dynamic_cast<const Tofino::TofinoContext *>(target_ctxs.at(type).get());
 }
 
 template <> Tofino::TofinoContext *Context::get_mutable_target_ctx<Tofino::TofinoContext>() {
   const TargetType type = TargetType::Tofino;
-  assert(target_ctxs.find(type) != target_ctxs.end() && "No context for target");
-  return dynamic_cast<Tofino::TofinoContext *>(target_ctxs.at(type));
+  return dynamic_cast<Tofino::TofinoContext *>(clone_target_ctx_if_shared(type));
 }
 
 } // namespace LibSynapse
\ No newline at end of file
@@ -5,13 +5,12 @@ namespace LibSynapse {
 template <> const x86::x86Context *Context::get_target_ctx<x86::x86Context>() const {
   TargetType type = TargetType::x86;
   assert(target_ctxs.find(type) != target_ctxs.end() && "No context for target");
-  return dynamic_cast<const x86::x86Context *>(target_ctxs.at(type));
+  return dynamic_cast<const x86::x86Context *>(target_ctxs.at(type).get());
 }
 
 template <> x86::x86Context *Context::get_mutable_target_ctx<x86::x86Context>() {
   TargetType type = TargetType::x86;
-  assert(target_ctxs.find(type) != target_ctxs.end() && "No context for target");
-  return dynamic_cast<x86::x86Context *>(target_ctxs.at(type));
+  return dynamic_cast<x86::x86Context *>(clone_target_ctx_if_shared(type));
 }
 
 } // namespace LibSynapse
\ No newline at end of file
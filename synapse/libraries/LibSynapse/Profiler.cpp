@@ -29,9 +29,9 @@ using LibCore::symbol_t;
 
 namespace {
 
-ProfilerNode *build_profiler_tree(const BDD *bdd, const BDDNode *node, const bdd_profile_t *bdd_profile, u64 max_count,
-                                  const std::unordered_set<u16> available_devs) {
-  ProfilerNode *prof_node = nullptr;
+std::shared_ptr<ProfilerNode> build_profiler_tree(const BDD *bdd, const BDDNode *node, const bdd_profile_t *bdd_profile, u64 max_count,
+                                                  const std::unordered_set<u16> available_devs) {
+  std::shared_ptr<ProfilerNode> prof_node;
 
   while (node) {
     switch (node->get_type()) {
@@ -39,7 +39,7 @@ ProfilerNode *build_profiler_tree(const BDD *bdd, const BDDNode *node, const bdd
       if (!node->get_next()) {
         const u64 counter   = bdd_profile->counters.at(node->get_id());
         const hit_rate_t hr = hit_rate_t(counter, max_count);
-        prof_node           = new ProfilerNode(nullptr, hr, node->get_id());
+        prof_node           = std::make_shared<ProfilerNode>(nullptr, hr, node->get_id());
       }
       node = node->get_next();
     } break;
@@ -51,16 +51,14 @@ ProfilerNode *build_profiler_tree(const BDD *bdd, const BDDNode *node, const bdd
 
       const u64 counter   = bdd_profile->counters.at(node->get_id());
       const hit_rate_t hr = hit_rate_t(counter, max_count);
-      prof_node           = new ProfilerNode(condition, hr, node->get_id());
+      prof_node           = std::make_shared<ProfilerNode>(condition, hr, node->get_id());
 
       if (on_true) {
-        prof_node->on_true       = build_profiler_tree(bdd, on_true, bdd_profile, max_count, available_devs);
-        prof_node->on_true->prev = prof_node;
+        prof_node->on_true = build_profiler_tree(bdd, on_true, bdd_profile, max_count, available_devs);
       }
 
       if (on_false) {
-        prof_node->on_false       = build_profiler_tree(bdd, on_false, bdd_profile, max_count, available_devs);
-        prof_node->on_false->prev = prof_node;
+        prof_node->on_false = build_profiler_tree(bdd, on_false, bdd_profile, max_count, available_devs);
       }
 
       node = nullptr;
@@ -74,7 +72,7 @@ ProfilerNode *build_profiler_tree(const BDD *bdd, const BDDNode *node, const bdd
       const u64 counter = bdd_profile->counters.at(node->get_id());
       const hit_rate_t hr(counter, max_count);
 
-      prof_node = new ProfilerNode(nullptr, hr, node->get_id());
+      prof_node = std::make_shared<ProfilerNode>(nullptr, hr, node->get_id());
 
       const bdd_profile_t::fwd_stats_t &fwd_stats = bdd_profile->forwarding_stats.at(node->get_id());
 
@@ -123,28 +121,75 @@ ProfilerNode *build_profiler_tree(const BDD *bdd, const BDDNode *node, const bdd
   return prof_node;
 }
 
-} // namespace
+// Makes sure the node in this slot isn't shared with other profilers, copying it (but not its children) if needed.
+// The slot itself must belong to an exclusive node (or be the root), so exclusivity must be established top-down.
+ProfilerNode *make_exclusive(std::shared_ptr<ProfilerNode> &slot) {
+  assert(slot && "Invalid profiler node");
+  if (slot.use_count() > 1) {
+    slot = std::make_shared<ProfilerNode>(*slot);
+  }
+  return slot.get();
+}
 
-ProfilerNode::ProfilerNode(klee::ref<klee::Expr> _constraint, hit_rate_t _fraction)
-    : constraint(_constraint), fraction(_fraction), on_true(nullptr), on_false(nullptr), prev(nullptr) {}
+std::shared_ptr<ProfilerNode> &get_child_slot(ProfilerNode *parent, const ProfilerNode *child) {
+  assert(((parent->on_true.get() == child) || (parent->on_false.get() == child)) && "Invalid node");
+  return parent->on_true.get() == child ? parent->on_true : parent->on_false;
+}
 
-ProfilerNode::ProfilerNode(klee::ref<klee::Expr> _constraint, hit_rate_t _fraction, bdd_node_id_t _node_id)
-    : constraint(_constraint), fraction(_fraction), bdd_node_id(_node_id), on_true(nullptr), on_false(nullptr), prev(nullptr) {}
+std::shared_ptr<ProfilerNode> &get_sibling_slot(ProfilerNode *parent, const ProfilerNode *child) {
+  assert(((parent->on_true.get() == child) || (parent->on_false.get() == child)) && "Invalid node");
+  return parent->on_true.get() == child ? parent->on_false : parent->on_true;
+}
 
-ProfilerNode::~ProfilerNode() {
-  if (on_true) {
-    delete on_true;
-    on_true = nullptr;
+bool are_exprs_structurally_equal(klee::ref<klee::Expr> e0, klee::ref<klee::Expr> e1) { return e0->hash() == e1->hash() && e0 == e1; }
+
+enum class Direction { None, OnTrue, OnFalse };
+
+// The constraints we are asked about are almost always the branch conditions stored in the tree (or their negation), built the same way. Try
+// that before bothering the solver.
+Direction match_constraint(klee::ref<klee::Expr> node_constraint, klee::ref<klee::Expr> &negated_node_constraint, klee::ref<klee::Expr> cnstr) {
+  if (are_exprs_structurally_equal(node_constraint, cnstr)) {
+    return Direction::OnTrue;
   }
 
-  if (on_false) {
-    delete on_false;
-    on_false = nullptr;
+  if (negated_node_constraint.isNull()) {
+    negated_node_constraint = solver_toolbox.exprBuilder->Not(node_constraint);
+  }
+
+  if (are_exprs_structurally_equal(negated_node_constraint, cnstr)) {
+    return Direction::OnFalse;
+  }
+
+  return Direction::None;
+}
+
+Direction solve_constraint(klee::ref<klee::Expr> node_constraint, klee::ref<klee::Expr> cnstr) {
+  klee::ConstraintManager manager;
+  manager.addConstraint(node_constraint);
+
+  const bool always_true  = solver_toolbox.is_expr_always_true(manager, cnstr);
+  const bool always_false = solver_toolbox.is_expr_always_false(manager, cnstr);
+
+  if (always_true) {
+    return Direction::OnTrue;
   }
+
+  if (always_false) {
+    return Direction::OnFalse;
+  }
+
+  return Direction::None;
 }
 
-ProfilerNode *ProfilerNode::clone(bool keep_bdd_info) const {
-  ProfilerNode *new_node = new ProfilerNode(constraint, fraction);
+} // namespace
+
+ProfilerNode::ProfilerNode(klee::ref<klee::Expr> _constraint, hit_rate_t _fraction) : constraint(_constraint), fraction(_fraction) {}
+
+ProfilerNode::ProfilerNode(klee::ref<klee::Expr> _constraint, hit_rate_t _fraction, bdd_node_id_t _node_id)
+    : constraint(_constraint), fraction(_fraction), bdd_node_id(_node_id) {}
+
+std::shared_ptr<ProfilerNode> ProfilerNode::clone(bool keep_bdd_info) const {
+  std::shared_ptr<ProfilerNode> new_node = std::make_shared<ProfilerNode>(constraint, fraction);
 
   if (keep_bdd_info) {
     new_node->bdd_node_id = bdd_node_id;
@@ -155,13 +200,11 @@ ProfilerNode *ProfilerNode::clone(bool keep_bdd_info) const {
   new_node->candidate_fwd_ports       = candidate_fwd_ports;
 
   if (on_true) {
-    new_node->on_true       = on_true->clone(keep_bdd_info);
-    new_node->on_true->prev = new_node;
+    new_node->on_true = on_true->clone(keep_bdd_info);
   }
 
   if (on_false) {
-    new_node->on_false       = on_false->clone(keep_bdd_info);
-    new_node->on_false->prev = new_node;
+    new_node->on_false = on_false->clone(keep_bdd_info);
   }
 
   return new_node;
@@ -268,7 +311,7 @@ Profiler::Profiler(const BDD *bdd, const bdd_profile_t &_bdd_profile, const std:
   assert(bdd_profile->counters.find(bdd_root->get_id()) != bdd_profile->counters.end() && "Root node not found");
   const u64 max_count = bdd_profile->counters.at(bdd_root->get_id());
 
-  root = std::shared_ptr<ProfilerNode>(build_profiler_tree(bdd, bdd_root, bdd_profile.get(), max_count, available_devs));
+  root = build_profiler_tree(bdd, bdd_root, bdd_profile.get(), max_count, available_devs);
 
   for (const auto &[map_addr, map_stats] : bdd_profile->stats_per_map) {
     for (const auto &node_map_stats : map_stats.nodes) {
@@ -324,46 +367,40 @@ const bdd_profile_t *Profiler::get_bdd_profile() const { return bdd_profile.get(
 
 bytes_t Profiler::get_avg_pkt_bytes() const { return avg_pkt_size; }
 
-ProfilerNode *Profiler::get_node(const std::vector<klee::ref<klee::Expr>> &constraints) const {
-  ProfilerNode *current = root.get();
+profiler_path_t Profiler::get_path(const std::vector<klee::ref<klee::Expr>> &constraints) const {
+  profiler_path_t path{root.get()};
+
+  std::vector<bool> used_constraints(constraints.size(), false);
+  size_t total_used_constraints = 0;
+
+  while (total_used_constraints != constraints.size()) {
+    ProfilerNode *current = path.back();
 
-  std::unordered_set<size_t> index_of_used_constraints;
-  while (index_of_used_constraints.size() != constraints.size()) {
     if (!current) {
-      return nullptr;
+      return {};
     }
 
     assert(!current->constraint.isNull() && "Invalid profiler node");
 
-    bool found = false;
-    for (size_t i = 0; i < constraints.size(); ++i) {
-      if (index_of_used_constraints.contains(i)) {
-        continue;
-      }
-
-      klee::ref<klee::Expr> cnstr = constraints[i];
+    klee::ref<klee::Expr> negated_constraint;
+    Direction direction = Direction::None;
+    size_t chosen       = 0;
 
-      klee::ConstraintManager manager;
-      manager.addConstraint(current->constraint);
-
-      const bool always_true  = solver_toolbox.is_expr_always_true(manager, cnstr);
-      const bool always_false = solver_toolbox.is_expr_always_false(manager, cnstr);
-
-      if (!always_true && !always_false) {
-        continue;
+    for (size_t i = 0; i < constraints.size() && direction == Direction::None; ++i) {
+      if (!used_constraints[i]) {
+        direction = match_constraint(current->constraint, negated_constraint, constraints[i]);
+        chosen    = i;
       }
+    }
 
-      if (always_true) {
-        current = current->on_true;
-      } else {
-        current = current->on_false;
+    for (size_t i = 0; i < constraints.size() && direction == Direction::None; ++i) {
+      if (!used_constraints[i]) {
+        direction = solve_constraint(current->constraint, constraints[i]);
+        chosen    = i;
       }
-
-      found = true;
-      index_of_used_constraints.insert(i);
     }
 
-    if (!found) {
+    if (direction == Direction::None) {
       std::cerr << "\n";
       std::cerr << "Constraints:\n";
       for (const klee::ref<klee::Expr> &c : constraints) {
@@ -373,10 +410,40 @@ ProfilerNode *Profiler::get_node(const std::vector<klee::ref<klee::Expr>> &const
       std::cerr << "  " << pretty_print_expr(current->constraint, true) << "\n";
       panic("Could find profiler node (invalid constraints)");
     }
+
+    used_constraints[chosen] = true;
+    total_used_constraints++;
+
+    path.push_back(direction == Direction::OnTrue ? current->on_true.get() : current->on_false.get());
+  }
+
+  if (!path.back()) {
+    return {};
   }
 
-  assert(current && "Profiler node not found");
-  return current;
+  return path;
+}
+
+profiler_path_t Profiler::get_mutable_path(const std::vector<klee::ref<klee::Expr>> &constraints) {
+  clear_cache();
+
+  const profiler_path_t shared_path = get_path(constraints);
+  assert(!shared_path.empty() && "Profiler node not found");
+
+  // Copy whatever is still shared along the way, and nothing else.
+  profiler_path_t path{make_exclusive(root)};
+  for (size_t i = 1; i < shared_path.size(); i++) {
+    ProfilerNode *parent = path.back();
+    const bool on_true   = shared_path[i - 1]->on_true.get() == shared_path[i];
+    path.push_back(make_exclusive(on_true ? parent->on_true : parent->on_false));
+  }
+
+  return path;
+}
+
+ProfilerNode *Profiler::get_node(const std::vector<klee::ref<klee::Expr>> &constraints) const {
+  const profiler_path_t path = get_path(constraints);
+  return path.empty() ? nullptr : path.back();
 }
 
 ProfilerNode *Profiler::get_node(const BDDNode *node) const {
@@ -422,16 +489,11 @@ ProfilerNode *Profiler::get_node(const EPNode *node) const {
 void Profiler::replace_root(klee::ref<klee::Expr> constraint, hit_rate_t fraction) {
   panic("Attempted to replace Profiler root node");
 
-  ProfilerNode *new_node = new ProfilerNode(constraint, 1_hr);
+  std::shared_ptr<ProfilerNode> new_node = std::make_shared<ProfilerNode>(constraint, 1_hr);
 
-  ProfilerNode *node = root.get();
-  root               = std::shared_ptr<ProfilerNode>(new_node);
-
-  new_node->on_true  = node;
-  new_node->on_false = node->clone(false);
-
-  new_node->on_true->prev  = new_node;
-  new_node->on_false->prev = new_node;
+  new_node->on_true  = root;
+  new_node->on_false = root->clone(false);
+  root               = new_node;
 
   const hit_rate_t fraction_on_true  = fraction;
   const hit_rate_t fraction_on_false = new_node->fraction - fraction;
@@ -439,164 +501,127 @@ void Profiler::replace_root(klee::ref<klee::Expr> constraint, hit_rate_t fractio
   assert(fraction_on_true <= new_node->fraction && "Invalid fraction");
   assert(fraction_on_false <= new_node->fraction && "Invalid fraction");
 
-  recursive_update_fractions(new_node->on_true, new_node->fraction, fraction_on_true);
-  recursive_update_fractions(new_node->on_false, new_node->fraction, fraction_on_false);
+  recursive_update_fractions(new_node->on_true, true, new_node->fraction, fraction_on_true);
+  recursive_update_fractions(new_node->on_false, true, new_node->fraction, fraction_on_false);
 }
 
-void Profiler::append(ProfilerNode *node, klee::ref<klee::Expr> constraint, hit_rate_t fraction) {
-  ProfilerNode *parent = node->prev;
-
-  if (!parent) {
+void Profiler::append(const profiler_path_t &path, klee::ref<klee::Expr> constraint, hit_rate_t fraction) {
+  if (path.size() < 2) {
     replace_root(constraint, fraction);
     return;
   }
 
-  ProfilerNode *new_node = new ProfilerNode(constraint, node->fraction);
+  ProfilerNode *node   = path[path.size() - 1];
+  ProfilerNode *parent = path[path.size() - 2];
 
-  assert(((parent->on_true == node) || (parent->on_false == node)) && "Invalid node");
-  if (parent->on_true == node) {
-    parent->on_true = new_node;
-  } else {
-    parent->on_false = new_node;
-  }
-
-  new_node->prev = parent;
-
-  new_node->on_true       = node;
-  new_node->on_true->prev = new_node;
+  std::shared_ptr<ProfilerNode> &slot    = get_child_slot(parent, node);
+  std::shared_ptr<ProfilerNode> new_node = std::make_shared<ProfilerNode>(constraint, node->fraction);
 
-  new_node->on_false       = node->clone(false);
-  new_node->on_false->prev = new_node;
+  new_node->on_true  = slot;
+  new_node->on_false = node->clone(false);
+  slot               = new_node;
 
   const hit_rate_t fraction_on_true  = fraction;
   const hit_rate_t fraction_on_false = new_node->fraction - fraction;
 
-  recursive_update_fractions(new_node->on_true, new_node->fraction, fraction_on_true);
-  recursive_update_fractions(new_node->on_false, new_node->fraction, fraction_on_false);
-}
-
-ProfilerNode::family_t ProfilerNode::get_family() {
-  family_t family = {
-      .node        = this,
-      .parent      = prev,
-      .grandparent = nullptr,
-      .sibling     = nullptr,
-  };
-
-  if (family.parent) {
-    family.grandparent = family.parent->prev;
-    family.sibling     = (family.parent->on_true == this) ? family.parent->on_false : family.parent->on_true;
-  }
-
-  return family;
+  recursive_update_fractions(new_node->on_true, true, new_node->fraction, fraction_on_true);
+  recursive_update_fractions(new_node->on_false, true, new_node->fraction, fraction_on_false);
 }
 
-void Profiler::remove(ProfilerNode *node) {
-  ProfilerNode::family_t family = node->get_family();
+// Returns the sibling, which takes the place of the removed parent.
+ProfilerNode *Profiler::remove(const profiler_path_t &path) {
+  assert(path.size() >= 2 && "Cannot remove the root node");
 
-  assert(family.parent && "Cannot remove the root node");
-  const hit_rate_t parent_fraction = family.parent->fraction;
+  ProfilerNode *node               = path[path.size() - 1];
+  ProfilerNode *parent             = path[path.size() - 2];
+  const hit_rate_t parent_fraction = parent->fraction;
 
   // By removing the current node, the parent is no longer needed (its purpose
   // was to differentiate between the on_true and on_false nodes, but now only
   // one side is left).
 
-  assert(family.grandparent && "Cannot remove the root node");
-
-  if (family.grandparent->on_true == family.parent) {
-    family.grandparent->on_true = family.sibling;
-  } else {
-    family.grandparent->on_false = family.sibling;
-  }
+  assert(path.size() >= 3 && "Cannot remove the root node");
+  ProfilerNode *grandparent = path[path.size() - 3];
 
-  family.sibling->prev = family.grandparent;
+  std::shared_ptr<ProfilerNode> &parent_slot = get_child_slot(grandparent, parent);
+  std::shared_ptr<ProfilerNode> sibling      = get_sibling_slot(parent, node);
+  assert(sibling && "Invalid sibling");
 
-  if (family.parent->on_true == family.sibling) {
-    family.parent->on_true = nullptr;
-  } else {
-    family.parent->on_false = nullptr;
-  }
+  // This frees the parent, and the removed node with it.
+  parent_slot = sibling;
+  sibling.reset();
 
-  delete family.parent;
+  ProfilerNode *new_sibling = make_exclusive(parent_slot);
 
-  const hit_rate_t old_fraction = family.sibling->fraction;
+  const hit_rate_t old_fraction = new_sibling->fraction;
   const hit_rate_t new_fraction = parent_fraction;
 
-  update_fractions(family.sibling, new_fraction);
+  update_fractions(new_sibling, new_fraction);
+  recursive_update_children_fractions(new_sibling, old_fraction, new_fraction);
 
-  recursive_update_fractions(family.sibling->on_true, old_fraction, new_fraction);
-  recursive_update_fractions(family.sibling->on_false, old_fraction, new_fraction);
+  return new_sibling;
 }
 
-void Profiler::remove_until(ProfilerNode *target, ProfilerNode *stopping_node) {
-  assert(target != nullptr);
-  assert(stopping_node != nullptr);
+void Profiler::remove_until(const profiler_path_t &target, profiler_path_t stopping_path) {
+  assert(target.size() >= 2);
+  assert(!stopping_path.empty());
+
+  const ProfilerNode *parent = target[target.size() - 2];
+
+  while (stopping_path.size() >= 2 && stopping_path[stopping_path.size() - 2] != parent) {
+    ProfilerNode *stopping_node = stopping_path[stopping_path.size() - 1];
+    ProfilerNode *stopping_prev = stopping_path[stopping_path.size() - 2];
 
-  ProfilerNode *parent = target->prev;
-  assert(parent);
+    profiler_path_t sibling_path(stopping_path.begin(), stopping_path.end() - 1);
+    sibling_path.push_back(make_exclusive(get_sibling_slot(stopping_prev, stopping_node)));
+    assert(sibling_path.back());
 
-  while (stopping_node->prev && stopping_node->prev != parent) {
-    ProfilerNode *sibling = stopping_node->get_family().sibling;
-    assert(sibling);
-    remove(sibling);
+    // The stopping node climbs one level.
+    ProfilerNode *promoted = remove(sibling_path);
+    stopping_path.erase(stopping_path.end() - 2);
+    stopping_path.back() = promoted;
   }
 }
 
-void Profiler::remove(const std::vector<klee::ref<klee::Expr>> &constraints) {
-  clone_tree_if_shared();
-  ProfilerNode *node = get_node(constraints);
-  remove(node);
-}
+void Profiler::remove(const std::vector<klee::ref<klee::Expr>> &constraints) { remove(get_mutable_path(constraints)); }
 
 void Profiler::remove_until(const std::vector<klee::ref<klee::Expr>> &target, const std::vector<klee::ref<klee::Expr>> &stopping_constraints) {
-  clone_tree_if_shared();
-  ProfilerNode *target_node   = get_node(target);
-  ProfilerNode *stopping_node = get_node(stopping_constraints);
-  remove_until(target_node, stopping_node);
+  const profiler_path_t target_path   = get_mutable_path(target);
+  const profiler_path_t stopping_path = get_mutable_path(stopping_constraints);
+  remove_until(target_path, stopping_path);
 }
 
 void Profiler::insert_relative(const std::vector<klee::ref<klee::Expr>> &constraints, klee::ref<klee::Expr> constraint,
                                hit_rate_t rel_fraction_on_true) {
-  clone_tree_if_shared();
-  ProfilerNode *node        = get_node(constraints);
-  const hit_rate_t fraction = hit_rate_t{rel_fraction_on_true * node->fraction};
-  append(node, constraint, fraction);
+  const profiler_path_t path = get_mutable_path(constraints);
+  const hit_rate_t fraction  = hit_rate_t{rel_fraction_on_true * path.back()->fraction};
+  append(path, constraint, fraction);
 }
 
 void Profiler::scale(const std::vector<klee::ref<klee::Expr>> &constraints, double factor) {
-  clone_tree_if_shared();
-  ProfilerNode *node = get_node(constraints);
+  ProfilerNode *node = get_mutable_path(constraints).back();
 
   const hit_rate_t old_fraction = node->fraction;
   const hit_rate_t new_fraction = node->fraction * factor;
 
   update_fractions(node, new_fraction);
-
-  recursive_update_fractions(node->on_true, old_fraction, new_fraction);
-  recursive_update_fractions(node->on_false, old_fraction, new_fraction);
+  recursive_update_children_fractions(node, old_fraction, new_fraction);
 }
 
 bool Profiler::can_set(const std::vector<klee::ref<klee::Expr>> &constraints, hit_rate_t new_hr) const {
-  return can_set(get_node(constraints), new_hr);
+  return can_set(get_path(constraints), new_hr);
 }
 
-void Profiler::set(const std::vector<klee::ref<klee::Expr>> &constraints, hit_rate_t new_hr) {
-  clone_tree_if_shared();
-  set(get_node(constraints), new_hr);
-}
+void Profiler::set(const std::vector<klee::ref<klee::Expr>> &constraints, hit_rate_t new_hr) { set(get_mutable_path(constraints), new_hr); }
 
 void Profiler::set_relative(const std::vector<klee::ref<klee::Expr>> &constraints, hit_rate_t parent_relative_hr) {
-  clone_tree_if_shared();
+  const profiler_path_t path = get_mutable_path(constraints);
+  assert(path.size() >= 2);
 
-  ProfilerNode *node = get_node(constraints);
-  assert(node);
+  const ProfilerNode *parent    = path[path.size() - 2];
+  const hit_rate_t new_fraction = hit_rate_t(parent->fraction * parent_relative_hr);
 
-  const ProfilerNode::family_t family = node->get_family();
-  assert(family.parent);
-
-  const hit_rate_t new_fraction = hit_rate_t(family.parent->fraction * parent_relative_hr);
-
-  set(node, new_fraction);
+  set(path, new_fraction);
 }
 
 hit_rate_t Profiler::get_hr(const BDDNode *node) const {
@@ -632,28 +657,13 @@ void Profiler::debug() const {
   std::cerr << "===========================================\n\n";
 }
 
-void Profiler::clone_tree_if_shared() {
-  clear_cache();
-
-  assert(root && "Invalid profiler root node");
-
-  // No need to clone a tree that is not shared.
-  if (root.use_count() == 1) {
-    return;
-  }
-
-  root = std::shared_ptr<ProfilerNode>(root->clone(true));
-}
-
 void Profiler::translate(SymbolManager *symbol_manager, const BDDNode *reordered_node, const std::vector<symbol_translation_t> &translated_symbols) {
-  clone_tree_if_shared();
-
   std::unordered_map<std::string, std::string> translations;
   for (const auto &[old_symbol, new_symbol] : translated_symbols) {
     translations[old_symbol.name] = new_symbol.name;
   }
 
-  std::vector<ProfilerNode *> nodes{get_node(reordered_node)};
+  std::vector<ProfilerNode *> nodes{get_mutable_path(reordered_node->get_ordered_branch_constraints()).back()};
 
   while (!nodes.empty()) {
     ProfilerNode *node = nodes.back();
@@ -662,24 +672,18 @@ void Profiler::translate(SymbolManager *symbol_manager, const BDDNode *reordered
     node->constraint = symbol_manager->translate(node->constraint, translations);
 
     if (node->on_true) {
-      nodes.push_back(node->on_true);
+      nodes.push_back(make_exclusive(node->on_true));
     }
 
     if (node->on_false) {
-      nodes.push_back(node->on_false);
+      nodes.push_back(make_exclusive(node->on_false));
     }
   }
 }
 
-void Profiler::replace_constraint(ProfilerNode *node, klee::ref<klee::Expr> constraint) {
-  clone_tree_if_shared();
-  node->constraint = constraint;
-}
-
 void Profiler::replace_constraint(const std::vector<klee::ref<klee::Expr>> &constraints, klee::ref<klee::Expr> constraint) {
-  clone_tree_if_shared();
-  ProfilerNode *node = get_node(constraints);
-  replace_constraint(node, constraint);
+  ProfilerNode *node = get_mutable_path(constraints).back();
+  node->constraint   = constraint;
 }
 
 rw_fractions_t Profiler::get_cond_map_put_rw_profile_fractions(const Call *map_get) const {
@@ -725,7 +729,7 @@ rw_fractions_t Profiler::get_cond_map_put_rw_profile_fractions(const Call *map_g
   return fractions;
 }
 
-bool Profiler::can_update_fractions(ProfilerNode *node) const {
+bool Profiler::can_update_fractions(const ProfilerNode *node) const {
   if (!node) {
     return false;
   }
@@ -746,7 +750,7 @@ bool Profiler::can_update_fractions(ProfilerNode *node) const {
     return true;
   }
 
-  fwd_stats_t &fwd_stats = node->forwarding_stats.value();
+  const fwd_stats_t &fwd_stats = node->forwarding_stats.value();
   if (fwd_stats.operation == RouteOp::Forward && original_fwd_stats.ports.empty()) {
     return false;
   }
@@ -816,38 +820,38 @@ void Profiler::update_fractions(ProfilerNode *node, hit_rate_t new_fraction) {
   }
 }
 
-bool Profiler::can_recursive_update_fractions(ProfilerNode *node, hit_rate_t parent_old_fraction) const {
+bool Profiler::can_recursive_update_fractions(const ProfilerNode *node, bool has_sibling, hit_rate_t parent_old_fraction) const {
   if (!node) {
     return false;
   }
 
   const hit_rate_t old_fraction = node->fraction;
 
-  if (parent_old_fraction == 0_hr) {
-    const ProfilerNode::family_t family = node->get_family();
-    if (family.sibling) {
-      // There is not enough information to make profiling forwarding decisions.
-      return false;
-    }
+  if (parent_old_fraction == 0_hr && has_sibling) {
+    // There is not enough information to make profiling forwarding decisions.
+    return false;
   }
 
   if (!can_update_fractions(node)) {
     return false;
   }
 
-  if (node->on_true && !can_recursive_update_fractions(node->on_true, old_fraction)) {
+  const bool has_both_children = node->on_true && node->on_false;
+
+  if (node->on_true && !can_recursive_update_fractions(node->on_true.get(), has_both_children, old_fraction)) {
     return false;
   }
 
-  if (node->on_false && !can_recursive_update_fractions(node->on_false, old_fraction)) {
+  if (node->on_false && !can_recursive_update_fractions(node->on_false.get(), has_both_children, old_fraction)) {
     return false;
   }
 
   return true;
 }
 
-void Profiler::recursive_update_fractions(ProfilerNode *node, hit_rate_t parent_old_fraction, hit_rate_t parent_new_fraction) {
-  if (!node) {
+void Profiler::recursive_update_fractions(std::shared_ptr<ProfilerNode> &slot, bool has_sibling, hit_rate_t parent_old_fraction,
+                                          hit_rate_t parent_new_fraction) {
+  if (!slot) {
     return;
   }
 
@@ -855,13 +859,12 @@ void Profiler::recursive_update_fractions(ProfilerNode *node, hit_rate_t parent_
     return;
   }
 
+  ProfilerNode *node            = make_exclusive(slot);
   const hit_rate_t old_fraction = node->fraction;
 
   hit_rate_t new_fraction;
   if (parent_old_fraction == 0_hr) {
-    const ProfilerNode::family_t family = node->get_family();
-
-    if (family.sibling) {
+    if (has_sibling) {
       // There is not enough information to make profiling forwarding decisions.
       panic("Not enough profiling information: distribution of traffic across siblings is unknown");
     } else {
@@ -872,20 +875,26 @@ void Profiler::recursive_update_fractions(ProfilerNode *node, hit_rate_t parent_
   }
 
   update_fractions(node, new_fraction);
-
-  recursive_update_fractions(node->on_true, old_fraction, new_fraction);
-  recursive_update_fractions(node->on_false, old_fraction, new_fraction);
+  recursive_update_children_fractions(node, old_fraction, new_fraction);
 
   if (node->on_true && node->on_false) {
     assert(node->on_true->fraction + node->on_false->fraction == new_fraction);
   }
 }
 
-bool Profiler::can_set(ProfilerNode *node, hit_rate_t new_hr) const {
-  if (!node) {
+void Profiler::recursive_update_children_fractions(ProfilerNode *node, hit_rate_t old_fraction, hit_rate_t new_fraction) {
+  const bool has_both_children = node->on_true && node->on_false;
+  recursive_update_fractions(node->on_true, has_both_children, old_fraction, new_fraction);
+  recursive_update_fractions(node->on_false, has_both_children, old_fraction, new_fraction);
+}
+
+bool Profiler::can_set(const profiler_path_t &path, hit_rate_t new_hr) const {
+  if (path.empty()) {
     return false;
   }
 
+  const ProfilerNode *node = path.back();
+
   const hit_rate_t old_fraction = node->fraction;
   const hit_rate_t new_fraction = new_hr;
 
@@ -893,16 +902,23 @@ bool Profiler::can_set(ProfilerNode *node, hit_rate_t new_hr) const {
     return true;
   }
 
-  if ((node->on_true && !can_recursive_update_fractions(node->on_true, old_fraction)) ||
-      (node->on_false && !can_recursive_update_fractions(node->on_false, old_fraction))) {
+  const bool has_both_children = node->on_true && node->on_false;
+
+  if ((node->on_true && !can_recursive_update_fractions(node->on_true.get(), has_both_children, old_fraction)) ||
+      (node->on_false && !can_recursive_update_fractions(node->on_false.get(), has_both_children, old_fraction))) {
     return false;
   }
 
-  const ProfilerNode::family_t family = node->get_family();
-  if (family.sibling) {
-    const hit_rate_t sibling_old_fraction = family.sibling->fraction;
-    if ((family.sibling->on_true && !can_recursive_update_fractions(family.sibling->on_true, sibling_old_fraction)) ||
-        (family.sibling->on_false && !can_recursive_update_fractions(family.sibling->on_false, sibling_old_fraction))) {
+  if (path.size() < 2) {
+    return true;
+  }
+
+  const ProfilerNode *sibling = get_sibling_slot(path[path.size() - 2], node).get();
+  if (sibling) {
+    const hit_rate_t sibling_old_fraction = sibling->fraction;
+    const bool sibling_has_both_children  = sibling->on_true && sibling->on_false;
+    if ((sibling->on_true && !can_recursive_update_fractions(sibling->on_true.get(), sibling_has_both_children, sibling_old_fraction)) ||
+        (sibling->on_false && !can_recursive_update_fractions(sibling->on_false.get(), sibling_has_both_children, sibling_old_fraction))) {
       return false;
     }
   }
@@ -910,7 +926,8 @@ bool Profiler::can_set(ProfilerNode *node, hit_rate_t new_hr) const {
   return true;
 }
 
-void Profiler::set(ProfilerNode *node, hit_rate_t new_hr) {
+void Profiler::set(const profiler_path_t &path, hit_rate_t new_hr) {
+  ProfilerNode *node            = path.back();
   const hit_rate_t old_fraction = node->fraction;
   const hit_rate_t new_fraction = new_hr;
 
@@ -918,33 +935,42 @@ void Profiler::set(ProfilerNode *node, hit_rate_t new_hr) {
     return;
   }
 
-  const ProfilerNode::family_t closest_family = node->get_family();
-
-  bool changed_parent_hr        = false;
-  ProfilerNode::family_t family = closest_family;
-  while (family.parent && family.parent->fraction < new_fraction) {
-    family.parent->fraction = new_fraction;
-    family                  = family.parent->get_family();
-    changed_parent_hr       = true;
+  // Parents grow to fit the new fraction, and their siblings shrink to compensate.
+  bool changed_parent_hr = false;
+  size_t level           = path.size() - 1;
+  while (level > 0 && path[level - 1]->fraction < new_fraction) {
+    path[level - 1]->fraction = new_fraction;
+    level--;
+    changed_parent_hr = true;
   }
 
   if (changed_parent_hr) {
-    set(family.sibling, family.parent->fraction - new_fraction);
+    assert(level > 0 && "Cannot grow past the root node");
+    ProfilerNode *parent = path[level - 1];
+
+    profiler_path_t sibling_path(path.begin(), path.begin() + level);
+    sibling_path.push_back(make_exclusive(get_sibling_slot(parent, path[level])));
+
+    set(sibling_path, parent->fraction - new_fraction);
   }
 
   update_fractions(node, new_fraction);
+  recursive_update_children_fractions(node, old_fraction, new_fraction);
 
-  recursive_update_fractions(node->on_true, old_fraction, new_fraction);
-  recursive_update_fractions(node->on_false, old_fraction, new_fraction);
+  if (path.size() < 2) {
+    return;
+  }
 
-  if (closest_family.sibling) {
-    const hit_rate_t sibling_old_fraction = closest_family.sibling->fraction;
-    const hit_rate_t sibling_new_fraction = closest_family.parent->fraction - new_fraction;
+  ProfilerNode *closest_parent                = path[path.size() - 2];
+  std::shared_ptr<ProfilerNode> &sibling_slot = get_sibling_slot(closest_parent, node);
 
-    update_fractions(closest_family.sibling, sibling_new_fraction);
+  if (sibling_slot) {
+    ProfilerNode *sibling                 = make_exclusive(sibling_slot);
+    const hit_rate_t sibling_old_fraction = sibling->fraction;
+    const hit_rate_t sibling_new_fraction = closest_parent->fraction - new_fraction;
 
-    recursive_update_fractions(closest_family.sibling->on_true, sibling_old_fraction, sibling_new_fraction);
-    recursive_update_fractions(closest_family.sibling->on_false, sibling_old_fraction, sibling_new_fraction);
+    update_fractions(sibling, sibling_new_fraction);
+    recursive_update_children_fractions(sibling, sibling_old_fraction, sibling_new_fraction);
   }
 }
 
@@ -5,6 +5,7 @@
 #include <LibBDD/Reorder.h>
 #include <LibCore/Types.h>
 
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -148,29 +149,23 @@ struct ProfilerNode {
   // this "candidate_fwd_ports". It contains all the _valid_ candidate ports for a specific forwarding node on the NF.
   std::unordered_set<u16> candidate_fwd_ports;
 
-  ProfilerNode *on_true;
-  ProfilerNode *on_false;
-  ProfilerNode *prev;
+  // Subtrees are shared between copies of the same profiler and only copied when one of them writes to it (see Profiler::get_mutable_path).
+  // A node can therefore have more than one parent, so there are no back pointers: the family of a node is given by the path used to reach it.
+  std::shared_ptr<ProfilerNode> on_true;
+  std::shared_ptr<ProfilerNode> on_false;
 
   ProfilerNode(klee::ref<klee::Expr> cnstr, hit_rate_t hr);
   ProfilerNode(klee::ref<klee::Expr> cnstr, hit_rate_t hr, bdd_node_id_t node);
-  ~ProfilerNode();
 
-  ProfilerNode *clone(bool keep_bdd_info) const;
+  std::shared_ptr<ProfilerNode> clone(bool keep_bdd_info) const;
   void debug(int lvl = 0) const;
 
   flow_stats_t get_flow_stats(klee::ref<klee::Expr> flow_id) const;
-
-  struct family_t {
-    ProfilerNode *node;
-    ProfilerNode *parent;
-    ProfilerNode *grandparent;
-    ProfilerNode *sibling;
-  };
-
-  family_t get_family();
 };
 
+// Every node from the root down to (and including) the target.
+using profiler_path_t = std::vector<ProfilerNode *>;
+
 class Profiler {
 private:
   const std::shared_ptr<bdd_profile_t> bdd_profile;
@@ -198,6 +193,7 @@ public:
 
   const bdd_profile_t *get_bdd_profile() const;
   bytes_t get_avg_pkt_bytes() const;
+  const ProfilerNode *get_root() const { return root.get(); }
 
   // Estimation is relative to the parent node.
   // E.g. if the parent node has a hit rate of 0.5, and the estimation_rel is
@@ -226,6 +222,8 @@ public:
   void debug() const;
 
 private:
+  profiler_path_t get_path(const std::vector<klee::ref<klee::Expr>> &cnstrs) const;
+  profiler_path_t get_mutable_path(const std::vector<klee::ref<klee::Expr>> &cnstrs);
   ProfilerNode *get_node(const std::vector<klee::ref<klee::Expr>> &cnstrs) const;
   ProfilerNode *get_node(const EPNode *node) const;
   ProfilerNode *get_node(const BDDNode *node) const;
@@ -233,19 +231,19 @@ private:
   hit_rate_t get_hr(const std::vector<klee::ref<klee::Expr>> &cnstrs) const;
   fwd_stats_t get_fwd_stats(const std::vector<klee::ref<klee::Expr>> &cnstrs) const;
 
-  void clone_tree_if_shared();
-  void append(ProfilerNode *node, klee::ref<klee::Expr> cnstr, hit_rate_t hr);
-  void remove(ProfilerNode *node);
-  void remove_until(ProfilerNode *target, ProfilerNode *stopping_node);
+  void append(const profiler_path_t &path, klee::ref<klee::Expr> cnstr, hit_rate_t hr);
+  ProfilerNode *remove(const profiler_path_t &path);
+  void remove_until(const profiler_path_t &target, profiler_path_t stopping_path);
   void replace_root(klee::ref<klee::Expr> cnstr, hit_rate_t hr);
-  void replace_constraint(ProfilerNode *node, klee::ref<klee::Expr> cnstr);
-  bool can_set(ProfilerNode *node, hit_rate_t new_hr) const;
-  void set(ProfilerNode *node, hit_rate_t new_hr);
+  bool can_set(const profiler_path_t &path, hit_rate_t new_hr) const;
+  void set(const profiler_path_t &path, hit_rate_t new_hr);
 
-  bool can_update_fractions(ProfilerNode *node) const;
-  bool can_recursive_update_fractions(ProfilerNode *node, hit_rate_t parent_old_fraction) const;
+  bool can_update_fractions(const ProfilerNode *node) const;
+  bool can_recursive_update_fractions(const ProfilerNode *node, bool has_sibling, hit_rate_t parent_old_fraction) const;
 
-  void recursive_update_fractions(ProfilerNode *node, hit_rate_t parent_old_fraction, hit_rate_t parent_new_fraction);
+  void recursive_update_fractions(std::shared_ptr<ProfilerNode> &node, bool has_sibling, hit_rate_t parent_old_fraction,
+                                  hit_rate_t parent_new_fraction);
+  void recursive_update_children_fractions(ProfilerNode *node, hit_rate_t old_fraction, hit_rate_t new_fraction);
   void update_fractions(ProfilerNode *node, hit_rate_t new_fraction);
 };
 
@@ -54,7 +54,10 @@ struct search_config_t {
   bool not_greedy;
   bool no_deadends;
 
-  search_config_t() : no_reorder(false), pause_and_show_on_backtrack(false), not_greedy(false), no_deadends(true) {}
+  // Upper bound on the number of unfinished EPs kept by the heuristic (0 means unbounded). When exceeded, the worst scoring ones are dropped.
+  size_t max_unfinished_eps;
+
+  search_config_t() : no_reorder(false), pause_and_show_on_backtrack(false), not_greedy(false), no_deadends(true), max_unfinished_eps(0) {}
 };
 
 class SearchEngine {
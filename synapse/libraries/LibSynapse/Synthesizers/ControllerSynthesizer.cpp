@@ -547,6 +547,22 @@ code_t ControllerSynthesizer::var_t::get_slice(bits_t offset, bits_t size, trans
   return coder.dump();
 }
 
+bytes_t ControllerSynthesizer::var_t::get_memory_offset(bits_t offset, bits_t size, transpiler_opt_t opt) const {
+  assert((is_ptr || is_buffer) && "Not in memory");
+  assert(offset + size <= expr->getWidth() && "Out of bounds");
+
+  if (is_header && (opt & TRANSPILER_OPT_INVERT_HEADERS)) {
+    offset = expr->getWidth() - (offset + size);
+  }
+
+  return offset / 8;
+}
+
+code_t ControllerSynthesizer::var_t::get_memory() const {
+  assert((is_ptr || is_buffer) && "Not in memory");
+  return is_ptr ? name : name + ".data";
+}
+
 code_t ControllerSynthesizer::var_t::get_stem() const {
   size_t pos = name.find_last_of('.');
   if (pos == std::string::npos) {
@@ -620,6 +636,29 @@ std::optional<ControllerSynthesizer::var_t> ControllerSynthesizer::Stack::get(kl
   return {};
 }
 
+std::optional<ControllerSynthesizer::memory_byte_t> ControllerSynthesizer::Stack::get_memory_byte(klee::ref<klee::Expr> byte,
+                                                                                                  transpiler_opt_t opt) const {
+  assert(byte->getWidth() == 8 && "Not a byte");
+
+  for (auto var_it = frames.rbegin(); var_it != frames.rend(); var_it++) {
+    const var_t &var = *var_it;
+
+    if (!var.is_ptr && !var.is_buffer) {
+      continue;
+    }
+
+    for (bits_t offset = 0; offset + 8 <= var.expr->getWidth(); offset += 8) {
+      klee::ref<klee::Expr> var_byte = solver_toolbox.exprBuilder->Extract(var.expr, offset, 8);
+
+      if (solver_toolbox.are_exprs_always_equal(var_byte, byte)) {
+        return memory_byte_t{var, var.get_memory_offset(offset, 8, opt)};
+      }
+    }
+  }
+
+  return {};
+}
+
 std::optional<ControllerSynthesizer::var_t> ControllerSynthesizer::Stack::get_by_addr(addr_t addr) const {
   for (auto var_it = frames.rbegin(); var_it != frames.rend(); var_it++) {
     const var_t &var = *var_it;
@@ -677,6 +716,17 @@ std::optional<ControllerSynthesizer::var_t> ControllerSynthesizer::Stacks::get_b
   return {};
 }
 
+std::optional<ControllerSynthesizer::memory_byte_t> ControllerSynthesizer::Stacks::get_memory_byte(klee::ref<klee::Expr> byte,
+                                                                                                   transpiler_opt_t opt) const {
+  for (auto stack_it = stacks.rbegin(); stack_it != stacks.rend(); stack_it++) {
+    if (std::optional<memory_byte_t> memory_byte = stack_it->get_memory_byte(byte, opt)) {
+      return memory_byte;
+    }
+  }
+
+  return {};
+}
+
 void ControllerSynthesizer::Stacks::clear() { stacks.clear(); }
 
 std::vector<ControllerSynthesizer::Stack> ControllerSynthesizer::Stacks::get_all() const { return stacks; }
@@ -716,6 +766,7 @@ void ControllerSynthesizer::synthesize() {
 
   synthesize_nf_process();
   synthesize_state_member_init_list();
+  synthesize_pipeline_flow_hash();
 
   std::ofstream ofs(out_file);
   ofs << code_template.dump();
@@ -816,6 +867,81 @@ void ControllerSynthesizer::synthesize_state_member_init_list() {
   }
 }
 
+void ControllerSynthesizer::synthesize_pipeline_flow_hash() {
+  // Code paths that share a data structure must go to the same pipeline worker, which then owns it.
+  std::unordered_map<ep_node_id_t, ep_node_id_t> group;
+  std::unordered_map<code_t, ep_node_id_t> ds_group;
+
+  auto find = [&group](ep_node_id_t code_path) {
+    while (group.at(code_path) != code_path) {
+      code_path = group.at(code_path);
+    }
+    return code_path;
+  };
+
+  for (ep_node_id_t code_path : code_paths) {
+    group[code_path] = code_path;
+  }
+
+  for (ep_node_id_t code_path : code_paths) {
+    for (const code_t &ds_id : code_path_data_structures[code_path]) {
+      auto found_it = ds_group.find(ds_id);
+      if (found_it == ds_group.end()) {
+        ds_group[ds_id] = code_path;
+      } else {
+        group[find(code_path)] = find(found_it->second);
+      }
+    }
+  }
+
+  std::unordered_map<ep_node_id_t, size_t> group_index;
+  for (ep_node_id_t code_path : code_paths) {
+    group_index.insert({find(code_path), group_index.size()});
+  }
+
+  if (group_index.size() < 2) {
+    return;
+  }
+
+  coder_t &nf_init = get(MARKER_NF_INIT);
+
+  nf_init << "\n";
+  nf_init.indent();
+  nf_init << "// Code paths sharing data structures go to the same pipeline worker.\n";
+  nf_init.indent();
+  nf_init << "set_pipeline_flow_hash([](const u8 *pkt, u16 size) -> u64 {\n";
+  nf_init.inc();
+
+  nf_init.indent();
+  nf_init << "if (size < sizeof(cpu_hdr_t)) {\n";
+  nf_init.inc();
+  nf_init.indent();
+  nf_init << "return 0;\n";
+  nf_init.dec();
+  nf_init.indent();
+  nf_init << "}\n";
+
+  nf_init.indent();
+  nf_init << "switch (bswap16(reinterpret_cast<const cpu_hdr_t *>(pkt)->code_path)) {\n";
+  for (ep_node_id_t code_path : code_paths) {
+    nf_init.indent();
+    nf_init << "case " << code_path << ":\n";
+    nf_init.inc();
+    nf_init.indent();
+    nf_init << "return " << group_index.at(find(code_path)) << ";\n";
+    nf_init.dec();
+  }
+  nf_init.indent();
+  nf_init << "}\n";
+
+  nf_init.indent();
+  nf_init << "return 0;\n";
+
+  nf_init.dec();
+  nf_init.indent();
+  nf_init << "});\n";
+}
+
 void ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_node) {
   coder_t &coder = get(MARKER_NF_PROCESS);
 
@@ -887,7 +1013,9 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   coder << "(bswap16(cpu_hdr->code_path) == " << ep_node->get_id() << ") {\n";
 
   coder.inc();
+  current_code_path = code_path;
   visit(ep, next_node);
+  current_code_path.reset();
   coder.dec();
 
   coder.indent();
@@ -1086,6 +1214,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const std::optional<symbol_t> found = node->get_found();
 
   const Tofino::MapTable *map_table = get_unique_tofino_ds_from_obj<Tofino::MapTable>(ep, obj);
+  access_ds(coder, map_table->id);
 
   const var_t key_var   = transpile_buffer_decl_and_set(coder, map_table->id + "_key", key, true);
   const var_t value_var = alloc_var("value", value, {}, NO_OPTION);
@@ -1114,6 +1243,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const klee::ref<klee::Expr> value = node->get_value();
 
   const Tofino::MapTable *map_table = get_unique_tofino_ds_from_obj<Tofino::MapTable>(ep, obj);
+  access_ds(coder, map_table->id);
 
   const var_t key_var = transpile_buffer_decl_and_set(coder, map_table->id + "_key", key, true);
 
@@ -1151,6 +1281,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const std::optional<symbol_t> found = node->get_found();
 
   const Tofino::GuardedMapTable *guarded_map_table = get_unique_tofino_ds_from_obj<Tofino::GuardedMapTable>(ep, obj);
+  access_ds(coder, guarded_map_table->id);
 
   const var_t key_var   = transpile_buffer_decl_and_set(coder, guarded_map_table->id + "_key", key, true);
   const var_t value_var = alloc_var("value", value, {}, NO_OPTION);
@@ -1179,6 +1310,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   klee::ref<klee::Expr> guard_allow_condition = node->get_guard_allow_condition();
 
   const Tofino::GuardedMapTable *guarded_map_table = get_unique_tofino_ds_from_obj<Tofino::GuardedMapTable>(ep, obj);
+  access_ds(coder, guarded_map_table->id);
 
   const var_t guard_allow_var = alloc_var("guard_allow", guard_allow_symbol.expr, {}, NO_OPTION);
 
@@ -1197,6 +1329,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const klee::ref<klee::Expr> value = node->get_value();
 
   const Tofino::GuardedMapTable *guarded_map_table = get_unique_tofino_ds_from_obj<Tofino::GuardedMapTable>(ep, obj);
+  access_ds(coder, guarded_map_table->id);
 
   const var_t key_var = transpile_buffer_decl_and_set(coder, guarded_map_table->id + "_key", key, true);
 
@@ -1233,6 +1366,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const klee::ref<klee::Expr> value = node->get_value();
 
   const Tofino::VectorTable *vector_table = get_unique_tofino_ds_from_obj<Tofino::VectorTable>(ep, obj);
+  access_ds(coder, vector_table->id);
 
   var_t value_var = alloc_var("value", value, {}, IS_BUFFER);
 
@@ -1256,6 +1390,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const klee::ref<klee::Expr> value = node->get_value();
 
   const Tofino::VectorTable *vector_table = get_unique_tofino_ds_from_obj<Tofino::VectorTable>(ep, obj);
+  access_ds(coder, vector_table->id);
 
   const var_t value_var = transpile_buffer_decl_and_set(coder, vector_table->id + "_value", value, true);
 
@@ -1287,6 +1422,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const symbol_t is_allocated = node->get_is_allocated();
 
   const Tofino::DchainTable *dchain_table = get_unique_tofino_ds_from_obj<Tofino::DchainTable>(ep, obj);
+  access_ds(coder, dchain_table->id);
 
   var_t is_allocated_var = alloc_var("is_allocated", is_allocated.expr, {}, NO_OPTION);
 
@@ -1307,6 +1443,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   klee::ref<klee::Expr> index = node->get_index();
 
   const Tofino::DchainTable *dchain_table = get_unique_tofino_ds_from_obj<Tofino::DchainTable>(ep, obj);
+  access_ds(coder, dchain_table->id);
 
   coder.indent();
   coder << "state->" << dchain_table->id;
@@ -1325,6 +1462,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   klee::ref<klee::Expr> success         = node->get_success();
 
   const Tofino::DchainTable *dchain_table = get_unique_tofino_ds_from_obj<Tofino::DchainTable>(ep, obj);
+  access_ds(coder, dchain_table->id);
 
   var_t allocated_index_var = alloc_var("allocated_index", allocated_index, {}, NO_OPTION);
   var_t success_var         = alloc_var("success", success, {}, NO_OPTION);
@@ -1471,6 +1609,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const klee::ref<klee::Expr> value = node->get_value();
 
   const Tofino::VectorRegister *vector_register = get_unique_tofino_ds_from_obj<Tofino::VectorRegister>(ep, obj);
+  access_ds(coder, vector_register->id);
 
   var_t value_var = alloc_var("value", value, {}, IS_BUFFER);
 
@@ -1495,6 +1634,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const klee::ref<klee::Expr> new_value = node->get_new_value();
 
   const Tofino::VectorRegister *vector_register = get_unique_tofino_ds_from_obj<Tofino::VectorRegister>(ep, obj);
+  access_ds(coder, vector_register->id);
 
   const var_t value_var = transpile_buffer_decl_and_set(coder, vector_register->id + "_value", new_value, true);
 
@@ -1549,6 +1689,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const symbol_t &map_has_this_key  = node->get_hit();
 
   const Tofino::HHTable *hh_table = get_unique_tofino_ds_from_obj<Tofino::HHTable>(ep, obj);
+  access_ds(coder, hh_table->id);
 
   const var_t key_var   = transpile_buffer_decl_and_set(coder, hh_table->id + "_key", key, true);
   const var_t value_var = alloc_var("value", value, {}, NO_OPTION);
@@ -1710,6 +1851,7 @@ EPVisitor::Action ControllerSynthesizer::visit(const EP *ep, const EPNode *ep_no
   const klee::ref<klee::Expr> min_estimate = node->get_min_estimate();
 
   const Tofino::CountMinSketch *cms = get_unique_tofino_ds_from_obj<Tofino::CountMinSketch>(ep, obj);
+  access_ds(coder, cms->id);
 
   const var_t key_var          = transpile_buffer_decl_and_set(coder, cms->id + "_key", key, true);
   const var_t min_estimate_var = alloc_var("min_estimate", min_estimate, {}, NO_OPTION);
@@ -1833,6 +1975,17 @@ code_t ControllerSynthesizer::assert_unique_name(const code_t &name) {
   return name;
 }
 
+void ControllerSynthesizer::access_ds(coder_t &coder, const code_t &ds_id) {
+  assert(current_code_path.has_value() && "Data structure accessed outside of a code path");
+  code_path_data_structures[*current_code_path].insert(ds_id);
+
+  // Pipeline workers run without the controller lock, which the callbacks take.
+  if (data_structures_with_callbacks.find(ds_id) != data_structures_with_callbacks.end()) {
+    coder.indent();
+    coder << "lock_shared_state();\n";
+  }
+}
+
 void ControllerSynthesizer::transpile_map_table_decl(const Tofino::MapTable *map_table) {
   coder_t &state_fields = get(MARKER_STATE_FIELDS);
 
@@ -1861,6 +2014,7 @@ void ControllerSynthesizer::transpile_map_table_decl(const Tofino::MapTable *map
 
   if (time_aware) {
     member_init_list << ", " << expiration_time_ms << "LL";
+    data_structures_with_callbacks.insert(name);
   }
 
   member_init_list << ")";
@@ -1896,6 +2050,7 @@ void ControllerSynthesizer::transpile_guarded_map_table_decl(const Tofino::Guard
 
   if (time_aware) {
     member_init_list << ", " << expiration_time_ms << "LL";
+    data_structures_with_callbacks.insert(name);
   }
 
   member_init_list << ")";
@@ -1935,6 +2090,7 @@ void ControllerSynthesizer::transpile_dchain_table_decl(const Tofino::DchainTabl
   state_fields << "DchainTable " << name << ";\n";
 
   synapse_data_structures_instances.push_back(name);
+  data_structures_with_callbacks.insert(name);
 
   coder_t member_init_list;
   member_init_list << name;
@@ -1983,6 +2139,7 @@ void ControllerSynthesizer::transpile_hh_table_decl(const Tofino::HHTable *hh_ta
   state_fields << "HHTable " << name << ";\n";
 
   synapse_data_structures_instances.push_back(name);
+  data_structures_with_callbacks.insert(name);
 
   coder_t member_init_list;
   member_init_list << name;
@@ -2016,6 +2173,7 @@ void ControllerSynthesizer::transpile_cms_decl(const Tofino::CountMinSketch *cms
   state_fields << "CountMinSketch " << name << ";\n";
 
   synapse_data_structures_instances.push_back(name);
+  data_structures_with_callbacks.insert(name);
 
   coder_t member_init_list;
   member_init_list << name;
@@ -2033,9 +2191,12 @@ void ControllerSynthesizer::transpile_cms_decl(const Tofino::CountMinSketch *cms
 
 ControllerSynthesizer::var_t ControllerSynthesizer::transpile_buffer_decl_and_set(coder_t &coder, const code_t &proposed_name,
                                                                                   klee::ref<klee::Expr> expr, bool skip_alloc) {
-  std::vector<code_t> bytes;
-  for (klee::ref<klee::Expr> byte : bytes_in_expr(expr, true)) {
-    bytes.push_back(transpiler.transpile(byte));
+  const std::vector<klee::ref<klee::Expr>> bytes = bytes_in_expr(expr, true);
+
+  // Where each byte sits in memory (a packet header or another buffer), if it is just a copy of it.
+  std::vector<std::optional<memory_byte_t>> memory_bytes;
+  for (klee::ref<klee::Expr> byte : bytes) {
+    memory_bytes.push_back(is_constant(byte) ? std::nullopt : vars.get_memory_byte(byte, TRANSPILER_OPT_NO_OPTION));
   }
 
   const var_t var    = alloc_var(proposed_name, expr, {}, IS_BUFFER | (skip_alloc ? SKIP_ALLOC : NO_OPTION));
@@ -2044,9 +2205,29 @@ ControllerSynthesizer::var_t ControllerSynthesizer::transpile_buffer_decl_and_se
 
   coder.indent();
   coder << "buffer_t " << var.name << "(" << size << ");\n";
-  for (bytes_t i = 0; i < size; i++) {
+
+  // Runs of bytes copied from consecutive offsets of the same var are copied all at once, instead of byte by byte.
+  bytes_t i = 0;
+  while (i < size) {
+    const std::optional<memory_byte_t> &first = memory_bytes[i];
+
+    bytes_t run = 1;
+    while (first.has_value() && i + run < size) {
+      const std::optional<memory_byte_t> &next = memory_bytes[i + run];
+      if (!next.has_value() || next->var.name != first->var.name || next->offset != first->offset + run) {
+        break;
+      }
+      run++;
+    }
+
     coder.indent();
-    coder << var.name << "[" << i << "] = " << bytes[i] << ";\n";
+    if (run > 1) {
+      coder << "std::memcpy(" << var.name << ".data + " << i << ", " << first->var.get_memory() << " + " << first->offset << ", " << run << ");\n";
+    } else {
+      coder << var.name << "[" << i << "] = " << transpiler.transpile(bytes[i]) << ";\n";
+    }
+
+    i += run;
   }
 
   return var;
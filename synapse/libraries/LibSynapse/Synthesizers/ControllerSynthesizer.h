@@ -94,6 +94,14 @@ private:
 
     code_t get_slice(bits_t offset, bits_t size, transpiler_opt_t opt) const;
     code_t get_stem() const;
+    bytes_t get_memory_offset(bits_t offset, bits_t size, transpiler_opt_t opt) const;
+    code_t get_memory() const;
+  };
+
+  // A byte held in the memory of a pointer or buffer var, at the given byte offset.
+  struct memory_byte_t {
+    var_t var;
+    bytes_t offset;
   };
 
   class Stack {
@@ -114,6 +122,7 @@ private:
     std::optional<var_t> get(klee::ref<klee::Expr> expr, transpiler_opt_t opt) const;
     std::optional<var_t> get_by_addr(addr_t addr) const;
     std::optional<var_t> get_exact(klee::ref<klee::Expr> expr) const;
+    std::optional<memory_byte_t> get_memory_byte(klee::ref<klee::Expr> byte, transpiler_opt_t opt) const;
     std::vector<var_t> get_all() const;
   };
 
@@ -140,6 +149,7 @@ private:
     Stack squash() const;
     std::optional<var_t> get(klee::ref<klee::Expr> expr, transpiler_opt_t opt) const;
     std::optional<var_t> get_by_addr(addr_t addr) const;
+    std::optional<memory_byte_t> get_memory_byte(klee::ref<klee::Expr> byte, transpiler_opt_t opt) const;
     std::vector<Stack> get_all() const;
   };
 
@@ -152,12 +162,18 @@ private:
   std::vector<code_t> state_member_init_list;
   std::vector<ep_node_id_t> code_paths;
 
+  // Data structures touched by each code path, and those also touched by dataplane notification callbacks (or background threads).
+  std::optional<ep_node_id_t> current_code_path;
+  std::unordered_map<ep_node_id_t, std::unordered_set<code_t>> code_path_data_structures;
+  std::unordered_set<code_t> data_structures_with_callbacks;
+
   const EP *target_ep;
   Transpiler transpiler;
 
   void synthesize_nf_init();
   void synthesize_nf_process();
   void synthesize_state_member_init_list();
+  void synthesize_pipeline_flow_hash();
 
   void visit(const EP *ep, const EPNode *ep_node) override final;
   void log(const EPNode *node) const override final;
@@ -268,6 +284,7 @@ private:
   void transpile_hh_table_decl(const Tofino::HHTable *hh_table, time_ns_t expiration_time);
   void transpile_cms_decl(const Tofino::CountMinSketch *cms, time_ns_t periodic_cleanup_interval);
 
+  void access_ds(coder_t &coder, const code_t &ds_id);
   void abort_transaction(coder_t &coder);
 
   void dbg_vars() const;
@@ -43,7 +43,7 @@ void log_visualization(const SearchSpace *search_space, const std::string &fname
 SSViz::SSViz() {}
 
 SSViz::SSViz(const ss_opts_t &opts) : treeviz(opts.fpath) {
-  const std::set<ep_id_t> &ancestors = opts.highlight->get_ancestors();
+  const std::vector<ep_id_t> ancestors = opts.highlight->get_ancestors();
   highlight.insert(ancestors.begin(), ancestors.end());
   highlight.insert(opts.highlight->get_id());
 }
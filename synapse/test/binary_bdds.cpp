@@ -0,0 +1,103 @@
+// Round-trips every BDD of a directory through the binary format, checking that the BDD loaded back from it (through the mmap-based loader) is
+// the one that was written, and that its node count and id index, built on first use, agree with the original.
+
+#include <LibBDD/BDD.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <vector>
+
+using namespace LibCore;
+using namespace LibBDD;
+
+#define CHECK(condition)                                                                                                                             \
+  do {                                                                                                                                               \
+    if (!(condition)) {                                                                                                                              \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                                                                  \
+      exit(1);                                                                                                                                       \
+    }                                                                                                                                                \
+  } while (0)
+
+namespace {
+
+std::string read_file(const std::filesystem::path &fpath) {
+  std::ifstream file(fpath, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+void test_round_trip(const std::filesystem::path &bdd_file, const std::filesystem::path &tmp_dir) {
+  const std::filesystem::path text_file        = tmp_dir / "text.bdd";
+  const std::filesystem::path binary_file      = tmp_dir / "binary.bdd";
+  const std::filesystem::path binary_text_file = tmp_dir / "binary.text.bdd";
+  const std::filesystem::path rebinary_file    = tmp_dir / "binary.binary.bdd";
+
+  SymbolManager symbol_manager;
+  const BDD bdd(bdd_file, &symbol_manager);
+  bdd.serialize(text_file);
+  bdd.serialize_binary(binary_file);
+
+  CHECK(!BDD::is_binary(text_file));
+  CHECK(BDD::is_binary(binary_file));
+
+  SymbolManager loaded_symbol_manager;
+  const BDD loaded(binary_file, &loaded_symbol_manager);
+
+  // Nothing was lost on the way, and nothing changes on a second trip.
+  loaded.serialize(binary_text_file);
+  loaded.serialize_binary(rebinary_file);
+  CHECK(read_file(text_file) == read_file(binary_text_file));
+  CHECK(read_file(binary_file) == read_file(rebinary_file));
+  CHECK(loaded.hash() == bdd.hash());
+
+  // The loaded BDD starts without a node count or an id index: both are built on first use.
+  CHECK(loaded.size() == bdd.size());
+
+  bdd.get_root()->visit_nodes([&loaded](const BDDNode *node) {
+    const BDDNode *loaded_node = loaded.get_node_by_id(node->get_id());
+    CHECK(loaded_node);
+    CHECK(loaded_node->get_id() == node->get_id());
+    CHECK(loaded_node->get_type() == node->get_type());
+    CHECK(loaded.get_node_depth(node->get_id()) >= 0);
+    return BDDNodeVisitAction::Continue;
+  });
+
+  printf("%s: ok (%zu nodes)\n", bdd_file.filename().c_str(), loaded.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <bdds directory>\n", argv[0]);
+    return 1;
+  }
+
+  const std::filesystem::path tmp_dir = std::filesystem::temp_directory_path() / ("binary_bdds." + std::to_string(getpid()));
+  std::filesystem::create_directories(tmp_dir);
+
+  std::vector<std::filesystem::path> bdd_files;
+  for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(argv[1])) {
+    if (entry.path().extension() == ".bdd") {
+      bdd_files.push_back(entry.path());
+    }
+  }
+
+  std::sort(bdd_files.begin(), bdd_files.end());
+  CHECK(!bdd_files.empty());
+
+  for (const std::filesystem::path &bdd_file : bdd_files) {
+    test_round_trip(bdd_file, tmp_dir);
+  }
+
+  std::filesystem::remove_all(tmp_dir);
+
+  printf("OK\n");
+
+  return 0;
+}
\ No newline at end of file
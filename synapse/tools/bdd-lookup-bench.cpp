@@ -0,0 +1,140 @@
+#include <LibBDD/BDD.h>
+#include <LibBDD/Reorder.h>
+
+#include <chrono>
+#include <filesystem>
+#include <CLI/CLI.hpp>
+
+using namespace LibCore;
+using namespace LibBDD;
+
+namespace {
+
+size_t count_nodes(const BDD &bdd) { return bdd.get_root() ? bdd.get_root()->count_children(true) + 1 : 0; }
+
+std::vector<bdd_node_id_t> collect_ids(const BDD &bdd) {
+  std::vector<bdd_node_id_t> ids;
+  bdd.get_root()->visit_nodes([&ids](const BDDNode *node) {
+    ids.push_back(node->get_id());
+    return BDDNodeVisitAction::Continue;
+  });
+  return ids;
+}
+
+// Checks the indexed lookups and the node count of the BDD against walks of the tree, returning the number of mismatches.
+size_t check(const BDD &bdd) {
+  size_t mismatches = 0;
+
+  if (bdd.size() != count_nodes(bdd)) {
+    std::cout << "  size() = " << bdd.size() << ", but the BDD has " << count_nodes(bdd) << " nodes\n";
+    mismatches++;
+  }
+
+  for (bdd_node_id_t id : collect_ids(bdd)) {
+    const BDDNode *node = bdd.get_root()->get_node_by_id(id);
+
+    if (bdd.get_node_by_id(id) != node) {
+      std::cout << "  get_node_by_id(" << id << ") doesn't match a walk of the tree\n";
+      mismatches++;
+    }
+  }
+
+  return mismatches;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  CLI::App app{"Benchmark BDD node lookups and node counts against walks of the tree, and check that they agree, including on reordered BDDs"};
+
+  std::vector<std::filesystem::path> input_bdd_files;
+  size_t rounds;
+  size_t anchors;
+
+  app.add_option("bdds", input_bdd_files, "BDD files, or directories holding them.")->required();
+  app.add_option("--rounds", rounds, "Rounds of lookups over every node id.")->default_val(10)->check(CLI::PositiveNumber);
+  app.add_option("--anchors", anchors, "Nodes (in visiting order) to reorder from, checking every resulting BDD.")->default_val(3);
+
+  CLI11_PARSE(app, argc, argv);
+
+  std::vector<std::filesystem::path> bdd_files;
+  for (const std::filesystem::path &path : input_bdd_files) {
+    if (!std::filesystem::is_directory(path)) {
+      bdd_files.push_back(path);
+      continue;
+    }
+
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(path)) {
+      if (entry.path().extension() == ".bdd") {
+        bdd_files.push_back(entry.path());
+      }
+    }
+  }
+
+  std::sort(bdd_files.begin(), bdd_files.end());
+
+  size_t mismatches = 0;
+
+  for (const std::filesystem::path &bdd_file : bdd_files) {
+    SymbolManager symbol_manager;
+    const BDD bdd(bdd_file, &symbol_manager);
+    const std::vector<bdd_node_id_t> ids = collect_ids(bdd);
+
+    std::cout << bdd_file.string() << ": " << ids.size() << " nodes\n";
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      for (bdd_node_id_t id : ids) {
+        bdd.get_root()->get_node_by_id(id);
+      }
+    }
+    const double walk_lookups = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      for (bdd_node_id_t id : ids) {
+        bdd.get_node_by_id(id);
+      }
+    }
+    const double indexed_lookups = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      count_nodes(bdd);
+    }
+    const double walk_counts = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      bdd.size();
+    }
+    const double size_calls = seconds_since(start);
+
+    std::cout << "  Lookups: walk=" << walk_lookups << "s indexed=" << indexed_lookups << "s\n";
+    std::cout << "  Counts:  walk=" << walk_counts << "s size()=" << size_calls << "s\n";
+
+    mismatches += check(bdd);
+
+    start              = std::chrono::steady_clock::now();
+    size_t reorderings = 0;
+    for (size_t i = 0; i < std::min(anchors, ids.size()); i++) {
+      for (const reordered_bdd_t &reordered : reorder(&bdd, ids[i])) {
+        mismatches += check(*reordered.bdd);
+        reorderings++;
+      }
+    }
+
+    std::cout << "  Checked " << reorderings << " reordered BDDs in " << seconds_since(start) << "s\n";
+  }
+
+  if (mismatches > 0) {
+    std::cout << mismatches << " mismatches\n";
+    return 1;
+  }
+
+  return 0;
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <LibBDD/Visitors/PrinterDebug.h>
 #include <LibCore/Debug.h>
 
+#include <chrono>
 #include <fstream>
 #include <filesystem>
 #include <CLI/CLI.hpp>
@@ -15,13 +16,21 @@ int main(int argc, char **argv) {
   std::vector<std::filesystem::path> input_call_path_files;
   std::filesystem::path input_bdd_file;
   std::filesystem::path output_bdd_file;
+  SimplifyValidation simplify_validation;
+  bool binary{false};
 
   app.add_option("call-paths", input_call_path_files, "Call paths");
-  app.add_option("--in", input_bdd_file, "Input file for BDD deserialization.");
+  app.add_option("--in", input_bdd_file, "Input file for BDD deserialization (text or binary).");
   app.add_option("--out", output_bdd_file, "Output file for BDD serialization.");
+  app.add_option("--simplify-validation", simplify_validation, "Solver validation of new expression simplifications.")
+      ->default_val(get_simplify_validation())
+      ->transform(CLI::CheckedTransformer(str_to_simplify_validation, CLI::ignore_case));
+  app.add_flag("--binary", binary, "Serialize the BDD in the compact binary format.");
 
   CLI11_PARSE(app, argc, argv);
 
+  set_simplify_validation(simplify_validation);
+
   if (input_bdd_file.empty() && input_call_path_files.empty()) {
     std::cout << "No input files provided.\n";
     return 1;
@@ -31,10 +40,18 @@ int main(int argc, char **argv) {
 
   std::unique_ptr<BDD> bdd;
   if (input_bdd_file.empty()) {
+    auto start = std::chrono::steady_clock::now();
     call_paths_t call_paths(input_call_path_files, &manager);
-    bdd = std::make_unique<BDD>(call_paths.get_view());
+    std::cout << "Loaded " << call_paths.data.size() << " call paths in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s\n";
+
+    start = std::chrono::steady_clock::now();
+    bdd   = std::make_unique<BDD>(call_paths.get_view());
+    std::cout << "Built the BDD in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s\n";
   } else {
-    bdd = std::make_unique<BDD>(input_bdd_file, &manager);
+    auto start = std::chrono::steady_clock::now();
+    bdd        = std::make_unique<BDD>(input_bdd_file, &manager);
+    std::cout << "Loaded the BDD in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s\n";
   }
 
   const BDD::inspection_report_t bdd_inspection_report = bdd->inspect();
@@ -45,7 +62,11 @@ int main(int argc, char **argv) {
   }
 
   if (!output_bdd_file.empty()) {
-    bdd->serialize(output_bdd_file);
+    if (binary) {
+      bdd->serialize_binary(output_bdd_file);
+    } else {
+      bdd->serialize(output_bdd_file);
+    }
   }
 
   std::cout << "BDD size: " << bdd->size() << "\n";
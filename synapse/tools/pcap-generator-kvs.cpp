@@ -160,6 +160,9 @@ int main(int argc, char *argv[]) {
   app.add_option("--zipf-param", config.zipf_param, "Zipf parameter.")->default_val(TrafficGenerator::DEFAULT_ZIPF_PARAM);
   app.add_option("--devs", config.devices, "Devices.")->required();
   app.add_option("--seed", config.random_seed, "Random seed.")->default_val(std::random_device()());
+  app.add_option("--threads", config.threads, "Threads drawing flows ahead of the packet writer (above 1, the seed gives other flows).")
+      ->default_val(TrafficGenerator::DEFAULT_THREADS)
+      ->check(CLI::PositiveNumber);
   app.add_option("--get-ratio", get_ratio, "Ratio of GET/PUT requests.");
   app.add_flag("--dry-run", config.dry_run, "Print out the configuration values without generating the pcaps.")->default_val(false);
 
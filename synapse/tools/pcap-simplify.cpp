@@ -57,9 +57,7 @@ int main(int argc, char *argv[]) {
 
   PcapWriter filtered_writer(filtered_pcap_file.c_str(), true);
 
-  u64 total_pkts = pcap_reader.get_total_pkts();
-  u64 pkt_count  = 0;
-  int progress   = -1;
+  int progress = -1;
 
   const u8 *pkt;
   u16 hdrs_len;
@@ -68,9 +66,7 @@ int main(int argc, char *argv[]) {
   std::optional<flow_t> flow;
 
   while (pcap_reader.read(pkt, hdrs_len, sz, ts, flow)) {
-    pkt_count++;
-
-    int current_progress = 100.0 * pkt_count / total_pkts;
+    int current_progress = 100.0 * pcap_reader.get_progress();
 
     if (current_progress > progress) {
       progress = current_progress;
@@ -36,9 +36,7 @@ int main(int argc, char *argv[]) {
   std::unordered_set<flow_t, flow_t::flow_hash_t> lan_flows;
   std::unordered_set<flow_t, flow_t::flow_hash_t> wan_flows;
 
-  u64 total_pkts = pcap_reader.get_total_pkts();
-  u64 pkt_count  = 0;
-  int progress   = -1;
+  int progress = -1;
 
   const u8 *pkt;
   u16 hdrs_len;
@@ -47,9 +45,7 @@ int main(int argc, char *argv[]) {
   std::optional<flow_t> flow;
 
   while (pcap_reader.read(pkt, hdrs_len, sz, ts, flow)) {
-    pkt_count++;
-
-    int current_progress = 100.0 * pkt_count / total_pkts;
+    int current_progress = 100.0 * pcap_reader.get_progress();
 
     if (current_progress > progress) {
       progress = current_progress;
@@ -1,8 +1,13 @@
 #include <LibCore/Pcap.h>
+#include <LibCore/Sketches.h>
+#include <LibCore/ThreadPool.h>
 
 #include <unordered_set>
 #include <unordered_map>
 #include <map>
+#include <list>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <optional>
 #include <time.h>
@@ -16,6 +21,13 @@ using json = nlohmann::json;
 using namespace LibCore;
 
 constexpr const time_ns_t EPOCH_DURATION_NS{1'000'000'000}; // 1 second
+constexpr const size_t DEFAULT_MEMORY_MB{1024};
+
+constexpr const u8 FLOWS_HLL_PRECISION{14};
+constexpr const u8 EPOCH_FLOWS_HLL_PRECISION{12};
+
+// Workers publish how far they got every so many packets.
+constexpr const u64 PROGRESS_PKTS_PERIOD{65'536};
 
 class Clock {
 private:
@@ -106,29 +118,59 @@ public:
   }
 };
 
-struct flow_ts {
+// Only what the report needs: gaps between packets are only ever averaged, so there is no need to keep them around.
+struct flow_stats_t {
   time_ns_t first;
   time_ns_t last;
-  std::vector<time_ns_t> dts;
+  u64 pkts;
+  u64 bytes;
+  time_us_t dts_us_sum;
+
+  flow_stats_t(time_ns_t ts, u16 sz) : first(ts), last(ts), pkts(1), bytes(sz), dts_us_sum(0) {}
+
+  void update(time_ns_t ts, u16 sz) {
+    dts_us_sum += (ts - last) / THOUSAND;
+    last = ts;
+    pkts++;
+    bytes += sz;
+  }
+
+  // Appends the stats of a later part of the same flow.
+  void append(const flow_stats_t &later) {
+    dts_us_sum += (later.first - last) / THOUSAND + later.dts_us_sum;
+    last = later.last;
+    pkts += later.pkts;
+    bytes += later.bytes;
+  }
 };
 
-struct report_t {
+// The CDFs are either exact (CDF) or sketched (LogHistogram).
+template <typename CDF_T> struct report_t {
   time_ns_t start;
   time_ns_t end;
   u64 total_pkts;
   u64 tcpudp_pkts;
-  CDF pkt_sizes_cdf;
+  CDF_T pkt_sizes_cdf;
   u64 total_flows;
   u64 total_symm_flows;
-  CDF concurrent_flows_per_epoch;
-  CDF pkts_per_flow_cdf;
-  CDF top_k_flows_cdf;
-  CDF top_k_flows_bytes_cdf;
-  CDF flow_duration_us_cdf;
-  CDF flow_dts_us_cdf;
+  CDF_T concurrent_flows_per_epoch;
+  CDF_T pkts_per_flow_cdf;
+  CDF_T top_k_flows_cdf;
+  CDF_T top_k_flows_bytes_cdf;
+  CDF_T flow_duration_us_cdf;
+  CDF_T flow_dts_us_cdf;
 };
 
-void dump_report(const std::filesystem::path &output_report, const report_t &report) {
+template <typename CDF_T> void add_flow_to_report(report_t<CDF_T> &report, const flow_stats_t &stats) {
+  report.pkts_per_flow_cdf.add(stats.pkts);
+  report.flow_duration_us_cdf.add((stats.last - stats.first) / THOUSAND);
+
+  if (stats.pkts > 1) {
+    report.flow_dts_us_cdf.add(stats.dts_us_sum / (double)(stats.pkts - 1));
+  }
+}
+
+template <typename CDF_T> void dump_report(const std::filesystem::path &output_report, const report_t<CDF_T> &report) {
   json j;
   j["start_utc_ns"]                   = report.start;
   j["end_utc_ns"]                     = report.end;
@@ -194,7 +236,7 @@ void dump_report(const std::filesystem::path &output_report, const report_t &rep
   out << j.dump(2) << std::endl;
 }
 
-void print_report(const report_t &report) {
+template <typename CDF_T> void print_report(const report_t<CDF_T> &report) {
   printf("###################### PCAP Stats ######################\n");
   printf("Start:                    %s\n", fmt_time_hh(report.start).c_str());
   printf("End:                      %s\n", fmt_time_hh(report.end).c_str());
@@ -236,41 +278,28 @@ void print_report(const report_t &report) {
   }
 }
 
-int main(int argc, char *argv[]) {
-  CLI::App app{"Pcap stats"};
-
-  std::filesystem::path pcap_file;
-  std::filesystem::path output_report;
-
-  app.add_option("pcap", pcap_file, "Pcap file.")->required();
-  app.add_option("--out", output_report, "Output report JSON file.");
-
-  CLI11_PARSE(app, argc, argv);
+template <typename CDF_T> void output_report(const report_t<CDF_T> &report, const std::filesystem::path &output_report_file) {
+  print_report(report);
 
-  if (!std::filesystem::exists(pcap_file)) {
-    fprintf(stderr, "File %s not found\n", pcap_file.c_str());
-    exit(1);
+  if (!output_report_file.empty()) {
+    dump_report(output_report_file, report);
   }
+}
 
+report_t<CDF> build_exact_report(const std::filesystem::path &pcap_file) {
   PcapReader pcap_reader(pcap_file);
 
   Clock clock(EPOCH_DURATION_NS);
-  std::unordered_set<flow_t, flow_t::flow_hash_t> flows;
+  std::unordered_map<flow_t, flow_stats_t, flow_t::flow_hash_t> flows;
   std::unordered_set<sflow_t, sflow_t::flow_hash_t> symm_flows;
   std::vector<std::unordered_set<flow_t, flow_t::flow_hash_t>> concurrent_flows_per_epoch;
 
-  std::unordered_map<flow_t, u64, sflow_t::flow_hash_t> pkts_per_flow;
-  std::unordered_map<flow_t, u64, sflow_t::flow_hash_t> bytes_per_flow;
-  std::unordered_map<flow_t, flow_ts, sflow_t::flow_hash_t> flow_times;
+  report_t<CDF> report;
 
-  report_t report;
-
-  report.total_pkts  = pcap_reader.get_total_pkts();
   report.tcpudp_pkts = 0;
   concurrent_flows_per_epoch.emplace_back();
 
-  u64 pkt_count = 0;
-  int progress  = -1;
+  int progress = -1;
 
   const u8 *pkt;
   u16 hdrs_len;
@@ -279,9 +308,7 @@ int main(int argc, char *argv[]) {
   std::optional<flow_t> flow;
 
   while (pcap_reader.read(pkt, hdrs_len, sz, ts, flow)) {
-    pkt_count++;
-
-    int current_progress = 100.0 * pkt_count / report.total_pkts;
+    int current_progress = 100.0 * pcap_reader.get_progress();
 
     if (current_progress > progress) {
       progress = current_progress;
@@ -300,28 +327,18 @@ int main(int argc, char *argv[]) {
     }
 
     report.tcpudp_pkts++;
-    flows.insert(flow.value());
     symm_flows.insert(flow.value());
     concurrent_flows_per_epoch.back().insert(flow.value());
-    pkts_per_flow[flow.value()]++;
-    bytes_per_flow[flow.value()] += sz;
-
-    auto flow_times_it = flow_times.find(flow.value());
 
-    if (flow_times_it == flow_times.end()) {
-      flow_times[flow.value()] = {
-          .first = ts,
-          .last  = ts,
-          .dts   = {},
-      };
+    auto flows_it = flows.find(flow.value());
+    if (flows_it == flows.end()) {
+      flows.emplace(flow.value(), flow_stats_t(ts, sz));
     } else {
-      flow_ts &fts       = flow_times_it->second;
-      const time_ns_t dt = ts - fts.last;
-      fts.last           = ts;
-      fts.dts.push_back(dt);
+      flows_it->second.update(ts, sz);
     }
   }
 
+  report.total_pkts       = pcap_reader.get_total_pkts();
   report.start            = pcap_reader.get_start();
   report.end              = pcap_reader.get_end();
   report.total_flows      = flows.size();
@@ -334,17 +351,12 @@ int main(int argc, char *argv[]) {
   std::vector<u64> pkts_per_flow_values;
   std::vector<u64> bytes_per_flow_values;
 
-  for (const auto &[flow, pkts] : pkts_per_flow) {
-    report.pkts_per_flow_cdf.add(pkts);
-    pkts_per_flow_values.push_back(pkts);
+  for (const auto &[flow, stats] : flows) {
+    add_flow_to_report(report, stats);
+    pkts_per_flow_values.push_back(stats.pkts);
+    bytes_per_flow_values.push_back(stats.bytes);
   }
 
-  for (const auto &[flow, bytes] : bytes_per_flow) {
-    bytes_per_flow_values.push_back(bytes);
-  }
-
-  assert(pkts_per_flow_values.size() == bytes_per_flow_values.size());
-
   std::sort(pkts_per_flow_values.begin(), pkts_per_flow_values.end(), std::greater<u64>());
   std::sort(bytes_per_flow_values.begin(), bytes_per_flow_values.end(), std::greater<u64>());
 
@@ -353,24 +365,425 @@ int main(int argc, char *argv[]) {
     report.top_k_flows_bytes_cdf.add(i + 1, bytes_per_flow_values[i]);
   }
 
-  for (const auto &[flow, ts] : flow_times) {
-    report.flow_duration_us_cdf.add((ts.last - ts.first) / THOUSAND);
+  return report;
+}
 
-    if (ts.dts.empty()) {
-      continue;
+// Folds any number of bytes into a hash, a word at a time.
+u64 mix_bytes(u64 hash, const u8 *bytes, size_t size) {
+  for (size_t i = 0; i < size; i += sizeof(u64)) {
+    u64 word = 0;
+    std::memcpy(&word, bytes + i, std::min(sizeof(u64), size - i));
+    hash = mix64(hash ^ word);
+  }
+  return hash;
+}
+
+// flow_t::flow_hash_t XORs the fields together, which is fine for a hash table but not for a distinct counter (a flow and its inverse collide).
+u64 hash_flow(const flow_t &flow) {
+  switch (flow.type) {
+  case FlowType::FiveTuple: {
+    const u64 addrs = (static_cast<u64>(flow.five_tuple.src_ip) << 32) | flow.five_tuple.dst_ip;
+    const u64 ports = (static_cast<u64>(flow.five_tuple.src_port) << 16) | flow.five_tuple.dst_port;
+    return mix64(addrs ^ mix64(ports));
+  }
+  case FlowType::KV: {
+    const u64 hash = mix_bytes(mix64(static_cast<u64>(FlowType::KV)), flow.kv.key.data(), sizeof(flow.kv.key));
+    return mix_bytes(hash, flow.kv.value.data(), sizeof(flow.kv.value));
+  }
+  }
+
+  return 0;
+}
+
+// Same notion of symmetric flow as sflow_t.
+u64 hash_symm_flow(const flow_t &flow) {
+  const u64 src = (static_cast<u64>(flow.five_tuple.src_ip) << 16) | flow.five_tuple.src_port;
+  const u64 dst = (static_cast<u64>(flow.five_tuple.dst_ip) << 16) | flow.five_tuple.dst_port;
+  return mix64(std::min(src, dst) ^ mix64(std::max(src, dst)));
+}
+
+struct flow_mix_hash_t {
+  std::size_t operator()(const flow_t &flow) const { return hash_flow(flow); }
+};
+
+// Stats of up to capacity flows. When full, the least recently updated flow is evicted and accounted for right away; should it show up again, it
+// starts over as a new flow, as it would on a flow exporter.
+class FlowTable {
+private:
+  using entry_t = std::pair<flow_t, flow_stats_t>;
+
+  size_t capacity;
+  // From the least to the most recently updated.
+  std::list<entry_t> lru;
+  std::unordered_map<flow_t, std::list<entry_t>::iterator, flow_mix_hash_t> index;
+
+public:
+  // List node, hash table node and bucket.
+  static constexpr const size_t ENTRY_BYTES = sizeof(entry_t) + sizeof(flow_t) + 6 * sizeof(void *);
+
+  FlowTable(size_t _capacity) : capacity(std::max<size_t>(_capacity, 1)) {}
+
+  size_t get_capacity() const { return capacity; }
+  void set_capacity(size_t _capacity) { capacity = std::max<size_t>(_capacity, 1); }
+
+  const std::list<entry_t> &get_entries() const { return lru; }
+
+  // Returns true if the flow was not in the table.
+  template <typename Evict> bool update(const flow_t &flow, time_ns_t ts, u16 sz, Evict &&evict) {
+    auto found_it = index.find(flow);
+
+    if (found_it == index.end()) {
+      insert(flow, flow_stats_t(ts, sz), evict);
+      return true;
+    }
+
+    found_it->second->second.update(ts, sz);
+    lru.splice(lru.end(), lru, found_it->second);
+
+    return false;
+  }
+
+  template <typename Evict> void append(const flow_t &flow, const flow_stats_t &later, Evict &&evict) {
+    auto found_it = index.find(flow);
+
+    if (found_it == index.end()) {
+      insert(flow, later, evict);
+      return;
     }
 
-    time_us_t dt_sum = 0;
-    for (const auto &dt : ts.dts) {
-      dt_sum += dt / THOUSAND;
+    found_it->second->second.append(later);
+    lru.splice(lru.end(), lru, found_it->second);
+  }
+
+private:
+  template <typename Evict> void insert(const flow_t &flow, const flow_stats_t &stats, Evict &&evict) {
+    while (index.size() >= capacity) {
+      const entry_t &oldest = lru.front();
+      evict(oldest.first, oldest.second);
+      index.erase(oldest.first);
+      lru.pop_front();
     }
-    report.flow_dts_us_cdf.add(dt_sum / (double)ts.dts.size());
+
+    lru.emplace_back(flow, stats);
+    index.emplace(flow, std::prev(lru.end()));
   }
+};
 
-  print_report(report);
+using TopK = SpaceSaving<flow_t, flow_mix_hash_t>;
+
+// Counter and hash table node.
+constexpr const size_t TOP_K_ENTRY_BYTES = sizeof(TopK::counter_t) + sizeof(flow_t) + 4 * sizeof(void *);
+
+// The top counted flows are known one by one. The rest is only known as a whole, so it is assumed to be spread evenly over the remaining flows.
+LogHistogram build_top_k_cdf(const std::vector<TopK::counter_t> &top, u64 total, u64 total_flows) {
+  LogHistogram cdf;
+
+  u64 accounted = 0;
+  u64 k         = 0;
+
+  for (const TopK::counter_t &counter : top) {
+    const u64 count = std::min(counter.count, total - accounted);
+    cdf.add(++k, count);
+    accounted += count;
+  }
+
+  if (total_flows > k && accounted < total) {
+    const u64 tail_flows = total_flows - k;
+    const u64 remaining  = total - accounted;
+
+    for (u64 i = 0; i < tail_flows; i++) {
+      cdf.add(k + i + 1, remaining / tail_flows + (i < remaining % tail_flows ? 1 : 0));
+    }
+  }
+
+  return cdf;
+}
+
+struct epoch_t {
+  i64 index;
+  HyperLogLog flows;
+};
+
+// Bounded-memory summary of a range of the trace. Summaries of consecutive ranges are merged in trace order.
+class TraceSketch {
+private:
+  report_t<LogHistogram> report;
+  u64 tcpudp_bytes;
+
+  HyperLogLog flows;
+  HyperLogLog symm_flows;
+
+  // Epochs may straddle ranges, so both the first and the current one are kept open until merged with the neighbouring ranges.
+  std::vector<epoch_t> open_epochs;
+
+  FlowTable flow_table;
+  TopK top_k_pkts;
+  TopK top_k_bytes;
+
+public:
+  TraceSketch(size_t flow_table_capacity, size_t top_k_capacity)
+      : tcpudp_bytes(0), flows(FLOWS_HLL_PRECISION), symm_flows(FLOWS_HLL_PRECISION), flow_table(flow_table_capacity),
+        top_k_pkts(top_k_capacity), top_k_bytes(top_k_capacity) {
+    report.start       = 0;
+    report.end         = 0;
+    report.total_pkts  = 0;
+    report.tcpudp_pkts = 0;
+  }
+
+  void add_packet(u16 sz, time_ns_t ts, const std::optional<flow_t> &flow, i64 epoch) {
+    report.pkt_sizes_cdf.add(sz);
+
+    if (!flow.has_value()) {
+      return;
+    }
+
+    report.tcpudp_pkts++;
+    tcpudp_bytes += sz;
+
+    const u64 hash = hash_flow(flow.value());
+    add_to_epoch(epoch, hash);
+
+    // Flows already in the table were already counted.
+    if (flow_table.update(flow.value(), ts, sz, [this](const flow_t &f, const flow_stats_t &stats) { account_flow(f, stats); })) {
+      flows.add_hash(hash);
+      symm_flows.add_hash(hash_symm_flow(flow.value()));
+    }
+  }
+
+  void set_range_stats(time_ns_t start, time_ns_t end, u64 total_pkts) {
+    report.start      = start;
+    report.end        = end;
+    report.total_pkts = total_pkts;
+  }
+
+  void merge(TraceSketch &&later) {
+    if (later.report.total_pkts > 0) {
+      if (report.total_pkts == 0) {
+        report.start = later.report.start;
+      }
+      report.end = later.report.end;
+    }
+
+    report.total_pkts += later.report.total_pkts;
+    report.tcpudp_pkts += later.report.tcpudp_pkts;
+    tcpudp_bytes += later.tcpudp_bytes;
+
+    report.pkt_sizes_cdf.merge(later.report.pkt_sizes_cdf);
+    report.concurrent_flows_per_epoch.merge(later.report.concurrent_flows_per_epoch);
+    report.pkts_per_flow_cdf.merge(later.report.pkts_per_flow_cdf);
+    report.flow_duration_us_cdf.merge(later.report.flow_duration_us_cdf);
+    report.flow_dts_us_cdf.merge(later.report.flow_dts_us_cdf);
+
+    flows.merge(later.flows);
+    symm_flows.merge(later.symm_flows);
+
+    std::vector<epoch_t> epochs = std::move(open_epochs);
+    for (epoch_t &epoch : later.open_epochs) {
+      if (!epochs.empty() && epochs.back().index == epoch.index) {
+        epochs.back().flows.merge(epoch.flows);
+      } else {
+        epochs.push_back(std::move(epoch));
+      }
+    }
+
+    open_epochs.clear();
+    for (size_t i = 0; i < epochs.size(); i++) {
+      if (i == 0 || i + 1 == epochs.size()) {
+        open_epochs.push_back(std::move(epochs[i]));
+      } else {
+        report.concurrent_flows_per_epoch.add(epochs[i].flows.estimate());
+      }
+    }
+
+    top_k_pkts.merge(later.top_k_pkts);
+    top_k_bytes.merge(later.top_k_bytes);
+
+    // Flows still open at the end of this range go on into the later one.
+    flow_table.set_capacity(flow_table.get_capacity() + later.flow_table.get_capacity());
+    for (const auto &[flow, stats] : later.flow_table.get_entries()) {
+      flow_table.append(flow, stats, [this](const flow_t &f, const flow_stats_t &s) { account_flow(f, s); });
+    }
+  }
+
+  report_t<LogHistogram> finish() {
+    for (const epoch_t &epoch : open_epochs) {
+      report.concurrent_flows_per_epoch.add(epoch.flows.estimate());
+    }
+    open_epochs.clear();
+
+    for (const auto &[flow, stats] : flow_table.get_entries()) {
+      account_flow(flow, stats);
+    }
+
+    const std::vector<TopK::counter_t> top_pkts  = top_k_pkts.get_top();
+    const std::vector<TopK::counter_t> top_bytes = top_k_bytes.get_top();
+
+    report.total_flows           = std::max<u64>(flows.estimate(), top_pkts.size());
+    report.total_symm_flows      = symm_flows.estimate();
+    report.top_k_flows_cdf       = build_top_k_cdf(top_pkts, report.tcpudp_pkts, report.total_flows);
+    report.top_k_flows_bytes_cdf = build_top_k_cdf(top_bytes, tcpudp_bytes, report.total_flows);
+
+    return report;
+  }
+
+private:
+  void add_to_epoch(i64 epoch, u64 hash) {
+    if (open_epochs.empty() || open_epochs.back().index != epoch) {
+      // The first epoch of the range stays open.
+      if (open_epochs.size() == 2) {
+        report.concurrent_flows_per_epoch.add(open_epochs.back().flows.estimate());
+        open_epochs.pop_back();
+      }
+
+      open_epochs.push_back({epoch, HyperLogLog(EPOCH_FLOWS_HLL_PRECISION)});
+    }
+
+    open_epochs.back().flows.add_hash(hash);
+  }
+
+  void account_flow(const flow_t &flow, const flow_stats_t &stats) {
+    add_flow_to_report(report, stats);
+    top_k_pkts.add(flow, stats.pkts);
+    top_k_bytes.add(flow, stats.bytes);
+  }
+};
+
+// Returns nothing if the range turns out not to end on a record boundary.
+std::optional<TraceSketch> sketch_range(const std::filesystem::path &pcap_file, size_t begin, size_t end, bool last, time_ns_t trace_start,
+                                        size_t flow_table_capacity, size_t top_k_capacity, std::atomic<u64> &read_bytes) {
+  PcapReader pcap_reader(pcap_file);
+  pcap_reader.set_range(begin, end);
+
+  TraceSketch sketch(flow_table_capacity, top_k_capacity);
+
+  const u8 *pkt;
+  u16 hdrs_len;
+  u16 sz;
+  time_ns_t ts;
+  std::optional<flow_t> flow;
+
+  size_t reported_offset = begin;
+
+  while (pcap_reader.read(pkt, hdrs_len, sz, ts, flow)) {
+    sketch.add_packet(sz, ts, flow, (ts - trace_start) / EPOCH_DURATION_NS);
+
+    if (pcap_reader.get_total_pkts() % PROGRESS_PKTS_PERIOD == 0) {
+      read_bytes += pcap_reader.get_offset() - reported_offset;
+      reported_offset = pcap_reader.get_offset();
+    }
+  }
+
+  read_bytes += pcap_reader.get_offset() - reported_offset;
+
+  // Only the last range may end early (on a truncated record). Any other range not ending right where the next one begins was split at a bogus
+  // record boundary.
+  if (!last && pcap_reader.get_offset() != end) {
+    fprintf(stderr, "\nRange [%zu, %zu) of %s ended at %zu, not on a record boundary\n", begin, end, pcap_file.c_str(), pcap_reader.get_offset());
+    return std::nullopt;
+  }
+
+  sketch.set_range_stats(pcap_reader.get_start(), pcap_reader.get_end(), pcap_reader.get_total_pkts());
+
+  return sketch;
+}
+
+report_t<LogHistogram> build_sketched_report(const std::filesystem::path &pcap_file, size_t threads, size_t memory_bytes) {
+  PcapReader pcap_reader(pcap_file);
+
+  // Epochs are counted from the first packet of the whole trace, whichever range the packets are in.
+  time_ns_t trace_start = 0;
+  {
+    const u8 *pkt;
+    u16 hdrs_len;
+    u16 sz;
+    std::optional<flow_t> flow;
+    pcap_reader.read(pkt, hdrs_len, sz, trace_start, flow);
+  }
+
+  std::vector<size_t> boundaries = pcap_reader.find_record_boundaries(threads);
+
+  while (true) {
+    const size_t ranges = boundaries.size() - 1;
+
+    // Three quarters of the budget go to the flow tables, the rest to the top-k counters.
+    const size_t range_memory_bytes  = memory_bytes / ranges;
+    const size_t flow_table_capacity = range_memory_bytes / 4 * 3 / FlowTable::ENTRY_BYTES;
+    const size_t top_k_capacity      = range_memory_bytes / 8 / TOP_K_ENTRY_BYTES;
+
+    std::atomic<u64> read_bytes{0};
+    const u64 total_bytes = boundaries.back() - boundaries.front();
+
+    std::vector<std::future<std::optional<TraceSketch>>> sketches;
+    ThreadPool pool(ranges);
+
+    for (size_t i = 0; i < ranges; i++) {
+      sketches.push_back(pool.submit([&, i]() {
+        return sketch_range(pcap_file, boundaries[i], boundaries[i + 1], i + 1 == ranges, trace_start, flow_table_capacity, top_k_capacity,
+                            read_bytes);
+      }));
+    }
+
+    for (std::future<std::optional<TraceSketch>> &sketch : sketches) {
+      while (sketch.wait_for(std::chrono::milliseconds(200)) != std::future_status::ready) {
+        fprintf(stderr, "\r[Progress %3d%%]", total_bytes == 0 ? 100 : (int)(100.0 * read_bytes / total_bytes));
+        fflush(stderr);
+      }
+    }
+
+    fprintf(stderr, "\r[Progress %3d%%]\n", 100);
+
+    std::optional<TraceSketch> trace_sketch = sketches[0].get();
+    for (size_t i = 1; i < ranges; i++) {
+      std::optional<TraceSketch> range_sketch = sketches[i].get();
+      if (trace_sketch && range_sketch) {
+        trace_sketch->merge(std::move(*range_sketch));
+      } else {
+        trace_sketch.reset();
+      }
+    }
+
+    if (trace_sketch) {
+      return trace_sketch->finish();
+    }
+
+    // Some split point was not a record boundary after all (a packet happened to look like a record header). A single range starts at a known
+    // boundary, so it always works.
+    assert_or_panic(ranges > 1, "Failed to read %s as a single range", pcap_file.c_str());
+    fprintf(stderr, "Failed to split %s into records, starting over on a single thread\n", pcap_file.c_str());
+    boundaries = {boundaries.front(), boundaries.back()};
+  }
+}
+
+int main(int argc, char *argv[]) {
+  CLI::App app{"Pcap stats"};
+
+  std::filesystem::path pcap_file;
+  std::filesystem::path output_report_file;
+  size_t threads;
+  size_t memory_mb;
+  bool exact = false;
+
+  app.add_option("pcap", pcap_file, "Pcap file.")->required();
+  app.add_option("--out", output_report_file, "Output report JSON file.");
+  app.add_option("--threads", threads, "Threads, each reading its own part of the trace.")
+      ->default_val(ThreadPool::hardware_concurrency())
+      ->check(CLI::PositiveNumber);
+  app.add_option("--memory", memory_mb, "Memory for per-flow state (MiB). Past it, the least recently seen flows are accounted for early.")
+      ->default_val(DEFAULT_MEMORY_MB)
+      ->check(CLI::PositiveNumber);
+  app.add_flag("--exact", exact, "Exact stats, on a single thread and with unbounded memory. Only meant for small traces.");
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (!std::filesystem::exists(pcap_file)) {
+    fprintf(stderr, "File %s not found\n", pcap_file.c_str());
+    exit(1);
+  }
 
-  if (!output_report.empty()) {
-    dump_report(output_report, report);
+  if (exact) {
+    output_report(build_exact_report(pcap_file), output_report_file);
+  } else {
+    output_report(build_sketched_report(pcap_file, threads, memory_mb * 1024 * 1024), output_report_file);
   }
 
   return 0;
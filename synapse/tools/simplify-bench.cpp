@@ -0,0 +1,129 @@
+#include <LibBDD/BDD.h>
+#include <LibCore/Expr.h>
+
+#include <chrono>
+#include <filesystem>
+#include <CLI/CLI.hpp>
+
+using namespace LibCore;
+using namespace LibBDD;
+
+namespace {
+
+std::vector<klee::ref<klee::Expr>> collect_exprs(const BDD &bdd) {
+  std::vector<klee::ref<klee::Expr>> exprs;
+
+  auto add = [&exprs](klee::ref<klee::Expr> expr) {
+    if (!expr.isNull()) {
+      exprs.push_back(expr);
+    }
+  };
+
+  bdd.get_root()->visit_nodes([&add](const BDDNode *node) {
+    switch (node->get_type()) {
+    case BDDNodeType::Branch: {
+      const Branch *branch = dynamic_cast<const Branch *>(node);
+      add(branch->get_condition());
+    } break;
+    case BDDNodeType::Call: {
+      const Call *call_node = dynamic_cast<const Call *>(node);
+      const call_t &call    = call_node->get_call();
+      for (const auto &[_, arg] : call.args) {
+        add(arg.expr);
+        add(arg.in);
+        add(arg.out);
+      }
+      for (const auto &[_, extra_var] : call.extra_vars) {
+        add(extra_var.first);
+        add(extra_var.second);
+      }
+      add(call.ret);
+    } break;
+    case BDDNodeType::Route:
+      break;
+    }
+    return BDDNodeVisitAction::Continue;
+  });
+
+  return exprs;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  CLI::App app{"Benchmark expression simplification over the expressions of a set of BDDs"};
+
+  std::vector<std::filesystem::path> input_bdd_files;
+  size_t rounds;
+  SimplifyValidation validation;
+
+  app.add_option("bdds", input_bdd_files, "BDD files, or directories holding them.")->required();
+  app.add_option("--rounds", rounds, "Rounds over all expressions. Only the first one starts with an empty memo table.")
+      ->default_val(3)
+      ->check(CLI::PositiveNumber);
+  app.add_option("--validation", validation, "Solver validation of new simplifications.")
+      ->default_val(get_simplify_validation())
+      ->transform(CLI::CheckedTransformer(str_to_simplify_validation, CLI::ignore_case));
+
+  CLI11_PARSE(app, argc, argv);
+
+  set_simplify_validation(validation);
+
+  std::vector<std::filesystem::path> bdd_files;
+  for (const std::filesystem::path &path : input_bdd_files) {
+    if (!std::filesystem::is_directory(path)) {
+      bdd_files.push_back(path);
+      continue;
+    }
+
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(path)) {
+      if (entry.path().extension() == ".bdd") {
+        bdd_files.push_back(entry.path());
+      }
+    }
+  }
+
+  std::sort(bdd_files.begin(), bdd_files.end());
+
+  // Every BDD gets its own symbol manager, as symbol names repeat across NFs.
+  std::vector<std::unique_ptr<SymbolManager>> managers;
+  std::vector<std::unique_ptr<BDD>> bdds;
+  std::vector<klee::ref<klee::Expr>> exprs;
+
+  for (const std::filesystem::path &bdd_file : bdd_files) {
+    managers.push_back(std::make_unique<SymbolManager>());
+    bdds.push_back(std::make_unique<BDD>(bdd_file, managers.back().get()));
+
+    const std::vector<klee::ref<klee::Expr>> bdd_exprs = collect_exprs(*bdds.back());
+    exprs.insert(exprs.end(), bdd_exprs.begin(), bdd_exprs.end());
+
+    std::cout << bdd_file.string() << ": " << bdd_exprs.size() << " expressions\n";
+  }
+
+  std::cout << "Total: " << exprs.size() << " expressions from " << bdd_files.size() << " BDDs\n";
+
+  clear_simplify_memo();
+
+  for (size_t round = 0; round < rounds; round++) {
+    const simplify_stats_t before = get_simplify_stats();
+    const auto start              = std::chrono::steady_clock::now();
+
+    for (klee::ref<klee::Expr> expr : exprs) {
+      simplify(expr);
+      if (is_conditional(expr)) {
+        simplify_conditional(expr);
+      }
+    }
+
+    const double elapsed         = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const simplify_stats_t after = get_simplify_stats();
+
+    std::cout << "Round " << round << ": " << elapsed << "s";
+    std::cout << " calls=" << after.calls - before.calls;
+    std::cout << " memo_hits=" << after.memo_hits - before.memo_hits;
+    std::cout << " validations=" << after.validations - before.validations;
+    std::cout << "\n";
+  }
+
+  return 0;
+}
@@ -6,8 +6,14 @@
 #include <LibSynapse/GlobalStats.h>
 #include <LibCore/Debug.h>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <unordered_set>
 #include <CLI/CLI.hpp>
 #include <nlohmann/json.hpp>
 
@@ -22,6 +28,58 @@ std::string nf_name_from_bdd(const std::string &bdd_fname) {
   return nf_name;
 }
 
+// The global stats are process-wide counters, so a sweep reports the difference between two snapshots for each of its runs.
+struct global_stats_t {
+  u64 num_phase1_speculations;
+  u64 num_phase2_speculations;
+  u64 num_phase3_speculations;
+  u64 num_speculation_cache_hits;
+  u64 num_speculation_cache_misses;
+  u64 num_placement_cache_hits;
+  u64 num_placement_cache_misses;
+  u64 num_trivial_queries;
+  u64 num_cache_hits;
+  u64 num_cache_misses;
+
+  // Snapshot of the counters so far.
+  global_stats_t()
+      : num_phase1_speculations(GlobalStats::num_phase1_speculations), num_phase2_speculations(GlobalStats::num_phase2_speculations),
+        num_phase3_speculations(GlobalStats::num_phase3_speculations), num_speculation_cache_hits(GlobalStats::num_speculation_cache_hits),
+        num_speculation_cache_misses(GlobalStats::num_speculation_cache_misses), num_placement_cache_hits(GlobalStats::num_placement_cache_hits),
+        num_placement_cache_misses(GlobalStats::num_placement_cache_misses), num_trivial_queries(GlobalStats::num_trivial_queries),
+        num_cache_hits(GlobalStats::num_cache_hits), num_cache_misses(GlobalStats::num_cache_misses) {}
+
+  global_stats_t operator-(const global_stats_t &other) const {
+    global_stats_t diff(*this);
+    diff.num_phase1_speculations -= other.num_phase1_speculations;
+    diff.num_phase2_speculations -= other.num_phase2_speculations;
+    diff.num_phase3_speculations -= other.num_phase3_speculations;
+    diff.num_speculation_cache_hits -= other.num_speculation_cache_hits;
+    diff.num_speculation_cache_misses -= other.num_speculation_cache_misses;
+    diff.num_placement_cache_hits -= other.num_placement_cache_hits;
+    diff.num_placement_cache_misses -= other.num_placement_cache_misses;
+    diff.num_trivial_queries -= other.num_trivial_queries;
+    diff.num_cache_hits -= other.num_cache_hits;
+    diff.num_cache_misses -= other.num_cache_misses;
+    return diff;
+  }
+
+  nlohmann::json to_json() const {
+    return {
+        {"num_phase1_speculations", num_phase1_speculations},
+        {"num_phase2_speculations", num_phase2_speculations},
+        {"num_phase3_speculations", num_phase3_speculations},
+        {"num_speculation_cache_hits", num_speculation_cache_hits},
+        {"num_speculation_cache_misses", num_speculation_cache_misses},
+        {"num_placement_cache_hits", num_placement_cache_hits},
+        {"num_placement_cache_misses", num_placement_cache_misses},
+        {"num_trivial_solver_queries", num_trivial_queries},
+        {"num_solver_cache_hits", num_cache_hits},
+        {"num_solver_cache_misses", num_cache_misses},
+    };
+  }
+};
+
 struct args_t {
   std::filesystem::path input_bdd_file;
   std::filesystem::path out_dir;
@@ -38,6 +96,8 @@ struct args_t {
   bool show_bdd{false};
   bool skip_synthesis{false};
   bool dry_run{false};
+  std::filesystem::path sweep_file;
+  SimplifyValidation simplify_validation;
 
   void print() const {
     const targets_config_t targets_config(targets_config_file);
@@ -70,6 +130,7 @@ struct args_t {
     std::cout << "]\n";
     std::cout << "  Pause on BT:        " << search_config.pause_and_show_on_backtrack << "\n";
     std::cout << "  Not greedy:         " << search_config.not_greedy << "\n";
+    std::cout << "  Max unfinished EPs: " << search_config.max_unfinished_eps << "\n";
     std::cout << "Debug:\n";
     std::cout << "  Show prof:          " << show_prof << "\n";
     std::cout << "  Show EP:            " << show_ep << "\n";
@@ -81,7 +142,7 @@ struct args_t {
   }
 };
 
-void dump_final_report(const args_t &args, const search_report_t &search_report) {
+void dump_final_report(const args_t &args, const search_report_t &search_report, const global_stats_t &global_stats) {
   const std::filesystem::path out_report_fpath = args.out_dir / (args.name + ".json");
 
   nlohmann::json report_json;
@@ -95,7 +156,7 @@ void dump_final_report(const args_t &args, const search_report_t &search_report)
   report_json["heuristic"] = nlohmann::json::object();
 
   report_json["heuristic"]["score"] = nlohmann::json::array();
-  for (const auto &score_value : search_report.score.values) {
+  for (i64 score_value : search_report.score) {
     report_json["heuristic"]["score"].push_back(score_value);
   }
 
@@ -138,11 +199,7 @@ void dump_final_report(const args_t &args, const search_report_t &search_report)
     report_json["implementations"].push_back(ds_impl_json);
   }
 
-  report_json["global_stats"] = {
-      {"num_phase1_speculations", GlobalStats::num_phase1_speculations},
-      {"num_phase2_speculations", GlobalStats::num_phase2_speculations},
-      {"num_phase3_speculations", GlobalStats::num_phase3_speculations},
-  };
+  report_json["global_stats"] = global_stats.to_json();
 
   std::ofstream out_report(out_report_fpath);
   if (!out_report.is_open()) {
@@ -153,7 +210,7 @@ void dump_final_report(const args_t &args, const search_report_t &search_report)
   out_report.close();
 }
 
-void dump_final_hr_report(const args_t &args, const search_report_t &search_report) {
+void dump_final_hr_report(const args_t &args, const search_report_t &search_report, const global_stats_t &global_stats) {
   const std::filesystem::path out_hr_report_fpath = args.out_dir / (args.name + ".txt");
 
   std::ofstream out_hr_report(out_hr_report_fpath);
@@ -177,6 +234,7 @@ void dump_final_hr_report(const args_t &args, const search_report_t &search_repo
   }
   out_hr_report << "  No reorder:         " << args.search_config.no_reorder << "\n";
   out_hr_report << "  Not greedy:         " << args.search_config.not_greedy << "\n";
+  out_hr_report << "  Max unfinished EPs: " << args.search_config.max_unfinished_eps << "\n";
   out_hr_report << "\n";
 
   out_hr_report << "Winner:\n";
@@ -208,15 +266,22 @@ void dump_final_hr_report(const args_t &args, const search_report_t &search_repo
   }
   out_hr_report << "\n";
 
-  const u64 total_speculations = GlobalStats::num_phase1_speculations;
-  const float phase1_percent   = total_speculations == 0 ? 0.0f : (100.0f * GlobalStats::num_phase1_speculations) / total_speculations;
-  const float phase2_percent   = total_speculations == 0 ? 0.0f : (100.0f * GlobalStats::num_phase2_speculations) / total_speculations;
-  const float phase3_percent   = total_speculations == 0 ? 0.0f : (100.0f * GlobalStats::num_phase3_speculations) / total_speculations;
+  const u64 total_speculations = global_stats.num_phase1_speculations;
+  const float phase1_percent   = total_speculations == 0 ? 0.0f : (100.0f * global_stats.num_phase1_speculations) / total_speculations;
+  const float phase2_percent   = total_speculations == 0 ? 0.0f : (100.0f * global_stats.num_phase2_speculations) / total_speculations;
+  const float phase3_percent   = total_speculations == 0 ? 0.0f : (100.0f * global_stats.num_phase3_speculations) / total_speculations;
 
   out_hr_report << "Global Stats:\n";
-  out_hr_report << "  Num phase 1 speculations: " << int2hr(GlobalStats::num_phase1_speculations) << " (" << phase1_percent << "%)\n";
-  out_hr_report << "  Num phase 2 speculations: " << int2hr(GlobalStats::num_phase2_speculations) << " (" << phase2_percent << "%)\n";
-  out_hr_report << "  Num phase 3 speculations: " << int2hr(GlobalStats::num_phase3_speculations) << " (" << phase3_percent << "%)\n";
+  out_hr_report << "  Num phase 1 speculations: " << int2hr(global_stats.num_phase1_speculations) << " (" << phase1_percent << "%)\n";
+  out_hr_report << "  Num phase 2 speculations: " << int2hr(global_stats.num_phase2_speculations) << " (" << phase2_percent << "%)\n";
+  out_hr_report << "  Num phase 3 speculations: " << int2hr(global_stats.num_phase3_speculations) << " (" << phase3_percent << "%)\n";
+  out_hr_report << "  Num speculation cache hits:   " << int2hr(global_stats.num_speculation_cache_hits) << "\n";
+  out_hr_report << "  Num speculation cache misses: " << int2hr(global_stats.num_speculation_cache_misses) << "\n";
+  out_hr_report << "  Num placement cache hits:     " << int2hr(global_stats.num_placement_cache_hits) << "\n";
+  out_hr_report << "  Num placement cache misses:   " << int2hr(global_stats.num_placement_cache_misses) << "\n";
+  out_hr_report << "  Num trivial solver queries: " << int2hr(global_stats.num_trivial_queries) << "\n";
+  out_hr_report << "  Num solver cache hits:      " << int2hr(global_stats.num_cache_hits) << "\n";
+  out_hr_report << "  Num solver cache misses:    " << int2hr(global_stats.num_cache_misses) << "\n";
 
   out_hr_report << "========================================================\n";
   out_hr_report.close();
@@ -237,6 +302,242 @@ bdd_profile_t build_bdd_profile(const BDD &bdd, const args_t &args, const std::u
   return bdd_profile;
 }
 
+std::string default_name(const args_t &args) {
+  std::string name = "synapse";
+  name += "-" + nf_name_from_bdd(args.input_bdd_file);
+  name += "-" + heuristic_opt_to_str.at(args.heuristic_opt);
+  name += "-" + std::to_string(args.seed);
+  if (!args.profile_file.empty()) {
+    name += "-" + args.profile_file.stem().string();
+  }
+  return name;
+}
+
+// A sweep runs every combination of profiles x heuristics x seeds x target configs given in a JSON spec:
+//
+//   {
+//     "profiles":   ["fw-flows-1000.json", ...], (optional, --profile or random profiles if missing or empty)
+//     "heuristics": ["maxtput", ...],
+//     "seeds":      [0, 1, ...],
+//     "configs":    ["tofino2.toml", ...]
+//   }
+//
+// The BDD is loaded once, each target config and profile (and its profiler) is built once, and the searches share them, running one after the other.
+// Everything else (the search flags, --skip-synthesis) comes from the command line and applies to every run.
+struct sweep_spec_t {
+  std::vector<std::filesystem::path> profiles;
+  std::vector<HeuristicOption> heuristics;
+  std::vector<u32> seeds;
+  std::vector<std::filesystem::path> configs;
+
+  sweep_spec_t(const std::filesystem::path &spec_file) {
+    std::ifstream spec_stream(spec_file);
+    if (!spec_stream.is_open()) {
+      panic("Failed to open sweep spec file: %s", spec_file.string().c_str());
+    }
+
+    const nlohmann::json spec_json = nlohmann::json::parse(spec_stream);
+    const std::filesystem::path spec_dir = spec_file.parent_path();
+
+    // Relative paths are relative to the spec itself, so that specs can be checked in next to what they sweep.
+    auto resolve = [&spec_dir](const std::filesystem::path &path) { return path.is_absolute() ? path : spec_dir / path; };
+
+    if (spec_json.contains("profiles")) {
+      for (const std::string &profile : spec_json.at("profiles")) {
+        profiles.push_back(resolve(profile));
+      }
+    }
+
+    for (const std::string &heuristic : spec_json.at("heuristics")) {
+      auto found_it = std::find_if(str_to_heuristic_opt.begin(), str_to_heuristic_opt.end(), [&heuristic](const auto &entry) {
+        return std::equal(entry.first.begin(), entry.first.end(), heuristic.begin(), heuristic.end(),
+                          [](char a, char b) { return std::tolower(a) == std::tolower(b); });
+      });
+      if (found_it == str_to_heuristic_opt.end()) {
+        panic("Unknown heuristic in sweep spec: %s", heuristic.c_str());
+      }
+      heuristics.push_back(found_it->second);
+    }
+
+    for (u32 seed : spec_json.at("seeds")) {
+      seeds.push_back(seed);
+    }
+
+    for (const std::string &config : spec_json.at("configs")) {
+      configs.push_back(resolve(config));
+    }
+
+    if (heuristics.empty() || seeds.empty() || configs.empty()) {
+      panic("Sweep spec needs at least one heuristic, one seed, and one config");
+    }
+  }
+};
+
+struct sweep_run_t {
+  args_t args;
+  const targets_config_t *targets_config;
+  const Profiler *profiler;
+  std::optional<search_report_t> report;
+};
+
+void dump_sweep_summary(const args_t &args, const std::vector<sweep_run_t> &runs, double elapsed_time) {
+  const std::filesystem::path out_csv_fpath  = args.out_dir / (args.name + ".csv");
+  const std::filesystem::path out_json_fpath = args.out_dir / (args.name + ".json");
+
+  std::ofstream out_csv(out_csv_fpath);
+  if (!out_csv.is_open()) {
+    panic("Failed to open output report file: %s", out_csv_fpath.string().c_str());
+  }
+
+  out_csv << "name,profile,config,heuristic,seed,score,tput_estimation_pps,tput_estimation_bps,elapsed_time_seconds,steps,backtracks,ss_size,"
+             "finished_eps\n";
+
+  nlohmann::json summary_json;
+  summary_json["bdd"]                  = args.input_bdd_file.filename().string();
+  summary_json["elapsed_time_seconds"] = elapsed_time;
+  summary_json["runs"]                 = nlohmann::json::array();
+
+  for (const sweep_run_t &run : runs) {
+    std::stringstream score;
+    score << run.report->score;
+
+    out_csv << run.args.name << ",";
+    out_csv << run.args.profile_file.filename().string() << ",";
+    out_csv << run.args.targets_config_file.filename().string() << ",";
+    out_csv << heuristic_opt_to_str.at(run.args.heuristic_opt) << ",";
+    out_csv << run.args.seed << ",";
+    out_csv << "\"" << score.str() << "\",";
+    out_csv << run.report->tput_estimation_pps << ",";
+    out_csv << run.report->tput_estimation_bps << ",";
+    out_csv << run.report->meta.elapsed_time << ",";
+    out_csv << run.report->meta.steps << ",";
+    out_csv << run.report->meta.backtracks << ",";
+    out_csv << run.report->meta.ss_size << ",";
+    out_csv << run.report->meta.finished_eps << "\n";
+
+    nlohmann::json run_json;
+    run_json["name"]                 = run.args.name;
+    run_json["profile_file"]         = run.args.profile_file.filename().string();
+    run_json["targets_config_file"]  = run.args.targets_config_file.filename().string();
+    run_json["heuristic"]            = heuristic_opt_to_str.at(run.args.heuristic_opt);
+    run_json["seed"]                 = run.args.seed;
+    run_json["score"]                = std::vector<i64>(run.report->score.begin(), run.report->score.end());
+    run_json["tput_estimation_pps"]  = run.report->tput_estimation_pps;
+    run_json["tput_estimation_bps"]  = run.report->tput_estimation_bps;
+    run_json["elapsed_time_seconds"] = run.report->meta.elapsed_time;
+    run_json["steps"]                = run.report->meta.steps;
+    run_json["backtracks"]           = run.report->meta.backtracks;
+    run_json["ss_size"]              = run.report->meta.ss_size;
+    run_json["finished_eps"]         = run.report->meta.finished_eps;
+    summary_json["runs"].push_back(run_json);
+  }
+
+  summary_json["global_stats"] = global_stats_t().to_json();
+
+  std::ofstream out_json(out_json_fpath);
+  if (!out_json.is_open()) {
+    panic("Failed to open output report file: %s", out_json_fpath.string().c_str());
+  }
+
+  out_json << std::setw(2) << summary_json << "\n";
+}
+
+int run_sweep(const args_t &args) {
+  const sweep_spec_t spec(args.sweep_file);
+  const auto start_sweep = std::chrono::steady_clock::now();
+
+  SymbolManager symbol_manager;
+  const BDD bdd(args.input_bdd_file, &symbol_manager);
+
+  std::vector<std::unique_ptr<const targets_config_t>> targets_configs;
+  for (const std::filesystem::path &config : spec.configs) {
+    targets_configs.push_back(std::make_unique<const targets_config_t>(config));
+  }
+
+  // Profilers are built up front, on this thread, once per (profile, config). Random profiles depend on the seed, so those are built once per
+  // (seed, config) instead.
+  std::map<std::pair<std::string, size_t>, std::unique_ptr<const Profiler>> profilers;
+  auto get_profiler = [&](const args_t &run_args, size_t config_idx) {
+    const std::string key = run_args.profile_file.empty() ? "random-" + std::to_string(run_args.seed) : run_args.profile_file.string();
+
+    std::unique_ptr<const Profiler> &profiler = profilers[{key, config_idx}];
+    if (!profiler) {
+      const std::unordered_set<u16> available_devs = targets_configs[config_idx]->tofino_config.get_available_devs();
+      SingletonRandomEngine::seed(run_args.seed);
+      profiler = std::make_unique<const Profiler>(&bdd, build_bdd_profile(bdd, run_args, available_devs), available_devs);
+    }
+
+    return profiler.get();
+  };
+
+  std::vector<std::filesystem::path> profiles = spec.profiles;
+  if (profiles.empty()) {
+    profiles.push_back(args.profile_file);
+  }
+
+  std::vector<sweep_run_t> runs;
+  for (size_t config_idx = 0; config_idx < spec.configs.size(); config_idx++) {
+    for (const std::filesystem::path &profile : profiles) {
+      for (HeuristicOption heuristic : spec.heuristics) {
+        for (u32 seed : spec.seeds) {
+          args_t run_args              = args;
+          run_args.targets_config_file = spec.configs[config_idx];
+          run_args.profile_file        = profile;
+          run_args.heuristic_opt       = heuristic;
+          run_args.seed                = seed;
+          run_args.name                = default_name(run_args);
+          if (spec.configs.size() > 1) {
+            run_args.name += "-" + run_args.targets_config_file.stem().string();
+          }
+
+          runs.push_back({run_args, targets_configs[config_idx].get(), get_profiler(run_args, config_idx), {}});
+        }
+      }
+    }
+  }
+
+  // Names only use the stems of the profiles and configs, which may repeat across directories, so repeated names are numbered.
+  std::unordered_set<std::string> names;
+  for (sweep_run_t &run : runs) {
+    const std::string name = run.args.name;
+    for (size_t i = 1; !names.insert(run.args.name).second; i++) {
+      run.args.name = name + "-" + std::to_string(i);
+    }
+  }
+
+  std::cout << "Sweep: " << runs.size() << " runs\n";
+
+  for (sweep_run_t &run : runs) {
+    // Every run gets exactly the random sequence it would get on its own.
+    SingletonRandomEngine::seed(run.args.seed);
+
+    const global_stats_t global_stats_before;
+
+    SearchEngine engine(bdd, run.args.heuristic_opt, *run.profiler, *run.targets_config, run.args.search_config);
+    run.report.emplace(engine.search());
+
+    const global_stats_t global_stats = global_stats_t() - global_stats_before;
+
+    if (!run.args.out_dir.empty()) {
+      if (!run.args.skip_synthesis) {
+        synthesize(run.report->ep.get(), run.args.name, run.args.out_dir);
+      }
+
+      dump_final_hr_report(run.args, *run.report, global_stats);
+      dump_final_report(run.args, *run.report, global_stats);
+    }
+
+    std::cout << "Finished " << run.args.name << " (" << run.report->meta.elapsed_time << " s)\n";
+  }
+
+  const double elapsed_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_sweep).count();
+  dump_sweep_summary(args, runs, elapsed_time);
+
+  std::cout << "Sweep finished in " << elapsed_time << " s\n";
+
+  return 0;
+}
+
 int main(int argc, char **argv) {
   CLI::App app{"Synapse"};
 
@@ -245,34 +546,52 @@ int main(int argc, char **argv) {
   app.add_option("--in", args.input_bdd_file, "Input file for BDD deserialization.")->required();
   app.add_option("--out", args.out_dir, "Output directory for every generated file.")->default_val(".");
   app.add_option("--name", args.name, "Synthesized filenames (without extensions) (defaults to \"synapse-{bdd filename}\").");
-  app.add_option("--config", args.targets_config_file, "Configuration file.")->required();
-  app.add_option("--heuristic", args.heuristic_opt, "Chosen heuristic.")
-      ->transform(CLI::CheckedTransformer(str_to_heuristic_opt, CLI::ignore_case))
-      ->required();
+
+  // Either a single run, which needs both a config and a heuristic, or a sweep, which takes them from its spec.
+  CLI::Option_group *mode       = app.add_option_group("mode", "A single run or a sweep");
+  CLI::Option_group *single_run = mode->add_option_group("single run");
+  single_run->add_option("--config", args.targets_config_file, "Configuration file.");
+  single_run->add_option("--heuristic", args.heuristic_opt, "Chosen heuristic.")
+      ->transform(CLI::CheckedTransformer(str_to_heuristic_opt, CLI::ignore_case));
+  single_run->require_option(2);
+  CLI::Option *sweep =
+      mode->add_option("--sweep", args.sweep_file, "Sweep spec JSON (profiles x heuristics x seeds x configs), instead of a single run.");
+  mode->require_option(1);
+  mode->required();
+
   app.add_option("--profile", args.profile_file, "BDD profile file JSON.");
   app.add_option("--seed", args.seed, "Random seed.")->default_val(std::random_device()());
   app.add_option("--peek", args.search_config.peek, "Peek execution plans.");
   app.add_flag("--no-reorder", args.search_config.no_reorder, "Deactivate BDD reordering.");
-  app.add_flag("--show-prof", args.show_prof, "Show NF profiling.");
-  app.add_flag("--show-ep", args.show_ep, "Show winner Execution Plan.");
-  app.add_flag("--show-ss", args.show_ss, "Show the entire search space.");
-  app.add_flag("--show-bdd", args.show_bdd, "Show the BDD's solution.");
-  app.add_flag("--backtrack", args.search_config.pause_and_show_on_backtrack, "Pause on backtrack.");
+  // Interactive, so only for single runs.
+  app.add_flag("--show-prof", args.show_prof, "Show NF profiling.")->excludes(sweep);
+  app.add_flag("--show-ep", args.show_ep, "Show winner Execution Plan.")->excludes(sweep);
+  app.add_flag("--show-ss", args.show_ss, "Show the entire search space.")->excludes(sweep);
+  app.add_flag("--show-bdd", args.show_bdd, "Show the BDD's solution.")->excludes(sweep);
+  app.add_flag("--backtrack", args.search_config.pause_and_show_on_backtrack, "Pause on backtrack.")->excludes(sweep);
   app.add_flag("--not-greedy", args.search_config.not_greedy, "Don't stop on first solution.");
+  app.add_option("--max-unfinished-eps", args.search_config.max_unfinished_eps, "Maximum number of unfinished execution plans (0 for unlimited).")
+      ->default_val(0);
+  app.add_option("--simplify-validation", args.simplify_validation, "Solver validation of new expression simplifications.")
+      ->default_val(get_simplify_validation())
+      ->transform(CLI::CheckedTransformer(str_to_simplify_validation, CLI::ignore_case));
   app.add_flag("--random-uniform-profile", args.random_uniform_profile, "Use a random uniform profile for the BDD.");
   app.add_flag("--skip-synthesis", args.skip_synthesis, "Skip synthesis step (only search).");
-  app.add_flag("--dry-run", args.dry_run, "Don't run search.");
+  app.add_flag("--dry-run", args.dry_run, "Don't run search.")->excludes(sweep);
 
   CLI11_PARSE(app, argc, argv);
 
-  if (args.name.empty()) {
-    args.name = "synapse";
-    args.name += "-" + nf_name_from_bdd(args.input_bdd_file);
-    args.name += "-" + heuristic_opt_to_str.at(args.heuristic_opt);
-    args.name += "-" + std::to_string(args.seed);
-    if (!args.profile_file.empty()) {
-      args.name += "-" + args.profile_file.stem().string();
+  set_simplify_validation(args.simplify_validation);
+
+  if (!args.sweep_file.empty()) {
+    if (args.name.empty()) {
+      args.name = "synapse-" + nf_name_from_bdd(args.input_bdd_file) + "-sweep";
     }
+    return run_sweep(args);
+  }
+
+  if (args.name.empty()) {
+    args.name = default_name(args);
   }
 
   if (args.dry_run) {
@@ -322,8 +641,9 @@ int main(int argc, char **argv) {
   }
 
   if (!args.out_dir.empty()) {
-    dump_final_hr_report(args, report);
-    dump_final_report(args, report);
+    const global_stats_t global_stats;
+    dump_final_hr_report(args, report, global_stats);
+    dump_final_report(args, report, global_stats);
   }
 
   report.ep->get_ctx().debug();
@@ -356,6 +676,23 @@ int main(int argc, char **argv) {
             << percent2str(GlobalStats::num_phase2_speculations, GlobalStats::num_phase1_speculations, 2) << ")\n";
   std::cout << "    Phase 3: " << int2hr(GlobalStats::num_phase3_speculations) << " ("
             << percent2str(GlobalStats::num_phase3_speculations, GlobalStats::num_phase1_speculations, 2) << ")\n";
+  std::cout << "  Speculation cache:\n";
+  std::cout << "    Hits:   " << int2hr(GlobalStats::num_speculation_cache_hits) << " ("
+            << percent2str(GlobalStats::num_speculation_cache_hits,
+                           GlobalStats::num_speculation_cache_hits + GlobalStats::num_speculation_cache_misses, 2)
+            << ")\n";
+  std::cout << "    Misses: " << int2hr(GlobalStats::num_speculation_cache_misses) << "\n";
+  std::cout << "  Placement cache:\n";
+  std::cout << "    Hits:   " << int2hr(GlobalStats::num_placement_cache_hits) << " ("
+            << percent2str(GlobalStats::num_placement_cache_hits,
+                           GlobalStats::num_placement_cache_hits + GlobalStats::num_placement_cache_misses, 2)
+            << ")\n";
+  std::cout << "    Misses: " << int2hr(GlobalStats::num_placement_cache_misses) << "\n";
+  std::cout << "  Solver queries:\n";
+  std::cout << "    Trivial:      " << int2hr(GlobalStats::num_trivial_queries) << "\n";
+  std::cout << "    Cache hits:   " << int2hr(GlobalStats::num_cache_hits) << " ("
+            << percent2str(GlobalStats::num_cache_hits, GlobalStats::num_cache_hits + GlobalStats::num_cache_misses, 2) << ")\n";
+  std::cout << "    Cache misses: " << int2hr(GlobalStats::num_cache_misses) << "\n";
   std::cout << "\n";
 
   return 0;
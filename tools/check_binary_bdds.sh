@@ -0,0 +1,38 @@
+#!/bin/bash
+
+# Round-trips every BDD in bdds/ through the binary format, and checks that nothing was lost on the way:
+# text -> text and text -> binary -> text must give the same file.
+
+set -euo pipefail
+
+export SCRIPT_DIR=$(cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd)
+export REPO_DIR=$(realpath "$SCRIPT_DIR/..")
+
+export BDDS_DIR="$REPO_DIR/bdds"
+export SYNAPSE_DIR="$REPO_DIR/synapse"
+
+export SYNAPSE_BINS_DIR="$SYNAPSE_DIR/build/bin"
+
+export CALL_PATHS_TO_BDD="$SYNAPSE_BINS_DIR/call-paths-to-bdd"
+
+TMP_DIR=$(mktemp -d)
+trap "rm -rf $TMP_DIR" EXIT
+
+failed=0
+
+for bdd in $BDDS_DIR/*.bdd; do
+	nf=$(basename $bdd .bdd)
+
+	$CALL_PATHS_TO_BDD --in $bdd --out $TMP_DIR/$nf.txt.bdd > /dev/null
+	$CALL_PATHS_TO_BDD --in $bdd --out $TMP_DIR/$nf.bin.bdd --binary > /dev/null
+	$CALL_PATHS_TO_BDD --in $TMP_DIR/$nf.bin.bdd --out $TMP_DIR/$nf.bin.txt.bdd > /dev/null
+
+	if diff -q $TMP_DIR/$nf.txt.bdd $TMP_DIR/$nf.bin.txt.bdd > /dev/null; then
+		echo "$nf: ok ($(stat -c %s $bdd) -> $(stat -c %s $TMP_DIR/$nf.bin.bdd) bytes)"
+	else
+		echo "$nf: MISMATCH"
+		failed=1
+	fi
+done
+
+exit $failed
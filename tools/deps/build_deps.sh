@@ -239,6 +239,7 @@ source_install_json() {
 build_libnf() {
 	pushd "$DPDK_NFS_DIR"
 		make lib
+		make lib MAP_IMPL=swiss
 	popd
 
 	add_multiline_var_to_paths_file "LD_LIBRARY_PATH" "$DPDK_NFS_DIR/build:\${LD_LIBRARY_PATH:-}"
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+
+# Measures search throughput (steps/s) and peak memory (RSS) of synapse on the bundled BDDs.
+# Pass --baseline with a second synapse binary (e.g. built from an older commit) to compare both side by side.
+
+import os
+import json
+import time
+import tempfile
+import subprocess
+import rich
+
+from dataclasses import dataclass
+from argparse import ArgumentParser
+from pathlib import Path
+from typing import Optional
+from prettytable import PrettyTable
+
+CURRENT_DIR = Path(os.path.abspath(os.path.dirname(__file__)))
+PROJECT_DIR = (CURRENT_DIR / "..").resolve()
+
+BDD_DIR = PROJECT_DIR / "bdds"
+CONFIGS_DIR = PROJECT_DIR / "configs"
+SYNAPSE_BIN = PROJECT_DIR / "synapse" / "build" / "bin" / "synapse"
+
+DEFAULT_NFS = ["echo", "fw", "nat", "kvs", "cl", "psd", "pol"]
+DEFAULT_HEURISTIC = "max-tput"
+DEFAULT_SEED = 0
+
+
+@dataclass
+class Measurement:
+    steps: int
+    elapsed: float
+    peak_rss_kb: int
+
+    @property
+    def steps_per_sec(self) -> float:
+        return self.steps / self.elapsed if self.elapsed > 0 else 0.0
+
+
+def panic(msg: str):
+    rich.print(f"[red]ERROR: {msg}[/red]")
+    exit(1)
+
+
+def run(synapse: Path, nf: str, heuristic: str, seed: int, threads: int) -> Measurement:
+    bdd = BDD_DIR / f"{nf}.bdd"
+    config = CONFIGS_DIR / ("tofino2-kvs.toml" if nf == "kvs" else "tofino2.toml")
+
+    if not bdd.is_file():
+        panic(f'BDD "{bdd}" not found')
+
+    with tempfile.TemporaryDirectory() as out_dir:
+        name = f"bench-{nf}"
+
+        cmd = [
+            str(synapse),
+            "--in",
+            str(bdd),
+            "--config",
+            str(config),
+            "--heuristic",
+            heuristic,
+            "--seed",
+            str(seed),
+            "--random-uniform-profile",
+            "--skip-synthesis",
+            "--name",
+            name,
+            "--out",
+            out_dir,
+        ]
+
+        # Older binaries (e.g. the baseline) might not know about this option.
+        if threads > 1:
+            cmd += ["--threads", str(threads)]
+
+        start = time.perf_counter()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+        # wait4 gives us the resource usage of this child alone (ru_maxrss is in KB on Linux).
+        _, status, rusage = os.wait4(proc.pid, 0)
+        elapsed = time.perf_counter() - start
+
+        if os.waitstatus_to_exitcode(status) != 0:
+            panic(f"{' '.join(cmd)} failed")
+
+        with open(Path(out_dir) / f"{name}.json") as f:
+            report = json.load(f)
+
+    return Measurement(
+        steps=report["search_meta"]["steps"],
+        elapsed=elapsed,
+        peak_rss_kb=rusage.ru_maxrss,
+    )
+
+
+def fmt_delta(new: float, old: float) -> str:
+    if old == 0:
+        return "-"
+    return f"{(new - old) / old * 100:+.1f}%"
+
+
+def main():
+    parser = ArgumentParser(description="Benchmark synapse's search on the bundled BDDs.")
+    parser.add_argument("--synapse", type=Path, default=SYNAPSE_BIN, help="synapse binary to benchmark")
+    parser.add_argument("--baseline", type=Path, help="baseline synapse binary to compare against")
+    parser.add_argument("--nfs", type=str, nargs="+", default=DEFAULT_NFS)
+    parser.add_argument("--heuristic", type=str, default=DEFAULT_HEURISTIC)
+    parser.add_argument("--seed", type=int, default=DEFAULT_SEED)
+    parser.add_argument("--threads", type=int, default=1)
+    args = parser.parse_args()
+
+    table = PrettyTable()
+    table.align = "r"
+
+    if args.baseline:
+        table.field_names = ["NF", "Steps", "Steps/s (base)", "Steps/s", "Δ", "Peak RSS (base)", "Peak RSS", "Δ RSS"]
+    else:
+        table.field_names = ["NF", "Steps", "Time (s)", "Steps/s", "Peak RSS"]
+
+    for nf in args.nfs:
+        rich.print(f"[cyan]Running {nf}...[/cyan]")
+        m = run(args.synapse, nf, args.heuristic, args.seed, args.threads)
+
+        base: Optional[Measurement] = None
+        if args.baseline:
+            base = run(args.baseline, nf, args.heuristic, args.seed, args.threads)
+            if base.steps != m.steps:
+                rich.print(f"[yellow]WARNING: {nf} took {m.steps} steps but baseline took {base.steps}[/yellow]")
+
+        if base:
+            table.add_row(
+                [
+                    nf,
+                    m.steps,
+                    f"{base.steps_per_sec:.1f}",
+                    f"{m.steps_per_sec:.1f}",
+                    fmt_delta(m.steps_per_sec, base.steps_per_sec),
+                    f"{base.peak_rss_kb / 1024:.1f} MB",
+                    f"{m.peak_rss_kb / 1024:.1f} MB",
+                    fmt_delta(m.peak_rss_kb, base.peak_rss_kb),
+                ]
+            )
+        else:
+            table.add_row([nf, m.steps, f"{m.elapsed:.2f}", f"{m.steps_per_sec:.1f}", f"{m.peak_rss_kb / 1024:.1f} MB"])
+
+    print(table)
+
+
+if __name__ == "__main__":
+    main()